@@ -0,0 +1,141 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Runs the real obs-websocket module on top of the fake libobs in `fake-obs/`, so the server, request handlers and
+// event handlers can be load tested (see `obs-websocket-loadgen`) on a machine without OBS Studio or a GPU.
+// Usage: obs-websocket-headless [--scenes <count>] [--sources <count>] [--filters <per source>] [--fps <fps>]
+//                               [--config-dir <path>] [--websocket_port <port>] [--websocket_password <password>] ...
+//
+// Every `--websocket_*` argument is handed to the module unchanged. The collection is rebuilt on every start, only the
+// module's own config is read from and written to `--config-dir`.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <QApplication>
+#include <QDir>
+#include <QTimer>
+#include <obs-module.h>
+
+#include "fake-obs/FakeObs.h"
+
+#define DEFAULT_CONFIG_DIR "obs-websocket-headless"
+#define SIGNAL_POLL_INTERVAL_MS 100
+
+static volatile sig_atomic_t exitRequested = 0;
+
+static void OnSignal(int)
+{
+	exitRequested = 1;
+}
+
+static bool ParseCount(const char *value, size_t &out)
+{
+	char *end;
+	unsigned long long count = strtoull(value, &end, 10);
+	if (end == value || *end)
+		return false;
+	out = (size_t)count;
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	FakeObs::StartupOptions startupOptions;
+	startupOptions.configPath = QDir::temp().filePath(DEFAULT_CONFIG_DIR).toStdString();
+	startupOptions.localePath = OBS_WEBSOCKET_LOCALE_DIR;
+	FakeObs::CollectionOptions collectionOptions;
+	collectionOptions.sceneCount = 10;
+	collectionOptions.inputCount = 100;
+
+	// Our own arguments are consumed here, everything else is left for the module's command line parser
+	std::vector<char *> moduleArgs = {argv[0]};
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		bool ok = true;
+		if (argument == "--scenes" && hasValue) {
+			ok = ParseCount(argv[++i], collectionOptions.sceneCount);
+		} else if (argument == "--sources" && hasValue) {
+			ok = ParseCount(argv[++i], collectionOptions.inputCount);
+		} else if (argument == "--filters" && hasValue) {
+			ok = ParseCount(argv[++i], collectionOptions.filtersPerInput);
+		} else if (argument == "--fps" && hasValue) {
+			size_t fps;
+			ok = ParseCount(argv[++i], fps) && fps > 0;
+			if (ok)
+				startupOptions.fpsNum = (uint32_t)fps;
+		} else if (argument == "--config-dir" && hasValue) {
+			startupOptions.configPath = argv[++i];
+		} else if (argument.rfind("--websocket_", 0) == 0) {
+			moduleArgs.push_back(argv[i]);
+		} else {
+			fprintf(stderr, "Unknown argument: %s\n", argument.c_str());
+			return 1;
+		}
+
+		if (!ok) {
+			fprintf(stderr, "Invalid value for %s: %s\n", argument.c_str(), argv[i]);
+			return 1;
+		}
+	}
+
+	// The settings dialog is still constructed, so a QApplication is needed even though nothing is shown
+	qputenv("QT_QPA_PLATFORM", "offscreen");
+	int moduleArgc = (int)moduleArgs.size();
+	moduleArgs.push_back(nullptr);
+	QApplication app(moduleArgc, moduleArgs.data());
+
+	QDir().mkpath(QString::fromStdString(startupOptions.configPath + "/plugin_config/obs-websocket"));
+
+	FakeObs::Startup(startupOptions);
+	obs_module_set_locale("en-US");
+	FakeObs::CreateCollection(collectionOptions);
+
+	if (!obs_module_load()) {
+		blog(LOG_ERROR, "[HeadlessServer] Failed to load the module.");
+		FakeObs::DestroyCollection();
+		FakeObs::Shutdown();
+		return 1;
+	}
+	obs_module_post_load();
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+
+	// Quitting is not async-signal-safe, so the handler only sets a flag which the event loop polls
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+	QTimer signalTimer;
+	QObject::connect(&signalTimer, &QTimer::timeout, [] {
+		if (exitRequested)
+			QCoreApplication::quit();
+	});
+	signalTimer.start(SIGNAL_POLL_INTERVAL_MS);
+	blog(LOG_INFO, "[HeadlessServer] Running. Press Ctrl+C to exit.");
+	int ret = app.exec();
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN);
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_EXIT);
+	obs_module_unload();
+	obs_module_free_locale();
+	FakeObs::DestroyCollection();
+	FakeObs::Shutdown();
+	return ret;
+}
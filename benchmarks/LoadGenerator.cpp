@@ -0,0 +1,617 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Drives a running obs-websocket server with a scenario of requests, request batches and subscription changes, then
+// reports client side throughput and latency next to the server's own `GetRequestStats` and `GetEventStats`.
+// Usage: obs-websocket-loadgen <scenario.json> [--url ws://127.0.0.1:4455] [--password <password>] [--output <results.json>]
+//
+// Scenarios (see `scenarios/`) are Json objects with these fields:
+// - `name`, `sessions`, `encoding` (`json` or `msgpack`), `eventSubscriptions`, `durationSeconds`, `inFlight`, `seed`
+// - `mix`: weighted entries, each with one of `request` (Request data), `batch` (RequestBatch data) or `reidentify`
+//   (Reidentify data), plus an optional `weight` and `label`. Results are grouped by label.
+//
+// All sessions share one IO thread. When the client becomes the bottleneck, run several instances side by side.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <nlohmann/json.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+using json = nlohmann::json;
+typedef websocketpp::client<websocketpp::config::asio_client> Client;
+typedef std::chrono::steady_clock Clock;
+
+#define DEFAULT_URL "ws://127.0.0.1:4455"
+#define RPC_VERSION 1
+// How long to wait for outstanding responses after the scenario duration, before giving up on them
+#define DRAIN_TIMEOUT_MS 10000
+
+struct MixEntry {
+	std::string label;
+	int op; // 3 (Reidentify), 6 (Request) or 8 (RequestBatch)
+	json data;
+};
+
+struct Scenario {
+	std::string name;
+	size_t sessions = 1;
+	bool msgPack = false;
+	uint64_t eventSubscriptions = 0;
+	double durationSeconds = 10;
+	size_t inFlight = 1; // Outstanding messages per session
+	uint32_t seed = 1;
+	std::vector<MixEntry> mix;
+	std::vector<double> weights;
+};
+
+struct LabelStats {
+	std::vector<double> latenciesUs;
+	uint64_t failures = 0;
+};
+
+struct Session {
+	websocketpp::connection_hdl hdl;
+	bool control = false;
+	bool identified = false;
+	bool done = false;
+	uint64_t nextRequestId = 0;
+	std::unordered_map<std::string, std::pair<size_t, Clock::time_point>> pendingRequests; // requestId: mix index, sent at
+	std::deque<std::pair<size_t, Clock::time_point>> pendingReidentifies;                  // Answered in order
+	uint64_t eventsReceived = 0;
+
+	size_t Outstanding() const { return pendingRequests.size() + pendingReidentifies.size(); }
+};
+
+static const char *GetExecutionTypeName(int executionType)
+{
+	switch (executionType) {
+	case 0:
+		return "SerialRealtime";
+	case 1:
+		return "SerialFrame";
+	case 2:
+		return "Parallel";
+	default:
+		return "None";
+	}
+}
+
+static std::string Sha256Base64(const std::string &data)
+{
+	return QCryptographicHash::hash(QByteArray::fromStdString(data), QCryptographicHash::Algorithm::Sha256)
+		.toBase64()
+		.toStdString();
+}
+
+static double GetPercentile(const std::vector<double> &sorted, double percentile)
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t index = std::min(sorted.size() - 1, (size_t)(percentile * sorted.size()));
+	return sorted[index];
+}
+
+static bool LoadScenario(const std::string &path, Scenario &scenario)
+{
+	std::ifstream f(path);
+	if (!f.is_open()) {
+		fprintf(stderr, "Unable to open scenario file: %s\n", path.c_str());
+		return false;
+	}
+
+	json scenarioJson;
+	try {
+		scenarioJson = json::parse(f);
+	} catch (json::exception &e) {
+		fprintf(stderr, "Unable to parse scenario file: %s\n", e.what());
+		return false;
+	}
+
+	try {
+		scenario.name = scenarioJson.value("name", path);
+		scenario.sessions = scenarioJson.value("sessions", (size_t)1);
+		scenario.msgPack = scenarioJson.value("encoding", std::string("json")) == "msgpack";
+		scenario.eventSubscriptions = scenarioJson.value("eventSubscriptions", (uint64_t)0);
+		scenario.durationSeconds = scenarioJson.value("durationSeconds", 10.0);
+		scenario.inFlight = scenarioJson.value("inFlight", (size_t)1);
+		scenario.seed = scenarioJson.value("seed", (uint32_t)1);
+
+		for (auto &entryJson : scenarioJson.at("mix")) {
+			MixEntry entry;
+			if (entryJson.contains("request")) {
+				entry.op = 6;
+				entry.data = entryJson["request"];
+				entry.label = entry.data.at("requestType").get<std::string>();
+			} else if (entryJson.contains("batch")) {
+				entry.op = 8;
+				entry.data = entryJson["batch"];
+				int executionType = entry.data.value("executionType", 0);
+				entry.label = std::string("RequestBatch(") + GetExecutionTypeName(executionType) + ")";
+			} else if (entryJson.contains("reidentify")) {
+				entry.op = 3;
+				entry.data = entryJson["reidentify"];
+				entry.label = "Reidentify";
+			} else {
+				fprintf(stderr, "Mix entries need one of `request`, `batch` or `reidentify`\n");
+				return false;
+			}
+			entry.label = entryJson.value("label", entry.label);
+			scenario.mix.push_back(std::move(entry));
+			scenario.weights.push_back(entryJson.value("weight", 1.0));
+		}
+	} catch (json::exception &e) {
+		fprintf(stderr, "Invalid scenario: %s\n", e.what());
+		return false;
+	}
+
+	if (!scenario.sessions || !scenario.inFlight || scenario.mix.empty()) {
+		fprintf(stderr, "Scenarios need at least one session, one message in flight and one mix entry\n");
+		return false;
+	}
+
+	return true;
+}
+
+class LoadGenerator {
+public:
+	LoadGenerator(const Scenario &scenario, const std::string &password)
+		: _scenario(scenario),
+		  _password(password),
+		  _rng(scenario.seed),
+		  _mixDistribution(scenario.weights.begin(), scenario.weights.end())
+	{
+		_client.clear_access_channels(websocketpp::log::alevel::all);
+		_client.clear_error_channels(websocketpp::log::elevel::all);
+		_client.init_asio();
+	}
+
+	bool Run(const std::string &url)
+	{
+		// The last session is the control session, which only resets and collects the server's stats
+		_sessions.resize(_scenario.sessions + 1);
+		_sessions.back().control = true;
+
+		for (auto &session : _sessions) {
+			websocketpp::lib::error_code errorCode;
+			Client::connection_ptr conn = _client.get_connection(url, errorCode);
+			if (errorCode) {
+				fprintf(stderr, "Unable to create connection: %s\n", errorCode.message().c_str());
+				return false;
+			}
+
+			conn->add_subprotocol(_scenario.msgPack ? "obswebsocket.msgpack" : "obswebsocket.json", errorCode);
+			Session *sessionPtr = &session;
+			conn->set_message_handler([this, sessionPtr](websocketpp::connection_hdl, Client::message_ptr message) {
+				OnMessage(*sessionPtr, message);
+			});
+			conn->set_fail_handler([this](websocketpp::connection_hdl hdl) {
+				auto failedConn = _client.get_con_from_hdl(hdl);
+				Fail("Connection failed: " + failedConn->get_ec().message());
+			});
+			conn->set_close_handler([this](websocketpp::connection_hdl hdl) {
+				auto closedConn = _client.get_con_from_hdl(hdl);
+				if (!_finished)
+					Fail("Connection closed by the server: " + closedConn->get_remote_close_reason());
+			});
+			session.hdl = conn->get_handle();
+			_client.connect(conn);
+		}
+
+		_client.run();
+		return _succeeded;
+	}
+
+	json GetResults() const { return _results; }
+
+private:
+	void Send(Session &session, const json &message)
+	{
+		websocketpp::lib::error_code errorCode;
+		if (_scenario.msgPack) {
+			auto msgPackData = json::to_msgpack(message);
+			_client.send(session.hdl, msgPackData.data(), msgPackData.size(), websocketpp::frame::opcode::binary,
+				     errorCode);
+		} else {
+			_client.send(session.hdl, message.dump(), websocketpp::frame::opcode::text, errorCode);
+		}
+
+		if (errorCode)
+			Fail("Send failed: " + errorCode.message());
+	}
+
+	void SendControlRequest(const std::string &requestType, const json &requestData = nullptr)
+	{
+		json message;
+		message["op"] = 6;
+		message["d"]["requestType"] = requestType;
+		message["d"]["requestId"] = requestType;
+		if (!requestData.is_null())
+			message["d"]["requestData"] = requestData;
+		_controlPending++;
+		Send(_sessions.back(), message);
+	}
+
+	void OnMessage(Session &session, Client::message_ptr message)
+	{
+		// Binary frames on Json sessions are volume meters or attachments, which are not part of the measurement
+		json incomingMessage;
+		try {
+			if (_scenario.msgPack)
+				incomingMessage = json::from_msgpack(message->get_payload());
+			else if (message->get_opcode() == websocketpp::frame::opcode::text)
+				incomingMessage = json::parse(message->get_payload());
+			else
+				return;
+		} catch (json::exception &) {
+			return;
+		}
+
+		if (!incomingMessage.is_object() || !incomingMessage.contains("op"))
+			return;
+
+		json &d = incomingMessage["d"];
+		switch (incomingMessage["op"].get<int>()) {
+		case 0: // Hello
+			Identify(session, d);
+			break;
+		case 2: // Identified
+			if (!session.identified) {
+				session.identified = true;
+				if (++_identifiedSessions == _sessions.size())
+					StartResetting();
+			} else if (!session.pendingReidentifies.empty()) {
+				auto [mixIndex, sentAt] = session.pendingReidentifies.front();
+				session.pendingReidentifies.pop_front();
+				Complete(session, mixIndex, sentAt, true);
+			}
+			break;
+		case 5: // Event
+			session.eventsReceived++;
+			break;
+		case 7:   // RequestResponse
+		case 9: { // RequestBatchResponse
+			std::string requestId = d.value("requestId", "");
+			if (session.control) {
+				OnControlResponse(requestId, d);
+				break;
+			}
+
+			auto it = session.pendingRequests.find(requestId);
+			if (it == session.pendingRequests.end())
+				break;
+
+			bool success = true;
+			if (d.contains("requestStatus")) {
+				success = d["requestStatus"].value("result", false);
+			} else if (d.contains("results")) {
+				for (auto &result : d["results"])
+					success = success && result["requestStatus"].value("result", false);
+			}
+
+			auto [mixIndex, sentAt] = it->second;
+			session.pendingRequests.erase(it);
+			Complete(session, mixIndex, sentAt, success);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	void Identify(Session &session, const json &hello)
+	{
+		json message;
+		message["op"] = 1;
+		message["d"]["rpcVersion"] = RPC_VERSION;
+		message["d"]["eventSubscriptions"] = session.control ? 0 : _scenario.eventSubscriptions;
+		if (hello.contains("authentication")) {
+			std::string secret = Sha256Base64(_password + hello["authentication"]["salt"].get<std::string>());
+			message["d"]["authentication"] =
+				Sha256Base64(secret + hello["authentication"]["challenge"].get<std::string>());
+		}
+		Send(session, message);
+	}
+
+	void StartResetting()
+	{
+		_stage = Stage::Resetting;
+		SendControlRequest("GetRequestStats", {{"reset", true}});
+		SendControlRequest("GetEventStats", {{"reset", true}});
+	}
+
+	void StartRunning()
+	{
+		printf("Running `%s`: %zu %s sessions, %zu in flight each, for %.1f seconds\n", _scenario.name.c_str(),
+		       _scenario.sessions, _scenario.msgPack ? "MsgPack" : "Json", _scenario.inFlight, _scenario.durationSeconds);
+
+		_stage = Stage::Running;
+		_startedAt = Clock::now();
+		_deadline = _startedAt + std::chrono::duration_cast<Clock::duration>(
+						 std::chrono::duration<double>(_scenario.durationSeconds));
+
+		// Sessions only send in response to responses, so this makes sure that the run ends even if none come back
+		long timeoutMs = (long)(_scenario.durationSeconds * 1000) + DRAIN_TIMEOUT_MS;
+		_drainTimer = _client.set_timer(timeoutMs, [this](const websocketpp::lib::error_code &errorCode) {
+			if (errorCode || _stage != Stage::Running)
+				return;
+			fprintf(stderr, "Timed out waiting for responses, results only include completed messages\n");
+			StartCollecting();
+		});
+
+		for (auto &session : _sessions) {
+			if (session.control)
+				continue;
+			for (size_t i = 0; i < _scenario.inFlight; i++)
+				SendNext(session);
+		}
+	}
+
+	void SendNext(Session &session)
+	{
+		if (_stage != Stage::Running || session.done)
+			return;
+
+		if (Clock::now() >= _deadline) {
+			if (session.Outstanding() == 0) {
+				session.done = true;
+				if (++_doneSessions == _scenario.sessions)
+					StartCollecting();
+			}
+			return;
+		}
+
+		size_t mixIndex = _mixDistribution(_rng);
+		const MixEntry &entry = _scenario.mix[mixIndex];
+
+		json message;
+		message["op"] = entry.op;
+		message["d"] = entry.data;
+		if (entry.op == 3) {
+			session.pendingReidentifies.emplace_back(mixIndex, Clock::now());
+		} else {
+			std::string requestId = std::to_string(session.nextRequestId++);
+			message["d"]["requestId"] = requestId;
+			session.pendingRequests[requestId] = {mixIndex, Clock::now()};
+		}
+		Send(session, message);
+	}
+
+	void Complete(Session &session, size_t mixIndex, Clock::time_point sentAt, bool success)
+	{
+		auto &stats = _labelStats[_scenario.mix[mixIndex].label];
+		stats.latenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sentAt).count());
+		if (!success)
+			stats.failures++;
+		_completedAt = Clock::now();
+
+		SendNext(session);
+	}
+
+	void StartCollecting()
+	{
+		_stage = Stage::Collecting;
+		if (_drainTimer)
+			_drainTimer->cancel();
+
+		SendControlRequest("GetRequestStats");
+		SendControlRequest("GetEventStats");
+		SendControlRequest("GetStats");
+	}
+
+	void OnControlResponse(const std::string &requestType, const json &d)
+	{
+		// Servers without the stats requests still get client side results
+		if (d.contains("responseData"))
+			_serverStats[requestType] = d["responseData"];
+		else
+			_serverStats[requestType] = nullptr;
+
+		if (--_controlPending)
+			return;
+
+		if (_stage == Stage::Resetting)
+			StartRunning();
+		else if (_stage == Stage::Collecting)
+			Finish();
+	}
+
+	void Finish()
+	{
+		_finished = true;
+		_succeeded = true;
+		Report();
+
+		for (auto &session : _sessions) {
+			websocketpp::lib::error_code errorCode;
+			_client.close(session.hdl, websocketpp::close::status::normal, "Load generator finished.", errorCode);
+		}
+	}
+
+	void Fail(const std::string &reason)
+	{
+		if (_finished)
+			return;
+
+		fprintf(stderr, "%s\n", reason.c_str());
+		_finished = true;
+		_client.stop();
+	}
+
+	void Report()
+	{
+		double elapsedSeconds = std::chrono::duration<double>(_completedAt - _startedAt).count();
+		if (elapsedSeconds <= 0)
+			elapsedSeconds = _scenario.durationSeconds;
+
+		_results["scenario"] = _scenario.name;
+		_results["elapsedSeconds"] = elapsedSeconds;
+
+		printf("\n%-40s %10s %8s %12s %10s %10s %10s %10s\n", "client (latency in us)", "count", "failed", "per second",
+		       "p50", "p99", "p999", "max");
+
+		uint64_t totalCount = 0;
+		std::vector<std::string> labels;
+		for (auto &[label, stats] : _labelStats)
+			labels.push_back(label);
+		std::sort(labels.begin(), labels.end());
+
+		for (auto &label : labels) {
+			auto &stats = _labelStats[label];
+			std::sort(stats.latenciesUs.begin(), stats.latenciesUs.end());
+			size_t count = stats.latenciesUs.size();
+			totalCount += count;
+
+			json labelResults;
+			labelResults["count"] = count;
+			labelResults["failed"] = stats.failures;
+			labelResults["perSecond"] = count / elapsedSeconds;
+			labelResults["p50"] = GetPercentile(stats.latenciesUs, 0.5);
+			labelResults["p99"] = GetPercentile(stats.latenciesUs, 0.99);
+			labelResults["p999"] = GetPercentile(stats.latenciesUs, 0.999);
+			labelResults["max"] = count ? stats.latenciesUs.back() : 0.0;
+			_results["client"][label] = labelResults;
+
+			printf("%-40s %10zu %8llu %12.1f %10.1f %10.1f %10.1f %10.1f\n", label.c_str(), count,
+			       (unsigned long long)stats.failures, labelResults["perSecond"].get<double>(),
+			       labelResults["p50"].get<double>(), labelResults["p99"].get<double>(),
+			       labelResults["p999"].get<double>(), labelResults["max"].get<double>());
+		}
+
+		uint64_t eventsReceived = 0;
+		for (auto &session : _sessions)
+			eventsReceived += session.eventsReceived;
+
+		_results["totalPerSecond"] = totalCount / elapsedSeconds;
+		_results["eventsReceived"] = eventsReceived;
+		printf("\nTotal: %.1f messages per second over %.2f seconds, %llu events received\n",
+		       totalCount / elapsedSeconds, elapsedSeconds, (unsigned long long)eventsReceived);
+
+		_results["server"] = _serverStats;
+
+		json &requestStats = _serverStats["GetRequestStats"];
+		if (requestStats.is_object() && !requestStats["requestStats"].empty()) {
+			printf("\n%-40s %10s %8s %10s %10s %10s %10s\n", "server (latency in us)", "requests", "failed",
+			       "queue p99", "decode p99", "handler p50", "handler p99");
+			for (auto &[requestType, stats] : requestStats["requestStats"].items())
+				printf("%-40s %10llu %8llu %10.1f %10.1f %10.1f %10.1f\n", requestType.c_str(),
+				       stats["requests"].get<unsigned long long>(),
+				       stats["failedRequests"].get<unsigned long long>(), stats["queueWait"]["p99"].get<double>(),
+				       stats["decode"]["p99"].get<double>(), stats["handler"]["p50"].get<double>(),
+				       stats["handler"]["p99"].get<double>());
+		}
+
+		json &eventStats = _serverStats["GetEventStats"];
+		if (eventStats.is_object() && !eventStats["eventStats"].empty()) {
+			printf("\n%-40s %10s %10s %12s %12s %12s\n", "server events", "emitted", "recipients", "json bytes",
+			       "msgpack bytes", "dispatch p99");
+			for (auto &[eventType, stats] : eventStats["eventStats"].items())
+				printf("%-40s %10llu %10llu %12llu %12llu %12.1f\n", eventType.c_str(),
+				       stats["emitted"].get<unsigned long long>(), stats["recipients"].get<unsigned long long>(),
+				       stats["jsonBytes"].get<unsigned long long>(),
+				       stats["msgPackBytes"].get<unsigned long long>(), stats["dispatch"]["p99"].get<double>());
+		}
+	}
+
+	enum class Stage {
+		Connecting,
+		Resetting,
+		Running,
+		Collecting,
+	};
+
+	const Scenario &_scenario;
+	std::string _password;
+
+	Client _client;
+	std::vector<Session> _sessions;
+	Stage _stage = Stage::Connecting;
+	size_t _identifiedSessions = 0;
+	size_t _doneSessions = 0;
+	size_t _controlPending = 0;
+	bool _finished = false;
+	bool _succeeded = false;
+
+	std::mt19937 _rng;
+	std::discrete_distribution<size_t> _mixDistribution;
+	Clock::time_point _startedAt;
+	Clock::time_point _deadline;
+	Clock::time_point _completedAt;
+	websocketpp::lib::shared_ptr<websocketpp::lib::asio::steady_timer> _drainTimer;
+
+	std::unordered_map<std::string, LabelStats> _labelStats;
+	json _serverStats;
+	json _results;
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr,
+			"Usage: %s <scenario.json> [--url ws://127.0.0.1:4455] [--password <password>] [--output <results.json>]\n",
+			argv[0]);
+		return 1;
+	}
+
+	std::string url = DEFAULT_URL;
+	std::string password;
+	std::string outputPath;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		std::string argument = argv[i];
+		if (argument == "--url") {
+			url = argv[i + 1];
+		} else if (argument == "--password") {
+			password = argv[i + 1];
+		} else if (argument == "--output") {
+			outputPath = argv[i + 1];
+		} else {
+			fprintf(stderr, "Unknown argument: %s\n", argument.c_str());
+			return 1;
+		}
+	}
+
+	Scenario scenario;
+	if (!LoadScenario(argv[1], scenario))
+		return 1;
+
+	LoadGenerator loadGenerator(scenario, password);
+	if (!loadGenerator.Run(url))
+		return 1;
+
+	if (!outputPath.empty()) {
+		std::ofstream f(outputPath);
+		if (!f.is_open()) {
+			fprintf(stderr, "Unable to write results to: %s\n", outputPath.c_str());
+			return 1;
+		}
+		f << loadGenerator.GetResults().dump(2) << "\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,332 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Times each stage of the per-message path in `WebSocketServer::onMessage()` and `ProcessMessage()` on its own: decode,
+// envelope validation and `Request` construction, result assembly, and encode. Request handlers are not run, their
+// cost depends on libobs. Payloads have the same shape as the messages captured from real clients and sessions.
+// Usage: obs-websocket-bench-protocol [--filter <substring>] [--min-time <seconds>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../src/requesthandler/rpc/RequestBatchRequest.h"
+#include "../src/requesthandler/rpc/RequestResult.h"
+#include "../src/utils/Json.h"
+#include "../src/websocketserver/rpc/ProtocolMessages.h"
+
+typedef std::chrono::steady_clock Clock;
+
+#define DEFAULT_MIN_TIME_SECONDS 0.5
+#define BATCH_SIZE 500
+#define SETTINGS_KEY_COUNT 400
+#define METER_INPUT_COUNT 64
+#define OP_REQUEST_RESPONSE 7
+#define OP_REQUEST_BATCH 8
+#define OP_REQUEST_BATCH_RESPONSE 9
+#define OP_EVENT 5
+#define INPUT_VOLUME_METERS_INTENT (1 << 16)
+
+struct Benchmark {
+	std::string name;
+	size_t bytesPerIteration; // Zero when throughput is not meaningful for the stage
+	std::function<size_t()> run; // Returns a value derived from the work, so it can not be optimized out
+};
+
+static volatile size_t sink;
+
+// Captured from a control surface toggling a mute button
+static const char *smallRequestJson = R"({"op":6,"d":{"requestType":"SetInputMute",)"
+				       R"("requestId":"f819dcf0-89cc-11eb-8f0e-382c4ac93b9c",)"
+				       R"("requestData":{"inputName":"Mic/Aux","inputMuted":true}}})";
+
+static std::string MakeUuid(size_t index)
+{
+	char uuid[37];
+	snprintf(uuid, sizeof(uuid), "%08zx-0000-4000-8000-%012zx", index, index * 2654435761u);
+	return uuid;
+}
+
+// A 500-item batch, like the scene item visibility sweeps stream decks send when switching layouts
+static json MakeBatchRequest()
+{
+	json requests = json::array();
+	for (size_t i = 0; i < BATCH_SIZE; i++) {
+		json request;
+		request["requestType"] = "SetSceneItemEnabled";
+		request["requestId"] = std::to_string(i);
+		request["requestData"] = {{"sceneName", "Scene " + std::to_string(i % 10 + 1)},
+					  {"sceneItemId", (int)(i / 10 + 1)},
+					  {"sceneItemEnabled", i % 2 == 0}};
+		requests.push_back(std::move(request));
+	}
+
+	json message;
+	message["op"] = OP_REQUEST_BATCH;
+	message["d"] = {{"requestId", "batch-1"}, {"haltOnFailure", false}, {"executionType", 0}, {"requests", requests}};
+	return message;
+}
+
+// Settings of a text source with a long text and a nested font, plus enough plugin keys to reach a realistic size
+static obs_data_t *MakeInputSettings()
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_string(settings, "text", std::string(2048, 'x').c_str());
+	obs_data_t *font = obs_data_create();
+	obs_data_set_string(font, "face", "Sans Serif");
+	obs_data_set_string(font, "style", "Regular");
+	obs_data_set_int(font, "size", 256);
+	obs_data_set_int(font, "flags", 0);
+	obs_data_set_obj(settings, "font", font);
+	obs_data_release(font);
+
+	for (size_t i = 0; i < SETTINGS_KEY_COUNT; i++) {
+		std::string key = "key_" + std::to_string(i);
+		switch (i % 4) {
+		case 0:
+			obs_data_set_string(settings, key.c_str(), MakeUuid(i).c_str());
+			break;
+		case 1:
+			obs_data_set_int(settings, key.c_str(), (long long)i * 1000);
+			break;
+		case 2:
+			obs_data_set_double(settings, key.c_str(), (double)i / 7.0);
+			break;
+		default:
+			obs_data_set_bool(settings, key.c_str(), i % 8 == 3);
+			break;
+		}
+	}
+	return settings;
+}
+
+static json MakeRequestResponse(const std::string &requestType, const std::string &requestId, json responseData)
+{
+	json message;
+	message["op"] = OP_REQUEST_RESPONSE;
+	message["d"] = {{"requestType", requestType},
+			{"requestId", requestId},
+			{"requestStatus", {{"result", true}, {"code", RequestStatus::Success}}},
+			{"responseData", std::move(responseData)}};
+	return message;
+}
+
+static json MakeMeterEvent()
+{
+	json inputs = json::array();
+	for (size_t i = 0; i < METER_INPUT_COUNT; i++) {
+		float level = (float)(i + 1) / (METER_INPUT_COUNT + 1);
+		json levels = json::array();
+		for (int channel = 0; channel < 2; channel++)
+			levels.push_back({level * 0.5f, level, level * 0.9f});
+		inputs.push_back({{"inputName", "Input " + std::to_string(i + 1)},
+				  {"inputUuid", MakeUuid(i)},
+				  {"inputLevelsMul", std::move(levels)}});
+	}
+
+	json message;
+	message["op"] = OP_EVENT;
+	message["d"] = {{"eventType", "InputVolumeMeters"},
+			{"eventIntent", INPUT_VOLUME_METERS_INTENT},
+			{"eventData", {{"inputs", std::move(inputs)}}}};
+	return message;
+}
+
+// The checks `onMessage()` and the `Request` case of `ProcessMessage()` make before dispatching
+static size_t BuildRequest(json &message)
+{
+	std::string closeReason;
+	if (ProtocolMessages::ValidateMessage(message, true, closeReason) != WebSocketCloseCode::DontClose)
+		return 0;
+
+	json &payloadData = message["d"];
+	if (ProtocolMessages::ValidatePayloadData(payloadData, closeReason) != WebSocketCloseCode::DontClose ||
+	    ProtocolMessages::ValidateRequest(payloadData, closeReason) != WebSocketCloseCode::DontClose)
+		return 0;
+
+	std::string requestType = payloadData["requestType"];
+	json requestData = payloadData["requestData"];
+	Request request(requestType, requestData);
+	return request.RequestType.size() + request.RequestData.size();
+}
+
+// The same walk as the `RequestBatch` case of `ProcessMessage()`
+static size_t BuildBatchRequests(json &message)
+{
+	json &payloadData = message["d"];
+	if (!payloadData.contains("requestId") || !payloadData["requests"].is_array())
+		return 0;
+
+	std::vector<json> requests = payloadData["requests"];
+	return ProtocolMessages::BuildBatchRequests(requests, RequestBatchExecutionType::SerialRealtime).size();
+}
+
+static size_t AssembleRequestResult(const json &requestJson)
+{
+	return ProtocolMessages::ConstructRequestResult(RequestResult::Success(), requestJson).size();
+}
+
+static size_t AssembleBatchResults(const json &batch)
+{
+	const json &requests = batch["d"]["requests"];
+	std::vector<json> results;
+	for (auto &requestJson : requests)
+		results.push_back(ProtocolMessages::ConstructRequestResult(RequestResult::Success(), requestJson));
+
+	json ret;
+	ret["op"] = OP_REQUEST_BATCH_RESPONSE;
+	ret["d"]["requestId"] = batch["d"]["requestId"];
+	ret["d"]["results"] = std::move(results);
+	return ret["d"]["results"].size();
+}
+
+static std::vector<Benchmark> CreateBenchmarks(obs_data_t *inputSettings)
+{
+	std::vector<Benchmark> benchmarks;
+
+	// Decode
+	std::string smallJson = smallRequestJson;
+	std::vector<uint8_t> smallMsgPack = json::to_msgpack(json::parse(smallJson));
+	json batch = MakeBatchRequest();
+	std::string batchJson = batch.dump();
+	std::vector<uint8_t> batchMsgPack = json::to_msgpack(batch);
+
+	benchmarks.push_back({"Decode/Json/SmallRequest", smallJson.size(), [=] { return json::parse(smallJson).size(); }});
+	benchmarks.push_back(
+		{"Decode/MsgPack/SmallRequest", smallMsgPack.size(), [=] { return json::from_msgpack(smallMsgPack).size(); }});
+	benchmarks.push_back({"Decode/Json/Batch500", batchJson.size(), [=] { return json::parse(batchJson).size(); }});
+	benchmarks.push_back(
+		{"Decode/MsgPack/Batch500", batchMsgPack.size(), [=] { return json::from_msgpack(batchMsgPack).size(); }});
+
+	// Envelope checks and `Request` construction, on a fresh copy of the decoded message like the server has
+	json smallDecoded = json::parse(smallJson);
+	benchmarks.push_back({"Build/SmallRequest", 0, [=] {
+				      json message = smallDecoded;
+				      return BuildRequest(message);
+			      }});
+	benchmarks.push_back({"Build/Batch500", 0, [=] {
+				      json message = batch;
+				      return BuildBatchRequests(message);
+			      }});
+
+	// Result assembly
+	benchmarks.push_back({"Assemble/SmallRequest", 0, [=] { return AssembleRequestResult(smallDecoded["d"]); }});
+	benchmarks.push_back({"Assemble/Batch500", 0, [=] { return AssembleBatchResults(batch); }});
+
+	// `GetInputSettings` response data, as a json tree and as a pre-serialized fragment
+	benchmarks.push_back({"Settings/Tree", 0, [=] { return Utils::Json::ObsDataToJson(inputSettings).size(); }});
+	benchmarks.push_back({"Settings/Fragment/Json", 0,
+			      [=] { return Utils::Json::ObsDataToFragment(inputSettings, false).get_binary().size(); }});
+	benchmarks.push_back({"Settings/Fragment/MsgPack", 0,
+			      [=] { return Utils::Json::ObsDataToFragment(inputSettings, true).get_binary().size(); }});
+
+	// Encode
+	json smallResponse = MakeRequestResponse("SetInputMute", "f819dcf0-89cc-11eb-8f0e-382c4ac93b9c", json::object());
+	json settingsTree = {{"inputSettings", Utils::Json::ObsDataToJson(inputSettings)}, {"inputKind", "text_ft2_source_v2"}};
+	json settingsResponse = MakeRequestResponse("GetInputSettings", "settings-1", settingsTree);
+	json settingsFragmentResponse = MakeRequestResponse(
+		"GetInputSettings", "settings-1",
+		{{"inputSettings", Utils::Json::ObsDataToFragment(inputSettings, false)}, {"inputKind", "text_ft2_source_v2"}});
+	json batchResponse;
+	batchResponse["op"] = OP_REQUEST_BATCH_RESPONSE;
+	batchResponse["d"]["requestId"] = "batch-1";
+	for (auto &requestJson : batch["d"]["requests"]) {
+		json result = ProtocolMessages::ConstructRequestResult(RequestResult::Success(), requestJson);
+		batchResponse["d"]["results"].push_back(std::move(result));
+	}
+	json meterEvent = MakeMeterEvent();
+
+	const std::vector<std::pair<std::string, json>> encodeMessages = {
+		{"SmallResponse", smallResponse},
+		{"Batch500Response", batchResponse},
+		{"InputSettingsResponse", settingsResponse},
+		{"InputSettingsFragmentResponse", settingsFragmentResponse},
+		{"MeterEvent", meterEvent},
+	};
+	for (auto &encodeMessage : encodeMessages) {
+		const json &message = encodeMessage.second;
+		benchmarks.push_back({"Encode/Json/" + encodeMessage.first, Utils::Json::Dump(message).size(),
+				      [=] { return Utils::Json::Dump(message).size(); }});
+		benchmarks.push_back({"Encode/MsgPack/" + encodeMessage.first, Utils::Json::ToMsgPack(message).size(),
+				      [=] { return Utils::Json::ToMsgPack(message).size(); }});
+	}
+
+	return benchmarks;
+}
+
+// Doubles the iteration count until a run takes at least `minTime`, then reports that run
+static void RunBenchmark(const Benchmark &benchmark, double minTime)
+{
+	size_t iterations = 1;
+	double seconds = 0.0;
+	while (true) {
+		size_t total = 0;
+		auto start = Clock::now();
+		for (size_t i = 0; i < iterations; i++)
+			total += benchmark.run();
+		seconds = std::chrono::duration<double>(Clock::now() - start).count();
+		sink = total;
+
+		if (seconds >= minTime || iterations >= ((size_t)1 << 30))
+			break;
+		iterations *= seconds > 0.0 ? std::clamp<size_t>((size_t)(minTime / seconds * 1.4), 2, 10) : 10;
+	}
+
+	double nsPerIteration = seconds * 1e9 / (double)iterations;
+	if (benchmark.bytesPerIteration) {
+		double mbPerSecond = (double)benchmark.bytesPerIteration * (double)iterations / seconds / (1024.0 * 1024.0);
+		printf("%-48s %14.1f ns %12zu %10.1f MiB/s\n", benchmark.name.c_str(), nsPerIteration, iterations, mbPerSecond);
+	} else {
+		printf("%-48s %14.1f ns %12zu\n", benchmark.name.c_str(), nsPerIteration, iterations);
+	}
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	std::string filter;
+	double minTime = DEFAULT_MIN_TIME_SECONDS;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		std::string argument = argv[i];
+		if (argument == "--filter") {
+			filter = argv[i + 1];
+		} else if (argument == "--min-time") {
+			minTime = atof(argv[i + 1]);
+		} else {
+			fprintf(stderr, "Unknown argument: %s\n", argument.c_str());
+			return 1;
+		}
+	}
+
+	obs_data_t *inputSettings = MakeInputSettings();
+	std::vector<Benchmark> benchmarks = CreateBenchmarks(inputSettings);
+
+	printf("%-48s %17s %12s %16s\n", "Benchmark", "Time", "Iterations", "Throughput");
+	for (auto &benchmark : benchmarks) {
+		if (filter.empty() || benchmark.name.find(filter) != std::string::npos)
+			RunBenchmark(benchmark, minTime);
+	}
+
+	obs_data_release(inputSettings);
+	return 0;
+}
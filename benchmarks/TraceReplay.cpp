@@ -0,0 +1,658 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Replays a trace recorded with `--websocket_trace <path>` against a running obs-websocket server. Every recorded session
+// is reconnected, and its inbound messages are sent at their recorded times. Latencies are reported per request type,
+// next to the latencies which were recorded in the trace.
+// Usage: obs-websocket-trace-replay <trace.bin> [--url ws://127.0.0.1:4455] [--password <password>] [--speed <factor>]
+//                                   [--output <results.json>]
+//
+// Recorded `Identify` messages are answered with `--password`, as the recorded authentication is tied to the original
+// session. Like the original clients, sessions hold their messages back until they have been identified.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <nlohmann/json.hpp>
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include "../src/utils/TraceRecorder.h"
+
+using json = nlohmann::json;
+typedef websocketpp::client<websocketpp::config::asio_client> Client;
+typedef std::chrono::steady_clock Clock;
+
+#define DEFAULT_URL "ws://127.0.0.1:4455"
+// How long to wait for outstanding responses after the last recorded message, before giving up on them
+#define DRAIN_TIMEOUT_MS 10000
+
+struct TraceMessage {
+	uint64_t offsetNs; // From the start of the trace
+	bool binary;
+	std::string payload;
+	int op = -1;
+	std::string requestId; // Requests and request batches only
+	std::string label;
+};
+
+struct TraceSession {
+	uint32_t id;
+	std::string subprotocol;
+	uint64_t connectedAtNs = 0;
+	bool disconnected = false;
+	uint64_t disconnectedAtNs = 0;
+	std::vector<TraceMessage> inbound;
+};
+
+struct LabelStats {
+	std::vector<double> recordedLatenciesUs;
+	std::vector<double> replayLatenciesUs;
+	uint64_t failures = 0;
+};
+
+static const char *GetExecutionTypeName(int executionType)
+{
+	switch (executionType) {
+	case 0:
+		return "SerialRealtime";
+	case 1:
+		return "SerialFrame";
+	case 2:
+		return "Parallel";
+	default:
+		return "None";
+	}
+}
+
+static std::string Sha256Base64(const std::string &data)
+{
+	return QCryptographicHash::hash(QByteArray::fromStdString(data), QCryptographicHash::Algorithm::Sha256)
+		.toBase64()
+		.toStdString();
+}
+
+static double GetPercentile(const std::vector<double> &sorted, double percentile)
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t index = std::min(sorted.size() - 1, (size_t)(percentile * sorted.size()));
+	return sorted[index];
+}
+
+static bool DecodeMessage(bool binary, const std::string &payload, json &message)
+{
+	try {
+		message = binary ? json::from_msgpack(payload) : json::parse(payload);
+	} catch (json::exception &) {
+		return false;
+	}
+
+	return message.is_object() && message.contains("op") && message["op"].is_number();
+}
+
+static bool ReadRecord(std::ifstream &f, Utils::Trace::RecordHeader &header, std::string &payload)
+{
+	if (!f.read((char *)&header, sizeof(header)))
+		return false;
+
+	payload.resize(header.size);
+	return header.size == 0 || (bool)f.read(payload.data(), header.size);
+}
+
+// Reads every session of the trace, and the latencies which the server recorded for each request
+static bool LoadTrace(const std::string &path, std::vector<TraceSession> &sessions,
+		      std::unordered_map<std::string, LabelStats> &labelStats)
+{
+	std::ifstream f(path, std::ios::binary);
+	if (!f.is_open()) {
+		fprintf(stderr, "Unable to open trace file: %s\n", path.c_str());
+		return false;
+	}
+
+	char fileHeader[TRACE_FILE_HEADER_SIZE];
+	uint32_t version;
+	if (!f.read(fileHeader, sizeof(fileHeader)) || memcmp(fileHeader, TRACE_FILE_MAGIC, 8) != 0) {
+		fprintf(stderr, "Not a trace file: %s\n", path.c_str());
+		return false;
+	}
+	memcpy(&version, fileHeader + 8, sizeof(version));
+	if (version != TRACE_FILE_VERSION) {
+		fprintf(stderr, "Unsupported trace version %u, expected %u\n", version, TRACE_FILE_VERSION);
+		return false;
+	}
+
+	std::map<uint32_t, TraceSession> sessionsById;
+	std::map<uint32_t, std::unordered_map<std::string, std::pair<std::string, uint64_t>>> pendingRequests;
+	uint64_t startNs = UINT64_MAX;
+	uint64_t skippedRecords = 0;
+
+	Utils::Trace::RecordHeader header;
+	std::string payload;
+	while (ReadRecord(f, header, payload)) {
+		auto it = sessionsById.find(header.sessionId);
+		if (header.type == Utils::Trace::Connected) {
+			TraceSession &session = sessionsById[header.sessionId];
+			session.id = header.sessionId;
+			session.subprotocol = payload;
+			session.connectedAtNs = header.timestamp;
+			startNs = std::min(startNs, header.timestamp);
+			continue;
+		}
+
+		// Sessions which connected before the trace was started can not be replayed
+		if (it == sessionsById.end()) {
+			skippedRecords++;
+			continue;
+		}
+		TraceSession &session = it->second;
+
+		json message;
+		switch (header.type) {
+		case Utils::Trace::Disconnected:
+			session.disconnected = true;
+			session.disconnectedAtNs = header.timestamp;
+			break;
+		case Utils::Trace::Inbound: {
+			TraceMessage traceMessage;
+			traceMessage.offsetNs = header.timestamp;
+			traceMessage.binary = header.binary;
+			if (DecodeMessage(header.binary, payload, message)) {
+				traceMessage.op = message["op"];
+				json &d = message["d"];
+				if (traceMessage.op == 6 && d.is_object()) {
+					traceMessage.requestId = d.value("requestId", "");
+					traceMessage.label = d.value("requestType", "");
+				} else if (traceMessage.op == 8 && d.is_object()) {
+					traceMessage.requestId = d.value("requestId", "");
+					traceMessage.label = std::string("RequestBatch(") +
+							     GetExecutionTypeName(d.value("executionType", 0)) + ")";
+				}
+				if (!traceMessage.requestId.empty())
+					pendingRequests[session.id][traceMessage.requestId] = {traceMessage.label,
+											       header.timestamp};
+			}
+			traceMessage.payload = std::move(payload);
+			session.inbound.push_back(std::move(traceMessage));
+			break;
+		}
+		case Utils::Trace::Outbound: {
+			// Only responses are decoded, and only while requests of the session are outstanding
+			auto &sessionPendingRequests = pendingRequests[session.id];
+			if (sessionPendingRequests.empty() || !DecodeMessage(header.binary, payload, message))
+				break;
+			int op = message["op"];
+			if (op != 7 && op != 9)
+				break;
+
+			auto request = sessionPendingRequests.find(message["d"].value("requestId", ""));
+			if (request == sessionPendingRequests.end())
+				break;
+			auto &[label, sentAt] = request->second;
+			labelStats[label].recordedLatenciesUs.push_back((double)(header.timestamp - sentAt) / 1000.0);
+			sessionPendingRequests.erase(request);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	if (sessionsById.empty()) {
+		fprintf(stderr, "The trace does not contain any sessions\n");
+		return false;
+	}
+
+	// Messages are recorded from several threads, so records are only roughly in timestamp order
+	for (auto &[sessionId, session] : sessionsById) {
+		session.connectedAtNs -= startNs;
+		if (session.disconnected)
+			session.disconnectedAtNs = std::max(session.disconnectedAtNs, startNs) - startNs;
+		for (auto &message : session.inbound)
+			message.offsetNs = std::max(message.offsetNs, startNs) - startNs;
+		std::stable_sort(session.inbound.begin(), session.inbound.end(),
+				 [](const TraceMessage &a, const TraceMessage &b) { return a.offsetNs < b.offsetNs; });
+		sessions.push_back(std::move(session));
+	}
+
+	if (skippedRecords)
+		fprintf(stderr, "Skipped %llu records of sessions which connected before the trace was started\n",
+			(unsigned long long)skippedRecords);
+
+	return true;
+}
+
+class TraceReplayer {
+public:
+	TraceReplayer(const std::vector<TraceSession> &traceSessions, std::unordered_map<std::string, LabelStats> &labelStats,
+		      const std::string &password, double speed)
+		: _traceSessions(traceSessions),
+		  _labelStats(labelStats),
+		  _password(password),
+		  _speed(speed)
+	{
+		_client.clear_access_channels(websocketpp::log::alevel::all);
+		_client.clear_error_channels(websocketpp::log::elevel::all);
+		_client.init_asio();
+	}
+
+	bool Run(const std::string &url)
+	{
+		_url = url;
+		_sessions.resize(_traceSessions.size());
+		_remainingSessions = _sessions.size();
+
+		uint64_t endNs = 0;
+		for (size_t i = 0; i < _sessions.size(); i++) {
+			const TraceSession &traceSession = _traceSessions[i];
+			Session &session = _sessions[i];
+			session.trace = &traceSession;
+			session.msgPack = traceSession.subprotocol == "obswebsocket.msgpack";
+
+			endNs = std::max(endNs, traceSession.connectedAtNs);
+			if (traceSession.disconnected)
+				endNs = std::max(endNs, traceSession.disconnectedAtNs);
+			if (!traceSession.inbound.empty())
+				endNs = std::max(endNs, traceSession.inbound.back().offsetNs);
+		}
+
+		printf("Replaying %zu sessions over %.2f seconds at %.2fx speed\n", _sessions.size(),
+		       (double)endNs / 1000000000.0, _speed);
+
+		_startedAt = Clock::now();
+		for (auto &session : _sessions) {
+			Session *sessionPtr = &session;
+			_client.set_timer(GetDelayMs(session.trace->connectedAtNs),
+					  [this, sessionPtr](const websocketpp::lib::error_code &errorCode) {
+						  if (!errorCode)
+							  Connect(*sessionPtr);
+					  });
+		}
+
+		long timeoutMs = GetDelayMs(endNs) + DRAIN_TIMEOUT_MS;
+		_drainTimer = _client.set_timer(timeoutMs, [this](const websocketpp::lib::error_code &errorCode) {
+			if (errorCode || !_remainingSessions)
+				return;
+			fprintf(stderr, "Timed out waiting for responses, results only include completed messages\n");
+			for (auto &session : _sessions)
+				Close(session, "Replay timed out.");
+		});
+
+		_client.run();
+		_completedAt = Clock::now();
+		Report();
+		return _failedSessions == 0;
+	}
+
+	json GetResults() const { return _results; }
+
+private:
+	struct Session {
+		const TraceSession *trace = nullptr;
+		websocketpp::connection_hdl hdl;
+		bool msgPack = false;
+		bool helloReceived = false;
+		json hello;
+		bool identified = false;
+		bool closing = false;
+		bool finished = false;
+		size_t nextMessage = 0;
+		// requestId: label, sent at
+		std::unordered_map<std::string, std::pair<std::string, Clock::time_point>> pendingRequests;
+	};
+
+	long GetDelayMs(uint64_t offsetNs)
+	{
+		auto due = _startedAt + std::chrono::nanoseconds((uint64_t)(offsetNs / _speed));
+		return std::max(0L, (long)std::chrono::duration_cast<std::chrono::milliseconds>(due - Clock::now()).count());
+	}
+
+	void Connect(Session &session)
+	{
+		websocketpp::lib::error_code errorCode;
+		Client::connection_ptr conn = _client.get_connection(_url, errorCode);
+		if (errorCode) {
+			fprintf(stderr, "Unable to create connection: %s\n", errorCode.message().c_str());
+			Finish(session, true);
+			return;
+		}
+
+		if (!session.trace->subprotocol.empty())
+			conn->add_subprotocol(session.trace->subprotocol, errorCode);
+		Session *sessionPtr = &session;
+		conn->set_message_handler([this, sessionPtr](websocketpp::connection_hdl, Client::message_ptr message) {
+			OnMessage(*sessionPtr, message);
+		});
+		conn->set_fail_handler([this, sessionPtr](websocketpp::connection_hdl hdl) {
+			auto failedConn = _client.get_con_from_hdl(hdl);
+			fprintf(stderr, "Session %u: Connection failed: %s\n", sessionPtr->trace->id,
+				failedConn->get_ec().message().c_str());
+			Finish(*sessionPtr, true);
+		});
+		conn->set_close_handler([this, sessionPtr](websocketpp::connection_hdl hdl) {
+			auto closedConn = _client.get_con_from_hdl(hdl);
+			if (!sessionPtr->closing) {
+				fprintf(stderr, "Session %u: Closed by the server: %s\n", sessionPtr->trace->id,
+					closedConn->get_remote_close_reason().c_str());
+				_closedByServer++;
+			}
+			Finish(*sessionPtr, false);
+		});
+		session.hdl = conn->get_handle();
+		_client.connect(conn);
+	}
+
+	void OnMessage(Session &session, Client::message_ptr message)
+	{
+		// Binary frames on Json sessions are volume meters or attachments, which are not replayed
+		if (!session.msgPack && message->get_opcode() != websocketpp::frame::opcode::text)
+			return;
+
+		json incomingMessage;
+		if (!DecodeMessage(session.msgPack, message->get_payload(), incomingMessage))
+			return;
+
+		json &d = incomingMessage["d"];
+		switch (incomingMessage["op"].get<int>()) {
+		case 0: // Hello
+			session.helloReceived = true;
+			session.hello = d;
+			ScheduleNext(session);
+			break;
+		case 2: // Identified
+			if (!session.identified) {
+				session.identified = true;
+				ScheduleNext(session);
+			}
+			break;
+		case 7:   // RequestResponse
+		case 9: { // RequestBatchResponse
+			auto it = session.pendingRequests.find(d.value("requestId", ""));
+			if (it == session.pendingRequests.end())
+				break;
+
+			bool success = true;
+			if (d.contains("requestStatus")) {
+				success = d["requestStatus"].value("result", false);
+			} else if (d.contains("results")) {
+				for (auto &result : d["results"])
+					success = success && result["requestStatus"].value("result", false);
+			}
+
+			auto &[label, sentAt] = it->second;
+			auto &stats = _labelStats[label];
+			stats.replayLatenciesUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sentAt).count());
+			if (!success)
+				stats.failures++;
+			session.pendingRequests.erase(it);
+
+			if (session.nextMessage == session.trace->inbound.size())
+				ScheduleNext(session);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	// Identify waits for the Hello, and everything else waits for the session to be identified
+	void ScheduleNext(Session &session)
+	{
+		if (session.closing)
+			return;
+
+		const auto &inbound = session.trace->inbound;
+		if (session.nextMessage == inbound.size()) {
+			Session *sessionPtr = &session;
+			if (session.trace->disconnected) {
+				_client.set_timer(GetDelayMs(session.trace->disconnectedAtNs),
+						  [this, sessionPtr](const websocketpp::lib::error_code &errorCode) {
+							  if (!errorCode)
+								  Close(*sessionPtr, "Replay reached the recorded disconnect.");
+						  });
+			} else if (session.pendingRequests.empty()) {
+				Close(session, "Replay finished.");
+			}
+			return;
+		}
+
+		const TraceMessage &message = inbound[session.nextMessage];
+		if (message.op == 1 ? !session.helloReceived : !session.identified)
+			return;
+
+		Session *sessionPtr = &session;
+		_client.set_timer(GetDelayMs(message.offsetNs), [this, sessionPtr](const websocketpp::lib::error_code &errorCode) {
+			if (!errorCode)
+				SendNext(*sessionPtr);
+		});
+	}
+
+	void SendNext(Session &session)
+	{
+		if (session.closing)
+			return;
+
+		const TraceMessage &message = session.trace->inbound[session.nextMessage++];
+		auto now = Clock::now();
+		auto due = _startedAt + std::chrono::nanoseconds((uint64_t)(message.offsetNs / _speed));
+		_sendLatenessMs.push_back(std::max(0.0, std::chrono::duration<double, std::milli>(now - due).count()));
+
+		websocketpp::lib::error_code errorCode;
+		if (message.op == 1) {
+			Identify(session, message);
+		} else {
+			if (!message.requestId.empty())
+				session.pendingRequests[message.requestId] = {message.label, now};
+			auto opCode = message.binary ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+			_client.send(session.hdl, message.payload, opCode, errorCode);
+		}
+
+		if (errorCode) {
+			fprintf(stderr, "Session %u: Send failed: %s\n", session.trace->id, errorCode.message().c_str());
+			Close(session, "Send failed.");
+			return;
+		}
+
+		ScheduleNext(session);
+	}
+
+	// The recorded authentication answered another challenge, so it is computed again for this session
+	void Identify(Session &session, const TraceMessage &message)
+	{
+		json identifyMessage;
+		DecodeMessage(message.binary, message.payload, identifyMessage);
+		json &d = identifyMessage["d"];
+		if (session.hello.contains("authentication")) {
+			json &authentication = session.hello["authentication"];
+			std::string secret = Sha256Base64(_password + authentication["salt"].get<std::string>());
+			d["authentication"] = Sha256Base64(secret + authentication["challenge"].get<std::string>());
+		} else if (d.is_object()) {
+			d.erase("authentication");
+		}
+
+		websocketpp::lib::error_code errorCode;
+		if (session.msgPack) {
+			auto msgPackData = json::to_msgpack(identifyMessage);
+			_client.send(session.hdl, msgPackData.data(), msgPackData.size(), websocketpp::frame::opcode::binary,
+				     errorCode);
+		} else {
+			_client.send(session.hdl, identifyMessage.dump(), websocketpp::frame::opcode::text, errorCode);
+		}
+	}
+
+	void Close(Session &session, const std::string &reason)
+	{
+		if (session.closing || session.finished)
+			return;
+
+		session.closing = true;
+		websocketpp::lib::error_code errorCode;
+		_client.close(session.hdl, websocketpp::close::status::normal, reason, errorCode);
+		if (errorCode)
+			Finish(session, false);
+	}
+
+	void Finish(Session &session, bool failed)
+	{
+		if (session.finished)
+			return;
+
+		session.finished = true;
+		session.closing = true;
+		if (failed)
+			_failedSessions++;
+
+		if (--_remainingSessions == 0 && _drainTimer)
+			_drainTimer->cancel();
+	}
+
+	void Report()
+	{
+		double elapsedSeconds = std::chrono::duration<double>(_completedAt - _startedAt).count();
+		_results["elapsedSeconds"] = elapsedSeconds;
+		_results["sessions"] = _sessions.size();
+		_results["failedSessions"] = _failedSessions;
+		_results["closedByServer"] = _closedByServer;
+
+		printf("\n%-40s %10s %8s %14s %14s %10s %10s %10s\n", "latency in us", "count", "failed", "recorded p50",
+		       "recorded p99", "p50", "p99", "max");
+
+		std::vector<std::string> labels;
+		for (auto &[label, stats] : _labelStats)
+			labels.push_back(label);
+		std::sort(labels.begin(), labels.end());
+
+		for (auto &label : labels) {
+			auto &stats = _labelStats[label];
+			std::sort(stats.recordedLatenciesUs.begin(), stats.recordedLatenciesUs.end());
+			std::sort(stats.replayLatenciesUs.begin(), stats.replayLatenciesUs.end());
+			size_t count = stats.replayLatenciesUs.size();
+
+			json labelResults;
+			labelResults["count"] = count;
+			labelResults["failed"] = stats.failures;
+			labelResults["recordedCount"] = stats.recordedLatenciesUs.size();
+			labelResults["recordedP50"] = GetPercentile(stats.recordedLatenciesUs, 0.5);
+			labelResults["recordedP99"] = GetPercentile(stats.recordedLatenciesUs, 0.99);
+			labelResults["p50"] = GetPercentile(stats.replayLatenciesUs, 0.5);
+			labelResults["p99"] = GetPercentile(stats.replayLatenciesUs, 0.99);
+			labelResults["max"] = count ? stats.replayLatenciesUs.back() : 0.0;
+			_results["requests"][label] = labelResults;
+
+			printf("%-40s %10zu %8llu %14.1f %14.1f %10.1f %10.1f %10.1f\n", label.c_str(), count,
+			       (unsigned long long)stats.failures, labelResults["recordedP50"].get<double>(),
+			       labelResults["recordedP99"].get<double>(), labelResults["p50"].get<double>(),
+			       labelResults["p99"].get<double>(), labelResults["max"].get<double>());
+		}
+
+		// Sends which went out late mean the replay did not reproduce the recorded timing
+		std::sort(_sendLatenessMs.begin(), _sendLatenessMs.end());
+		_results["sendLatenessMs"]["p50"] = GetPercentile(_sendLatenessMs, 0.5);
+		_results["sendLatenessMs"]["p99"] = GetPercentile(_sendLatenessMs, 0.99);
+		_results["sendLatenessMs"]["max"] = _sendLatenessMs.empty() ? 0.0 : _sendLatenessMs.back();
+
+		printf("\nReplayed %zu messages over %.2f seconds, sends were late by %.1f ms p50, %.1f ms p99, %.1f ms max\n",
+		       _sendLatenessMs.size(), elapsedSeconds, _results["sendLatenessMs"]["p50"].get<double>(),
+		       _results["sendLatenessMs"]["p99"].get<double>(), _results["sendLatenessMs"]["max"].get<double>());
+		if (_closedByServer || _failedSessions)
+			printf("%llu sessions were closed by the server, %llu failed to connect\n",
+			       (unsigned long long)_closedByServer, (unsigned long long)_failedSessions);
+	}
+
+	const std::vector<TraceSession> &_traceSessions;
+	std::unordered_map<std::string, LabelStats> &_labelStats;
+	std::string _password;
+	double _speed;
+	std::string _url;
+
+	Client _client;
+	std::vector<Session> _sessions;
+	size_t _remainingSessions = 0;
+	uint64_t _failedSessions = 0;
+	uint64_t _closedByServer = 0;
+
+	Clock::time_point _startedAt;
+	Clock::time_point _completedAt;
+	websocketpp::lib::shared_ptr<websocketpp::lib::asio::steady_timer> _drainTimer;
+
+	std::vector<double> _sendLatenessMs;
+	json _results;
+};
+
+int main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr,
+			"Usage: %s <trace.bin> [--url ws://127.0.0.1:4455] [--password <password>] [--speed <factor>] [--output <results.json>]\n",
+			argv[0]);
+		return 1;
+	}
+
+	std::string url = DEFAULT_URL;
+	std::string password;
+	std::string outputPath;
+	double speed = 1.0;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		std::string argument = argv[i];
+		if (argument == "--url") {
+			url = argv[i + 1];
+		} else if (argument == "--password") {
+			password = argv[i + 1];
+		} else if (argument == "--speed") {
+			speed = atof(argv[i + 1]);
+			if (speed <= 0) {
+				fprintf(stderr, "Invalid value for --speed: %s\n", argv[i + 1]);
+				return 1;
+			}
+		} else if (argument == "--output") {
+			outputPath = argv[i + 1];
+		} else {
+			fprintf(stderr, "Unknown argument: %s\n", argument.c_str());
+			return 1;
+		}
+	}
+
+	std::vector<TraceSession> sessions;
+	std::unordered_map<std::string, LabelStats> labelStats;
+	if (!LoadTrace(argv[1], sessions, labelStats))
+		return 1;
+
+	TraceReplayer replayer(sessions, labelStats, password, speed);
+	bool succeeded = replayer.Run(url);
+
+	if (!outputPath.empty()) {
+		std::ofstream f(outputPath);
+		if (!f.is_open()) {
+			fprintf(stderr, "Unable to write results to: %s\n", outputPath.c_str());
+			return 1;
+		}
+		f << replayer.GetResults().dump(2) << "\n";
+	}
+
+	return succeeded ? 0 : 1;
+}
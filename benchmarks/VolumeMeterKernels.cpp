@@ -0,0 +1,115 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Compares the volume meter plane kernels against the original SSE peak helpers and scalar magnitude loop.
+// Usage: obs-websocket-bench-volume-meter [iterations]
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <util/sse-intrin.h>
+
+#include "../src/utils/Obs_VolumeMeter_Helpers.h"
+#include "../src/utils/Obs_VolumeMeter_Kernels.h"
+
+using namespace Utils::Obs::VolumeMeter;
+
+// One OBS audio packet at 48 kHz
+#define SAMPLE_COUNT 1024
+
+// The original implementation: separate peak and magnitude passes, aligned buffers only
+static void ProcessPlaneLegacy(const float *previousSamples, const float *samples, size_t sampleCount, bool truePeak,
+			       float &peak, float &sumSquares)
+{
+	__m128 previous = _mm_loadu_ps(previousSamples);
+	peak = truePeak ? GetTruePeak(previous, samples, sampleCount) : GetSamplePeak(previous, samples, sampleCount);
+
+	sumSquares = 0.0f;
+	for (size_t i = 0; i < sampleCount; i++)
+		sumSquares += samples[i] * samples[i];
+}
+
+static double Measure(PlaneKernel kernel, const float *previousSamples, const float *samples, bool truePeak,
+		      int iterations, float &peak, float &sumSquares)
+{
+	// Warm up
+	for (int i = 0; i < 100; i++)
+		kernel(previousSamples, samples, SAMPLE_COUNT, truePeak, peak, sumSquares);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		kernel(previousSamples, samples, SAMPLE_COUNT, truePeak, peak, sumSquares);
+	auto end = std::chrono::steady_clock::now();
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count();
+	return ns / ((double)iterations * SAMPLE_COUNT);
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+	if (iterations <= 0)
+		iterations = 100000;
+
+	// Over-allocate so that an unaligned view of the same data is available
+	alignas(32) static float buffer[SAMPLE_COUNT + 8];
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	for (auto &sample : buffer)
+		sample = dist(rng);
+
+	const float previousSamples[4] = {0.1f, -0.2f, 0.3f, -0.05f};
+
+	struct Candidate {
+		const char *name;
+		PlaneKernel kernel;
+		bool alignedOnly;
+	};
+	std::vector<Candidate> candidates = {
+		{"legacy-sse", ProcessPlaneLegacy, true},
+		{"scalar", Kernels::ProcessPlaneScalar, false},
+		{"sse", Kernels::ProcessPlaneSse, false},
+	};
+	if (Kernels::Avx2Supported())
+		candidates.push_back({"avx2", Kernels::ProcessPlaneAvx2, false});
+
+	printf("Dispatched kernel: %s, %d iterations of %d samples\n\n", GetPlaneKernelName(), iterations, SAMPLE_COUNT);
+	printf("%-12s %-10s %-10s %12s %12s %14s\n", "kernel", "mode", "buffer", "ns/sample", "peak", "sumSquares");
+
+	for (bool truePeak : {false, true}) {
+		for (bool aligned : {true, false}) {
+			const float *samples = aligned ? buffer : buffer + 1;
+			for (auto &candidate : candidates) {
+				if (!aligned && candidate.alignedOnly)
+					continue;
+
+				float peak, sumSquares;
+				double nsPerSample = Measure(candidate.kernel, previousSamples, samples, truePeak, iterations,
+							     peak, sumSquares);
+				printf("%-12s %-10s %-10s %12.4f %12.6f %14.6f\n", candidate.name, truePeak ? "true" : "sample",
+				       aligned ? "aligned" : "unaligned", nsPerSample, peak, sumSquares);
+			}
+		}
+	}
+
+	return 0;
+}
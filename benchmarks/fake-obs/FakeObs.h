@@ -0,0 +1,306 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+// Headless stand-in for the parts of libobs and obs-frontend-api which obs-websocket uses. It is compiled against the
+// real headers, so the plugin sources build unchanged, but everything lives in memory: there is no GPU, no encoders
+// and no audio/video pipeline. Graphics calls are no-ops, and audio is a synthetic sine on every audio source.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <obs.h>
+#include <obs-frontend-api.h>
+
+namespace FakeObs {
+	struct StartupOptions {
+		std::string configPath; // Root of the module config directory, `obs_module_config_path()` lives below it
+		std::string localePath; // Directory containing `<locale>.ini` files for `obs_module_load_locale()`
+		uint32_t fpsNum = 60;
+		uint32_t fpsDen = 1;
+		uint32_t baseWidth = 1920;
+		uint32_t baseHeight = 1080;
+		int logLevel = LOG_INFO;
+	};
+
+	struct CollectionOptions {
+		size_t sceneCount = 1;
+		size_t inputCount = 0;          // Distributed round-robin across the scenes
+		size_t filtersPerInput = 0;     // Video filters on video inputs, gain filters on audio inputs
+		size_t audioInputPercent = 25;  // Share of the inputs which are audio capture inputs
+		size_t mediaInputPercent = 10;  // Share of the inputs which are media inputs
+		size_t globalAudioSources = 2;  // Desktop/mic sources on the output channels, which are always active
+	};
+
+	// Creates the core signal/proc handlers and starts the tick and audio threads
+	void Startup(const StartupOptions &options);
+	// Stops the threads and destroys every remaining object. Call after the module is unloaded
+	void Shutdown();
+
+	// Builds a synthetic scene collection and makes the first scene the program scene
+	void CreateCollection(const CollectionOptions &options);
+	// Removes the channel sources and every scene, which tears the collection down
+	void DestroyCollection();
+
+	// Invokes every registered frontend event callback, as OBS does from the UI thread
+	void EmitFrontendEvent(enum obs_frontend_event event);
+
+	// Fakes a "reconnect" on the streaming output, for the output reconnect events
+	void SimulateStreamReconnect();
+
+	// ---------------------------------------------------------------------------------------------------------------
+	// Internal helpers shared by the fake translation units
+
+	template<typename T> struct WeakRef {
+		std::atomic<long> refs = 1;     // Strong references. The object is destroyed when this reaches zero
+		std::atomic<long> weakRefs = 1; // Weak references, plus one held by the strong references as a group
+		T *object = nullptr;
+	};
+
+	template<typename W> inline W *AddWeakRef(W *control)
+	{
+		if (control)
+			control->weakRefs.fetch_add(1);
+		return control;
+	}
+
+	template<typename W> inline void ReleaseWeakRef(W *control)
+	{
+		if (control && control->weakRefs.fetch_sub(1) == 1)
+			delete control;
+	}
+
+	// Adds a strong reference unless the object is already being destroyed
+	template<typename W> inline auto GetStrongRef(W *control) -> decltype(control->object)
+	{
+		if (!control)
+			return nullptr;
+
+		long refs = control->refs.load();
+		while (refs > 0) {
+			if (control->refs.compare_exchange_weak(refs, refs + 1))
+				return control->object;
+		}
+		return nullptr;
+	}
+
+	// Returns true when the caller released the last strong reference and must destroy the object
+	template<typename W> inline bool ReleaseStrongRef(W *control)
+	{
+		return control && control->refs.fetch_sub(1) == 1;
+	}
+
+	struct TypeInfo {
+		std::string id;
+		std::string unversionedId;
+		enum obs_source_type type;
+		uint32_t outputFlags;
+		void (*defaults)(obs_data_t *settings);
+		void (*properties)(obs_properties_t *props);
+	};
+
+	const TypeInfo *FindType(const char *id);
+	const std::vector<TypeInfo> &GetTypes();
+
+	std::string GenerateUuid();
+	const std::string &GetConfigPath();
+	uint64_t GetVideoFrameIntervalNs();
+	void GetBaseSize(uint32_t &width, uint32_t &height);
+	// Zero values keep the current setting
+	void ResetVideo(uint32_t baseWidth, uint32_t baseHeight, uint32_t fpsNum, uint32_t fpsDen);
+	config_t *CreateConfig();
+
+	// Emits `signal` with a "source" parameter on the source's handler, then `coreSignal` on the core handler. Either
+	// may be null
+	void EmitSourceSignal(obs_source_t *source, const char *signal, const char *coreSignal = nullptr);
+
+	obs_source_t *CreateSource(const char *id, const char *name, obs_data_t *settings, bool isPrivate);
+	void DestroySource(obs_source_t *source);
+	// Returns referenced copies of the public sources, in creation order
+	std::vector<obs_source_t *> GetSourcesSnapshot();
+	void ReleaseSnapshot(std::vector<obs_source_t *> &sources);
+	// Propagates (de)activation to the children of scenes and to filters, emitting "activate"/"deactivate" on edges
+	void SetSourceActive(obs_source_t *source, bool active);
+	void SetChannelSource(uint32_t channel, obs_source_t *source);
+	void TickSources(uint64_t now);
+	void GenerateAudio(uint64_t timestamp, uint32_t frames, uint32_t sampleRate);
+
+	obs_scene_t *CreateSceneData(obs_source_t *source, bool isGroup);
+	void DestroySceneData(obs_scene_t *scene);
+	void SetSceneItemsActive(obs_scene_t *scene, bool active);
+	void RemoveItemsOfSource(obs_source_t *source);
+
+	obs_output_t *CreateOutput(const char *id, const char *name, uint32_t flags);
+	bool OutputsActive();
+	void CreateFrontendObjects();
+	void DestroyFrontendObjects();
+	void TickFrontend(uint64_t now);
+	void RunQueuedTasks(enum obs_task_type type);
+
+	obs_properties_t *CreateProperties();
+	void AddListProperty(obs_properties_t *props, const char *name, enum obs_combo_format format,
+			     const std::vector<std::pair<std::string, std::string>> &items);
+	void AddButtonProperty(obs_properties_t *props, const char *name);
+	void AddTextProperty(obs_properties_t *props, const char *name);
+
+	void SetDefaultString(obs_data_t *data, const char *name, const char *val);
+	void SetDefaultInt(obs_data_t *data, const char *name, long long val);
+	void SetDefaultDouble(obs_data_t *data, const char *name, double val);
+	void SetDefaultBool(obs_data_t *data, const char *name, bool val);
+
+	// Clears every user value, leaving the defaults
+	void ClearUserValues(obs_data_t *data);
+}
+
+struct signal_handler {
+	struct Callback {
+		signal_callback_t callback;
+		void *data;
+		bool remove;
+		bool keepRef;
+	};
+
+	std::recursive_mutex mutex;
+	std::unordered_map<std::string, std::vector<Callback>> signals;
+	int signalling = 0; // Removal is deferred while callbacks are running, so indices stay valid
+	std::atomic<long> refs = 1; // The creator's, plus one per `signal_handler_connect_ref()` connection
+};
+
+struct proc_handler {
+	std::mutex mutex;
+	std::unordered_map<std::string, std::pair<proc_handler_proc_t, void *>> procs;
+};
+
+struct obs_weak_source : FakeObs::WeakRef<obs_source> {};
+struct obs_weak_output : FakeObs::WeakRef<obs_output> {};
+struct obs_weak_service : FakeObs::WeakRef<obs_service> {};
+struct obs_weak_encoder : FakeObs::WeakRef<obs_encoder> {};
+
+struct obs_source {
+	obs_weak_source *control;
+	const FakeObs::TypeInfo *info;
+	std::string name;
+	std::string uuid;
+	bool isPrivate;
+
+	obs_data_t *settings;
+	obs_data_t *privateSettings;
+	signal_handler_t *signals;
+	obs_scene_t *scene = nullptr; // Set for scenes and groups
+
+	std::atomic<bool> removed = false;
+	std::atomic<bool> enabled = true;
+	std::atomic<bool> muted = false;
+	std::atomic<float> volume = 1.0f;
+	std::atomic<float> balance = 0.5f;
+	std::atomic<int64_t> syncOffset = 0;
+	std::atomic<uint32_t> audioMixers = 0x3F;
+	std::atomic<int> monitoringType = OBS_MONITORING_TYPE_NONE;
+	std::atomic<int> deinterlaceMode = OBS_DEINTERLACE_MODE_DISABLE;
+	std::atomic<int> deinterlaceFieldOrder = OBS_DEINTERLACE_FIELD_ORDER_TOP;
+	std::atomic<long> activeRefs = 0;
+	std::atomic<long> showingRefs = 0;
+
+	std::recursive_mutex filterMutex;
+	std::vector<obs_source_t *> filters; // Each holds a reference
+	std::atomic<obs_source_t *> filterParent = nullptr;
+
+	std::mutex audioMutex;
+	std::vector<std::pair<obs_source_audio_capture_t, void *>> audioCallbacks;
+	double audioPhase = 0.0;
+	double audioFrequency = 440.0;
+
+	std::mutex mediaMutex;
+	enum obs_media_state mediaState = OBS_MEDIA_STATE_PLAYING;
+	int64_t mediaDuration = 0;
+	int64_t mediaTime = 0;       // Position when the state last changed, in milliseconds
+	uint64_t mediaChangedAt = 0; // `os_gettime_ns()` when the state last changed
+};
+
+struct obs_scene {
+	obs_source_t *source; // Not referenced, the scene is the source
+	bool isGroup;
+
+	std::recursive_mutex mutex;
+	std::vector<obs_sceneitem_t *> items; // Bottom to top, each holds a reference
+	int64_t lastId = 0;
+};
+
+struct obs_scene_item {
+	std::atomic<long> refs = 1;
+	obs_scene_t *parent;
+	obs_source_t *source; // Referenced
+	int64_t id;
+
+	std::atomic<bool> visible = true;
+	std::atomic<bool> locked = false;
+	std::atomic<bool> removed = false;
+	std::atomic<int> blendingMode = OBS_BLEND_NORMAL;
+
+	std::mutex transformMutex;
+	struct obs_transform_info info;
+	struct obs_sceneitem_crop crop;
+
+	obs_data_t *privateSettings;
+};
+
+struct obs_output {
+	obs_weak_output *control;
+	std::string id;
+	std::string name;
+	uint32_t flags;
+	obs_data_t *settings;
+	signal_handler_t *signals;
+
+	std::atomic<bool> active = false;
+	std::atomic<bool> paused = false;
+	std::atomic<bool> reconnecting = false;
+	std::atomic<uint64_t> startedAt = 0;
+};
+
+struct obs_service {
+	obs_weak_service *control;
+	std::string id;
+	std::string name;
+	obs_data_t *settings;
+};
+
+struct obs_encoder {
+	obs_weak_encoder *control;
+	std::string name;
+};
+
+struct obs_hotkey {
+	obs_hotkey_id id;
+	std::string name;
+	std::string description;
+	enum obs_hotkey_registerer_type registererType;
+	void *registerer;
+	void (*func)(bool pressed);
+};
+
+struct video_output {
+	std::atomic<uint32_t> totalFrames = 0;
+	std::atomic<uint32_t> skippedFrames = 0;
+	uint64_t frameTime = 0;
+};
@@ -0,0 +1,123 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+
+#include "FakeObs.h"
+
+#define DESKTOP_AUDIO_CHANNEL 1
+#define MIC_AUDIO_CHANNEL 3
+
+// Picks the input kind for the `index`th input, spreading audio and media inputs evenly through the collection
+static const char *GetInputKind(const FakeObs::CollectionOptions &options, size_t index)
+{
+	size_t bucket = index % 100;
+	if (bucket < options.audioInputPercent)
+		return "pulse_input_capture";
+	if (bucket < options.audioInputPercent + options.mediaInputPercent)
+		return "ffmpeg_source";
+
+	switch (index % 3) {
+	case 0:
+		return "color_source_v3";
+	case 1:
+		return "image_source";
+	default:
+		return "text_ft2_source_v2";
+	}
+}
+
+static void AddFilters(obs_source_t *input, size_t count)
+{
+	bool audioOnly = !(obs_source_get_output_flags(input) & OBS_SOURCE_VIDEO);
+	const char *filterKind = audioOnly ? "gain_filter" : "color_filter_v2";
+
+	for (size_t i = 0; i < count; i++) {
+		std::string filterName = "Filter " + std::to_string(i + 1);
+		obs_source_t *filter = obs_source_create_private(filterKind, filterName.c_str(), nullptr);
+		obs_source_filter_add(input, filter);
+		obs_source_release(filter);
+	}
+}
+
+static void CreateGlobalAudioSource(uint32_t channel, const char *kind, const char *name)
+{
+	obs_source_t *source = obs_source_create(kind, name, nullptr, nullptr);
+	FakeObs::SetChannelSource(channel, source);
+	obs_source_release(source);
+}
+
+void FakeObs::CreateCollection(const CollectionOptions &options)
+{
+	uint64_t startTime = os_gettime_ns();
+
+	// The frontend takes its own reference to every scene as it is created
+	std::vector<obs_scene_t *> collectionScenes;
+	for (size_t i = 0; i < std::max<size_t>(options.sceneCount, 1); i++) {
+		std::string sceneName = "Scene " + std::to_string(i + 1);
+		collectionScenes.push_back(obs_scene_create(sceneName.c_str()));
+	}
+
+	for (size_t i = 0; i < options.inputCount; i++) {
+		const char *inputKind = GetInputKind(options, i);
+		std::string inputName = "Input " + std::to_string(i + 1);
+		obs_source_t *input = obs_source_create(inputKind, inputName.c_str(), nullptr, nullptr);
+		AddFilters(input, options.filtersPerInput);
+		obs_scene_add(collectionScenes[i % collectionScenes.size()], input);
+		obs_source_release(input);
+	}
+
+	if (options.globalAudioSources > 0)
+		CreateGlobalAudioSource(DESKTOP_AUDIO_CHANNEL, "pulse_output_capture", "Desktop Audio");
+	if (options.globalAudioSources > 1)
+		CreateGlobalAudioSource(MIC_AUDIO_CHANNEL, "pulse_input_capture", "Mic/Aux");
+
+	obs_frontend_set_current_scene(obs_scene_get_source(collectionScenes.front()));
+	for (obs_scene_t *scene : collectionScenes)
+		obs_scene_release(scene);
+
+	blog(LOG_INFO, "[FakeObs::CreateCollection] Created %zu scenes and %zu inputs with %zu filters each in %.1f ms",
+	     collectionScenes.size(), options.inputCount, options.filtersPerInput,
+	     (double)(os_gettime_ns() - startTime) / 1000000.0);
+}
+
+// Removing every scene drops the frontend's references, which destroys the scene items and with them the inputs
+void FakeObs::DestroyCollection()
+{
+	for (uint32_t channel = 0; channel < MAX_CHANNELS; channel++) {
+		obs_source_t *source = obs_get_output_source(channel);
+		if (!source)
+			continue;
+
+		SetChannelSource(channel, nullptr);
+		obs_source_remove(source);
+		obs_source_release(source);
+	}
+
+	struct obs_frontend_source_list sceneList = {};
+	obs_frontend_get_scenes(&sceneList);
+	for (size_t i = 0; i < sceneList.sources.num; i++)
+		obs_source_remove(sceneList.sources.array[i]);
+	obs_frontend_source_list_free(&sceneList);
+
+	std::vector<obs_source_t *> remaining = GetSourcesSnapshot();
+	for (obs_source_t *source : remaining)
+		obs_source_remove(source);
+	ReleaseSnapshot(remaining);
+}
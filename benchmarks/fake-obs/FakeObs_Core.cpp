@@ -0,0 +1,809 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <QCoreApplication>
+#include <QThread>
+#include <util/bmem.h>
+#include <util/config-file.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/text-lookup.h>
+
+#include "FakeObs.h"
+
+#define AUDIO_SAMPLE_RATE 48000
+#define AUDIO_FRAMES_PER_TICK 1024
+#define FPS_WINDOW_NS 1000000000ULL
+
+struct QueuedTask {
+	obs_task_t task;
+	void *param;
+	std::promise<void> *done;
+};
+
+static FakeObs::StartupOptions options;
+static signal_handler_t *coreSignals = nullptr;
+static proc_handler_t *coreProcs = nullptr;
+static video_output coreVideo;
+
+static std::atomic<bool> running = false;
+static std::thread tickThread;
+static std::thread audioThread;
+static std::thread::id tickThreadId;
+static std::thread::id audioThreadId;
+
+static std::mutex tickCallbacksMutex;
+static std::vector<std::pair<void (*)(void *, float), void *>> tickCallbacks;
+
+static std::recursive_mutex graphicsMutex;
+
+static std::mutex taskMutex;
+static std::deque<QueuedTask> graphicsTasks;
+static std::deque<QueuedTask> audioTasks;
+static std::deque<QueuedTask> destroyTasks;
+
+static std::atomic<uint64_t> averageFrameTimeNs = 0;
+static std::atomic<uint64_t> videoFrameTime = 0;
+static std::atomic<uint32_t> laggedFrames = 0;
+static std::atomic<double> activeFps = 0.0;
+
+static const char *GetLevelName(int level)
+{
+	switch (level) {
+	case LOG_ERROR:
+		return "error";
+	case LOG_WARNING:
+		return "warning";
+	case LOG_INFO:
+		return "info";
+	default:
+		return "debug";
+	}
+}
+
+void blogva(int log_level, const char *format, va_list args)
+{
+	if (log_level > options.logLevel)
+		return;
+
+	char message[4096];
+	vsnprintf(message, sizeof(message), format, args);
+
+	auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+	char timestamp[16];
+	std::strftime(timestamp, sizeof(timestamp), "%H:%M:%S", std::localtime(&now));
+	fprintf(stderr, "%s [%s] %s\n", timestamp, GetLevelName(log_level), message);
+}
+
+void blog(int log_level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	blogva(log_level, format, args);
+	va_end(args);
+}
+
+// There is no profiler to report to, scopes only need to link
+void profile_start(const char *) {}
+
+void profile_end(const char *) {}
+
+static std::atomic<long> numAllocs = 0;
+
+void *bmalloc(size_t size)
+{
+	void *ptr = malloc(size ? size : 1);
+	if (!ptr) {
+		blog(LOG_ERROR, "[FakeObs::bmalloc] Out of memory while trying to allocate %zu bytes", size);
+		abort();
+	}
+	numAllocs.fetch_add(1);
+	return ptr;
+}
+
+void *brealloc(void *ptr, size_t size)
+{
+	if (!ptr)
+		numAllocs.fetch_add(1);
+
+	ptr = realloc(ptr, size ? size : 1);
+	if (!ptr) {
+		blog(LOG_ERROR, "[FakeObs::brealloc] Out of memory while trying to allocate %zu bytes", size);
+		abort();
+	}
+	return ptr;
+}
+
+void bfree(void *ptr)
+{
+	if (ptr)
+		numAllocs.fetch_sub(1);
+	free(ptr);
+}
+
+long bnum_allocs(void)
+{
+	return numAllocs;
+}
+
+void *bmemdup(const void *ptr, size_t size)
+{
+	void *out = bmalloc(size);
+	if (size)
+		memcpy(out, ptr, size);
+	return out;
+}
+
+uint64_t os_gettime_ns(void)
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+struct os_cpu_usage_info {
+	std::clock_t lastCpuTime;
+	uint64_t lastTime;
+	unsigned cores;
+};
+
+os_cpu_usage_info_t *os_cpu_usage_info_start(void)
+{
+	auto info = new os_cpu_usage_info;
+	info->lastCpuTime = std::clock();
+	info->lastTime = os_gettime_ns();
+	info->cores = std::max(1u, std::thread::hardware_concurrency());
+	return info;
+}
+
+// Process CPU time over wall time since the previous query, as a percentage of all cores
+double os_cpu_usage_info_query(os_cpu_usage_info_t *info)
+{
+	if (!info)
+		return 0.0;
+
+	std::clock_t cpuTime = std::clock();
+	uint64_t time = os_gettime_ns();
+	double cpuSeconds = (double)(cpuTime - info->lastCpuTime) / CLOCKS_PER_SEC;
+	double wallSeconds = (double)(time - info->lastTime) / 1000000000.0;
+	info->lastCpuTime = cpuTime;
+	info->lastTime = time;
+
+	if (wallSeconds <= 0.0)
+		return 0.0;
+	return cpuSeconds / wallSeconds / info->cores * 100.0;
+}
+
+void os_cpu_usage_info_destroy(os_cpu_usage_info_t *info)
+{
+	delete info;
+}
+
+uint64_t os_get_free_disk_space(const char *dir)
+{
+	std::error_code ec;
+	auto space = std::filesystem::space(std::filesystem::u8path(dir ? dir : "."), ec);
+	return ec ? 0 : space.available;
+}
+
+uint64_t os_get_proc_resident_size(void)
+{
+#ifdef __linux__
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (!file)
+		return 0;
+
+	unsigned long long size = 0, resident = 0;
+	int read = fscanf(file, "%llu %llu", &size, &resident);
+	fclose(file);
+	return read == 2 ? resident * 4096 : 0;
+#else
+	return 0;
+#endif
+}
+
+// Config files only live in memory, saving always succeeds
+struct config_data {
+	std::recursive_mutex mutex;
+	std::map<std::string, std::map<std::string, std::string>> values;
+	std::map<std::string, std::map<std::string, std::string>> defaults;
+};
+
+config_t *FakeObs::CreateConfig()
+{
+	return new config_data;
+}
+
+void config_close(config_t *config)
+{
+	delete config;
+}
+
+static const std::string *FindConfigValue(config_t *config, const char *section, const char *name, bool defaults)
+{
+	if (!config || !section || !name)
+		return nullptr;
+
+	auto &map = defaults ? config->defaults : config->values;
+	auto sectionIt = map.find(section);
+	if (sectionIt == map.end())
+		return nullptr;
+	auto it = sectionIt->second.find(name);
+	return it == sectionIt->second.end() ? nullptr : &it->second;
+}
+
+static const char *GetConfigString(config_t *config, const char *section, const char *name)
+{
+	if (!config)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	const std::string *value = FindConfigValue(config, section, name, false);
+	if (!value)
+		value = FindConfigValue(config, section, name, true);
+	return value ? value->c_str() : nullptr;
+}
+
+const char *config_get_string(config_t *config, const char *section, const char *name)
+{
+	return GetConfigString(config, section, name);
+}
+
+const char *config_get_default_string(config_t *config, const char *section, const char *name)
+{
+	if (!config)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	const std::string *value = FindConfigValue(config, section, name, true);
+	return value ? value->c_str() : nullptr;
+}
+
+bool config_get_bool(config_t *config, const char *section, const char *name)
+{
+	const char *value = GetConfigString(config, section, name);
+	return value && (strcmp(value, "true") == 0 || strtoll(value, nullptr, 10) != 0);
+}
+
+uint64_t config_get_uint(config_t *config, const char *section, const char *name)
+{
+	const char *value = GetConfigString(config, section, name);
+	return value ? strtoull(value, nullptr, 10) : 0;
+}
+
+int64_t config_get_int(config_t *config, const char *section, const char *name)
+{
+	const char *value = GetConfigString(config, section, name);
+	return value ? strtoll(value, nullptr, 10) : 0;
+}
+
+bool config_has_user_value(config_t *config, const char *section, const char *name)
+{
+	if (!config)
+		return false;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	return FindConfigValue(config, section, name, false) != nullptr;
+}
+
+bool config_has_default_value(config_t *config, const char *section, const char *name)
+{
+	if (!config)
+		return false;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	return FindConfigValue(config, section, name, true) != nullptr;
+}
+
+bool config_remove_value(config_t *config, const char *section, const char *name)
+{
+	if (!config || !section || !name)
+		return false;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	auto sectionIt = config->values.find(section);
+	return sectionIt != config->values.end() && sectionIt->second.erase(name) > 0;
+}
+
+void config_set_string(config_t *config, const char *section, const char *name, const char *value)
+{
+	if (!config || !section || !name)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	config->values[section][name] = value ? value : "";
+}
+
+void config_set_uint(config_t *config, const char *section, const char *name, uint64_t value)
+{
+	config_set_string(config, section, name, std::to_string(value).c_str());
+}
+
+void config_set_int(config_t *config, const char *section, const char *name, int64_t value)
+{
+	config_set_string(config, section, name, std::to_string(value).c_str());
+}
+
+void config_set_bool(config_t *config, const char *section, const char *name, bool value)
+{
+	config_set_string(config, section, name, value ? "true" : "false");
+}
+
+void config_set_default_string(config_t *config, const char *section, const char *name, const char *value)
+{
+	if (!config || !section || !name)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(config->mutex);
+	config->defaults[section][name] = value ? value : "";
+}
+
+void config_set_default_uint(config_t *config, const char *section, const char *name, uint64_t value)
+{
+	config_set_default_string(config, section, name, std::to_string(value).c_str());
+}
+
+int config_save(config_t *config)
+{
+	return config ? CONFIG_SUCCESS : CONFIG_ERROR;
+}
+
+int config_save_safe(config_t *config, const char *, const char *)
+{
+	return config_save(config);
+}
+
+// Locale files are the plugin's own `data/locale/*.ini`, in the `Key="Value"` format
+struct text_lookup {
+	std::unordered_map<std::string, std::string> strings;
+};
+
+static void LoadLocaleFile(lookup_t *lookup, const std::string &path)
+{
+	std::ifstream file(std::filesystem::u8path(path));
+	std::string line;
+	while (std::getline(file, line)) {
+		size_t separator = line.find('=');
+		if (separator == std::string::npos || line[0] == '#' || line[0] == ';')
+			continue;
+
+		std::string key = line.substr(0, separator);
+		std::string value = line.substr(separator + 1);
+		while (!value.empty() && (value.back() == '\r' || value.back() == ' '))
+			value.pop_back();
+		if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+			value = value.substr(1, value.size() - 2);
+
+		size_t pos = 0;
+		while ((pos = value.find("\\n", pos)) != std::string::npos)
+			value.replace(pos, 2, "\n");
+
+		lookup->strings[key] = value;
+	}
+}
+
+lookup_t *obs_module_load_locale(obs_module_t *, const char *default_locale, const char *locale)
+{
+	auto lookup = new text_lookup;
+	if (default_locale)
+		LoadLocaleFile(lookup, options.localePath + "/" + default_locale + ".ini");
+	if (locale && (!default_locale || strcmp(locale, default_locale) != 0))
+		LoadLocaleFile(lookup, options.localePath + "/" + locale + ".ini");
+	return lookup;
+}
+
+bool text_lookup_getstr(lookup_t *lookup, const char *lookup_val, const char **out)
+{
+	if (!lookup || !lookup_val)
+		return false;
+
+	auto it = lookup->strings.find(lookup_val);
+	if (it == lookup->strings.end())
+		return false;
+
+	*out = it->second.c_str();
+	return true;
+}
+
+void text_lookup_destroy(lookup_t *lookup)
+{
+	delete lookup;
+}
+
+const std::string &FakeObs::GetConfigPath()
+{
+	return options.configPath;
+}
+
+char *obs_module_get_config_path(obs_module_t *, const char *file)
+{
+	std::string path = options.configPath + "/plugin_config/obs-websocket/" + (file ? file : "");
+	return bstrdup(path.c_str());
+}
+
+uint32_t obs_get_version(void)
+{
+	return LIBOBS_API_VER;
+}
+
+const char *obs_get_version_string(void)
+{
+	static std::string version = std::to_string(LIBOBS_API_MAJOR_VER) + "." + std::to_string(LIBOBS_API_MINOR_VER) + "." +
+				     std::to_string(LIBOBS_API_PATCH_VER) + "-headless";
+	return version.c_str();
+}
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+	return coreSignals;
+}
+
+proc_handler_t *obs_get_proc_handler(void)
+{
+	return coreProcs;
+}
+
+uint64_t FakeObs::GetVideoFrameIntervalNs()
+{
+	return 1000000000ULL * options.fpsDen / options.fpsNum;
+}
+
+void FakeObs::GetBaseSize(uint32_t &width, uint32_t &height)
+{
+	width = options.baseWidth;
+	height = options.baseHeight;
+}
+
+void FakeObs::ResetVideo(uint32_t baseWidth, uint32_t baseHeight, uint32_t fpsNum, uint32_t fpsDen)
+{
+	if (baseWidth && baseHeight) {
+		options.baseWidth = baseWidth;
+		options.baseHeight = baseHeight;
+	}
+	if (fpsNum && fpsDen) {
+		options.fpsNum = fpsNum;
+		options.fpsDen = fpsDen;
+	}
+	coreVideo.frameTime = GetVideoFrameIntervalNs();
+}
+
+video_t *obs_get_video(void)
+{
+	return &coreVideo;
+}
+
+bool obs_get_video_info(struct obs_video_info *ovi)
+{
+	if (!ovi)
+		return false;
+
+	*ovi = {};
+	ovi->graphics_module = "fake-graphics";
+	ovi->fps_num = options.fpsNum;
+	ovi->fps_den = options.fpsDen;
+	ovi->base_width = options.baseWidth;
+	ovi->base_height = options.baseHeight;
+	ovi->output_width = options.baseWidth;
+	ovi->output_height = options.baseHeight;
+	ovi->output_format = VIDEO_FORMAT_NV12;
+	ovi->gpu_conversion = true;
+	ovi->colorspace = VIDEO_CS_709;
+	ovi->range = VIDEO_RANGE_PARTIAL;
+	ovi->scale_type = OBS_SCALE_BICUBIC;
+	return true;
+}
+
+bool obs_video_active(void)
+{
+	return FakeObs::OutputsActive();
+}
+
+bool obs_audio_monitoring_available(void)
+{
+	return false;
+}
+
+double obs_get_active_fps(void)
+{
+	return activeFps;
+}
+
+uint64_t obs_get_video_frame_time(void)
+{
+	return videoFrameTime;
+}
+
+uint64_t obs_get_average_frame_time_ns(void)
+{
+	return averageFrameTimeNs;
+}
+
+uint32_t obs_get_total_frames(void)
+{
+	return coreVideo.totalFrames;
+}
+
+uint32_t obs_get_lagged_frames(void)
+{
+	return laggedFrames;
+}
+
+uint32_t video_output_get_total_frames(const video_t *video)
+{
+	return video ? video->totalFrames.load() : 0;
+}
+
+uint32_t video_output_get_skipped_frames(const video_t *video)
+{
+	return video ? video->skippedFrames.load() : 0;
+}
+
+uint64_t video_output_get_frame_time(const video_t *video)
+{
+	return video ? video->frameTime : 0;
+}
+
+float obs_mul_to_db(float mul)
+{
+	return mul == 0.0f ? -INFINITY : 20.0f * log10f(mul);
+}
+
+float obs_db_to_mul(float db)
+{
+	return db == -INFINITY ? 0.0f : powf(10.0f, db / 20.0f);
+}
+
+void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param)
+{
+	std::lock_guard<std::mutex> lock(tickCallbacksMutex);
+	tickCallbacks.emplace_back(tick, param);
+}
+
+void obs_remove_tick_callback(void (*tick)(void *param, float seconds), void *param)
+{
+	std::lock_guard<std::mutex> lock(tickCallbacksMutex);
+	auto it = std::find(tickCallbacks.begin(), tickCallbacks.end(), std::make_pair(tick, param));
+	if (it != tickCallbacks.end())
+		tickCallbacks.erase(it);
+}
+
+// There is no graphics context, the mutex keeps `obs_enter_graphics()` sections serialized like the real one
+void obs_enter_graphics(void)
+{
+	graphicsMutex.lock();
+}
+
+void obs_leave_graphics(void)
+{
+	graphicsMutex.unlock();
+}
+
+bool obs_in_task_thread(enum obs_task_type type)
+{
+	switch (type) {
+	case OBS_TASK_UI:
+		return !qApp || QThread::currentThread() == qApp->thread();
+	case OBS_TASK_GRAPHICS:
+	case OBS_TASK_DESTROY:
+		return std::this_thread::get_id() == tickThreadId;
+	case OBS_TASK_AUDIO:
+		return std::this_thread::get_id() == audioThreadId;
+	}
+	return false;
+}
+
+static std::deque<QueuedTask> *GetTaskQueue(enum obs_task_type type)
+{
+	switch (type) {
+	case OBS_TASK_GRAPHICS:
+		return &graphicsTasks;
+	case OBS_TASK_AUDIO:
+		return &audioTasks;
+	case OBS_TASK_DESTROY:
+		return &destroyTasks;
+	default:
+		return nullptr;
+	}
+}
+
+void obs_queue_task(enum obs_task_type type, obs_task_t task, void *param, bool wait)
+{
+	if (!task)
+		return;
+
+	// Waiting for a task from its own thread would deadlock, libobs runs it inline too
+	if (wait && obs_in_task_thread(type)) {
+		task(param);
+		return;
+	}
+
+	if (type == OBS_TASK_UI) {
+		QMetaObject::invokeMethod(
+			qApp, [task, param]() { task(param); }, wait ? Qt::BlockingQueuedConnection : Qt::QueuedConnection);
+		return;
+	}
+
+	// Without running threads nothing would drain the queue
+	if (!running) {
+		task(param);
+		return;
+	}
+
+	std::promise<void> done;
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		GetTaskQueue(type)->push_back({task, param, wait ? &done : nullptr});
+	}
+
+	if (wait)
+		done.get_future().wait();
+}
+
+void FakeObs::RunQueuedTasks(enum obs_task_type type)
+{
+	std::deque<QueuedTask> tasks;
+	{
+		std::lock_guard<std::mutex> lock(taskMutex);
+		tasks.swap(*GetTaskQueue(type));
+	}
+
+	for (auto &task : tasks) {
+		task.task(task.param);
+		if (task.done)
+			task.done->set_value();
+	}
+}
+
+// Stands in for the graphics thread: tasks, tick callbacks, media and transition state, at the configured frame rate
+static void TickThread()
+{
+	tickThreadId = std::this_thread::get_id();
+
+	uint64_t interval = FakeObs::GetVideoFrameIntervalNs();
+	uint64_t lastTick = os_gettime_ns();
+	uint64_t nextTick = lastTick + interval;
+	uint64_t fpsWindowStart = lastTick;
+	uint32_t fpsWindowFrames = 0;
+
+	while (running) {
+		uint64_t frameStart = os_gettime_ns();
+		float seconds = (float)(frameStart - lastTick) / 1000000000.0f;
+		lastTick = frameStart;
+		videoFrameTime = frameStart;
+
+		FakeObs::RunQueuedTasks(OBS_TASK_GRAPHICS);
+		FakeObs::RunQueuedTasks(OBS_TASK_DESTROY);
+
+		std::vector<std::pair<void (*)(void *, float), void *>> callbacks;
+		{
+			std::lock_guard<std::mutex> lock(tickCallbacksMutex);
+			callbacks = tickCallbacks;
+		}
+		for (auto &callback : callbacks)
+			callback.first(callback.second, seconds);
+
+		FakeObs::TickSources(frameStart);
+		FakeObs::TickFrontend(frameStart);
+
+		uint64_t frameEnd = os_gettime_ns();
+		uint64_t frameTime = frameEnd - frameStart;
+		uint64_t average = averageFrameTimeNs;
+		averageFrameTimeNs = average ? (average * 15 + frameTime) / 16 : frameTime;
+		coreVideo.totalFrames++;
+
+		fpsWindowFrames++;
+		if (frameEnd - fpsWindowStart >= FPS_WINDOW_NS) {
+			activeFps = (double)fpsWindowFrames * 1000000000.0 / (double)(frameEnd - fpsWindowStart);
+			fpsWindowStart = frameEnd;
+			fpsWindowFrames = 0;
+		}
+
+		interval = FakeObs::GetVideoFrameIntervalNs();
+		if (frameEnd > nextTick) {
+			// Count the frames which were missed, then realign instead of bursting to catch up
+			uint32_t missed = (uint32_t)((frameEnd - nextTick) / interval) + 1;
+			laggedFrames += missed;
+			coreVideo.skippedFrames += missed;
+			nextTick = frameEnd + interval;
+			continue;
+		}
+
+		std::this_thread::sleep_for(std::chrono::nanoseconds(nextTick - frameEnd));
+		nextTick += interval;
+	}
+
+	FakeObs::RunQueuedTasks(OBS_TASK_GRAPHICS);
+	FakeObs::RunQueuedTasks(OBS_TASK_DESTROY);
+}
+
+static void AudioThread()
+{
+	audioThreadId = std::this_thread::get_id();
+
+	uint64_t interval = 1000000000ULL * AUDIO_FRAMES_PER_TICK / AUDIO_SAMPLE_RATE;
+	uint64_t nextTick = os_gettime_ns();
+
+	while (running) {
+		FakeObs::RunQueuedTasks(OBS_TASK_AUDIO);
+		FakeObs::GenerateAudio(nextTick, AUDIO_FRAMES_PER_TICK, AUDIO_SAMPLE_RATE);
+
+		nextTick += interval;
+		uint64_t now = os_gettime_ns();
+		if (now < nextTick)
+			std::this_thread::sleep_for(std::chrono::nanoseconds(nextTick - now));
+		else
+			nextTick = now;
+	}
+
+	FakeObs::RunQueuedTasks(OBS_TASK_AUDIO);
+}
+
+void FakeObs::Startup(const StartupOptions &startupOptions)
+{
+	options = startupOptions;
+	coreSignals = signal_handler_create();
+	coreProcs = proc_handler_create();
+	coreVideo.frameTime = GetVideoFrameIntervalNs();
+
+	CreateFrontendObjects();
+
+	running = true;
+	tickThread = std::thread(TickThread);
+	audioThread = std::thread(AudioThread);
+
+	blog(LOG_INFO, "[FakeObs::Startup] Started headless libobs %s (%ux%u @ %u/%u fps)", obs_get_version_string(),
+	     options.baseWidth, options.baseHeight, options.fpsNum, options.fpsDen);
+}
+
+void FakeObs::Shutdown()
+{
+	running = false;
+	if (tickThread.joinable())
+		tickThread.join();
+	if (audioThread.joinable())
+		audioThread.join();
+
+	DestroyFrontendObjects();
+
+	{
+		std::lock_guard<std::mutex> lock(tickCallbacksMutex);
+		if (!tickCallbacks.empty())
+			blog(LOG_WARNING, "[FakeObs::Shutdown] %zu tick callbacks were never removed", tickCallbacks.size());
+		tickCallbacks.clear();
+	}
+
+	proc_handler_destroy(coreProcs);
+	coreProcs = nullptr;
+	signal_handler_destroy(coreSignals);
+	coreSignals = nullptr;
+
+	blog(LOG_INFO, "[FakeObs::Shutdown] Finished shutting down, %ld allocations left", bnum_allocs());
+}
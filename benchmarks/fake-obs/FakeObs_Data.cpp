@@ -0,0 +1,692 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cstdlib>
+#include <memory>
+#include <nlohmann/json.hpp>
+
+#include "FakeObs.h"
+
+using json = nlohmann::json;
+
+// Items keep their insertion order like libobs, which makes `obs_data_first()` iteration deterministic.
+// A value is either unset, a user value or a default value. Reads fall back from the user value to the default.
+struct DataValue {
+	bool set = false;
+	enum obs_data_number_type numType = OBS_DATA_NUM_INVALID;
+	long long intValue = 0;
+	double doubleValue = 0.0;
+	bool boolValue = false;
+	std::string stringValue;
+	obs_data_t *objValue = nullptr;
+	obs_data_array_t *arrayValue = nullptr;
+};
+
+struct obs_data_item {
+	std::atomic<long> refs = 1; // One held by the parent while attached
+	obs_data_t *parent;
+	obs_data_item_t *next = nullptr;
+	std::string name;
+	enum obs_data_type type;
+	DataValue user;
+	DataValue def;
+};
+
+struct obs_data {
+	std::atomic<long> refs = 1;
+	obs_data_item_t *first = nullptr;
+	std::string json; // Backing storage for `obs_data_get_json()`
+};
+
+struct obs_data_array {
+	std::atomic<long> refs = 1;
+	std::vector<obs_data_t *> objects;
+};
+
+static void ClearValue(DataValue &value)
+{
+	obs_data_release(value.objValue);
+	obs_data_array_release(value.arrayValue);
+	value = DataValue();
+}
+
+static void ItemAddRef(obs_data_item_t *item)
+{
+	item->refs.fetch_add(1);
+}
+
+static void ItemRelease(obs_data_item_t *item)
+{
+	if (!item || item->refs.fetch_sub(1) != 1)
+		return;
+
+	ClearValue(item->user);
+	ClearValue(item->def);
+	delete item;
+}
+
+static obs_data_item_t *FindItem(obs_data_t *data, const char *name)
+{
+	if (!data || !name)
+		return nullptr;
+
+	for (obs_data_item_t *item = data->first; item; item = item->next) {
+		if (item->name == name)
+			return item;
+	}
+	return nullptr;
+}
+
+static void DetachItem(obs_data_item_t *item)
+{
+	obs_data_t *data = item->parent;
+	if (!data)
+		return;
+
+	obs_data_item_t **link = &data->first;
+	while (*link && *link != item)
+		link = &(*link)->next;
+	if (*link)
+		*link = item->next;
+
+	item->parent = nullptr;
+	ItemRelease(item);
+}
+
+// Returns the item to write `name` into, replacing an existing item of another type
+static obs_data_item_t *GetWritableItem(obs_data_t *data, const char *name, enum obs_data_type type)
+{
+	obs_data_item_t *item = FindItem(data, name);
+	if (item && item->type != type) {
+		DetachItem(item);
+		item = nullptr;
+	}
+
+	if (!item) {
+		item = new obs_data_item;
+		item->parent = data;
+		item->name = name;
+		item->type = type;
+
+		obs_data_item_t **link = &data->first;
+		while (*link)
+			link = &(*link)->next;
+		*link = item;
+	}
+
+	return item;
+}
+
+static const DataValue *GetValue(obs_data_item_t *item)
+{
+	if (!item)
+		return nullptr;
+	if (item->user.set)
+		return &item->user;
+	if (item->def.set)
+		return &item->def;
+	return nullptr;
+}
+
+static DataValue &SetValue(obs_data_t *data, const char *name, enum obs_data_type type, bool isDefault)
+{
+	obs_data_item_t *item = GetWritableItem(data, name, type);
+	DataValue &value = isDefault ? item->def : item->user;
+	ClearValue(value);
+	value.set = true;
+	return value;
+}
+
+static json ToJson(obs_data_t *data);
+
+static json ItemToJson(obs_data_item_t *item)
+{
+	const DataValue &value = item->user;
+	switch (item->type) {
+	case OBS_DATA_STRING:
+		return value.stringValue;
+	case OBS_DATA_NUMBER:
+		if (value.numType == OBS_DATA_NUM_INT)
+			return value.intValue;
+		return value.doubleValue;
+	case OBS_DATA_BOOLEAN:
+		return value.boolValue;
+	case OBS_DATA_OBJECT:
+		return ToJson(value.objValue);
+	case OBS_DATA_ARRAY: {
+		json ret = json::array();
+		if (value.arrayValue) {
+			for (obs_data_t *obj : value.arrayValue->objects)
+				ret.push_back(ToJson(obj));
+		}
+		return ret;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+// Serializes user values only, like libobs
+static json ToJson(obs_data_t *data)
+{
+	json ret = json::object();
+	if (!data)
+		return ret;
+
+	for (obs_data_item_t *item = data->first; item; item = item->next) {
+		if (item->user.set)
+			ret[item->name] = ItemToJson(item);
+	}
+	return ret;
+}
+
+void FakeObs::SetDefaultString(obs_data_t *data, const char *name, const char *val)
+{
+	SetValue(data, name, OBS_DATA_STRING, true).stringValue = val ? val : "";
+}
+
+void FakeObs::SetDefaultInt(obs_data_t *data, const char *name, long long val)
+{
+	DataValue &value = SetValue(data, name, OBS_DATA_NUMBER, true);
+	value.numType = OBS_DATA_NUM_INT;
+	value.intValue = val;
+	value.doubleValue = (double)val;
+}
+
+void FakeObs::SetDefaultDouble(obs_data_t *data, const char *name, double val)
+{
+	DataValue &value = SetValue(data, name, OBS_DATA_NUMBER, true);
+	value.numType = OBS_DATA_NUM_DOUBLE;
+	value.doubleValue = val;
+	value.intValue = (long long)val;
+}
+
+void FakeObs::SetDefaultBool(obs_data_t *data, const char *name, bool val)
+{
+	SetValue(data, name, OBS_DATA_BOOLEAN, true).boolValue = val;
+}
+
+void FakeObs::ClearUserValues(obs_data_t *data)
+{
+	if (!data)
+		return;
+
+	obs_data_item_t *item = data->first;
+	while (item) {
+		obs_data_item_t *next = item->next;
+		ClearValue(item->user);
+		if (!item->def.set)
+			DetachItem(item);
+		item = next;
+	}
+}
+
+obs_data_t *obs_data_create()
+{
+	return new obs_data;
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+	if (data)
+		data->refs.fetch_add(1);
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	if (!data || data->refs.fetch_sub(1) != 1)
+		return;
+
+	obs_data_item_t *item = data->first;
+	while (item) {
+		obs_data_item_t *next = item->next;
+		item->parent = nullptr;
+		ItemRelease(item);
+		item = next;
+	}
+	delete data;
+}
+
+const char *obs_data_get_json(obs_data_t *data)
+{
+	if (!data)
+		return nullptr;
+
+	data->json = ToJson(data).dump();
+	return data->json.c_str();
+}
+
+void obs_data_apply(obs_data_t *target, obs_data_t *apply_data)
+{
+	if (!target || !apply_data || target == apply_data)
+		return;
+
+	for (obs_data_item_t *item = apply_data->first; item; item = item->next) {
+		if (!item->user.set)
+			continue;
+
+		DataValue &value = SetValue(target, item->name.c_str(), item->type, false);
+		value.numType = item->user.numType;
+		value.intValue = item->user.intValue;
+		value.doubleValue = item->user.doubleValue;
+		value.boolValue = item->user.boolValue;
+		value.stringValue = item->user.stringValue;
+		value.objValue = item->user.objValue;
+		value.arrayValue = item->user.arrayValue;
+		obs_data_addref(value.objValue);
+		obs_data_array_addref(value.arrayValue);
+	}
+}
+
+void obs_data_erase(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = FindItem(data, name);
+	if (item)
+		DetachItem(item);
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	if (!data || !name)
+		return;
+
+	SetValue(data, name, OBS_DATA_STRING, false).stringValue = val ? val : "";
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	if (!data || !name)
+		return;
+
+	DataValue &value = SetValue(data, name, OBS_DATA_NUMBER, false);
+	value.numType = OBS_DATA_NUM_INT;
+	value.intValue = val;
+	value.doubleValue = (double)val;
+}
+
+void obs_data_set_double(obs_data_t *data, const char *name, double val)
+{
+	if (!data || !name)
+		return;
+
+	DataValue &value = SetValue(data, name, OBS_DATA_NUMBER, false);
+	value.numType = OBS_DATA_NUM_DOUBLE;
+	value.doubleValue = val;
+	value.intValue = (long long)val;
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	if (!data || !name)
+		return;
+
+	SetValue(data, name, OBS_DATA_BOOLEAN, false).boolValue = val;
+}
+
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_addref(obj);
+	SetValue(data, name, OBS_DATA_OBJECT, false).objValue = obj;
+}
+
+void obs_data_set_array(obs_data_t *data, const char *name, obs_data_array_t *array)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_array_addref(array);
+	SetValue(data, name, OBS_DATA_ARRAY, false).arrayValue = array;
+}
+
+bool obs_data_has_user_value(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = FindItem(data, name);
+	return item && item->user.set;
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_int(FindItem(data, name));
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_double(FindItem(data, name));
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_bool(FindItem(data, name));
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_string(FindItem(data, name));
+}
+
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_obj(FindItem(data, name));
+}
+
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name)
+{
+	return obs_data_item_get_array(FindItem(data, name));
+}
+
+obs_data_item_t *obs_data_first(obs_data_t *data)
+{
+	if (!data || !data->first)
+		return nullptr;
+
+	ItemAddRef(data->first);
+	return data->first;
+}
+
+obs_data_item_t *obs_data_item_byname(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = FindItem(data, name);
+	if (item)
+		ItemAddRef(item);
+	return item;
+}
+
+bool obs_data_item_next(obs_data_item_t **item)
+{
+	if (!item || !*item)
+		return false;
+
+	obs_data_item_t *next = (*item)->next;
+	if (next)
+		ItemAddRef(next);
+	ItemRelease(*item);
+	*item = next;
+	return next != nullptr;
+}
+
+void obs_data_item_release(obs_data_item_t **item)
+{
+	if (!item || !*item)
+		return;
+
+	ItemRelease(*item);
+	*item = nullptr;
+}
+
+void obs_data_item_remove(obs_data_item_t **item)
+{
+	if (!item || !*item)
+		return;
+
+	DetachItem(*item);
+	obs_data_item_release(item);
+}
+
+bool obs_data_item_has_user_value(obs_data_item_t *item)
+{
+	return item && item->user.set;
+}
+
+enum obs_data_type obs_data_item_gettype(obs_data_item_t *item)
+{
+	return item ? item->type : OBS_DATA_NULL;
+}
+
+enum obs_data_number_type obs_data_item_numtype(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_NUMBER)
+		return OBS_DATA_NUM_INVALID;
+	return value->numType;
+}
+
+const char *obs_data_item_get_name(obs_data_item_t *item)
+{
+	return item ? item->name.c_str() : nullptr;
+}
+
+const char *obs_data_item_get_string(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_STRING)
+		return "";
+	return value->stringValue.c_str();
+}
+
+long long obs_data_item_get_int(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_NUMBER)
+		return 0;
+	return value->numType == OBS_DATA_NUM_INT ? value->intValue : (long long)value->doubleValue;
+}
+
+double obs_data_item_get_double(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_NUMBER)
+		return 0.0;
+	return value->numType == OBS_DATA_NUM_DOUBLE ? value->doubleValue : (double)value->intValue;
+}
+
+bool obs_data_item_get_bool(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_BOOLEAN)
+		return false;
+	return value->boolValue;
+}
+
+obs_data_t *obs_data_item_get_obj(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_OBJECT)
+		return nullptr;
+	obs_data_addref(value->objValue);
+	return value->objValue;
+}
+
+obs_data_array_t *obs_data_item_get_array(obs_data_item_t *item)
+{
+	const DataValue *value = GetValue(item);
+	if (!value || item->type != OBS_DATA_ARRAY)
+		return nullptr;
+	obs_data_array_addref(value->arrayValue);
+	return value->arrayValue;
+}
+
+obs_data_array_t *obs_data_array_create()
+{
+	return new obs_data_array;
+}
+
+void obs_data_array_addref(obs_data_array_t *array)
+{
+	if (array)
+		array->refs.fetch_add(1);
+}
+
+void obs_data_array_release(obs_data_array_t *array)
+{
+	if (!array || array->refs.fetch_sub(1) != 1)
+		return;
+
+	for (obs_data_t *obj : array->objects)
+		obs_data_release(obj);
+	delete array;
+}
+
+size_t obs_data_array_count(obs_data_array_t *array)
+{
+	return array ? array->objects.size() : 0;
+}
+
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx)
+{
+	if (!array || idx >= array->objects.size())
+		return nullptr;
+
+	obs_data_t *obj = array->objects[idx];
+	obs_data_addref(obj);
+	return obj;
+}
+
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj)
+{
+	if (!array || !obj)
+		return 0;
+
+	obs_data_addref(obj);
+	array->objects.push_back(obj);
+	return array->objects.size() - 1;
+}
+
+// Properties only carry what the request handlers read: list items, buttons and enabled state
+
+struct obs_property {
+	struct ListItem {
+		std::string name;
+		std::string stringValue;
+		long long intValue;
+		double floatValue;
+	};
+
+	std::string name;
+	enum obs_property_type type;
+	enum obs_combo_format format = OBS_COMBO_FORMAT_INVALID;
+	std::vector<ListItem> items;
+};
+
+struct obs_properties {
+	std::vector<std::unique_ptr<obs_property>> properties;
+};
+
+obs_properties_t *FakeObs::CreateProperties()
+{
+	return new obs_properties;
+}
+
+void FakeObs::AddListProperty(obs_properties_t *props, const char *name, enum obs_combo_format format,
+			      const std::vector<std::pair<std::string, std::string>> &items)
+{
+	auto property = std::make_unique<obs_property>();
+	property->name = name;
+	property->type = OBS_PROPERTY_LIST;
+	property->format = format;
+	for (auto &item : items) {
+		long long intValue = format == OBS_COMBO_FORMAT_STRING ? 0 : std::atoll(item.second.c_str());
+		property->items.push_back({item.first, item.second, intValue, (double)intValue});
+	}
+	props->properties.push_back(std::move(property));
+}
+
+void FakeObs::AddButtonProperty(obs_properties_t *props, const char *name)
+{
+	auto property = std::make_unique<obs_property>();
+	property->name = name;
+	property->type = OBS_PROPERTY_BUTTON;
+	props->properties.push_back(std::move(property));
+}
+
+void FakeObs::AddTextProperty(obs_properties_t *props, const char *name)
+{
+	auto property = std::make_unique<obs_property>();
+	property->name = name;
+	property->type = OBS_PROPERTY_TEXT;
+	props->properties.push_back(std::move(property));
+}
+
+void obs_properties_destroy(obs_properties_t *props)
+{
+	delete props;
+}
+
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *prop)
+{
+	if (!props || !prop)
+		return nullptr;
+
+	for (auto &property : props->properties) {
+		if (property->name == prop)
+			return property.get();
+	}
+	return nullptr;
+}
+
+bool obs_property_button_clicked(obs_property_t *, void *)
+{
+	// Buttons have no side effects here, and never ask for the properties to be refreshed
+	return false;
+}
+
+bool obs_property_enabled(obs_property_t *p)
+{
+	return p != nullptr;
+}
+
+enum obs_property_type obs_property_get_type(obs_property_t *p)
+{
+	return p ? p->type : OBS_PROPERTY_INVALID;
+}
+
+enum obs_combo_format obs_property_list_format(obs_property_t *p)
+{
+	return p ? p->format : OBS_COMBO_FORMAT_INVALID;
+}
+
+size_t obs_property_list_item_count(obs_property_t *p)
+{
+	return p ? p->items.size() : 0;
+}
+
+bool obs_property_list_item_disabled(obs_property_t *, size_t)
+{
+	return false;
+}
+
+const char *obs_property_list_item_name(obs_property_t *p, size_t idx)
+{
+	if (!p || idx >= p->items.size())
+		return nullptr;
+	return p->items[idx].name.c_str();
+}
+
+const char *obs_property_list_item_string(obs_property_t *p, size_t idx)
+{
+	if (!p || idx >= p->items.size())
+		return nullptr;
+	return p->items[idx].stringValue.c_str();
+}
+
+long long obs_property_list_item_int(obs_property_t *p, size_t idx)
+{
+	if (!p || idx >= p->items.size())
+		return 0;
+	return p->items[idx].intValue;
+}
+
+double obs_property_list_item_float(obs_property_t *p, size_t idx)
+{
+	if (!p || idx >= p->items.size())
+		return 0.0;
+	return p->items[idx].floatValue;
+}
@@ -0,0 +1,984 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <QAction>
+#include <QApplication>
+#include <util/bmem.h>
+#include <util/config-file.h>
+
+#include "FakeObs.h"
+
+#define DEFAULT_TRANSITION_DURATION 300
+#define TBAR_PRECISION 1024
+#define DEFAULT_COLLECTION_NAME "Benchmark"
+#define DEFAULT_PROFILE_NAME "Benchmark"
+#define NO_EVENT ((enum obs_frontend_event) - 1)
+
+// Mirrors the parts of `OBSBasic` which the frontend API exposes. All state lives behind one lock, and frontend
+// events and signals are only emitted once it has been released, since their handlers call straight back in.
+
+static std::recursive_mutex frontendMutex;
+
+static std::mutex eventCallbacksMutex;
+static std::vector<std::pair<obs_frontend_event_cb, void *>> eventCallbacks;
+
+static std::vector<obs_source_t *> scenes; // Non-group scenes in creation order, each holds a reference
+static obs_source_t *programScene = nullptr;
+static obs_source_t *previewScene = nullptr;
+static bool studioMode = false;
+static int tbarPosition = 0;
+
+static std::vector<obs_source_t *> transitions; // Private, each holds a reference
+static obs_source_t *currentTransition = nullptr;
+static int transitionDuration = DEFAULT_TRANSITION_DURATION;
+static obs_source_t *transitioningFrom = nullptr; // Referenced while a transition is in progress
+static uint64_t transitionStartedAt = 0;
+static uint64_t transitionEndsAt = 0;
+
+static std::vector<std::string> sceneCollections;
+static std::string currentSceneCollection;
+static std::vector<std::string> profiles;
+static std::string currentProfile;
+
+static obs_output_t *streamOutput = nullptr;
+static obs_output_t *recordOutput = nullptr;
+static obs_output_t *replayBufferOutput = nullptr;
+static obs_output_t *virtualcamOutput = nullptr;
+static obs_service_t *streamService = nullptr;
+static int recordingFileIndex = 0;
+static std::string lastReplay;
+static std::string lastScreenshot;
+
+static config_t *profileConfig = nullptr;
+static config_t *globalConfig = nullptr;
+
+static std::vector<obs_frontend_translate_ui_cb> translations;
+static std::vector<obs_hotkey_t> hotkeys;
+
+void FakeObs::EmitFrontendEvent(enum obs_frontend_event event)
+{
+	std::vector<std::pair<obs_frontend_event_cb, void *>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(eventCallbacksMutex);
+		callbacks = eventCallbacks;
+	}
+
+	for (auto &callback : callbacks)
+		callback.first(event, callback.second);
+}
+
+static void EmitTransitionSignal(obs_source_t *transition, const char *signal)
+{
+	if (transition)
+		FakeObs::EmitSourceSignal(transition, signal);
+}
+
+// Ends the transition in progress, if any. Returns the transition which ended, referenced, for the caller to signal
+static obs_source_t *FinishTransition()
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	if (!transitioningFrom)
+		return nullptr;
+
+	FakeObs::SetSourceActive(transitioningFrom, false);
+	obs_source_release(transitioningFrom);
+	transitioningFrom = nullptr;
+	return obs_source_get_ref(currentTransition);
+}
+
+static void SignalTransitionStopped(obs_source_t *transition)
+{
+	if (!transition)
+		return;
+
+	EmitTransitionSignal(transition, "transition_stop");
+	EmitTransitionSignal(transition, "transition_video_stop");
+	obs_source_release(transition);
+}
+
+// Makes `scene` the program scene, through the current transition like `OBSBasic::TransitionToScene()`
+static void TransitionToScene(obs_source_t *scene)
+{
+	SignalTransitionStopped(FinishTransition());
+
+	obs_source_t *transition = nullptr;
+	bool previewChanged = false;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!scene || scene == programScene)
+			return;
+
+		obs_source_t *prevScene = programScene;
+		programScene = obs_source_get_ref(scene);
+		FakeObs::SetSourceActive(programScene, true);
+
+		// Studio mode swaps the old program scene into the preview, the default behaviour of OBS
+		if (studioMode && prevScene) {
+			obs_source_release(previewScene);
+			previewScene = obs_source_get_ref(prevScene);
+			previewChanged = true;
+		}
+
+		bool fixed = obs_transition_fixed(currentTransition);
+		if (prevScene && !fixed && transitionDuration > 0) {
+			transitioningFrom = prevScene;
+			transitionStartedAt = os_gettime_ns();
+			transitionEndsAt = transitionStartedAt + (uint64_t)transitionDuration * 1000000;
+		} else if (prevScene) {
+			FakeObs::SetSourceActive(prevScene, false);
+			obs_source_release(prevScene);
+		}
+		transition = obs_source_get_ref(currentTransition);
+	}
+
+	EmitTransitionSignal(transition, "transition_start");
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_CHANGED);
+	if (previewChanged)
+		FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+
+	// Cuts and zero-length transitions end immediately
+	bool finished;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		finished = !transitioningFrom;
+	}
+	if (finished) {
+		EmitTransitionSignal(transition, "transition_stop");
+		EmitTransitionSignal(transition, "transition_video_stop");
+		FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_TRANSITION_STOPPED);
+	}
+	obs_source_release(transition);
+}
+
+void FakeObs::TickFrontend(uint64_t now)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!transitioningFrom || now < transitionEndsAt)
+			return;
+	}
+
+	obs_source_t *transition = FinishTransition();
+	if (!transition)
+		return;
+
+	SignalTransitionStopped(transition);
+	EmitFrontendEvent(OBS_FRONTEND_EVENT_TRANSITION_STOPPED);
+}
+
+// Keeps the scene list in sync with the core, the same way the OBS scenes dock does
+static void OnSourceCreate(void *, calldata_t *cd)
+{
+	auto source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+	if (!obs_scene_from_source(source))
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		scenes.push_back(obs_source_get_ref(source));
+	}
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED);
+}
+
+static void OnSourceRemove(void *, calldata_t *cd)
+{
+	auto source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+	obs_source_t *nextScene = nullptr;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		auto it = std::find(scenes.begin(), scenes.end(), source);
+		if (it == scenes.end())
+			return;
+		scenes.erase(it);
+
+		if (previewScene == source) {
+			obs_source_release(previewScene);
+			previewScene = nullptr;
+		}
+		if (programScene == source && !scenes.empty()) {
+			nextScene = obs_source_get_ref(scenes.front());
+		} else if (programScene == source) {
+			FakeObs::SetSourceActive(programScene, false);
+			obs_source_release(programScene);
+			programScene = nullptr;
+		}
+	}
+
+	// The source is still referenced by `obs_source_remove()` while this runs
+	obs_source_release(source);
+	if (nextScene) {
+		TransitionToScene(nextScene);
+		obs_source_release(nextScene);
+	}
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED);
+}
+
+static void AddHotkey(const char *name, const char *description, void (*func)(bool pressed))
+{
+	obs_hotkey_t hotkey;
+	hotkey.id = (obs_hotkey_id)hotkeys.size();
+	hotkey.name = name;
+	hotkey.description = description;
+	hotkey.registererType = OBS_HOTKEY_REGISTERER_FRONTEND;
+	hotkey.registerer = nullptr;
+	hotkey.func = func;
+	hotkeys.push_back(hotkey);
+}
+
+static void CreateHotkeys()
+{
+	AddHotkey("OBSBasic.StartStreaming", "Start Streaming", [](bool pressed) {
+		if (pressed)
+			obs_frontend_streaming_start();
+	});
+	AddHotkey("OBSBasic.StopStreaming", "Stop Streaming", [](bool pressed) {
+		if (pressed)
+			obs_frontend_streaming_stop();
+	});
+	AddHotkey("OBSBasic.StartRecording", "Start Recording", [](bool pressed) {
+		if (pressed)
+			obs_frontend_recording_start();
+	});
+	AddHotkey("OBSBasic.StopRecording", "Stop Recording", [](bool pressed) {
+		if (pressed)
+			obs_frontend_recording_stop();
+	});
+	AddHotkey("OBSBasic.EnablePreviewProgram", "Enable Studio Mode", [](bool pressed) {
+		if (pressed)
+			obs_frontend_set_preview_program_mode(true);
+	});
+	AddHotkey("OBSBasic.DisablePreviewProgram", "Disable Studio Mode", [](bool pressed) {
+		if (pressed)
+			obs_frontend_set_preview_program_mode(false);
+	});
+	AddHotkey("OBSBasic.Transition", "Transition", [](bool pressed) {
+		obs_source_t *scene;
+		{
+			std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+			scene = studioMode && pressed ? obs_source_get_ref(previewScene) : nullptr;
+		}
+		TransitionToScene(scene);
+		obs_source_release(scene);
+	});
+}
+
+void FakeObs::CreateFrontendObjects()
+{
+	signal_handler_t *sh = obs_get_signal_handler();
+	signal_handler_connect(sh, "source_create", OnSourceCreate, nullptr);
+	signal_handler_connect(sh, "source_remove", OnSourceRemove, nullptr);
+
+	transitions.push_back(CreateSource("fade_transition", "Fade", nullptr, true));
+	transitions.push_back(CreateSource("cut_transition", "Cut", nullptr, true));
+	currentTransition = transitions.front();
+
+	sceneCollections = {DEFAULT_COLLECTION_NAME};
+	currentSceneCollection = DEFAULT_COLLECTION_NAME;
+	profiles = {DEFAULT_PROFILE_NAME};
+	currentProfile = DEFAULT_PROFILE_NAME;
+
+	streamOutput = CreateOutput("rtmp_output", "simple_stream", OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_SERVICE);
+	recordOutput = CreateOutput("ffmpeg_muxer", "simple_file_output",
+				    OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED | OBS_OUTPUT_CAN_PAUSE | OBS_OUTPUT_MULTI_TRACK);
+	replayBufferOutput = CreateOutput("replay_buffer", "Replay Buffer", OBS_OUTPUT_AV | OBS_OUTPUT_ENCODED);
+	virtualcamOutput = CreateOutput("virtualcam_output", "virtualcam_output", OBS_OUTPUT_VIDEO);
+	streamService = obs_service_create("rtmp_common", "default_service", nullptr, nullptr);
+
+	uint32_t baseWidth, baseHeight;
+	GetBaseSize(baseWidth, baseHeight);
+	obs_video_info ovi;
+	obs_get_video_info(&ovi);
+
+	profileConfig = CreateConfig();
+	config_set_default_uint(profileConfig, "Video", "BaseCX", baseWidth);
+	config_set_default_uint(profileConfig, "Video", "BaseCY", baseHeight);
+	config_set_default_uint(profileConfig, "Video", "OutputCX", baseWidth);
+	config_set_default_uint(profileConfig, "Video", "OutputCY", baseHeight);
+	config_set_default_uint(profileConfig, "Video", "FPSNum", ovi.fps_num);
+	config_set_default_uint(profileConfig, "Video", "FPSDen", ovi.fps_den);
+	config_set_default_string(profileConfig, "Output", "Mode", "Simple");
+	config_set_default_string(profileConfig, "SimpleOutput", "FilePath", (GetConfigPath() + "/recordings").c_str());
+	globalConfig = CreateConfig();
+
+	CreateHotkeys();
+}
+
+void FakeObs::DestroyFrontendObjects()
+{
+	SignalTransitionStopped(FinishTransition());
+
+	signal_handler_t *sh = obs_get_signal_handler();
+	signal_handler_disconnect(sh, "source_create", OnSourceCreate, nullptr);
+	signal_handler_disconnect(sh, "source_remove", OnSourceRemove, nullptr);
+
+	std::vector<obs_source_t *> remaining;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		remaining.swap(scenes);
+		remaining.insert(remaining.end(), transitions.begin(), transitions.end());
+		transitions.clear();
+		currentTransition = nullptr;
+		obs_source_release(programScene);
+		programScene = nullptr;
+		obs_source_release(previewScene);
+		previewScene = nullptr;
+	}
+	ReleaseSnapshot(remaining);
+
+	for (obs_output_t *output : {streamOutput, recordOutput, replayBufferOutput, virtualcamOutput}) {
+		obs_output_stop(output);
+		obs_output_release(output);
+	}
+	streamOutput = recordOutput = replayBufferOutput = virtualcamOutput = nullptr;
+	obs_service_release(streamService);
+	streamService = nullptr;
+
+	config_close(profileConfig);
+	profileConfig = nullptr;
+	config_close(globalConfig);
+	globalConfig = nullptr;
+
+	hotkeys.clear();
+
+	std::lock_guard<std::mutex> lock(eventCallbacksMutex);
+	if (!eventCallbacks.empty())
+		blog(LOG_WARNING, "[FakeObs::DestroyFrontendObjects] %zu frontend event callbacks were never removed",
+		     eventCallbacks.size());
+	eventCallbacks.clear();
+}
+
+// Returns the list as a single allocation, freed with one `bfree()` like the `strlist` OBS hands out
+static char **CreateStringList(const std::vector<std::string> &strings)
+{
+	size_t size = (strings.size() + 1) * sizeof(char *);
+	for (auto &string : strings)
+		size += string.size() + 1;
+
+	auto list = static_cast<char **>(bmalloc(size));
+	char *cursor = reinterpret_cast<char *>(list + strings.size() + 1);
+	for (size_t i = 0; i < strings.size(); i++) {
+		list[i] = cursor;
+		std::memcpy(cursor, strings[i].c_str(), strings[i].size() + 1);
+		cursor += strings[i].size() + 1;
+	}
+	list[strings.size()] = nullptr;
+	return list;
+}
+
+static void PushSourceList(struct obs_frontend_source_list *list, const std::vector<obs_source_t *> &sources)
+{
+	for (obs_source_t *source : sources) {
+		source = obs_source_get_ref(source);
+		if (source)
+			da_push_back(list->sources, &source);
+	}
+}
+
+void *obs_frontend_get_main_window(void)
+{
+	return nullptr;
+}
+
+void *obs_frontend_get_main_window_handle(void)
+{
+	return nullptr;
+}
+
+void *obs_frontend_get_system_tray(void)
+{
+	return nullptr;
+}
+
+void *obs_frontend_add_tools_menu_qaction(const char *name)
+{
+	return new QAction(QString::fromUtf8(name), qApp);
+}
+
+void obs_frontend_push_ui_translation(obs_frontend_translate_ui_cb translate)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	translations.push_back(translate);
+}
+
+void obs_frontend_pop_ui_translation(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	if (!translations.empty())
+		translations.pop_back();
+}
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	std::lock_guard<std::mutex> lock(eventCallbacksMutex);
+	eventCallbacks.emplace_back(callback, private_data);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	std::lock_guard<std::mutex> lock(eventCallbacksMutex);
+	auto it = std::find(eventCallbacks.begin(), eventCallbacks.end(), std::make_pair(callback, private_data));
+	if (it != eventCallbacks.end())
+		eventCallbacks.erase(it);
+}
+
+void obs_frontend_get_scenes(struct obs_frontend_source_list *sources)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	PushSourceList(sources, scenes);
+}
+
+obs_source_t *obs_frontend_get_current_scene(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return obs_source_get_ref(programScene);
+}
+
+void obs_frontend_set_current_scene(obs_source_t *scene)
+{
+	if (obs_scene_from_source(scene))
+		TransitionToScene(scene);
+}
+
+bool obs_frontend_preview_program_mode_active(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return studioMode;
+}
+
+void obs_frontend_set_preview_program_mode(bool enable)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (studioMode == enable)
+			return;
+
+		studioMode = enable;
+		obs_source_release(previewScene);
+		previewScene = enable ? obs_source_get_ref(programScene) : nullptr;
+	}
+
+	FakeObs::EmitFrontendEvent(enable ? OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED : OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED);
+}
+
+obs_source_t *obs_frontend_get_current_preview_scene(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return studioMode ? obs_source_get_ref(previewScene) : nullptr;
+}
+
+void obs_frontend_set_current_preview_scene(obs_source_t *scene)
+{
+	if (!obs_scene_from_source(scene))
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!studioMode || previewScene == scene)
+			return;
+
+		obs_source_release(previewScene);
+		previewScene = obs_source_get_ref(scene);
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED);
+}
+
+void obs_frontend_get_transitions(struct obs_frontend_source_list *sources)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	PushSourceList(sources, transitions);
+}
+
+obs_source_t *obs_frontend_get_current_transition(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return obs_source_get_ref(currentTransition);
+}
+
+void obs_frontend_set_current_transition(obs_source_t *transition)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (std::find(transitions.begin(), transitions.end(), transition) == transitions.end())
+			return;
+		if (transition == currentTransition)
+			return;
+
+		currentTransition = transition;
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_TRANSITION_CHANGED);
+}
+
+int obs_frontend_get_transition_duration(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return transitionDuration;
+}
+
+void obs_frontend_set_transition_duration(int duration)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (transitionDuration == duration)
+			return;
+
+		transitionDuration = duration;
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_TRANSITION_DURATION_CHANGED);
+}
+
+int obs_frontend_get_tbar_position(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return tbarPosition;
+}
+
+void obs_frontend_set_tbar_position(int position)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!studioMode)
+			return;
+
+		tbarPosition = std::clamp(position, 0, TBAR_PRECISION);
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_TBAR_VALUE_CHANGED);
+}
+
+// Releasing the T-Bar at the end commits the preview to program, anywhere else cancels the manual transition
+void obs_frontend_release_tbar(void)
+{
+	obs_source_t *scene = nullptr;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!studioMode)
+			return;
+
+		if (tbarPosition >= TBAR_PRECISION)
+			scene = obs_source_get_ref(previewScene);
+		tbarPosition = 0;
+	}
+
+	TransitionToScene(scene);
+	obs_source_release(scene);
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_TBAR_VALUE_CHANGED);
+}
+
+// The libobs transition calls live here, since transition progress is driven by the frontend
+bool obs_transition_fixed(obs_source_t *transition)
+{
+	return !transition || strcmp(obs_source_get_id(transition), "cut_transition") == 0;
+}
+
+float obs_transition_get_time(obs_source_t *transition)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	if (studioMode && tbarPosition > 0)
+		return (float)tbarPosition / TBAR_PRECISION;
+	if (!transitioningFrom || transition != currentTransition || transitionEndsAt <= transitionStartedAt)
+		return 1.0f;
+
+	uint64_t now = std::min(os_gettime_ns(), transitionEndsAt);
+	return (float)(now - transitionStartedAt) / (float)(transitionEndsAt - transitionStartedAt);
+}
+
+// Scene collections and profiles are names only. Switching emits the events but keeps the loaded synthetic collection
+char **obs_frontend_get_scene_collections(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return CreateStringList(sceneCollections);
+}
+
+char *obs_frontend_get_current_scene_collection(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return bstrdup(currentSceneCollection.c_str());
+}
+
+void obs_frontend_set_current_scene_collection(const char *collection)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!collection || currentSceneCollection == collection)
+			return;
+		if (std::find(sceneCollections.begin(), sceneCollections.end(), collection) == sceneCollections.end())
+			return;
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING);
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		currentSceneCollection = collection;
+	}
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED);
+}
+
+bool obs_frontend_add_scene_collection(const char *name)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!name || std::find(sceneCollections.begin(), sceneCollections.end(), name) != sceneCollections.end())
+			return false;
+
+		sceneCollections.push_back(name);
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_SCENE_COLLECTION_LIST_CHANGED);
+	obs_frontend_set_current_scene_collection(name);
+	return true;
+}
+
+char **obs_frontend_get_profiles(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return CreateStringList(profiles);
+}
+
+char *obs_frontend_get_current_profile(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return bstrdup(currentProfile.c_str());
+}
+
+char *obs_frontend_get_current_profile_path(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	std::string path = FakeObs::GetConfigPath() + "/basic/profiles/" + currentProfile;
+	return bstrdup(path.c_str());
+}
+
+void obs_frontend_set_current_profile(const char *profile)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!profile || currentProfile == profile)
+			return;
+		if (std::find(profiles.begin(), profiles.end(), profile) == profiles.end())
+			return;
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PROFILE_CHANGING);
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		currentProfile = profile;
+	}
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PROFILE_CHANGED);
+}
+
+void obs_frontend_create_profile(const char *name)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!name || std::find(profiles.begin(), profiles.end(), name) != profiles.end())
+			return;
+
+		profiles.push_back(name);
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PROFILE_LIST_CHANGED);
+	obs_frontend_set_current_profile(name);
+}
+
+void obs_frontend_delete_profile(const char *profile)
+{
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		if (!profile || currentProfile == profile)
+			return;
+
+		auto it = std::find(profiles.begin(), profiles.end(), profile);
+		if (it == profiles.end())
+			return;
+		profiles.erase(it);
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_PROFILE_LIST_CHANGED);
+}
+
+config_t *obs_frontend_get_profile_config(void)
+{
+	return profileConfig;
+}
+
+config_t *obs_frontend_get_global_config(void)
+{
+	return globalConfig;
+}
+
+void obs_frontend_reset_video(void)
+{
+	FakeObs::ResetVideo((uint32_t)config_get_uint(profileConfig, "Video", "BaseCX"),
+			    (uint32_t)config_get_uint(profileConfig, "Video", "BaseCY"),
+			    (uint32_t)config_get_uint(profileConfig, "Video", "FPSNum"),
+			    (uint32_t)config_get_uint(profileConfig, "Video", "FPSDen"));
+}
+
+// Starts or stops an output, wrapped in the frontend events OBS emits around it
+static void SetOutputActive(obs_output_t *output, bool active, enum obs_frontend_event starting, enum obs_frontend_event started,
+			    enum obs_frontend_event stopping, enum obs_frontend_event stopped)
+{
+	if (obs_output_active(output) == active)
+		return;
+
+	if (active) {
+		if (starting != NO_EVENT)
+			FakeObs::EmitFrontendEvent(starting);
+		obs_output_start(output);
+		FakeObs::EmitFrontendEvent(started);
+	} else {
+		if (stopping != NO_EVENT)
+			FakeObs::EmitFrontendEvent(stopping);
+		obs_output_stop(output);
+		FakeObs::EmitFrontendEvent(stopped);
+	}
+}
+
+void obs_frontend_streaming_start(void)
+{
+	SetOutputActive(streamOutput, true, OBS_FRONTEND_EVENT_STREAMING_STARTING, OBS_FRONTEND_EVENT_STREAMING_STARTED,
+			NO_EVENT, NO_EVENT);
+}
+
+void obs_frontend_streaming_stop(void)
+{
+	SetOutputActive(streamOutput, false, NO_EVENT, NO_EVENT, OBS_FRONTEND_EVENT_STREAMING_STOPPING,
+			OBS_FRONTEND_EVENT_STREAMING_STOPPED);
+}
+
+bool obs_frontend_streaming_active(void)
+{
+	return obs_output_active(streamOutput);
+}
+
+void obs_frontend_recording_start(void)
+{
+	SetOutputActive(recordOutput, true, OBS_FRONTEND_EVENT_RECORDING_STARTING, OBS_FRONTEND_EVENT_RECORDING_STARTED,
+			NO_EVENT, NO_EVENT);
+}
+
+void obs_frontend_recording_stop(void)
+{
+	SetOutputActive(recordOutput, false, NO_EVENT, NO_EVENT, OBS_FRONTEND_EVENT_RECORDING_STOPPING,
+			OBS_FRONTEND_EVENT_RECORDING_STOPPED);
+}
+
+bool obs_frontend_recording_active(void)
+{
+	return obs_output_active(recordOutput);
+}
+
+void obs_frontend_recording_pause(bool pause)
+{
+	if (obs_output_paused(recordOutput) == pause || !obs_output_pause(recordOutput, pause))
+		return;
+
+	FakeObs::EmitFrontendEvent(pause ? OBS_FRONTEND_EVENT_RECORDING_PAUSED : OBS_FRONTEND_EVENT_RECORDING_UNPAUSED);
+}
+
+bool obs_frontend_recording_paused(void)
+{
+	return obs_output_paused(recordOutput);
+}
+
+bool obs_frontend_recording_split_file(void)
+{
+	if (!obs_output_active(recordOutput))
+		return false;
+
+	std::string nextFile;
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		nextFile = config_get_string(profileConfig, "SimpleOutput", "FilePath");
+		nextFile += "/recording-" + std::to_string(++recordingFileIndex) + ".mkv";
+	}
+
+	calldata_t cd = {0};
+	calldata_set_ptr(&cd, "output", recordOutput);
+	calldata_set_string(&cd, "next_file", nextFile.c_str());
+	signal_handler_signal(obs_output_get_signal_handler(recordOutput), "file_changed", &cd);
+	calldata_free(&cd);
+	return true;
+}
+
+bool obs_frontend_recording_add_chapter(const char *name)
+{
+	return obs_output_active(recordOutput) && name;
+}
+
+char *obs_frontend_get_current_record_output_path(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return bstrdup(config_get_string(profileConfig, "SimpleOutput", "FilePath"));
+}
+
+void obs_frontend_replay_buffer_start(void)
+{
+	SetOutputActive(replayBufferOutput, true, OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTING,
+			OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED, NO_EVENT, NO_EVENT);
+}
+
+void obs_frontend_replay_buffer_stop(void)
+{
+	SetOutputActive(replayBufferOutput, false, NO_EVENT, NO_EVENT, OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPING,
+			OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED);
+}
+
+void obs_frontend_replay_buffer_save(void)
+{
+	if (!obs_output_active(replayBufferOutput))
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+		lastReplay = config_get_string(profileConfig, "SimpleOutput", "FilePath");
+		lastReplay += "/replay-" + std::to_string(os_gettime_ns()) + ".mkv";
+	}
+
+	FakeObs::EmitFrontendEvent(OBS_FRONTEND_EVENT_REPLAY_BUFFER_SAVED);
+}
+
+bool obs_frontend_replay_buffer_active(void)
+{
+	return obs_output_active(replayBufferOutput);
+}
+
+char *obs_frontend_get_last_replay(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return lastReplay.empty() ? nullptr : bstrdup(lastReplay.c_str());
+}
+
+char *obs_frontend_get_last_screenshot(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return lastScreenshot.empty() ? nullptr : bstrdup(lastScreenshot.c_str());
+}
+
+void obs_frontend_start_virtualcam(void)
+{
+	SetOutputActive(virtualcamOutput, true, NO_EVENT, OBS_FRONTEND_EVENT_VIRTUALCAM_STARTED, NO_EVENT, NO_EVENT);
+}
+
+void obs_frontend_stop_virtualcam(void)
+{
+	SetOutputActive(virtualcamOutput, false, NO_EVENT, NO_EVENT, NO_EVENT, OBS_FRONTEND_EVENT_VIRTUALCAM_STOPPED);
+}
+
+bool obs_frontend_virtualcam_active(void)
+{
+	return obs_output_active(virtualcamOutput);
+}
+
+obs_output_t *obs_frontend_get_streaming_output(void)
+{
+	return obs_output_get_ref(streamOutput);
+}
+
+obs_output_t *obs_frontend_get_recording_output(void)
+{
+	return obs_output_get_ref(recordOutput);
+}
+
+obs_output_t *obs_frontend_get_replay_buffer_output(void)
+{
+	return obs_output_get_ref(replayBufferOutput);
+}
+
+obs_output_t *obs_frontend_get_virtualcam_output(void)
+{
+	return obs_output_get_ref(virtualcamOutput);
+}
+
+obs_service_t *obs_frontend_get_streaming_service(void)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	return streamService;
+}
+
+void obs_frontend_set_streaming_service(obs_service_t *service)
+{
+	std::lock_guard<std::recursive_mutex> lock(frontendMutex);
+	if (!service || service == streamService)
+		return;
+
+	obs_service_release(streamService);
+	streamService = obs_service_get_ref(service);
+}
+
+void obs_frontend_save_streaming_service(void) {}
+
+void obs_frontend_open_projector(const char *, int, const char *, const char *) {}
+
+void obs_frontend_open_source_properties(obs_source_t *) {}
+
+void obs_frontend_open_source_filters(obs_source_t *) {}
+
+void obs_frontend_open_source_interaction(obs_source_t *) {}
+
+// Only the frontend's own hotkeys exist. Key combinations are never bound, so injected key events do nothing
+void obs_enum_hotkeys(obs_hotkey_enum_func func, void *data)
+{
+	for (obs_hotkey_t &hotkey : hotkeys) {
+		if (!func(data, hotkey.id, &hotkey))
+			break;
+	}
+}
+
+obs_hotkey_id obs_hotkey_get_id(const obs_hotkey_t *key)
+{
+	return key->id;
+}
+
+const char *obs_hotkey_get_name(const obs_hotkey_t *key)
+{
+	return key->name.c_str();
+}
+
+const char *obs_hotkey_get_description(const obs_hotkey_t *key)
+{
+	return key->description.c_str();
+}
+
+enum obs_hotkey_registerer_type obs_hotkey_get_registerer_type(const obs_hotkey_t *key)
+{
+	return key->registererType;
+}
+
+void *obs_hotkey_get_registerer(const obs_hotkey_t *key)
+{
+	return key->registerer;
+}
+
+void obs_hotkey_trigger_routed_callback(obs_hotkey_id id, bool pressed)
+{
+	if (id < hotkeys.size())
+		hotkeys[id].func(pressed);
+}
+
+void obs_hotkey_inject_event(obs_key_combination_t, bool) {}
+
+obs_key_t obs_key_from_name(const char *)
+{
+	return OBS_KEY_NONE;
+}
@@ -0,0 +1,119 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <vector>
+
+#include "FakeObs.h"
+
+#define STAGE_BYTES_PER_PIXEL 4
+#define STAGE_FILL_VALUE 0x80
+
+// Nothing is rendered. Render targets only remember their size, and staging surfaces map to a mid-gray buffer of the
+// right dimensions, so readback and image encoding paths still do their full amount of CPU work.
+
+struct gs_texture {
+	uint32_t width;
+	uint32_t height;
+};
+
+struct gs_texture_render {
+	gs_texture texture = {0, 0};
+	bool rendered = false;
+};
+
+struct gs_stage_surface {
+	uint32_t width;
+	uint32_t height;
+	std::vector<uint8_t> data;
+};
+
+gs_texrender_t *gs_texrender_create(enum gs_color_format, enum gs_zstencil_format)
+{
+	return new gs_texture_render;
+}
+
+void gs_texrender_destroy(gs_texrender_t *texrender)
+{
+	delete texrender;
+}
+
+bool gs_texrender_begin(gs_texrender_t *texrender, uint32_t cx, uint32_t cy)
+{
+	if (!texrender || texrender->rendered || !cx || !cy)
+		return false;
+
+	texrender->texture.width = cx;
+	texrender->texture.height = cy;
+	return true;
+}
+
+void gs_texrender_end(gs_texrender_t *texrender)
+{
+	if (texrender)
+		texrender->rendered = true;
+}
+
+void gs_texrender_reset(gs_texrender_t *texrender)
+{
+	if (texrender)
+		texrender->rendered = false;
+}
+
+gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender)
+{
+	return texrender ? const_cast<gs_texture_t *>(&texrender->texture) : nullptr;
+}
+
+gs_stagesurf_t *gs_stagesurface_create(uint32_t width, uint32_t height, enum gs_color_format)
+{
+	auto stagesurf = new gs_stage_surface;
+	stagesurf->width = width;
+	stagesurf->height = height;
+	stagesurf->data.assign((size_t)width * height * STAGE_BYTES_PER_PIXEL, STAGE_FILL_VALUE);
+	return stagesurf;
+}
+
+void gs_stagesurface_destroy(gs_stagesurf_t *stagesurf)
+{
+	delete stagesurf;
+}
+
+void gs_stage_texture(gs_stagesurf_t *, gs_texture_t *) {}
+
+bool gs_stagesurface_map(gs_stagesurf_t *stagesurf, uint8_t **data, uint32_t *linesize)
+{
+	if (!stagesurf || stagesurf->data.empty())
+		return false;
+
+	*data = stagesurf->data.data();
+	*linesize = stagesurf->width * STAGE_BYTES_PER_PIXEL;
+	return true;
+}
+
+void gs_stagesurface_unmap(gs_stagesurf_t *) {}
+
+void gs_clear(uint32_t, const struct vec4 *, float, uint8_t) {}
+
+void gs_ortho(float, float, float, float, float, float) {}
+
+void gs_blend_state_push(void) {}
+
+void gs_blend_state_pop(void) {}
+
+void gs_blend_function(enum gs_blend_type, enum gs_blend_type) {}
@@ -0,0 +1,388 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+
+#include "FakeObs.h"
+
+// Outputs produce nothing, their statistics are derived from how long they have been active
+#define OUTPUT_BYTES_PER_SECOND 750000
+
+static std::recursive_mutex outputsMutex;
+static std::vector<obs_output_t *> outputs;
+
+obs_output_t *FakeObs::CreateOutput(const char *id, const char *name, uint32_t flags)
+{
+	auto output = new obs_output;
+	output->control = new obs_weak_output;
+	output->control->object = output;
+	output->id = id;
+	output->name = name;
+	output->flags = flags;
+	output->settings = obs_data_create();
+	output->signals = signal_handler_create();
+
+	std::lock_guard<std::recursive_mutex> lock(outputsMutex);
+	outputs.push_back(output);
+	return output;
+}
+
+bool FakeObs::OutputsActive()
+{
+	std::lock_guard<std::recursive_mutex> lock(outputsMutex);
+	return std::any_of(outputs.begin(), outputs.end(), [](obs_output_t *output) { return output->active.load(); });
+}
+
+static void EmitOutputSignal(obs_output_t *output, const char *signal, int code = -1)
+{
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "output", output);
+	if (code >= 0)
+		calldata_set_int(&cd, "code", code);
+	signal_handler_signal(output->signals, signal, &cd);
+}
+
+void FakeObs::SimulateStreamReconnect()
+{
+	obs_output_t *output = obs_frontend_get_streaming_output();
+	if (!output)
+		return;
+
+	if (output->active) {
+		output->reconnecting = true;
+		EmitOutputSignal(output, "reconnect");
+		output->reconnecting = false;
+		EmitOutputSignal(output, "reconnect_success");
+	}
+	obs_output_release(output);
+}
+
+static double GetActiveSeconds(const obs_output_t *output)
+{
+	if (!output->active)
+		return 0.0;
+	return (double)(os_gettime_ns() - output->startedAt) / 1000000000.0;
+}
+
+obs_output_t *obs_output_get_ref(obs_output_t *output)
+{
+	return output ? FakeObs::GetStrongRef(output->control) : nullptr;
+}
+
+void obs_output_release(obs_output_t *output)
+{
+	if (!output || !FakeObs::ReleaseStrongRef(output->control))
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(outputsMutex);
+		outputs.erase(std::remove(outputs.begin(), outputs.end(), output), outputs.end());
+	}
+
+	obs_data_release(output->settings);
+	signal_handler_destroy(output->signals);
+	FakeObs::ReleaseWeakRef(output->control);
+	delete output;
+}
+
+obs_output_t *obs_weak_output_get_output(obs_weak_output_t *weak)
+{
+	return FakeObs::GetStrongRef(weak);
+}
+
+void obs_weak_output_addref(obs_weak_output_t *weak)
+{
+	FakeObs::AddWeakRef(weak);
+}
+
+void obs_weak_output_release(obs_weak_output_t *weak)
+{
+	FakeObs::ReleaseWeakRef(weak);
+}
+
+obs_output_t *obs_get_output_by_name(const char *name)
+{
+	if (!name)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(outputsMutex);
+	for (obs_output_t *output : outputs) {
+		if (output->name == name)
+			return obs_output_get_ref(output);
+	}
+	return nullptr;
+}
+
+void obs_enum_outputs(bool (*enum_proc)(void *, obs_output_t *), void *param)
+{
+	std::vector<obs_output_t *> snapshot;
+	{
+		std::lock_guard<std::recursive_mutex> lock(outputsMutex);
+		for (obs_output_t *output : outputs) {
+			output = obs_output_get_ref(output);
+			if (output)
+				snapshot.push_back(output);
+		}
+	}
+
+	bool enumerating = true;
+	for (obs_output_t *output : snapshot) {
+		if (enumerating)
+			enumerating = enum_proc(param, output);
+		obs_output_release(output);
+	}
+}
+
+bool obs_output_start(obs_output_t *output)
+{
+	if (!output || output->active.exchange(true))
+		return false;
+
+	output->startedAt = os_gettime_ns();
+	EmitOutputSignal(output, "starting");
+	EmitOutputSignal(output, "start");
+	return true;
+}
+
+void obs_output_stop(obs_output_t *output)
+{
+	if (!output || !output->active)
+		return;
+
+	EmitOutputSignal(output, "stopping");
+	output->active = false;
+	output->paused = false;
+	EmitOutputSignal(output, "stop", OBS_OUTPUT_SUCCESS);
+}
+
+bool obs_output_pause(obs_output_t *output, bool pause)
+{
+	if (!output || !output->active || !(output->flags & OBS_OUTPUT_CAN_PAUSE))
+		return false;
+	if (output->paused.exchange(pause) == pause)
+		return true;
+
+	EmitOutputSignal(output, pause ? "pause" : "unpause");
+	return true;
+}
+
+bool obs_output_active(const obs_output_t *output)
+{
+	return output && output->active;
+}
+
+bool obs_output_paused(const obs_output_t *output)
+{
+	return output && output->paused;
+}
+
+bool obs_output_reconnecting(const obs_output_t *output)
+{
+	return output && output->reconnecting;
+}
+
+uint32_t obs_output_get_flags(const obs_output_t *output)
+{
+	return output ? output->flags : 0;
+}
+
+const char *obs_output_get_id(const obs_output_t *output)
+{
+	return output ? output->id.c_str() : nullptr;
+}
+
+const char *obs_output_get_name(const obs_output_t *output)
+{
+	return output ? output->name.c_str() : nullptr;
+}
+
+obs_data_t *obs_output_get_settings(const obs_output_t *output)
+{
+	if (!output)
+		return nullptr;
+
+	obs_data_addref(output->settings);
+	return output->settings;
+}
+
+void obs_output_update(obs_output_t *output, obs_data_t *settings)
+{
+	if (output)
+		obs_data_apply(output->settings, settings);
+}
+
+signal_handler_t *obs_output_get_signal_handler(const obs_output_t *output)
+{
+	return output ? output->signals : nullptr;
+}
+
+video_t *obs_output_video(const obs_output_t *output)
+{
+	return output && (output->flags & OBS_OUTPUT_VIDEO) ? obs_get_video() : nullptr;
+}
+
+uint32_t obs_output_get_width(const obs_output_t *output)
+{
+	uint32_t width, height;
+	FakeObs::GetBaseSize(width, height);
+	return output && (output->flags & OBS_OUTPUT_VIDEO) ? width : 0;
+}
+
+uint32_t obs_output_get_height(const obs_output_t *output)
+{
+	uint32_t width, height;
+	FakeObs::GetBaseSize(width, height);
+	return output && (output->flags & OBS_OUTPUT_VIDEO) ? height : 0;
+}
+
+float obs_output_get_congestion(obs_output_t *)
+{
+	return 0.0f;
+}
+
+int obs_output_get_frames_dropped(const obs_output_t *)
+{
+	return 0;
+}
+
+int obs_output_get_total_frames(const obs_output_t *output)
+{
+	if (!output)
+		return 0;
+	return (int)(GetActiveSeconds(output) * 1000000000.0 / FakeObs::GetVideoFrameIntervalNs());
+}
+
+uint64_t obs_output_get_total_bytes(const obs_output_t *output)
+{
+	if (!output || !(output->flags & OBS_OUTPUT_ENCODED))
+		return 0;
+	return (uint64_t)(GetActiveSeconds(output) * OUTPUT_BYTES_PER_SECOND);
+}
+
+bool obs_output_output_caption_text2(obs_output_t *output, const char *text, double)
+{
+	return output && output->active && text;
+}
+
+obs_service_t *obs_service_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *)
+{
+	if (!id || !name)
+		return nullptr;
+
+	auto service = new obs_service;
+	service->control = new obs_weak_service;
+	service->control->object = service;
+	service->id = id;
+	service->name = name;
+	service->settings = obs_data_create();
+	obs_data_apply(service->settings, settings);
+	return service;
+}
+
+obs_service_t *obs_service_get_ref(obs_service_t *service)
+{
+	return service ? FakeObs::GetStrongRef(service->control) : nullptr;
+}
+
+void obs_service_release(obs_service_t *service)
+{
+	if (!service || !FakeObs::ReleaseStrongRef(service->control))
+		return;
+
+	obs_data_release(service->settings);
+	FakeObs::ReleaseWeakRef(service->control);
+	delete service;
+}
+
+obs_service_t *obs_weak_service_get_service(obs_weak_service_t *weak)
+{
+	return FakeObs::GetStrongRef(weak);
+}
+
+void obs_weak_service_addref(obs_weak_service_t *weak)
+{
+	FakeObs::AddWeakRef(weak);
+}
+
+void obs_weak_service_release(obs_weak_service_t *weak)
+{
+	FakeObs::ReleaseWeakRef(weak);
+}
+
+const char *obs_service_get_name(const obs_service_t *service)
+{
+	return service ? service->name.c_str() : nullptr;
+}
+
+const char *obs_service_get_type(const obs_service_t *service)
+{
+	return service ? service->id.c_str() : nullptr;
+}
+
+obs_data_t *obs_service_get_settings(const obs_service_t *service)
+{
+	if (!service)
+		return nullptr;
+
+	obs_data_addref(service->settings);
+	return service->settings;
+}
+
+void obs_service_update(obs_service_t *service, obs_data_t *settings)
+{
+	if (service)
+		obs_data_apply(service->settings, settings);
+}
+
+// No encoders are ever created, these only back the `OBSEncoder` wrappers and hotkey registerer lookups
+obs_encoder_t *obs_encoder_get_ref(obs_encoder_t *encoder)
+{
+	return encoder ? FakeObs::GetStrongRef(encoder->control) : nullptr;
+}
+
+void obs_encoder_release(obs_encoder_t *encoder)
+{
+	if (!encoder || !FakeObs::ReleaseStrongRef(encoder->control))
+		return;
+
+	FakeObs::ReleaseWeakRef(encoder->control);
+	delete encoder;
+}
+
+obs_encoder_t *obs_weak_encoder_get_encoder(obs_weak_encoder_t *weak)
+{
+	return FakeObs::GetStrongRef(weak);
+}
+
+void obs_weak_encoder_addref(obs_weak_encoder_t *weak)
+{
+	FakeObs::AddWeakRef(weak);
+}
+
+void obs_weak_encoder_release(obs_weak_encoder_t *weak)
+{
+	FakeObs::ReleaseWeakRef(weak);
+}
+
+const char *obs_encoder_get_name(const obs_encoder_t *encoder)
+{
+	return encoder ? encoder->name.c_str() : nullptr;
+}
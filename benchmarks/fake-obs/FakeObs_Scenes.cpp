@@ -0,0 +1,406 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+
+#include "FakeObs.h"
+
+static void EmitItemSignal(obs_sceneitem_t *item, const char *signal, const char *boolName = nullptr, bool boolValue = false)
+{
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "scene", item->parent);
+	calldata_set_ptr(&cd, "item", item);
+	if (boolName)
+		calldata_set_bool(&cd, boolName, boolValue);
+	signal_handler_signal(item->parent->source->signals, signal, &cd);
+}
+
+static void EmitReorder(obs_scene_t *scene)
+{
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "scene", scene);
+	signal_handler_signal(scene->source->signals, "reorder", &cd);
+}
+
+// Returns referenced copies of the scene's items, bottom to top
+static std::vector<obs_sceneitem_t *> GetItemsSnapshot(obs_scene_t *scene)
+{
+	std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+	for (obs_sceneitem_t *item : scene->items)
+		obs_sceneitem_addref(item);
+	return scene->items;
+}
+
+static void ReleaseItems(std::vector<obs_sceneitem_t *> &items)
+{
+	for (obs_sceneitem_t *item : items)
+		obs_sceneitem_release(item);
+	items.clear();
+}
+
+obs_scene_t *FakeObs::CreateSceneData(obs_source_t *source, bool isGroup)
+{
+	auto scene = new obs_scene;
+	scene->source = source;
+	scene->isGroup = isGroup;
+	return scene;
+}
+
+void FakeObs::DestroySceneData(obs_scene_t *scene)
+{
+	std::vector<obs_sceneitem_t *> items;
+	{
+		std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+		items.swap(scene->items);
+	}
+
+	for (obs_sceneitem_t *item : items) {
+		item->removed = true;
+		obs_sceneitem_release(item);
+	}
+	delete scene;
+}
+
+void FakeObs::SetSceneItemsActive(obs_scene_t *scene, bool active)
+{
+	std::vector<obs_sceneitem_t *> items = GetItemsSnapshot(scene);
+	for (obs_sceneitem_t *item : items) {
+		if (item->visible)
+			SetSourceActive(item->source, active);
+	}
+	ReleaseItems(items);
+}
+
+// Removing a source removes every item which shows it, like libobs
+void FakeObs::RemoveItemsOfSource(obs_source_t *source)
+{
+	std::vector<obs_source_t *> sources = GetSourcesSnapshot();
+	for (obs_source_t *sceneSource : sources) {
+		if (!sceneSource->scene)
+			continue;
+
+		std::vector<obs_sceneitem_t *> items = GetItemsSnapshot(sceneSource->scene);
+		for (obs_sceneitem_t *item : items) {
+			if (item->source == source)
+				obs_sceneitem_remove(item);
+		}
+		ReleaseItems(items);
+	}
+	ReleaseSnapshot(sources);
+}
+
+obs_scene_t *obs_scene_create(const char *name)
+{
+	obs_source_t *source = FakeObs::CreateSource("scene", name, nullptr, false);
+	return source ? source->scene : nullptr;
+}
+
+obs_scene_t *obs_scene_get_ref(obs_scene_t *scene)
+{
+	return scene && obs_source_get_ref(scene->source) ? scene : nullptr;
+}
+
+void obs_scene_release(obs_scene_t *scene)
+{
+	if (scene)
+		obs_source_release(scene->source);
+}
+
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene)
+{
+	return scene ? scene->source : nullptr;
+}
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+	if (!source || !source->scene || source->scene->isGroup)
+		return nullptr;
+	return source->scene;
+}
+
+obs_scene_t *obs_group_from_source(const obs_source_t *source)
+{
+	if (!source || !source->scene || !source->scene->isGroup)
+		return nullptr;
+	return source->scene;
+}
+
+obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene, int64_t id)
+{
+	if (!scene)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+	for (obs_sceneitem_t *item : scene->items) {
+		if (item->id == id)
+			return item;
+	}
+	return nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t *scene, bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *), void *param)
+{
+	if (!scene || !callback)
+		return;
+
+	std::vector<obs_sceneitem_t *> items = GetItemsSnapshot(scene);
+	for (obs_sceneitem_t *item : items) {
+		if (!item->removed && !callback(scene, item, param))
+			break;
+	}
+	ReleaseItems(items);
+}
+
+void obs_scene_atomic_update(obs_scene_t *scene, obs_scene_atomic_update_func func, void *data)
+{
+	if (!scene || !func)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+	func(data, scene);
+}
+
+// The returned item is owned by the scene, no reference is added for the caller
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source)
+{
+	if (!scene || !source || source == scene->source)
+		return nullptr;
+
+	source = obs_source_get_ref(source);
+	if (!source)
+		return nullptr;
+
+	auto item = new obs_scene_item;
+	item->parent = scene;
+	item->source = source;
+	item->privateSettings = obs_data_create();
+	item->info = {};
+	vec2_set(&item->info.scale, 1.0f, 1.0f);
+	item->info.alignment = OBS_ALIGN_TOP | OBS_ALIGN_LEFT;
+	item->info.bounds_type = OBS_BOUNDS_NONE;
+	item->info.bounds_alignment = OBS_ALIGN_CENTER;
+	item->crop = {};
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+		item->id = ++scene->lastId;
+		scene->items.push_back(item);
+	}
+
+	if (obs_source_active(scene->source))
+		FakeObs::SetSourceActive(source, true);
+
+	EmitItemSignal(item, "item_add");
+	return item;
+}
+
+void obs_sceneitem_addref(obs_sceneitem_t *item)
+{
+	if (item)
+		item->refs.fetch_add(1);
+}
+
+void obs_sceneitem_release(obs_sceneitem_t *item)
+{
+	if (!item || item->refs.fetch_sub(1) != 1)
+		return;
+
+	obs_data_release(item->privateSettings);
+	obs_source_release(item->source);
+	delete item;
+}
+
+void obs_sceneitem_remove(obs_sceneitem_t *item)
+{
+	if (!item || item->removed.exchange(true))
+		return;
+
+	obs_scene_t *scene = item->parent;
+	{
+		std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+		auto it = std::find(scene->items.begin(), scene->items.end(), item);
+		if (it == scene->items.end())
+			return;
+		scene->items.erase(it);
+	}
+
+	if (obs_source_active(scene->source) && item->visible)
+		FakeObs::SetSourceActive(item->source, false);
+
+	EmitItemSignal(item, "item_remove");
+	obs_sceneitem_release(item);
+}
+
+obs_scene_t *obs_sceneitem_get_scene(const obs_sceneitem_t *item)
+{
+	return item ? item->parent : nullptr;
+}
+
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+	return item ? item->source : nullptr;
+}
+
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item)
+{
+	return item ? item->id : 0;
+}
+
+bool obs_sceneitem_is_group(obs_sceneitem_t *item)
+{
+	return item && obs_source_is_group(item->source);
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t *item)
+{
+	return item && item->visible;
+}
+
+bool obs_sceneitem_set_visible(obs_sceneitem_t *item, bool visible)
+{
+	if (!item)
+		return false;
+	if (item->visible.exchange(visible) == visible)
+		return false;
+
+	if (obs_source_active(item->parent->source))
+		FakeObs::SetSourceActive(item->source, visible);
+
+	EmitItemSignal(item, "item_visible", "visible", visible);
+	return true;
+}
+
+bool obs_sceneitem_locked(const obs_sceneitem_t *item)
+{
+	return item && item->locked;
+}
+
+bool obs_sceneitem_set_locked(obs_sceneitem_t *item, bool lock)
+{
+	if (!item)
+		return false;
+	if (item->locked.exchange(lock) == lock)
+		return false;
+
+	EmitItemSignal(item, "item_locked", "locked", lock);
+	return true;
+}
+
+int obs_sceneitem_get_order_position(obs_sceneitem_t *item)
+{
+	if (!item)
+		return -1;
+
+	obs_scene_t *scene = item->parent;
+	std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+	auto it = std::find(scene->items.begin(), scene->items.end(), item);
+	return it == scene->items.end() ? -1 : (int)(it - scene->items.begin());
+}
+
+void obs_sceneitem_set_order_position(obs_sceneitem_t *item, int position)
+{
+	if (!item)
+		return;
+
+	obs_scene_t *scene = item->parent;
+	{
+		std::lock_guard<std::recursive_mutex> lock(scene->mutex);
+		auto &items = scene->items;
+		auto it = std::find(items.begin(), items.end(), item);
+		if (it == items.end())
+			return;
+
+		int newPosition = std::clamp(position, 0, (int)items.size() - 1);
+		if (newPosition == it - items.begin())
+			return;
+
+		items.erase(it);
+		items.insert(items.begin() + newPosition, item);
+	}
+
+	EmitReorder(scene);
+}
+
+void obs_sceneitem_get_info2(const obs_sceneitem_t *item, struct obs_transform_info *info)
+{
+	if (!item || !info)
+		return;
+
+	std::lock_guard<std::mutex> lock(const_cast<obs_sceneitem_t *>(item)->transformMutex);
+	*info = item->info;
+}
+
+void obs_sceneitem_set_info2(obs_sceneitem_t *item, const struct obs_transform_info *info)
+{
+	if (!item || !info)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(item->transformMutex);
+		item->info = *info;
+	}
+
+	EmitItemSignal(item, "item_transform");
+}
+
+void obs_sceneitem_get_crop(const obs_sceneitem_t *item, struct obs_sceneitem_crop *crop)
+{
+	if (!item || !crop)
+		return;
+
+	std::lock_guard<std::mutex> lock(const_cast<obs_sceneitem_t *>(item)->transformMutex);
+	*crop = item->crop;
+}
+
+void obs_sceneitem_set_crop(obs_sceneitem_t *item, const struct obs_sceneitem_crop *crop)
+{
+	if (!item || !crop)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(item->transformMutex);
+		item->crop = *crop;
+	}
+
+	EmitItemSignal(item, "item_transform");
+}
+
+enum obs_blending_type obs_sceneitem_get_blending_mode(obs_sceneitem_t *item)
+{
+	return item ? (enum obs_blending_type)item->blendingMode.load() : OBS_BLEND_NORMAL;
+}
+
+void obs_sceneitem_set_blending_mode(obs_sceneitem_t *item, enum obs_blending_type type)
+{
+	if (item)
+		item->blendingMode = type;
+}
+
+obs_data_t *obs_sceneitem_get_private_settings(obs_sceneitem_t *item)
+{
+	if (!item)
+		return nullptr;
+
+	obs_data_addref(item->privateSettings);
+	return item->privateSettings;
+}
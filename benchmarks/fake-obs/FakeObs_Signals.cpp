@@ -0,0 +1,298 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <util/bmem.h>
+
+#include "FakeObs.h"
+
+#define CALLDATA_GROWTH 128
+
+/*
+ * The calldata stack uses the same layout as libobs, since the inline accessors in calldata.h are compiled into the
+ * plugin and only `calldata_get_data()`, `calldata_set_data()` and `calldata_get_string()` come from here:
+ *   [size_t name_size][char[] name][size_t data_size][uint8_t[] data] ... [size_t 0]
+ */
+
+static bool FindParam(const calldata_t *data, const char *name, uint8_t **pos)
+{
+	if (!data->stack || !data->size)
+		return false;
+
+	size_t nameSize = strlen(name) + 1;
+	uint8_t *cur = data->stack;
+	for (;;) {
+		size_t curNameSize;
+		memcpy(&curNameSize, cur, sizeof(size_t));
+		if (!curNameSize)
+			return false;
+
+		const char *curName = (const char *)(cur + sizeof(size_t));
+		uint8_t *dataPos = cur + sizeof(size_t) + curNameSize;
+		if (curNameSize == nameSize && memcmp(curName, name, nameSize) == 0) {
+			*pos = dataPos;
+			return true;
+		}
+
+		size_t curDataSize;
+		memcpy(&curDataSize, dataPos, sizeof(size_t));
+		cur = dataPos + sizeof(size_t) + curDataSize;
+	}
+}
+
+static bool EnsureCapacity(calldata_t *data, size_t size)
+{
+	if (size <= data->capacity)
+		return true;
+
+	if (data->fixed) {
+		blog(LOG_ERROR, "[FakeObs::calldata] Fixed calldata stack of %zu bytes is too small", data->capacity);
+		return false;
+	}
+
+	size_t capacity = std::max(size, data->capacity + CALLDATA_GROWTH);
+	data->stack = (uint8_t *)brealloc(data->stack, capacity);
+	data->capacity = capacity;
+	return true;
+}
+
+bool calldata_get_data(const calldata_t *data, const char *name, void *out, size_t size)
+{
+	uint8_t *pos;
+	if (!data || !name || !FindParam(data, name, &pos))
+		return false;
+
+	size_t dataSize;
+	memcpy(&dataSize, pos, sizeof(size_t));
+	if (dataSize != size)
+		return false;
+
+	memcpy(out, pos + sizeof(size_t), size);
+	return true;
+}
+
+bool calldata_get_string(const calldata_t *data, const char *name, const char **str)
+{
+	uint8_t *pos;
+	if (!data || !name || !FindParam(data, name, &pos))
+		return false;
+
+	size_t dataSize;
+	memcpy(&dataSize, pos, sizeof(size_t));
+	*str = dataSize ? (const char *)(pos + sizeof(size_t)) : nullptr;
+	return true;
+}
+
+void calldata_set_data(calldata_t *data, const char *name, const void *in, size_t new_size)
+{
+	if (!data || !name || !*name)
+		return;
+
+	uint8_t *pos;
+	if (FindParam(data, name, &pos)) {
+		size_t oldSize;
+		memcpy(&oldSize, pos, sizeof(size_t));
+
+		if (oldSize != new_size) {
+			size_t offset = pos - data->stack;
+			size_t tailOffset = offset + sizeof(size_t) + oldSize;
+			size_t tailSize = data->size - tailOffset;
+			size_t newStackSize = data->size - oldSize + new_size;
+			if (!EnsureCapacity(data, newStackSize))
+				return;
+
+			pos = data->stack + offset;
+			memmove(pos + sizeof(size_t) + new_size, data->stack + tailOffset, tailSize);
+			data->size = newStackSize;
+		}
+
+		memcpy(pos, &new_size, sizeof(size_t));
+		if (new_size)
+			memcpy(pos + sizeof(size_t), in, new_size);
+		return;
+	}
+
+	size_t nameSize = strlen(name) + 1;
+	size_t endSize = data->size ? data->size : sizeof(size_t);
+	size_t newStackSize = endSize + sizeof(size_t) + nameSize + sizeof(size_t) + new_size;
+	if (!EnsureCapacity(data, newStackSize))
+		return;
+
+	// Overwrite the terminating zero, then write a new one after the parameter
+	uint8_t *cur = data->stack + endSize - sizeof(size_t);
+	memcpy(cur, &nameSize, sizeof(size_t));
+	cur += sizeof(size_t);
+	memcpy(cur, name, nameSize);
+	cur += nameSize;
+	memcpy(cur, &new_size, sizeof(size_t));
+	cur += sizeof(size_t);
+	if (new_size)
+		memcpy(cur, in, new_size);
+	cur += new_size;
+
+	size_t terminator = 0;
+	memcpy(cur, &terminator, sizeof(size_t));
+	data->size = newStackSize;
+}
+
+signal_handler_t *signal_handler_create(void)
+{
+	return new signal_handler;
+}
+
+void signal_handler_destroy(signal_handler_t *handler)
+{
+	if (handler && handler->refs.fetch_sub(1) == 1)
+		delete handler;
+}
+
+bool signal_handler_add(signal_handler_t *handler, const char *signal_decl)
+{
+	// Any signal can be connected to, so declarations only need to parse
+	return handler && signal_decl;
+}
+
+static void Connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data, bool keepRef)
+{
+	if (!handler || !signal || !callback)
+		return;
+
+	if (keepRef)
+		handler->refs.fetch_add(1);
+
+	std::lock_guard<std::recursive_mutex> lock(handler->mutex);
+	handler->signals[signal].push_back({callback, data, false, keepRef});
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+	Connect(handler, signal, callback, data, false);
+}
+
+// Used by `OBSSignal`, the connection keeps the handler alive until it is disconnected
+void signal_handler_connect_ref(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+	Connect(handler, signal, callback, data, true);
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+	if (!handler || !signal || !callback)
+		return;
+
+	bool keepRef = false;
+	{
+		// Blocks until any in-flight emission on another thread has finished, like libobs
+		std::lock_guard<std::recursive_mutex> lock(handler->mutex);
+		auto it = handler->signals.find(signal);
+		if (it == handler->signals.end())
+			return;
+
+		auto &callbacks = it->second;
+		for (size_t i = 0; i < callbacks.size(); i++) {
+			if (callbacks[i].callback != callback || callbacks[i].data != data || callbacks[i].remove)
+				continue;
+
+			keepRef = callbacks[i].keepRef;
+			if (handler->signalling)
+				callbacks[i].remove = true;
+			else
+				callbacks.erase(callbacks.begin() + i);
+			break;
+		}
+	}
+
+	if (keepRef)
+		signal_handler_destroy(handler);
+}
+
+void signal_handler_signal(signal_handler_t *handler, const char *signal, calldata_t *params)
+{
+	if (!handler || !signal)
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(handler->mutex);
+	auto it = handler->signals.find(signal);
+	if (it == handler->signals.end())
+		return;
+
+	// Element references survive rehashing, iterators do not, and callbacks may connect other signals
+	auto &callbacks = it->second;
+	handler->signalling++;
+	for (size_t i = 0; i < callbacks.size(); i++) {
+		auto callback = callbacks[i];
+		if (!callback.remove)
+			callback.callback(callback.data, params);
+	}
+	handler->signalling--;
+
+	if (!handler->signalling)
+		callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [](auto &cb) { return cb.remove; }),
+				callbacks.end());
+}
+
+proc_handler_t *proc_handler_create(void)
+{
+	return new proc_handler;
+}
+
+void proc_handler_destroy(proc_handler_t *handler)
+{
+	delete handler;
+}
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string, proc_handler_proc_t proc, void *data)
+{
+	if (!handler || !decl_string || !proc)
+		return;
+
+	// `void name(in ptr param, out ptr ret)`, the name is the identifier right before the parameter list
+	std::string decl = decl_string;
+	size_t end = decl.find('(');
+	if (end == std::string::npos) {
+		blog(LOG_ERROR, "[FakeObs::proc_handler_add] Invalid declaration: %s", decl_string);
+		return;
+	}
+	while (end > 0 && decl[end - 1] == ' ')
+		end--;
+	size_t start = decl.find_last_of(' ', end - 1);
+	start = start == std::string::npos ? 0 : start + 1;
+
+	std::lock_guard<std::mutex> lock(handler->mutex);
+	handler->procs[decl.substr(start, end - start)] = {proc, data};
+}
+
+bool proc_handler_call(proc_handler_t *handler, const char *name, calldata_t *params)
+{
+	if (!handler || !name)
+		return false;
+
+	std::pair<proc_handler_proc_t, void *> proc;
+	{
+		std::lock_guard<std::mutex> lock(handler->mutex);
+		auto it = handler->procs.find(name);
+		if (it == handler->procs.end())
+			return false;
+		proc = it->second;
+	}
+
+	proc.first(proc.second, params);
+	return true;
+}
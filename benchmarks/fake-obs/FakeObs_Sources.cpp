@@ -0,0 +1,1200 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+#include "FakeObs.h"
+
+#define MEDIA_DURATION_MS 60000
+#define AUDIO_AMPLITUDE 0.25
+#define AUDIO_CHANNELS 2
+#define AUDIO_TWO_PI 6.283185307179586
+
+// Source kinds mirror common OBS kinds, so scenarios written against a real OBS instance work unchanged
+static void ColorSourceDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultInt(settings, "color", 0xFFD1D1D1);
+	FakeObs::SetDefaultInt(settings, "width", 1920);
+	FakeObs::SetDefaultInt(settings, "height", 1080);
+}
+
+static void TextSourceDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultString(settings, "text", "");
+	FakeObs::SetDefaultInt(settings, "color1", 0xFFFFFFFF);
+	FakeObs::SetDefaultInt(settings, "color2", 0xFFFFFFFF);
+	FakeObs::SetDefaultBool(settings, "outline", false);
+}
+
+static void ImageSourceDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultString(settings, "file", "");
+	FakeObs::SetDefaultBool(settings, "unload", false);
+}
+
+static void MediaSourceDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultString(settings, "local_file", "");
+	FakeObs::SetDefaultBool(settings, "is_local_file", true);
+	FakeObs::SetDefaultBool(settings, "looping", false);
+	FakeObs::SetDefaultBool(settings, "restart_on_activate", true);
+	FakeObs::SetDefaultInt(settings, "speed_percent", 100);
+}
+
+static void AudioCaptureDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultString(settings, "device_id", "default");
+}
+
+static void ColorFilterDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultDouble(settings, "opacity", 1.0);
+	FakeObs::SetDefaultDouble(settings, "brightness", 0.0);
+	FakeObs::SetDefaultDouble(settings, "contrast", 0.0);
+	FakeObs::SetDefaultDouble(settings, "saturation", 0.0);
+}
+
+static void GainFilterDefaults(obs_data_t *settings)
+{
+	FakeObs::SetDefaultDouble(settings, "db", 0.0);
+}
+
+static void FadeTransitionDefaults(obs_data_t *) {}
+
+static void TextSourceProperties(obs_properties_t *props)
+{
+	FakeObs::AddTextProperty(props, "text");
+}
+
+static void MediaSourceProperties(obs_properties_t *props)
+{
+	FakeObs::AddTextProperty(props, "local_file");
+	FakeObs::AddListProperty(props, "speed_percent", OBS_COMBO_FORMAT_INT, {{"50%", "50"}, {"100%", "100"}, {"200%", "200"}});
+}
+
+static void AudioCaptureProperties(obs_properties_t *props)
+{
+	FakeObs::AddListProperty(props, "device_id", OBS_COMBO_FORMAT_STRING,
+				 {{"Default", "default"}, {"Synthetic Sine", "synthetic_sine"}, {"Silence", "silence"}});
+	FakeObs::AddButtonProperty(props, "refresh_devices");
+}
+
+static void ImageSourceProperties(obs_properties_t *props)
+{
+	FakeObs::AddTextProperty(props, "file");
+	FakeObs::AddButtonProperty(props, "reload");
+}
+
+static const std::vector<FakeObs::TypeInfo> sourceTypes = {
+	{"color_source_v3", "color_source", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW, ColorSourceDefaults,
+	 nullptr},
+	{"text_ft2_source_v2", "text_ft2_source", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO, TextSourceDefaults,
+	 TextSourceProperties},
+	{"image_source", "image_source", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_VIDEO, ImageSourceDefaults, ImageSourceProperties},
+	{"ffmpeg_source", "ffmpeg_source", OBS_SOURCE_TYPE_INPUT,
+	 OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_AUDIO | OBS_SOURCE_CONTROLLABLE_MEDIA, MediaSourceDefaults, MediaSourceProperties},
+	{"pulse_input_capture", "pulse_input_capture", OBS_SOURCE_TYPE_INPUT, OBS_SOURCE_AUDIO | OBS_SOURCE_DO_NOT_DUPLICATE,
+	 AudioCaptureDefaults, AudioCaptureProperties},
+	{"pulse_output_capture", "pulse_output_capture", OBS_SOURCE_TYPE_INPUT,
+	 OBS_SOURCE_AUDIO | OBS_SOURCE_DO_NOT_DUPLICATE | OBS_SOURCE_DO_NOT_SELF_MONITOR, AudioCaptureDefaults,
+	 AudioCaptureProperties},
+	{"color_filter_v2", "color_filter", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_VIDEO, ColorFilterDefaults, nullptr},
+	{"gain_filter", "gain_filter", OBS_SOURCE_TYPE_FILTER, OBS_SOURCE_AUDIO, GainFilterDefaults, nullptr},
+	{"cut_transition", "cut_transition", OBS_SOURCE_TYPE_TRANSITION, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW,
+	 FadeTransitionDefaults, nullptr},
+	{"fade_transition", "fade_transition", OBS_SOURCE_TYPE_TRANSITION, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW,
+	 FadeTransitionDefaults, nullptr},
+	{"scene", "scene", OBS_SOURCE_TYPE_SCENE, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_COMPOSITE, nullptr,
+	 nullptr},
+	{"group", "group", OBS_SOURCE_TYPE_SCENE, OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_COMPOSITE, nullptr,
+	 nullptr},
+};
+
+// Public sources, in creation order. The registry does not hold references, sources leave it when removed or destroyed
+static std::recursive_mutex registryMutex;
+static std::vector<obs_source_t *> registry;
+static std::unordered_map<std::string, obs_source_t *> registryByName;
+static std::unordered_map<std::string, obs_source_t *> registryByUuid;
+
+static std::mutex channelMutex;
+static obs_source_t *channels[MAX_CHANNELS] = {};
+
+const FakeObs::TypeInfo *FakeObs::FindType(const char *id)
+{
+	if (!id)
+		return nullptr;
+
+	for (auto &type : sourceTypes) {
+		if (type.id == id)
+			return &type;
+	}
+	return nullptr;
+}
+
+const std::vector<FakeObs::TypeInfo> &FakeObs::GetTypes()
+{
+	return sourceTypes;
+}
+
+std::string FakeObs::GenerateUuid()
+{
+	static std::mutex mutex;
+	static std::mt19937_64 rng{std::random_device{}()};
+
+	uint64_t high, low;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		high = rng();
+		low = rng();
+	}
+
+	// Version 4, variant 1
+	high = (high & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+	low = (low & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+
+	char ret[37];
+	snprintf(ret, sizeof(ret), "%08x-%04x-%04x-%04x-%012llx", (uint32_t)(high >> 32), (uint32_t)(high >> 16) & 0xFFFF,
+		 (uint32_t)high & 0xFFFF, (uint32_t)(low >> 48), (unsigned long long)(low & 0xFFFFFFFFFFFFULL));
+	return ret;
+}
+
+void FakeObs::EmitSourceSignal(obs_source_t *source, const char *signal, const char *coreSignal)
+{
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+
+	if (signal)
+		signal_handler_signal(source->signals, signal, &cd);
+	if (coreSignal)
+		signal_handler_signal(obs_get_signal_handler(), coreSignal, &cd);
+}
+
+static void RegisterSource(obs_source_t *source)
+{
+	std::lock_guard<std::recursive_mutex> lock(registryMutex);
+	registry.push_back(source);
+	registryByName[source->name] = source;
+	registryByUuid[source->uuid] = source;
+}
+
+static void UnregisterSource(obs_source_t *source)
+{
+	std::lock_guard<std::recursive_mutex> lock(registryMutex);
+	auto it = std::find(registry.begin(), registry.end(), source);
+	if (it == registry.end())
+		return;
+
+	registry.erase(it);
+	auto nameIt = registryByName.find(source->name);
+	if (nameIt != registryByName.end() && nameIt->second == source)
+		registryByName.erase(nameIt);
+	registryByUuid.erase(source->uuid);
+}
+
+obs_source_t *FakeObs::CreateSource(const char *id, const char *name, obs_data_t *settings, bool isPrivate)
+{
+	const TypeInfo *info = FindType(id);
+	if (!info) {
+		blog(LOG_ERROR, "[FakeObs::CreateSource] Source ID '%s' not found", id ? id : "(null)");
+		return nullptr;
+	}
+
+	auto source = new obs_source;
+	source->control = new obs_weak_source;
+	source->control->object = source;
+	source->info = info;
+	source->name = name ? name : "";
+	source->uuid = GenerateUuid();
+	source->isPrivate = isPrivate;
+	source->settings = obs_data_create();
+	if (info->defaults)
+		info->defaults(source->settings);
+	obs_data_apply(source->settings, settings);
+	source->privateSettings = obs_data_create();
+	source->signals = signal_handler_create();
+	source->audioFrequency = 220.0 + (double)(std::hash<std::string>{}(source->uuid) % 660);
+
+	if (info->outputFlags & OBS_SOURCE_CONTROLLABLE_MEDIA) {
+		source->mediaDuration = MEDIA_DURATION_MS;
+		source->mediaChangedAt = os_gettime_ns();
+	}
+
+	if (info->type == OBS_SOURCE_TYPE_SCENE)
+		source->scene = CreateSceneData(source, info->id == "group");
+
+	if (!isPrivate) {
+		RegisterSource(source);
+		EmitSourceSignal(source, nullptr, "source_create");
+	}
+
+	blog(LOG_DEBUG, "[FakeObs::CreateSource] Created source '%s' of kind '%s'", source->name.c_str(), id);
+	return source;
+}
+
+void FakeObs::DestroySource(obs_source_t *source)
+{
+	if (!source->isPrivate)
+		EmitSourceSignal(source, "destroy", "source_destroy");
+	UnregisterSource(source);
+
+	if (source->scene)
+		DestroySceneData(source->scene);
+
+	std::vector<obs_source_t *> filters;
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		filters.swap(source->filters);
+	}
+	for (obs_source_t *filter : filters) {
+		filter->filterParent = nullptr;
+		obs_source_release(filter);
+	}
+
+	obs_data_release(source->settings);
+	obs_data_release(source->privateSettings);
+	signal_handler_destroy(source->signals);
+	ReleaseWeakRef(source->control);
+	delete source;
+}
+
+std::vector<obs_source_t *> FakeObs::GetSourcesSnapshot()
+{
+	std::vector<obs_source_t *> ret;
+
+	std::lock_guard<std::recursive_mutex> lock(registryMutex);
+	ret.reserve(registry.size());
+	for (obs_source_t *source : registry) {
+		source = obs_source_get_ref(source);
+		if (source)
+			ret.push_back(source);
+	}
+	return ret;
+}
+
+void FakeObs::ReleaseSnapshot(std::vector<obs_source_t *> &sources)
+{
+	for (obs_source_t *source : sources)
+		obs_source_release(source);
+	sources.clear();
+}
+
+void FakeObs::SetSourceActive(obs_source_t *source, bool active)
+{
+	if (active) {
+		if (source->activeRefs.fetch_add(1) != 0)
+			return;
+	} else {
+		if (source->activeRefs.fetch_sub(1) != 1)
+			return;
+	}
+
+	if (source->scene)
+		SetSceneItemsActive(source->scene, active);
+
+	std::vector<obs_source_t *> filters;
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		filters = source->filters;
+	}
+	for (obs_source_t *filter : filters)
+		SetSourceActive(filter, active);
+
+	if (active)
+		EmitSourceSignal(source, "activate", "source_activate");
+	else
+		EmitSourceSignal(source, "deactivate", "source_deactivate");
+}
+
+void FakeObs::SetChannelSource(uint32_t channel, obs_source_t *source)
+{
+	if (channel >= MAX_CHANNELS)
+		return;
+
+	source = obs_source_get_ref(source);
+
+	obs_source_t *prev;
+	{
+		std::lock_guard<std::mutex> lock(channelMutex);
+		prev = channels[channel];
+		channels[channel] = source;
+	}
+
+	if (source)
+		SetSourceActive(source, true);
+	if (prev) {
+		SetSourceActive(prev, false);
+		obs_source_release(prev);
+	}
+}
+
+static int64_t GetMediaTime(obs_source_t *source, uint64_t now)
+{
+	if (source->mediaState != OBS_MEDIA_STATE_PLAYING)
+		return source->mediaTime;
+
+	int64_t time = source->mediaTime + (int64_t)((now - source->mediaChangedAt) / 1000000);
+	return std::min(time, source->mediaDuration);
+}
+
+static void SetMediaState(obs_source_t *source, enum obs_media_state state, int64_t time)
+{
+	std::lock_guard<std::mutex> lock(source->mediaMutex);
+	source->mediaState = state;
+	source->mediaTime = time;
+	source->mediaChangedAt = os_gettime_ns();
+}
+
+static bool IsMedia(const obs_source_t *source)
+{
+	return source && (source->info->outputFlags & OBS_SOURCE_CONTROLLABLE_MEDIA);
+}
+
+// Ends or loops media inputs which played to the end
+void FakeObs::TickSources(uint64_t now)
+{
+	std::vector<obs_source_t *> ended;
+	{
+		std::lock_guard<std::recursive_mutex> lock(registryMutex);
+		for (obs_source_t *source : registry) {
+			if (!IsMedia(source))
+				continue;
+
+			std::lock_guard<std::mutex> mediaLock(source->mediaMutex);
+			if (source->mediaState != OBS_MEDIA_STATE_PLAYING || GetMediaTime(source, now) < source->mediaDuration)
+				continue;
+
+			source = obs_source_get_ref(source);
+			if (source)
+				ended.push_back(source);
+		}
+	}
+
+	for (obs_source_t *source : ended) {
+		if (obs_data_get_bool(source->settings, "looping")) {
+			SetMediaState(source, OBS_MEDIA_STATE_PLAYING, 0);
+		} else {
+			SetMediaState(source, OBS_MEDIA_STATE_ENDED, source->mediaDuration);
+			EmitSourceSignal(source, "media_ended");
+		}
+		obs_source_release(source);
+	}
+}
+
+// Feeds a sine at a per-source frequency to every audio source which has capture callbacks. Only sources with
+// callbacks are generated, which keeps thousands of idle audio inputs cheap
+void FakeObs::GenerateAudio(uint64_t timestamp, uint32_t frames, uint32_t sampleRate)
+{
+	std::vector<obs_source_t *> sources = GetSourcesSnapshot();
+	std::vector<float> planes[AUDIO_CHANNELS];
+	for (auto &plane : planes)
+		plane.resize(frames);
+
+	for (obs_source_t *source : sources) {
+		if (!(source->info->outputFlags & OBS_SOURCE_AUDIO))
+			continue;
+
+		std::vector<std::pair<obs_source_audio_capture_t, void *>> callbacks;
+		{
+			std::lock_guard<std::mutex> lock(source->audioMutex);
+			callbacks = source->audioCallbacks;
+		}
+		if (callbacks.empty())
+			continue;
+
+		double step = AUDIO_TWO_PI * source->audioFrequency / sampleRate;
+		double phase = source->audioPhase;
+		for (uint32_t i = 0; i < frames; i++) {
+			float sample = (float)(AUDIO_AMPLITUDE * std::sin(phase));
+			for (auto &plane : planes)
+				plane[i] = sample;
+			phase += step;
+		}
+		source->audioPhase = std::fmod(phase, AUDIO_TWO_PI);
+
+		struct audio_data data = {};
+		for (size_t channel = 0; channel < AUDIO_CHANNELS; channel++)
+			data.data[channel] = (uint8_t *)planes[channel].data();
+		data.frames = frames;
+		data.timestamp = timestamp;
+
+		bool muted = source->muted;
+		for (auto &callback : callbacks)
+			callback.first(callback.second, source, &data, muted);
+	}
+
+	ReleaseSnapshot(sources);
+}
+
+obs_source_t *obs_source_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *)
+{
+	return FakeObs::CreateSource(id, name, settings, false);
+}
+
+obs_source_t *obs_source_create_private(const char *id, const char *name, obs_data_t *settings)
+{
+	return FakeObs::CreateSource(id, name, settings, true);
+}
+
+obs_source_t *obs_source_get_ref(obs_source_t *source)
+{
+	return source ? FakeObs::GetStrongRef(source->control) : nullptr;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+	if (!source)
+		return;
+
+	obs_weak_source_t *control = source->control;
+	if (FakeObs::ReleaseStrongRef(control))
+		FakeObs::DestroySource(source);
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+	return source ? FakeObs::AddWeakRef(source->control) : nullptr;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+	return FakeObs::GetStrongRef(weak);
+}
+
+void obs_weak_source_addref(obs_weak_source_t *weak)
+{
+	FakeObs::AddWeakRef(weak);
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+	FakeObs::ReleaseWeakRef(weak);
+}
+
+bool obs_weak_source_expired(obs_weak_source_t *weak)
+{
+	return !weak || weak->refs.load() == 0;
+}
+
+bool obs_weak_source_references_source(obs_weak_source_t *weak, obs_source_t *source)
+{
+	return weak && source && source->control == weak;
+}
+
+void obs_source_remove(obs_source_t *source)
+{
+	if (!source || source->removed.exchange(true))
+		return;
+
+	obs_source_t *ref = obs_source_get_ref(source);
+	if (!ref)
+		return;
+
+	UnregisterSource(source);
+	FakeObs::EmitSourceSignal(source, "remove", "source_remove");
+	FakeObs::RemoveItemsOfSource(source);
+
+	// Filters are removed from their parent with them
+	obs_source_t *parent = source->filterParent;
+	if (parent)
+		obs_source_filter_remove(parent, source);
+
+	obs_source_release(ref);
+}
+
+bool obs_source_removed(const obs_source_t *source)
+{
+	return !source || source->removed;
+}
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+	if (!name)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(registryMutex);
+	auto it = registryByName.find(name);
+	return it == registryByName.end() ? nullptr : obs_source_get_ref(it->second);
+}
+
+obs_source_t *obs_get_source_by_uuid(const char *uuid)
+{
+	if (!uuid)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(registryMutex);
+	auto it = registryByUuid.find(uuid);
+	return it == registryByUuid.end() ? nullptr : obs_source_get_ref(it->second);
+}
+
+obs_source_t *obs_get_output_source(uint32_t channel)
+{
+	if (channel >= MAX_CHANNELS)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(channelMutex);
+	return obs_source_get_ref(channels[channel]);
+}
+
+// Inputs and groups, like libobs
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	std::vector<obs_source_t *> sources = FakeObs::GetSourcesSnapshot();
+	for (obs_source_t *source : sources) {
+		bool isGroup = source->scene && source->scene->isGroup;
+		if (source->info->type != OBS_SOURCE_TYPE_INPUT && !isGroup)
+			continue;
+		if (!enum_proc(param, source))
+			break;
+	}
+	FakeObs::ReleaseSnapshot(sources);
+}
+
+// Scenes and groups, like libobs
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	std::vector<obs_source_t *> sources = FakeObs::GetSourcesSnapshot();
+	for (obs_source_t *source : sources) {
+		if (source->info->type != OBS_SOURCE_TYPE_SCENE)
+			continue;
+		if (!enum_proc(param, source))
+			break;
+	}
+	FakeObs::ReleaseSnapshot(sources);
+}
+
+static bool EnumTypes(enum obs_source_type type, size_t idx, const char **id, const char **unversioned_id)
+{
+	for (auto &info : sourceTypes) {
+		if (info.type != type || info.id == "group")
+			continue;
+		if (idx--)
+			continue;
+
+		if (id)
+			*id = info.id.c_str();
+		if (unversioned_id)
+			*unversioned_id = info.unversionedId.c_str();
+		return true;
+	}
+	return false;
+}
+
+bool obs_enum_input_types2(size_t idx, const char **id, const char **unversioned_id)
+{
+	return EnumTypes(OBS_SOURCE_TYPE_INPUT, idx, id, unversioned_id);
+}
+
+bool obs_enum_filter_types(size_t idx, const char **id)
+{
+	return EnumTypes(OBS_SOURCE_TYPE_FILTER, idx, id, nullptr);
+}
+
+bool obs_enum_transition_types(size_t idx, const char **id)
+{
+	return EnumTypes(OBS_SOURCE_TYPE_TRANSITION, idx, id, nullptr);
+}
+
+uint32_t obs_get_source_output_flags(const char *id)
+{
+	const FakeObs::TypeInfo *info = FakeObs::FindType(id);
+	return info ? info->outputFlags : 0;
+}
+
+obs_data_t *obs_get_source_defaults(const char *id)
+{
+	const FakeObs::TypeInfo *info = FakeObs::FindType(id);
+	if (!info)
+		return nullptr;
+
+	obs_data_t *settings = obs_data_create();
+	if (info->defaults)
+		info->defaults(settings);
+	return settings;
+}
+
+bool obs_source_configurable(const obs_source_t *source)
+{
+	return source && (source->info->defaults || source->info->properties);
+}
+
+obs_properties_t *obs_source_properties(const obs_source_t *source)
+{
+	if (!source)
+		return nullptr;
+
+	obs_properties_t *props = FakeObs::CreateProperties();
+	if (source->info->properties)
+		source->info->properties(props);
+	return props;
+}
+
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	if (!source || !settings)
+		return;
+
+	obs_data_apply(source->settings, settings);
+	FakeObs::EmitSourceSignal(source, "update");
+}
+
+void obs_source_reset_settings(obs_source_t *source, obs_data_t *settings)
+{
+	if (!source)
+		return;
+
+	FakeObs::ClearUserValues(source->settings);
+	obs_source_update(source, settings);
+}
+
+void obs_source_update_properties(obs_source_t *source)
+{
+	if (source)
+		FakeObs::EmitSourceSignal(source, "update_properties");
+}
+
+void obs_source_video_render(obs_source_t *) {}
+
+uint32_t obs_source_get_width(obs_source_t *source)
+{
+	if (!source || !(source->info->outputFlags & (OBS_SOURCE_VIDEO | OBS_SOURCE_ASYNC_VIDEO)))
+		return 0;
+
+	uint32_t width, height;
+	FakeObs::GetBaseSize(width, height);
+	if (source->info->id == "color_source_v3")
+		return (uint32_t)obs_data_get_int(source->settings, "width");
+	return width;
+}
+
+uint32_t obs_source_get_height(obs_source_t *source)
+{
+	if (!source || !(source->info->outputFlags & (OBS_SOURCE_VIDEO | OBS_SOURCE_ASYNC_VIDEO)))
+		return 0;
+
+	uint32_t width, height;
+	FakeObs::GetBaseSize(width, height);
+	if (source->info->id == "color_source_v3")
+		return (uint32_t)obs_data_get_int(source->settings, "height");
+	return height;
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	if (!source)
+		return nullptr;
+
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+obs_data_t *obs_source_get_private_settings(obs_source_t *source)
+{
+	if (!source)
+		return nullptr;
+
+	obs_data_addref(source->privateSettings);
+	return source->privateSettings;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->name.c_str() : nullptr;
+}
+
+void obs_source_set_name(obs_source_t *source, const char *name)
+{
+	if (!source || !name || source->name == name)
+		return;
+
+	std::string prevName = source->name;
+	{
+		std::lock_guard<std::recursive_mutex> lock(registryMutex);
+		bool registered = !source->isPrivate && !source->removed;
+		if (registered) {
+			auto it = registryByName.find(prevName);
+			if (it != registryByName.end() && it->second == source)
+				registryByName.erase(it);
+		}
+		source->name = name;
+		if (registered)
+			registryByName[source->name] = source;
+	}
+
+	calldata_t cd;
+	uint8_t stack[256];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_string(&cd, "new_name", source->name.c_str());
+	calldata_set_string(&cd, "prev_name", prevName.c_str());
+	signal_handler_signal(source->signals, "rename", &cd);
+	if (!source->isPrivate)
+		signal_handler_signal(obs_get_signal_handler(), "source_rename", &cd);
+}
+
+enum obs_source_type obs_source_get_type(const obs_source_t *source)
+{
+	return source ? source->info->type : OBS_SOURCE_TYPE_INPUT;
+}
+
+const char *obs_source_get_id(const obs_source_t *source)
+{
+	return source ? source->info->id.c_str() : nullptr;
+}
+
+const char *obs_source_get_unversioned_id(const obs_source_t *source)
+{
+	return source ? source->info->unversionedId.c_str() : nullptr;
+}
+
+const char *obs_source_get_uuid(const obs_source_t *source)
+{
+	return source ? source->uuid.c_str() : nullptr;
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+	return source ? source->signals : nullptr;
+}
+
+uint32_t obs_source_get_output_flags(const obs_source_t *source)
+{
+	return source ? source->info->outputFlags : 0;
+}
+
+bool obs_source_is_group(const obs_source_t *source)
+{
+	return source && source->scene && source->scene->isGroup;
+}
+
+bool obs_source_active(const obs_source_t *source)
+{
+	return source && source->activeRefs > 0;
+}
+
+bool obs_source_showing(const obs_source_t *source)
+{
+	return source && source->showingRefs > 0;
+}
+
+void obs_source_inc_showing(obs_source_t *source)
+{
+	if (source && source->showingRefs.fetch_add(1) == 0)
+		FakeObs::EmitSourceSignal(source, "show", "source_show");
+}
+
+void obs_source_dec_showing(obs_source_t *source)
+{
+	if (source && source->showingRefs.fetch_sub(1) == 1)
+		FakeObs::EmitSourceSignal(source, "hide", "source_hide");
+}
+
+bool obs_source_enabled(const obs_source_t *source)
+{
+	return source && source->enabled;
+}
+
+void obs_source_set_enabled(obs_source_t *source, bool enabled)
+{
+	if (!source)
+		return;
+
+	source->enabled = enabled;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_bool(&cd, "enabled", enabled);
+	signal_handler_signal(source->signals, "enable", &cd);
+}
+
+bool obs_source_muted(const obs_source_t *source)
+{
+	return source && source->muted;
+}
+
+void obs_source_set_muted(obs_source_t *source, bool muted)
+{
+	if (!source)
+		return;
+
+	source->muted = muted;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_bool(&cd, "muted", muted);
+	signal_handler_signal(source->signals, "mute", &cd);
+}
+
+float obs_source_get_volume(const obs_source_t *source)
+{
+	return source ? source->volume.load() : 0.0f;
+}
+
+void obs_source_set_volume(obs_source_t *source, float volume)
+{
+	if (!source)
+		return;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_float(&cd, "volume", volume);
+	signal_handler_signal(source->signals, "volume", &cd);
+	signal_handler_signal(obs_get_signal_handler(), "source_volume", &cd);
+
+	// Handlers may adjust the volume, like libobs
+	source->volume = (float)calldata_float(&cd, "volume");
+}
+
+float obs_source_get_balance_value(const obs_source_t *source)
+{
+	return source ? source->balance.load() : 0.5f;
+}
+
+void obs_source_set_balance_value(obs_source_t *source, float balance)
+{
+	if (!source)
+		return;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_float(&cd, "balance", balance);
+	signal_handler_signal(source->signals, "audio_balance", &cd);
+
+	source->balance = (float)calldata_float(&cd, "balance");
+}
+
+int64_t obs_source_get_sync_offset(const obs_source_t *source)
+{
+	return source ? source->syncOffset.load() : 0;
+}
+
+void obs_source_set_sync_offset(obs_source_t *source, int64_t offset)
+{
+	if (!source)
+		return;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_int(&cd, "offset", offset);
+	signal_handler_signal(source->signals, "audio_sync", &cd);
+
+	source->syncOffset = calldata_int(&cd, "offset");
+}
+
+uint32_t obs_source_get_audio_mixers(const obs_source_t *source)
+{
+	return source ? source->audioMixers.load() : 0;
+}
+
+void obs_source_set_audio_mixers(obs_source_t *source, uint32_t mixers)
+{
+	if (!source || !(source->info->outputFlags & OBS_SOURCE_AUDIO) || source->audioMixers == mixers)
+		return;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_int(&cd, "mixers", mixers);
+	signal_handler_signal(source->signals, "audio_mixers", &cd);
+
+	source->audioMixers = (uint32_t)calldata_int(&cd, "mixers");
+}
+
+enum obs_monitoring_type obs_source_get_monitoring_type(const obs_source_t *source)
+{
+	return source ? (enum obs_monitoring_type)source->monitoringType.load() : OBS_MONITORING_TYPE_NONE;
+}
+
+void obs_source_set_monitoring_type(obs_source_t *source, enum obs_monitoring_type type)
+{
+	if (!source || source->monitoringType == type)
+		return;
+
+	source->monitoringType = type;
+
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_int(&cd, "type", type);
+	signal_handler_signal(source->signals, "audio_monitoring", &cd);
+}
+
+enum obs_deinterlace_mode obs_source_get_deinterlace_mode(const obs_source_t *source)
+{
+	return source ? (enum obs_deinterlace_mode)source->deinterlaceMode.load() : OBS_DEINTERLACE_MODE_DISABLE;
+}
+
+void obs_source_set_deinterlace_mode(obs_source_t *source, enum obs_deinterlace_mode mode)
+{
+	if (source)
+		source->deinterlaceMode = mode;
+}
+
+enum obs_deinterlace_field_order obs_source_get_deinterlace_field_order(const obs_source_t *source)
+{
+	return source ? (enum obs_deinterlace_field_order)source->deinterlaceFieldOrder.load()
+		      : OBS_DEINTERLACE_FIELD_ORDER_TOP;
+}
+
+void obs_source_set_deinterlace_field_order(obs_source_t *source, enum obs_deinterlace_field_order field_order)
+{
+	if (source)
+		source->deinterlaceFieldOrder = field_order;
+}
+
+void obs_source_add_audio_capture_callback(obs_source_t *source, obs_source_audio_capture_t callback, void *param)
+{
+	if (!source || !callback)
+		return;
+
+	std::lock_guard<std::mutex> lock(source->audioMutex);
+	source->audioCallbacks.emplace_back(callback, param);
+}
+
+void obs_source_remove_audio_capture_callback(obs_source_t *source, obs_source_audio_capture_t callback, void *param)
+{
+	if (!source)
+		return;
+
+	std::lock_guard<std::mutex> lock(source->audioMutex);
+	auto &callbacks = source->audioCallbacks;
+	auto it = std::find(callbacks.begin(), callbacks.end(), std::make_pair(callback, param));
+	if (it != callbacks.end())
+		callbacks.erase(it);
+}
+
+void obs_source_enum_filters(obs_source_t *source, obs_source_enum_proc_t callback, void *param)
+{
+	if (!source || !callback)
+		return;
+
+	std::vector<obs_source_t *> filters;
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		for (obs_source_t *filter : source->filters)
+			filters.push_back(obs_source_get_ref(filter));
+	}
+
+	for (obs_source_t *filter : filters) {
+		callback(source, filter, param);
+		obs_source_release(filter);
+	}
+}
+
+obs_source_t *obs_source_get_filter_by_name(obs_source_t *source, const char *name)
+{
+	if (!source || !name)
+		return nullptr;
+
+	std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+	for (obs_source_t *filter : source->filters) {
+		if (filter->name == name)
+			return obs_source_get_ref(filter);
+	}
+	return nullptr;
+}
+
+obs_source_t *obs_filter_get_parent(const obs_source_t *filter)
+{
+	return filter ? filter->filterParent.load() : nullptr;
+}
+
+static void EmitFilterSignal(obs_source_t *source, obs_source_t *filter, const char *signal)
+{
+	calldata_t cd;
+	uint8_t stack[128];
+	calldata_init_fixed(&cd, stack, sizeof(stack));
+	calldata_set_ptr(&cd, "source", source);
+	calldata_set_ptr(&cd, "filter", filter);
+	signal_handler_signal(source->signals, signal, &cd);
+}
+
+void obs_source_filter_add(obs_source_t *source, obs_source_t *filter)
+{
+	if (!source || !filter || source == filter)
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		if (std::find(source->filters.begin(), source->filters.end(), filter) != source->filters.end())
+			return;
+
+		source->filters.push_back(obs_source_get_ref(filter));
+		filter->filterParent = source;
+	}
+
+	if (obs_source_active(source))
+		FakeObs::SetSourceActive(filter, true);
+
+	EmitFilterSignal(source, filter, "filter_add");
+}
+
+void obs_source_filter_remove(obs_source_t *source, obs_source_t *filter)
+{
+	if (!source || !filter)
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		auto it = std::find(source->filters.begin(), source->filters.end(), filter);
+		if (it == source->filters.end())
+			return;
+
+		source->filters.erase(it);
+	}
+
+	if (obs_source_active(source))
+		FakeObs::SetSourceActive(filter, false);
+
+	EmitFilterSignal(source, filter, "filter_remove");
+	filter->filterParent = nullptr;
+	obs_source_release(filter);
+}
+
+// Indices follow `obs_source_enum_filters()` order, "down" moves a filter towards the end
+void obs_source_filter_set_order(obs_source_t *source, obs_source_t *filter, enum obs_order_movement movement)
+{
+	if (!source || !filter)
+		return;
+
+	{
+		std::lock_guard<std::recursive_mutex> lock(source->filterMutex);
+		auto &filters = source->filters;
+		auto it = std::find(filters.begin(), filters.end(), filter);
+		if (it == filters.end())
+			return;
+
+		size_t idx = it - filters.begin();
+		size_t newIdx = idx;
+		switch (movement) {
+		case OBS_ORDER_MOVE_UP:
+			newIdx = idx ? idx - 1 : 0;
+			break;
+		case OBS_ORDER_MOVE_DOWN:
+			newIdx = std::min(idx + 1, filters.size() - 1);
+			break;
+		case OBS_ORDER_MOVE_TOP:
+			newIdx = 0;
+			break;
+		case OBS_ORDER_MOVE_BOTTOM:
+			newIdx = filters.size() - 1;
+			break;
+		}
+
+		if (newIdx == idx)
+			return;
+
+		filters.erase(filters.begin() + idx);
+		filters.insert(filters.begin() + newIdx, filter);
+	}
+
+	FakeObs::EmitSourceSignal(source, "reorder_filters");
+}
+
+void obs_source_media_play_pause(obs_source_t *source, bool pause)
+{
+	if (!IsMedia(source))
+		return;
+
+	SetMediaState(source, pause ? OBS_MEDIA_STATE_PAUSED : OBS_MEDIA_STATE_PLAYING,
+		      GetMediaTime(source, os_gettime_ns()));
+	FakeObs::EmitSourceSignal(source, pause ? "media_pause" : "media_play");
+}
+
+void obs_source_media_restart(obs_source_t *source)
+{
+	if (!IsMedia(source))
+		return;
+
+	SetMediaState(source, OBS_MEDIA_STATE_PLAYING, 0);
+	FakeObs::EmitSourceSignal(source, "media_restart");
+}
+
+void obs_source_media_stop(obs_source_t *source)
+{
+	if (!IsMedia(source))
+		return;
+
+	SetMediaState(source, OBS_MEDIA_STATE_STOPPED, 0);
+	FakeObs::EmitSourceSignal(source, "media_stopped");
+}
+
+void obs_source_media_next(obs_source_t *source)
+{
+	if (IsMedia(source))
+		FakeObs::EmitSourceSignal(source, "media_next");
+}
+
+void obs_source_media_previous(obs_source_t *source)
+{
+	if (IsMedia(source))
+		FakeObs::EmitSourceSignal(source, "media_previous");
+}
+
+int64_t obs_source_media_get_duration(obs_source_t *source)
+{
+	return IsMedia(source) ? source->mediaDuration : 0;
+}
+
+int64_t obs_source_media_get_time(obs_source_t *source)
+{
+	if (!IsMedia(source))
+		return 0;
+
+	std::lock_guard<std::mutex> lock(source->mediaMutex);
+	return GetMediaTime(source, os_gettime_ns());
+}
+
+void obs_source_media_set_time(obs_source_t *source, int64_t ms)
+{
+	if (!IsMedia(source))
+		return;
+
+	enum obs_media_state state;
+	{
+		std::lock_guard<std::mutex> lock(source->mediaMutex);
+		state = source->mediaState;
+	}
+	SetMediaState(source, state, std::clamp<int64_t>(ms, 0, source->mediaDuration));
+}
+
+enum obs_media_state obs_source_media_get_state(obs_source_t *source)
+{
+	if (!IsMedia(source))
+		return OBS_MEDIA_STATE_NONE;
+
+	std::lock_guard<std::mutex> lock(source->mediaMutex);
+	return source->mediaState;
+}
@@ -22,7 +22,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <obs.h>
 
-#define OBS_WEBSOCKET_API_VERSION 3
+#define OBS_WEBSOCKET_API_VERSION 4
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +31,8 @@ extern "C" {
 typedef void *obs_websocket_vendor;
 typedef void (*obs_websocket_request_callback_function)(obs_data_t *, obs_data_t *, void *);
 typedef void (*obs_websocket_event_callback_function)(uint64_t, const char *, const char *, void *);
+// uint64_t event_intent, const char *event_type, const uint8_t *event_data, size_t event_data_size, void *priv_data
+typedef void (*obs_websocket_event_callback_msgpack_function)(uint64_t, const char *, const uint8_t *, size_t, void *);
 
 struct obs_websocket_request_response {
 	unsigned int status_code;
@@ -38,6 +40,13 @@ struct obs_websocket_request_response {
 	char *response_data; // JSON string, because obs_data_t* only supports array<object>, so conversions would break API.
 };
 
+struct obs_websocket_request_response_msgpack {
+	unsigned int status_code;
+	char *comment;
+	uint8_t *response_data; // MsgPack map, or NULL if the request has no response data
+	size_t response_data_size;
+};
+
 /* ==================== INTERNAL DEFINITIONS ==================== */
 
 struct obs_websocket_request_callback {
@@ -50,6 +59,12 @@ struct obs_websocket_event_callback {
 	void *priv_data;
 };
 
+struct obs_websocket_event_callback_msgpack {
+	obs_websocket_event_callback_msgpack_function callback;
+	uint64_t event_subscriptions;
+	void *priv_data;
+};
+
 static proc_handler_t *_ph;
 
 /* ==================== INTERNAL API FUNCTIONS ==================== */
@@ -189,6 +204,86 @@ static inline bool obs_websocket_unregister_event_callback(obs_websocket_event_c
 	return ret;
 }
 
+// Calls an obs-websocket request, with the request data and response data encoded as MsgPack maps instead of JSON strings.
+// `request_data` may be NULL. Requires API version 4. Free response with `obs_websocket_request_response_msgpack_free()`
+static inline struct obs_websocket_request_response_msgpack *
+obs_websocket_call_request_msgpack(const char *request_type, const uint8_t *request_data, size_t request_data_size)
+{
+	if (!obs_websocket_ensure_ph())
+		return NULL;
+
+	calldata_t cd = {0, 0, 0, 0};
+	calldata_set_string(&cd, "request_type", request_type);
+	calldata_set_ptr(&cd, "request_data", (void *)request_data);
+	calldata_set_int(&cd, "request_data_size", (long long)request_data_size);
+
+	proc_handler_call(_ph, "call_request_msgpack", &cd);
+
+	struct obs_websocket_request_response_msgpack *ret =
+		(struct obs_websocket_request_response_msgpack *)calldata_ptr(&cd, "response");
+
+	calldata_free(&cd);
+
+	return ret;
+}
+
+// Free a request response object returned by `obs_websocket_call_request_msgpack()`
+static inline void obs_websocket_request_response_msgpack_free(struct obs_websocket_request_response_msgpack *response)
+{
+	if (!response)
+		return;
+
+	if (response->comment)
+		bfree(response->comment);
+	if (response->response_data)
+		bfree(response->response_data);
+	bfree(response);
+}
+
+// Register an event handler to receive obs-websocket events as MsgPack, only for the events matching `event_subscriptions`
+// (`EventSubscription` bit flags from the protocol documentation). The event data is encoded once for all MsgPack
+// callbacks, and is only valid for the duration of the callback. Requires API version 4.
+static inline bool obs_websocket_register_event_callback_msgpack(obs_websocket_event_callback_msgpack_function event_callback,
+								 uint64_t event_subscriptions, void *priv_data)
+{
+	if (!obs_websocket_ensure_ph())
+		return false;
+
+	struct obs_websocket_event_callback_msgpack cb = {event_callback, event_subscriptions, priv_data};
+
+	calldata_t cd = {0, 0, 0, 0};
+	calldata_set_ptr(&cd, "callback", &cb);
+
+	proc_handler_call(_ph, "register_event_callback_msgpack", &cd);
+
+	bool ret = calldata_bool(&cd, "success");
+
+	calldata_free(&cd);
+
+	return ret;
+}
+
+// Unregister an existing MsgPack event handler
+static inline bool obs_websocket_unregister_event_callback_msgpack(obs_websocket_event_callback_msgpack_function event_callback,
+								   void *priv_data)
+{
+	if (!obs_websocket_ensure_ph())
+		return false;
+
+	struct obs_websocket_event_callback_msgpack cb = {event_callback, 0, priv_data};
+
+	calldata_t cd = {0, 0, 0, 0};
+	calldata_set_ptr(&cd, "callback", &cb);
+
+	proc_handler_call(_ph, "unregister_event_callback_msgpack", &cd);
+
+	bool ret = calldata_bool(&cd, "success");
+
+	calldata_free(&cd);
+
+	return ret;
+}
+
 /* ==================== VENDOR API FUNCTIONS ==================== */
 
 // ALWAYS CALL ONLY VIA `obs_module_post_load()` CALLBACK!
@@ -41,11 +41,21 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #define PARAM_ALERTS "alerts_enabled"
 #define PARAM_AUTHREQUIRED "auth_required"
 #define PARAM_PASSWORD "server_password"
+#define PARAM_METRICS "metrics_enabled"
+#define PARAM_SERIAL_FRAME_BUDGET "serial_frame_budget_us"
+#define PARAM_SESSION_RATE_LIMIT "session_rate_limit"
+#define PARAM_CONTROL_RATE_LIMIT "control_rate_limit"
+#define PARAM_QUERY_RATE_LIMIT "query_rate_limit"
+#define PARAM_BULK_RATE_LIMIT "bulk_rate_limit"
+#define PARAM_SESSION_MAX_QUEUED_MESSAGES "session_max_queued_messages"
+#define PARAM_ADMISSION_QUEUE_WAIT "admission_queue_wait_ms"
 
 #define CMDLINE_WEBSOCKET_PORT "websocket_port"
 #define CMDLINE_WEBSOCKET_IPV4_ONLY "websocket_ipv4_only"
 #define CMDLINE_WEBSOCKET_PASSWORD "websocket_password"
 #define CMDLINE_WEBSOCKET_DEBUG "websocket_debug"
+#define CMDLINE_WEBSOCKET_METRICS "websocket_metrics"
+#define CMDLINE_WEBSOCKET_TRACE "websocket_trace"
 
 void Config::Load(json config)
 {
@@ -72,6 +82,22 @@ void Config::Load(json config)
 		AuthRequired = config[PARAM_AUTHREQUIRED];
 	if (config.contains(PARAM_PASSWORD) && config[PARAM_PASSWORD].is_string())
 		ServerPassword = config[PARAM_PASSWORD];
+	if (config.contains(PARAM_METRICS) && config[PARAM_METRICS].is_boolean())
+		MetricsEnabled = config[PARAM_METRICS];
+	if (config.contains(PARAM_SERIAL_FRAME_BUDGET) && config[PARAM_SERIAL_FRAME_BUDGET].is_number_unsigned())
+		SerialFrameBudget = config[PARAM_SERIAL_FRAME_BUDGET];
+	if (config.contains(PARAM_SESSION_RATE_LIMIT) && config[PARAM_SESSION_RATE_LIMIT].is_number_unsigned())
+		SessionRateLimit = config[PARAM_SESSION_RATE_LIMIT];
+	if (config.contains(PARAM_CONTROL_RATE_LIMIT) && config[PARAM_CONTROL_RATE_LIMIT].is_number_unsigned())
+		ControlRateLimit = config[PARAM_CONTROL_RATE_LIMIT];
+	if (config.contains(PARAM_QUERY_RATE_LIMIT) && config[PARAM_QUERY_RATE_LIMIT].is_number_unsigned())
+		QueryRateLimit = config[PARAM_QUERY_RATE_LIMIT];
+	if (config.contains(PARAM_BULK_RATE_LIMIT) && config[PARAM_BULK_RATE_LIMIT].is_number_unsigned())
+		BulkRateLimit = config[PARAM_BULK_RATE_LIMIT];
+	if (config.contains(PARAM_SESSION_MAX_QUEUED_MESSAGES) && config[PARAM_SESSION_MAX_QUEUED_MESSAGES].is_number_unsigned())
+		SessionMaxQueuedMessages = config[PARAM_SESSION_MAX_QUEUED_MESSAGES];
+	if (config.contains(PARAM_ADMISSION_QUEUE_WAIT) && config[PARAM_ADMISSION_QUEUE_WAIT].is_number_unsigned())
+		AdmissionQueueWait = config[PARAM_ADMISSION_QUEUE_WAIT];
 
 	// Set server password and save it to the config before processing overrides,
 	// so that there is always a true configured password regardless of if
@@ -126,6 +152,20 @@ void Config::Load(json config)
 		blog(LOG_INFO, "[Config::Load] --websocket_debug passed. Enabling debug logging.");
 		DebugEnabled = true;
 	}
+
+	// Process `--websocket_metrics` override
+	if (Utils::Platform::GetCommandLineFlagSet(CMDLINE_WEBSOCKET_METRICS)) {
+		blog(LOG_INFO, "[Config::Load] --websocket_metrics passed. Enabling the metrics endpoint.");
+		MetricsEnabled = true;
+	}
+
+	// Process `--websocket_trace` override
+	QString traceArgument = Utils::Platform::GetCommandLineArgument(CMDLINE_WEBSOCKET_TRACE);
+	if (traceArgument != "") {
+		blog(LOG_INFO, "[Config::Load] --websocket_trace passed. Recording a message trace to: %s",
+		     traceArgument.toUtf8().constData());
+		TraceFilePath = traceArgument.toStdString();
+	}
 }
 
 void Config::Save()
@@ -144,6 +184,14 @@ void Config::Save()
 		config[PARAM_AUTHREQUIRED] = AuthRequired.load();
 		config[PARAM_PASSWORD] = ServerPassword;
 	}
+	config[PARAM_METRICS] = MetricsEnabled.load();
+	config[PARAM_SERIAL_FRAME_BUDGET] = SerialFrameBudget.load();
+	config[PARAM_SESSION_RATE_LIMIT] = SessionRateLimit.load();
+	config[PARAM_CONTROL_RATE_LIMIT] = ControlRateLimit.load();
+	config[PARAM_QUERY_RATE_LIMIT] = QueryRateLimit.load();
+	config[PARAM_BULK_RATE_LIMIT] = BulkRateLimit.load();
+	config[PARAM_SESSION_MAX_QUEUED_MESSAGES] = SessionMaxQueuedMessages.load();
+	config[PARAM_ADMISSION_QUEUE_WAIT] = AdmissionQueueWait.load();
 
 	if (Utils::Json::SetJsonFileContent(configFilePath, config))
 		blog(LOG_DEBUG, "[Config::Save] Saved config.");
@@ -41,6 +41,16 @@ struct Config {
 	std::atomic<bool> AlertsEnabled = false;
 	std::atomic<bool> AuthRequired = true;
 	std::string ServerPassword;
+	std::atomic<bool> MetricsEnabled = false;
+	std::atomic<uint64_t> SerialFrameBudget = 0; // Microseconds of SerialFrame requests per graphics tick, 0 for no limit
+	// Messages per second per session, and requests per second per session for each request class. 0 for no limit
+	std::atomic<uint64_t> SessionRateLimit = 0;
+	std::atomic<uint64_t> ControlRateLimit = 0;
+	std::atomic<uint64_t> QueryRateLimit = 0;
+	std::atomic<uint64_t> BulkRateLimit = 0;
+	std::atomic<uint64_t> SessionMaxQueuedMessages = 0; // Messages per session waiting for a worker thread, 0 for no limit
+	std::atomic<uint64_t> AdmissionQueueWait = 0; // Milliseconds of queue wait before bulk requests are shed, 0 to disable
+	std::string TraceFilePath; // Only set by `--websocket_trace`, never saved
 };
 
 json MigrateGlobalConfigData();
@@ -48,10 +48,17 @@ WebSocketApi::WebSocketApi()
 	proc_handler_add(_procHandler, "bool get_api_version(out int version)", &get_api_version, nullptr);
 	proc_handler_add(_procHandler, "bool call_request(in string request_type, in string request_data, out ptr response)",
 			 &call_request, this);
+	proc_handler_add(_procHandler,
+			 "bool call_request_msgpack(in string request_type, in ptr request_data, in int request_data_size, out ptr response)",
+			 &call_request_msgpack, this);
 	proc_handler_add(_procHandler, "bool register_event_callback(in ptr callback, out bool success)", &register_event_callback,
 			 this);
 	proc_handler_add(_procHandler, "bool unregister_event_callback(in ptr callback, out bool success)",
 			 &unregister_event_callback, this);
+	proc_handler_add(_procHandler, "bool register_event_callback_msgpack(in ptr callback, out bool success)",
+			 &register_event_callback_msgpack, this);
+	proc_handler_add(_procHandler, "bool unregister_event_callback_msgpack(in ptr callback, out bool success)",
+			 &unregister_event_callback_msgpack, this);
 	proc_handler_add(_procHandler, "bool vendor_register(in string name, out ptr vendor)", &vendor_register_cb, this);
 	proc_handler_add(_procHandler,
 			 "bool vendor_request_register(in ptr vendor, in string type, in ptr callback, out bool success)",
@@ -75,8 +82,9 @@ WebSocketApi::~WebSocketApi()
 
 	proc_handler_destroy(_procHandler);
 
-	size_t numEventCallbacks = _eventCallbacks.size();
+	size_t numEventCallbacks = _eventCallbacks.size() + _eventCallbacksMsgPack.size();
 	_eventCallbacks.clear();
+	_eventCallbacksMsgPack.clear();
 	blog_debug("[WebSocketApi::~WebSocketApi] Deleted %ld event callbacks", numEventCallbacks);
 
 	for (auto vendor : _vendors) {
@@ -96,12 +104,25 @@ void WebSocketApi::BroadcastEvent(uint64_t requiredIntent, const std::string &ev
 	if (rpcVersion && rpcVersion != CURRENT_RPC_VERSION)
 		return;
 
-	std::string eventDataString = eventData.dump();
-
 	std::shared_lock l(_mutex);
 
-	for (auto &cb : _eventCallbacks)
-		cb.callback(requiredIntent, eventType.c_str(), eventDataString.c_str(), cb.priv_data);
+	// Each encoding is only produced if a callback will receive it
+	if (!_eventCallbacks.empty()) {
+		std::string eventDataString = eventData.dump();
+		for (auto &cb : _eventCallbacks)
+			cb.callback(requiredIntent, eventType.c_str(), eventDataString.c_str(), cb.priv_data);
+	}
+
+	std::vector<uint8_t> eventDataMsgPack;
+	for (auto &cb : _eventCallbacksMsgPack) {
+		if ((cb.event_subscriptions & requiredIntent) == 0)
+			continue;
+
+		if (eventDataMsgPack.empty())
+			eventDataMsgPack = Utils::Json::ToMsgPack(eventData);
+
+		cb.callback(requiredIntent, eventType.c_str(), eventDataMsgPack.data(), eventDataMsgPack.size(), cb.priv_data);
+	}
 }
 
 enum WebSocketApi::RequestReturnCode WebSocketApi::PerformVendorRequest(std::string vendorName, std::string requestType,
@@ -195,6 +216,65 @@ void WebSocketApi::call_request(void *priv_data, calldata_t *cd)
 	RETURN_SUCCESS();
 }
 
+void WebSocketApi::call_request_msgpack(void *priv_data, calldata_t *cd)
+{
+	auto c = static_cast<WebSocketApi *>(priv_data);
+
+#if !defined(PLUGIN_TESTS)
+	if (!c->_obsReady)
+		RETURN_FAILURE();
+#endif
+
+	const char *request_type = calldata_string(cd, "request_type");
+	auto request_data = static_cast<const uint8_t *>(calldata_ptr(cd, "request_data"));
+	size_t request_data_size = (size_t)calldata_int(cd, "request_data_size");
+
+	if (!request_type)
+		RETURN_FAILURE();
+
+#ifdef PLUGIN_TESTS
+	// Allow plugin tests to complete, even though OBS wouldn't be ready at the time of the test
+	if (!c->_obsReady && std::string(request_type) != "GetVersion")
+		RETURN_FAILURE();
+#endif
+
+	json requestData;
+	if (request_data && request_data_size) {
+		try {
+			requestData = json::from_msgpack(request_data, request_data + request_data_size);
+		} catch (json::parse_error &e) {
+			blog(LOG_WARNING, "[WebSocketApi::call_request_msgpack] Failed to decode request data of %s: %s",
+			     request_type, e.what());
+			RETURN_FAILURE();
+		}
+	}
+
+	auto response = static_cast<obs_websocket_request_response_msgpack *>(
+		bzalloc(sizeof(struct obs_websocket_request_response_msgpack)));
+	if (!response)
+		RETURN_FAILURE();
+
+	RequestHandler requestHandler;
+	Request request(request_type, requestData);
+	RequestResult requestResult = requestHandler.ProcessRequest(request);
+
+	response->status_code = (unsigned int)requestResult.StatusCode;
+	if (!requestResult.Comment.empty())
+		response->comment = bstrdup(requestResult.Comment.c_str());
+	if (requestResult.ResponseData.is_object()) {
+		auto responseData = Utils::Json::ToMsgPack(requestResult.ResponseData);
+		response->response_data = static_cast<uint8_t *>(bmemdup(responseData.data(), responseData.size()));
+		response->response_data_size = responseData.size();
+	}
+
+	calldata_set_ptr(cd, "response", response);
+
+	blog_debug("[WebSocketApi::call_request_msgpack] Request %s called, response status code is %u", request_type,
+		   response->status_code);
+
+	RETURN_SUCCESS();
+}
+
 void WebSocketApi::register_event_callback(void *priv_data, calldata_t *cd)
 {
 	auto c = static_cast<WebSocketApi *>(priv_data);
@@ -241,6 +321,52 @@ void WebSocketApi::unregister_event_callback(void *priv_data, calldata_t *cd)
 	RETURN_SUCCESS();
 }
 
+void WebSocketApi::register_event_callback_msgpack(void *priv_data, calldata_t *cd)
+{
+	auto c = static_cast<WebSocketApi *>(priv_data);
+
+	void *voidCallback;
+	if (!calldata_get_ptr(cd, "callback", &voidCallback) || !voidCallback) {
+		blog(LOG_WARNING, "[WebSocketApi::register_event_callback_msgpack] Failed due to missing `callback` pointer.");
+		RETURN_FAILURE();
+	}
+
+	auto cb = static_cast<obs_websocket_event_callback_msgpack *>(voidCallback);
+
+	std::unique_lock l(c->_mutex);
+
+	int64_t foundIndex = c->GetEventCallbackIndex(*cb);
+	if (foundIndex != -1)
+		RETURN_FAILURE();
+
+	c->_eventCallbacksMsgPack.push_back(*cb);
+
+	RETURN_SUCCESS();
+}
+
+void WebSocketApi::unregister_event_callback_msgpack(void *priv_data, calldata_t *cd)
+{
+	auto c = static_cast<WebSocketApi *>(priv_data);
+
+	void *voidCallback;
+	if (!calldata_get_ptr(cd, "callback", &voidCallback) || !voidCallback) {
+		blog(LOG_WARNING, "[WebSocketApi::unregister_event_callback_msgpack] Failed due to missing `callback` pointer.");
+		RETURN_FAILURE();
+	}
+
+	auto cb = static_cast<obs_websocket_event_callback_msgpack *>(voidCallback);
+
+	std::unique_lock l(c->_mutex);
+
+	int64_t foundIndex = c->GetEventCallbackIndex(*cb);
+	if (foundIndex == -1)
+		RETURN_FAILURE();
+
+	c->_eventCallbacksMsgPack.erase(c->_eventCallbacksMsgPack.begin() + foundIndex);
+
+	RETURN_SUCCESS();
+}
+
 void WebSocketApi::vendor_register_cb(void *priv_data, calldata_t *cd)
 {
 	auto c = static_cast<WebSocketApi *>(priv_data);
@@ -67,12 +67,25 @@ private:
 		return -1;
 	}
 
+	inline int64_t GetEventCallbackIndex(obs_websocket_event_callback_msgpack &cb)
+	{
+		for (int64_t i = 0; i < (int64_t)_eventCallbacksMsgPack.size(); i++) {
+			auto currentCb = _eventCallbacksMsgPack[i];
+			if (currentCb.callback == cb.callback && currentCb.priv_data == cb.priv_data)
+				return i;
+		}
+		return -1;
+	}
+
 	// Proc handlers
 	static void get_ph_cb(void *priv_data, calldata_t *cd);
 	static void get_api_version(void *, calldata_t *cd);
 	static void call_request(void *, calldata_t *cd);
+	static void call_request_msgpack(void *, calldata_t *cd);
 	static void register_event_callback(void *, calldata_t *cd);
 	static void unregister_event_callback(void *, calldata_t *cd);
+	static void register_event_callback_msgpack(void *, calldata_t *cd);
+	static void unregister_event_callback_msgpack(void *, calldata_t *cd);
 	static void vendor_register_cb(void *priv_data, calldata_t *cd);
 	static void vendor_request_register_cb(void *priv_data, calldata_t *cd);
 	static void vendor_request_unregister_cb(void *priv_data, calldata_t *cd);
@@ -82,6 +95,7 @@ private:
 	proc_handler_t *_procHandler;
 	std::map<std::string, Vendor *> _vendors;
 	std::vector<obs_websocket_event_callback> _eventCallbacks;
+	std::vector<obs_websocket_event_callback_msgpack> _eventCallbacksMsgPack;
 
 	std::atomic<bool> _obsReady = false;
 
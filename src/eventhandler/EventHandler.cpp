@@ -18,6 +18,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
 #include "EventHandler.h"
+#include "../utils/Metrics.h"
 
 EventHandler::EventHandler()
 {
@@ -68,16 +69,12 @@ EventHandler::~EventHandler()
 void EventHandler::ProcessSubscriptionChange(bool type, uint64_t eventSubscriptions)
 {
 	if (type) {
-		if ((eventSubscriptions & EventSubscription::InputVolumeMeters) != 0) {
-			if (_inputVolumeMetersRef.fetch_add(1) == 0) {
-				if (_inputVolumeMetersHandler)
-					blog(LOG_WARNING,
-					     "[EventHandler::ProcessSubscription] Input volume meter handler already exists!");
-				else
-					_inputVolumeMetersHandler = std::make_unique<Utils::Obs::VolumeMeter::Handler>(
-						std::bind(&EventHandler::HandleInputVolumeMeters, this, std::placeholders::_1));
-			}
-		}
+		if ((eventSubscriptions & EventSubscription::InputVolumeMeters) != 0)
+			_inputVolumeMetersRef++;
+		if ((eventSubscriptions & EventSubscription::InputVolumeMetersBinary) != 0)
+			_inputVolumeMetersBinaryRef++;
+		if ((eventSubscriptions & (EventSubscription::InputVolumeMeters | EventSubscription::InputVolumeMetersBinary)) != 0)
+			UpdateInputVolumeMetersHandler((eventSubscriptions & EventSubscription::InputVolumeMetersBinary) != 0);
 		if ((eventSubscriptions & EventSubscription::InputActiveStateChanged) != 0)
 			_inputActiveStateChangedRef++;
 		if ((eventSubscriptions & EventSubscription::InputShowStateChanged) != 0)
@@ -85,10 +82,12 @@ void EventHandler::ProcessSubscriptionChange(bool type, uint64_t eventSubscripti
 		if ((eventSubscriptions & EventSubscription::SceneItemTransformChanged) != 0)
 			_sceneItemTransformChangedRef++;
 	} else {
-		if ((eventSubscriptions & EventSubscription::InputVolumeMeters) != 0) {
-			if (_inputVolumeMetersRef.fetch_sub(1) == 1)
-				_inputVolumeMetersHandler.reset();
-		}
+		if ((eventSubscriptions & EventSubscription::InputVolumeMeters) != 0)
+			_inputVolumeMetersRef--;
+		if ((eventSubscriptions & EventSubscription::InputVolumeMetersBinary) != 0)
+			_inputVolumeMetersBinaryRef--;
+		if ((eventSubscriptions & (EventSubscription::InputVolumeMeters | EventSubscription::InputVolumeMetersBinary)) != 0)
+			UpdateInputVolumeMetersHandler(false);
 		if ((eventSubscriptions & EventSubscription::InputActiveStateChanged) != 0)
 			_inputActiveStateChangedRef--;
 		if ((eventSubscriptions & EventSubscription::InputShowStateChanged) != 0)
@@ -98,13 +97,68 @@ void EventHandler::ProcessSubscriptionChange(bool type, uint64_t eventSubscripti
 	}
 }
 
+// Creates, updates, or destroys the input volume meter handler to match the current subscription refcounts.
+// The JSON and binary outputs are only generated while at least one client is subscribed to them.
+void EventHandler::UpdateInputVolumeMetersHandler(bool announceMapping)
+{
+	std::unique_lock<std::mutex> l(_inputVolumeMetersMutex);
+
+	bool jsonEnabled = _inputVolumeMetersRef > 0;
+	bool binaryEnabled = _inputVolumeMetersBinaryRef > 0;
+
+	if (!jsonEnabled && !binaryEnabled) {
+		_inputVolumeMetersHandler.reset();
+		return;
+	}
+
+	if (!_inputVolumeMetersHandler)
+		_inputVolumeMetersHandler = std::make_unique<Utils::Obs::VolumeMeter::Handler>(
+			std::bind(&EventHandler::HandleInputVolumeMeters, this, std::placeholders::_1),
+			std::bind(&EventHandler::HandleInputVolumeMetersBinary, this, std::placeholders::_1,
+				  std::placeholders::_2),
+			std::bind(&EventHandler::HandleInputVolumeMetersMapping, this, std::placeholders::_1,
+				  std::placeholders::_2),
+			_inputVolumeMetersPeriod, _inputVolumeMetersInputs);
+
+	_inputVolumeMetersHandler->JsonEnabled = jsonEnabled;
+	_inputVolumeMetersHandler->BinaryEnabled = binaryEnabled;
+
+	// Newly subscribed clients have not seen the current mapping yet
+	if (announceMapping)
+		_inputVolumeMetersHandler->InvalidateMapping();
+}
+
+// Sets the fastest update period and the union of inputs requested by subscribed clients. Empty `inputs` for all inputs
+void EventHandler::SetInputVolumeMetersConfig(uint64_t updatePeriod, std::vector<std::string> inputs)
+{
+	std::unique_lock<std::mutex> l(_inputVolumeMetersMutex);
+
+	bool inputsChanged = _inputVolumeMetersInputs != inputs;
+	_inputVolumeMetersPeriod = updatePeriod;
+	_inputVolumeMetersInputs = inputs;
+
+	if (!_inputVolumeMetersHandler)
+		return;
+
+	_inputVolumeMetersHandler->SetUpdatePeriod(updatePeriod);
+	if (inputsChanged)
+		_inputVolumeMetersHandler->SetInputFilter(inputs);
+}
+
 // Function required in order to use default arguments
 void EventHandler::BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion)
 {
 	if (!_eventCallback)
 		return;
 
-	_eventCallback(requiredIntent, eventType, eventData, rpcVersion);
+	// Events are broadcast from their libobs signal handlers, so this is as close to the signal as we get
+	uint64_t emittedAt = os_gettime_ns();
+
+	auto eventMetrics = GetEventMetrics();
+	if (eventMetrics)
+		eventMetrics->RecordEmitted(eventType);
+
+	_eventCallback(requiredIntent, eventType, eventData, rpcVersion, emittedAt);
 }
 
 // Connect source signals for Inputs, Scenes, and Transitions. Filters are automatically connected.
@@ -252,6 +306,8 @@ void EventHandler::OnFrontendEvent(enum obs_frontend_event event, void *private_
 {
 	auto eventHandler = static_cast<EventHandler *>(private_data);
 
+	ScopeProfiler prof{"obs_websocket_frontend_event"};
+
 	switch (event) {
 	// General
 	case OBS_FRONTEND_EVENT_FINISHED_LOADING:
@@ -482,6 +538,8 @@ void EventHandler::SourceCreatedMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_created"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -506,6 +564,8 @@ void EventHandler::SourceDestroyedMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_destroyed"};
+
 	// We can't use any smart types here because releasing the source will cause infinite recursion
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
@@ -536,6 +596,8 @@ void EventHandler::SourceRemovedMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_removed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -556,6 +618,8 @@ void EventHandler::SourceRenamedMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_renamed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -583,6 +647,8 @@ void EventHandler::SourceUpdatedMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_updated"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -603,6 +669,8 @@ void EventHandler::StreamOutputReconnectHandler(void *param, calldata_t *)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_stream_output_reconnect"};
+
 	eventHandler->HandleStreamStateChanged(OBS_WEBSOCKET_OUTPUT_RECONNECTING);
 }
 
@@ -610,5 +678,7 @@ void EventHandler::StreamOutputReconnectSuccessHandler(void *param, calldata_t *
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_stream_output_reconnect_success"};
+
 	eventHandler->HandleStreamStateChanged(OBS_WEBSOCKET_OUTPUT_RECONNECTED);
 }
@@ -22,6 +22,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <atomic>
 #include <obs.hpp>
 #include <obs-frontend-api.h>
+#include <util/profiler.hpp>
 
 #include "types/EventSubscription.h"
 #include "../obs-websocket.h"
@@ -35,18 +36,25 @@ public:
 	~EventHandler();
 
 	void ProcessSubscriptionChange(bool type, uint64_t eventSubscriptions);
+	void SetInputVolumeMetersConfig(uint64_t updatePeriod, std::vector<std::string> inputs);
 
 	// Callback when an event fires
-	typedef std::function<void(uint64_t, std::string, json, uint8_t)>
-		EventCallback; // uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion
+	typedef std::function<void(uint64_t, std::string, json, uint8_t, uint64_t)>
+		EventCallback; // uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion, uint64_t emittedAt
 	inline void SetEventCallback(EventCallback cb) { _eventCallback = cb; }
 
+	// Callback when a pre-encoded binary event frame is ready. The data is only valid for the duration of the call
+	typedef std::function<void(uint64_t, const uint8_t *, size_t)>
+		BinaryEventCallback; // uint64_t requiredIntent, const uint8_t *data, size_t size
+	inline void SetBinaryEventCallback(BinaryEventCallback cb) { _binaryEventCallback = cb; }
+
 	// Callback when OBS becomes ready or non-ready
 	typedef std::function<void(bool)> ObsReadyCallback; // bool ready
 	inline void SetObsReadyCallback(ObsReadyCallback cb) { _obsReadyCallback = cb; }
 
 private:
 	EventCallback _eventCallback;
+	BinaryEventCallback _binaryEventCallback;
 	ObsReadyCallback _obsReadyCallback;
 
 	std::atomic<bool> _obsReady = false;
@@ -55,7 +63,11 @@ private:
 	OBSSignal recordFileChangedSignal;
 
 	std::unique_ptr<Utils::Obs::VolumeMeter::Handler> _inputVolumeMetersHandler;
+	std::mutex _inputVolumeMetersMutex;
 	std::atomic<uint64_t> _inputVolumeMetersRef = 0;
+	std::atomic<uint64_t> _inputVolumeMetersBinaryRef = 0;
+	uint64_t _inputVolumeMetersPeriod = 50;
+	std::vector<std::string> _inputVolumeMetersInputs;
 	std::atomic<uint64_t> _inputActiveStateChangedRef = 0;
 	std::atomic<uint64_t> _inputShowStateChangedRef = 0;
 	std::atomic<uint64_t> _sceneItemTransformChangedRef = 0;
@@ -64,6 +76,7 @@ private:
 	void DisconnectSourceSignals(obs_source_t *source);
 
 	void BroadcastEvent(uint64_t requiredIntent, std::string eventType, json eventData = nullptr, uint8_t rpcVersion = 0);
+	void UpdateInputVolumeMetersHandler(bool announceMapping);
 
 	// Signal handler: frontend
 	static void OnFrontendEvent(enum obs_frontend_event event, void *private_data);
@@ -130,6 +143,8 @@ private:
 	static void HandleInputAudioMonitorTypeChanged(void *param,
 						       calldata_t *data); // Direct callback
 	void HandleInputVolumeMeters(std::vector<json> &inputs);          // AudioMeter::Handler callback
+	void HandleInputVolumeMetersBinary(const uint8_t *data, size_t size); // AudioMeter::Handler callback
+	void HandleInputVolumeMetersMapping(uint32_t mappingSequence, std::vector<json> &inputs); // AudioMeter::Handler callback
 
 	// Transitions
 	void HandleCurrentSceneTransitionChanged();
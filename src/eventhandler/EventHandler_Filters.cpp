@@ -23,6 +23,8 @@ void EventHandler::FilterAddMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_filter_add"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	obs_source_t *filter = GetCalldataPointer<obs_source_t>(data, "filter");
 
@@ -38,6 +40,8 @@ void EventHandler::FilterRemoveMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_filter_remove"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	obs_source_t *filter = GetCalldataPointer<obs_source_t>(data, "filter");
 
@@ -67,6 +71,8 @@ void EventHandler::HandleSourceFilterListReindexed(void *param, calldata_t *data
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_filter_list_reindexed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -152,6 +158,8 @@ void EventHandler::HandleSourceFilterNameChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_filter_name_changed"};
+
 	obs_source_t *filter = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!filter)
 		return;
@@ -208,6 +216,8 @@ void EventHandler::HandleSourceFilterEnableStateChanged(void *param, calldata_t
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_filter_enable_state_changed"};
+
 	obs_source_t *filter = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!filter)
 		return;
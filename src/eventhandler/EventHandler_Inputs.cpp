@@ -109,6 +109,7 @@ void EventHandler::HandleInputNameChanged(obs_source_t *source, std::string oldI
  * @dataField inputName     | String | Name of the input
  * @dataField inputUuid     | String | UUID of the input
  * @dataField inputSettings | Object | New settings object of the input
+ * @dataField isDelta       | Boolean | Only present for sessions with `eventDeltas` enabled. Whether `inputSettings` is a JSON Merge Patch against the previous settings
  *
  * @eventType InputSettingsChanged
  * @eventSubscription Inputs
@@ -153,6 +154,8 @@ void EventHandler::HandleInputActiveStateChanged(void *param, calldata_t *data)
 	if (!eventHandler->_inputActiveStateChangedRef.load())
 		return;
 
+	ScopeProfiler prof{"obs_websocket_signal_input_active_state_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -191,6 +194,8 @@ void EventHandler::HandleInputShowStateChanged(void *param, calldata_t *data)
 	if (!eventHandler->_inputShowStateChangedRef.load())
 		return;
 
+	ScopeProfiler prof{"obs_websocket_signal_input_show_state_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -224,6 +229,8 @@ void EventHandler::HandleInputMuteStateChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_mute_state_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -258,6 +265,8 @@ void EventHandler::HandleInputVolumeChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_volume_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -299,6 +308,8 @@ void EventHandler::HandleInputAudioBalanceChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_audio_balance_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -334,6 +345,8 @@ void EventHandler::HandleInputAudioSyncOffsetChanged(void *param, calldata_t *da
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_audio_sync_offset_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -369,6 +382,8 @@ void EventHandler::HandleInputAudioTracksChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_audio_tracks_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -415,6 +430,8 @@ void EventHandler::HandleInputAudioMonitorTypeChanged(void *param, calldata_t *d
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_input_audio_monitor_type_changed"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -434,6 +451,8 @@ void EventHandler::HandleInputAudioMonitorTypeChanged(void *param, calldata_t *d
 /**
  * A high-volume event providing volume levels of all active inputs every 50 milliseconds.
  *
+ * The interval and set of inputs can be changed per session with the `inputVolumeMetersPeriod` and `inputVolumeMetersInputs` Identify parameters.
+ *
  * @dataField inputs | Array<Object> | Array of active inputs with their associated volume levels
  *
  * @eventType InputVolumeMeters
@@ -450,3 +469,36 @@ void EventHandler::HandleInputVolumeMeters(std::vector<json> &inputs)
 	eventData["inputs"] = inputs;
 	BroadcastEvent(EventSubscription::InputVolumeMeters, "InputVolumeMeters", eventData);
 }
+
+// Binary counterpart of `InputVolumeMeters`. The frame format is documented in the protocol introduction.
+void EventHandler::HandleInputVolumeMetersBinary(const uint8_t *data, size_t size)
+{
+	if (!_binaryEventCallback)
+		return;
+
+	_binaryEventCallback(EventSubscription::InputVolumeMetersBinary, data, size);
+}
+
+/**
+ * The mapping of input indexes used in binary volume meter frames has changed.
+ *
+ * Sent when a client subscribes to `InputVolumeMetersBinary`, and whenever an audio input becomes active or inactive. Binary frames carry the `mappingSequence` they were generated with, so entries of frames with a sequence newer than the last received mapping should be ignored until this event arrives.
+ *
+ * @dataField mappingSequence | Number        | Sequence number of this mapping, matching the one in binary meter frame headers
+ * @dataField inputs          | Array<Object> | Array of active inputs with their `inputIndex`, `inputName`, and `inputUuid`
+ *
+ * @eventType InputVolumeMetersMapping
+ * @eventSubscription InputVolumeMetersBinary
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @api events
+ * @category inputs
+ */
+void EventHandler::HandleInputVolumeMetersMapping(uint32_t mappingSequence, std::vector<json> &inputs)
+{
+	json eventData;
+	eventData["mappingSequence"] = mappingSequence;
+	eventData["inputs"] = inputs;
+	BroadcastEvent(EventSubscription::InputVolumeMetersBinary, "InputVolumeMetersMapping", eventData);
+}
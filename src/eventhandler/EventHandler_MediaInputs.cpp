@@ -40,6 +40,8 @@ void EventHandler::SourceMediaPauseMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_pause"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -54,6 +56,8 @@ void EventHandler::SourceMediaPlayMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_play"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -68,6 +72,8 @@ void EventHandler::SourceMediaRestartMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_restart"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -82,6 +88,8 @@ void EventHandler::SourceMediaStopMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_stop"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -96,6 +104,8 @@ void EventHandler::SourceMediaNextMultiHandler(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_next"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -110,6 +120,8 @@ void EventHandler::SourceMediaPreviousMultiHandler(void *param, calldata_t *data
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_source_media_previous"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -138,6 +150,8 @@ void EventHandler::HandleMediaInputPlaybackStarted(void *param, calldata_t *data
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_media_input_playback_started"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
@@ -169,6 +183,8 @@ void EventHandler::HandleMediaInputPlaybackEnded(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_media_input_playback_ended"};
+
 	obs_source_t *source = GetCalldataPointer<obs_source_t>(data, "source");
 	if (!source)
 		return;
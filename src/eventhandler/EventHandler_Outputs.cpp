@@ -104,6 +104,8 @@ void EventHandler::HandleRecordFileChanged(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_record_file_changed"};
+
 	json eventData;
 	eventData["newOutputPath"] = calldata_string(data, "next_file");
 	eventHandler->BroadcastEvent(EventSubscription::Outputs, "RecordFileChanged", eventData);
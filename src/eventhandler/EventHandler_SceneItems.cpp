@@ -41,6 +41,8 @@ void EventHandler::HandleSceneItemCreated(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_created"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -82,6 +84,8 @@ void EventHandler::HandleSceneItemRemoved(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_removed"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -118,6 +122,8 @@ void EventHandler::HandleSceneItemListReindexed(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_list_reindexed"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -149,6 +155,8 @@ void EventHandler::HandleSceneItemEnableStateChanged(void *param, calldata_t *da
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_enable_state_changed"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -187,6 +195,8 @@ void EventHandler::HandleSceneItemLockStateChanged(void *param, calldata_t *data
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_lock_state_changed"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -224,6 +234,8 @@ void EventHandler::HandleSceneItemSelected(void *param, calldata_t *data)
 {
 	auto eventHandler = static_cast<EventHandler *>(param);
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_selected"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
@@ -246,6 +258,7 @@ void EventHandler::HandleSceneItemSelected(void *param, calldata_t *data)
  * @dataField sceneUuid          | String | The UUID of the scene the item is in
  * @dataField sceneItemId        | Number | Numeric ID of the scene item
  * @dataField sceneItemTransform | Object | New transform/crop info of the scene item
+ * @dataField isDelta            | Boolean | Only present for sessions with `eventDeltas` enabled. Whether `sceneItemTransform` is a JSON Merge Patch against the previous transform
  *
  * @eventType SceneItemTransformChanged
  * @eventSubscription SceneItemTransformChanged
@@ -262,6 +275,8 @@ void EventHandler::HandleSceneItemTransformChanged(void *param, calldata_t *data
 	if (!eventHandler->_sceneItemTransformChangedRef.load())
 		return;
 
+	ScopeProfiler prof{"obs_websocket_signal_scene_item_transform_changed"};
+
 	obs_scene_t *scene = GetCalldataPointer<obs_scene_t>(data, "scene");
 	if (!scene)
 		return;
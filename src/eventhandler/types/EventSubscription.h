@@ -209,5 +209,16 @@ namespace EventSubscription {
 		* @api enums
 		*/
 		SceneItemTransformChanged = (1 << 19),
+		/**
+		* Subscription value to receive binary input volume meter frames, and the `InputVolumeMetersMapping` event.
+		*
+		* @enumIdentifier InputVolumeMetersBinary
+		* @enumValue (1 << 20)
+		* @enumType EventSubscription
+		* @rpcVersion -1
+		* @initialVersion 5.6.0
+		* @api enums
+		*/
+		InputVolumeMetersBinary = (1 << 20),
 	};
 }
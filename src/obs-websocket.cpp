@@ -28,6 +28,11 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "websocketserver/WebSocketServer.h"
 #include "eventhandler/EventHandler.h"
 #include "forms/SettingsDialog.h"
+#include "requesthandler/RequestHandler.h"
+#include "utils/Metrics.h"
+#include "utils/Obs_FrameReadback.h"
+#include "utils/Obs_FrameStream.h"
+#include "utils/PersistentData.h"
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-websocket", "en-US")
@@ -46,10 +51,17 @@ ConfigPtr _config;
 EventHandlerPtr _eventHandler;
 WebSocketApiPtr _webSocketApi;
 WebSocketServerPtr _webSocketServer;
+FrameReadbackHandlerPtr _frameReadbackHandler;
+FrameStreamHandlerPtr _frameStreamHandler;
+PersistentDataStorePtr _persistentDataStore;
+RequestMetricsPtr _requestMetrics;
+EventMetricsPtr _eventMetrics;
 SettingsDialog *_settingsDialog = nullptr;
 
 void OnWebSocketApiVendorEvent(std::string vendorName, std::string eventType, obs_data_t *obsEventData);
-void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion);
+void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion, uint64_t emittedAt);
+void OnBinaryEvent(uint64_t requiredIntent, const uint8_t *data, size_t size);
+void OnSourceFrame(uint32_t sessionId, const uint8_t *data, size_t size);
 void OnObsReady(bool ready);
 
 bool obs_module_load(void)
@@ -73,11 +85,27 @@ bool obs_module_load(void)
 	_config = std::make_shared<Config>();
 	_config->Load(migratedConfig);
 
+	// Initialize the persistent data store, after migrations have moved the data files into place
+	_persistentDataStore = std::make_shared<Utils::PersistentData::Store>();
+
+	// Initialize the request metrics, for every known request type
+	_requestMetrics = std::make_shared<Utils::Metrics::RequestMetrics>(RequestHandler().GetRequestList());
+
+	// Initialize the event metrics
+	_eventMetrics = std::make_shared<Utils::Metrics::EventMetrics>();
+
 	// Initialize the event handler
 	_eventHandler = std::make_shared<EventHandler>();
 	_eventHandler->SetEventCallback(OnEvent);
+	_eventHandler->SetBinaryEventCallback(OnBinaryEvent);
 	_eventHandler->SetObsReadyCallback(OnObsReady);
 
+	// Initialize the asynchronous screenshot readback
+	_frameReadbackHandler = std::make_shared<Utils::Obs::FrameReadback::Handler>();
+
+	// Initialize the source frame streams
+	_frameStreamHandler = std::make_shared<Utils::Obs::FrameStream::Handler>(OnSourceFrame);
+
 	// Initialize the plugin/script API
 	_webSocketApi = std::make_shared<WebSocketApi>();
 	_webSocketApi->SetVendorEventCallback(OnWebSocketApiVendorEvent);
@@ -86,6 +114,9 @@ bool obs_module_load(void)
 	_webSocketServer = std::make_shared<WebSocketServer>();
 	_webSocketServer->SetClientSubscriptionCallback(std::bind(&EventHandler::ProcessSubscriptionChange, _eventHandler.get(),
 								  std::placeholders::_1, std::placeholders::_2));
+	_webSocketServer->SetInputVolumeMetersConfigCallback(std::bind(&EventHandler::SetInputVolumeMetersConfig,
+								       _eventHandler.get(), std::placeholders::_1,
+								       std::placeholders::_2));
 
 	// Initialize the settings dialog
 	obs_frontend_push_ui_translation(obs_module_get_string);
@@ -133,15 +164,30 @@ void obs_module_unload(void)
 		_webSocketServer->Stop();
 	}
 
+	// Release the source frame streams, which send to the WebSocket server
+	_frameStreamHandler = nullptr;
+
 	// Release the WebSocket server
 	_webSocketServer->SetClientSubscriptionCallback(nullptr);
+	_webSocketServer->SetInputVolumeMetersConfigCallback(nullptr);
 	_webSocketServer = nullptr;
 
 	// Release the plugin/script api
 	_webSocketApi = nullptr;
 
+	// Release the screenshot readback
+	_frameReadbackHandler = nullptr;
+
+	// Release the persistent data store, which writes out pending changes
+	_persistentDataStore = nullptr;
+
+	// Release the request and event metrics
+	_requestMetrics = nullptr;
+	_eventMetrics = nullptr;
+
 	// Release the event handler
 	_eventHandler->SetObsReadyCallback(nullptr);
+	_eventHandler->SetBinaryEventCallback(nullptr);
 	_eventHandler->SetEventCallback(nullptr);
 	_eventHandler = nullptr;
 
@@ -179,6 +225,31 @@ WebSocketServerPtr GetWebSocketServer()
 	return _webSocketServer;
 }
 
+FrameReadbackHandlerPtr GetFrameReadbackHandler()
+{
+	return _frameReadbackHandler;
+}
+
+FrameStreamHandlerPtr GetFrameStreamHandler()
+{
+	return _frameStreamHandler;
+}
+
+PersistentDataStorePtr GetPersistentDataStore()
+{
+	return _persistentDataStore;
+}
+
+RequestMetricsPtr GetRequestMetrics()
+{
+	return _requestMetrics;
+}
+
+EventMetricsPtr GetEventMetrics()
+{
+	return _eventMetrics;
+}
+
 bool IsDebugEnabled()
 {
 	return !_config || _config->DebugEnabled;
@@ -215,14 +286,28 @@ void OnWebSocketApiVendorEvent(std::string vendorName, std::string eventType, ob
 }
 
 // Sent from: EventHandler
-void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion)
+void OnEvent(uint64_t requiredIntent, std::string eventType, json eventData, uint8_t rpcVersion, uint64_t emittedAt)
 {
 	if (_webSocketServer)
-		_webSocketServer->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion);
+		_webSocketServer->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion, emittedAt);
 	if (_webSocketApi)
 		_webSocketApi->BroadcastEvent(requiredIntent, eventType, eventData, rpcVersion);
 }
 
+// Sent from: EventHandler
+void OnBinaryEvent(uint64_t requiredIntent, const uint8_t *data, size_t size)
+{
+	if (_webSocketServer)
+		_webSocketServer->BroadcastBinaryEvent(requiredIntent, data, size);
+}
+
+// Sent from: FrameStream handler
+void OnSourceFrame(uint32_t sessionId, const uint8_t *data, size_t size)
+{
+	if (_webSocketServer)
+		_webSocketServer->SendSessionBinaryMessage(sessionId, data, size);
+}
+
 // Sent from: EventHandler
 void OnObsReady(bool ready)
 {
@@ -246,6 +331,17 @@ void test_call_request()
 		blog(LOG_ERROR, "[test_call_request] Failed to call GetVersion request via obs-websocket plugin API!");
 	}
 
+	struct obs_websocket_request_response_msgpack *msgPackResponse = obs_websocket_call_request_msgpack("GetVersion", NULL, 0);
+	if (msgPackResponse) {
+		json responseData = json::from_msgpack(msgPackResponse->response_data,
+						       msgPackResponse->response_data + msgPackResponse->response_data_size);
+		blog(LOG_INFO, "[test_call_request] Called GetVersion (MsgPack). Status Code: %u | Response Data: %s",
+		     msgPackResponse->status_code, responseData.dump().c_str());
+		obs_websocket_request_response_msgpack_free(msgPackResponse);
+	} else {
+		blog(LOG_ERROR, "[test_call_request] Failed to call GetVersion request via obs-websocket MsgPack plugin API!");
+	}
+
 	blog(LOG_INFO, "[test_call_request] Test done.");
 }
 
@@ -257,6 +353,16 @@ static void test_event_cb(uint64_t eventIntent, const char *eventType, const cha
 	UNUSED_PARAMETER(priv_data);
 }
 
+static void test_event_msgpack_cb(uint64_t eventIntent, const char *eventType, const uint8_t *eventData, size_t eventDataSize,
+				  void *priv_data)
+{
+	blog(LOG_DEBUG, "[test_event_msgpack_cb] New event! Type: %s | Data: %s", eventType,
+	     json::from_msgpack(eventData, eventData + eventDataSize).dump().c_str());
+
+	UNUSED_PARAMETER(eventIntent);
+	UNUSED_PARAMETER(priv_data);
+}
+
 void test_register_event_callback()
 {
 	blog(LOG_INFO, "[test_register_event_callback] Registering test event callback...");
@@ -264,6 +370,9 @@ void test_register_event_callback()
 	if (!obs_websocket_register_event_callback(test_event_cb, nullptr))
 		blog(LOG_ERROR, "[test_register_event_callback] Failed to register event callback!");
 
+	if (!obs_websocket_register_event_callback_msgpack(test_event_msgpack_cb, EventSubscription::Scenes, nullptr))
+		blog(LOG_ERROR, "[test_register_event_callback] Failed to register MsgPack event callback!");
+
 	blog(LOG_INFO, "[test_register_event_callback] Test done.");
 }
 
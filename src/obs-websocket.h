@@ -40,6 +40,29 @@ typedef std::shared_ptr<WebSocketApi> WebSocketApiPtr;
 class WebSocketServer;
 typedef std::shared_ptr<WebSocketServer> WebSocketServerPtr;
 
+namespace Utils {
+	namespace Obs {
+		namespace FrameReadback {
+			class Handler;
+		}
+		namespace FrameStream {
+			class Handler;
+		}
+	}
+	namespace PersistentData {
+		class Store;
+	}
+	namespace Metrics {
+		class RequestMetrics;
+		class EventMetrics;
+	}
+}
+typedef std::shared_ptr<Utils::Obs::FrameReadback::Handler> FrameReadbackHandlerPtr;
+typedef std::shared_ptr<Utils::Obs::FrameStream::Handler> FrameStreamHandlerPtr;
+typedef std::shared_ptr<Utils::PersistentData::Store> PersistentDataStorePtr;
+typedef std::shared_ptr<Utils::Metrics::RequestMetrics> RequestMetricsPtr;
+typedef std::shared_ptr<Utils::Metrics::EventMetrics> EventMetricsPtr;
+
 os_cpu_usage_info_t *GetCpuUsageInfo();
 
 ConfigPtr GetConfig();
@@ -50,4 +73,14 @@ WebSocketApiPtr GetWebSocketApi();
 
 WebSocketServerPtr GetWebSocketServer();
 
+FrameReadbackHandlerPtr GetFrameReadbackHandler();
+
+FrameStreamHandlerPtr GetFrameStreamHandler();
+
+PersistentDataStorePtr GetPersistentDataStore();
+
+RequestMetricsPtr GetRequestMetrics();
+
+EventMetricsPtr GetEventMetrics();
+
 bool IsDebugEnabled();
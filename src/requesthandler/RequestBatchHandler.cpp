@@ -16,13 +16,16 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
 #include <queue>
 #include <condition_variable>
 #include <util/profiler.hpp>
 
 #include "RequestBatchHandler.h"
 #include "../utils/Compat.h"
+#include "../utils/Json.h"
 #include "../obs-websocket.h"
+#include "../Config.h"
 
 struct SerialFrameBatch {
 	RequestHandler &requestHandler;
@@ -44,6 +47,15 @@ struct SerialFrameBatch {
 	}
 };
 
+// Time spent on SerialFrame requests in the current tick, shared by every batch. Graphics thread only.
+static uint64_t tickFrameTime = 0;
+static uint64_t tickCostNs = 0;
+static bool tickDeferred = false;
+
+static std::atomic<uint64_t> serialFrameTicks = 0;
+static std::atomic<uint64_t> serialFrameDeferredTicks = 0;
+static std::atomic<uint64_t> serialFrameMaxTickCostNs = 0;
+
 struct ParallelBatchResults {
 	RequestHandler &requestHandler;
 	std::vector<RequestResult> results;
@@ -105,7 +117,8 @@ static void PostProcessVariables(json &variables, const RequestBatchRequest &req
 			continue;
 		}
 
-		variables[key] = requestResult.ResponseData[valueString];
+		// Pre-serialized settings must be readable by the next requests
+		variables[key] = Utils::Json::ResolveFragment(requestResult.ResponseData[valueString]);
 	}
 }
 
@@ -127,14 +140,37 @@ static void ObsTickCallback(void *param, float)
 			serialFrameBatch->sleepUntilFrame = 0;
 	}
 
+	// Every batch running in this tick draws from the same budget
+	uint64_t frameTime = obs_get_video_frame_time();
+	if (frameTime != tickFrameTime) {
+		tickFrameTime = frameTime;
+		tickCostNs = 0;
+		tickDeferred = false;
+	}
+
+	auto conf = GetConfig();
+	uint64_t budgetNs = conf ? conf->SerialFrameBudget * 1000 : 0;
+	uint64_t startedAt = os_gettime_ns();
+	size_t processedRequests = 0;
+
 	// Begin recursing any unprocessed requests
 	while (!serialFrameBatch->requests.empty()) {
+		// Defer the rest to the next frame once the budget is used up, but always make progress
+		if (budgetNs && processedRequests && tickCostNs + (os_gettime_ns() - startedAt) >= budgetNs) {
+			if (!tickDeferred) {
+				tickDeferred = true;
+				serialFrameDeferredTicks++;
+			}
+			break;
+		}
+
 		// Fetch first in queue
 		RequestBatchRequest request = serialFrameBatch->requests.front();
 		// Pre-process batch variables
 		PreProcessVariables(serialFrameBatch->variables, request);
 		// Process request and get result
 		RequestResult requestResult = serialFrameBatch->requestHandler.ProcessRequest(request);
+		processedRequests++;
 		// Post-process batch variables
 		PostProcessVariables(serialFrameBatch->variables, request, requestResult);
 		// Add to results vector
@@ -155,6 +191,14 @@ static void ObsTickCallback(void *param, float)
 		}
 	}
 
+	if (processedRequests) {
+		if (!tickCostNs)
+			serialFrameTicks++;
+		tickCostNs += std::max<uint64_t>(os_gettime_ns() - startedAt, 1);
+		if (tickCostNs > serialFrameMaxTickCostNs)
+			serialFrameMaxTickCostNs = tickCostNs;
+	}
+
 	// If request queue is empty, we can notify the paused worker thread
 	if (serialFrameBatch->requests.empty())
 		serialFrameBatch->condition.notify_one();
@@ -232,3 +276,8 @@ RequestBatchHandler::ProcessRequestBatch(QThreadPool &threadPool, SessionPtr ses
 	// Return empty vector if not a batch somehow
 	return std::vector<RequestResult>();
 }
+
+RequestBatchHandler::SerialFrameStats RequestBatchHandler::GetSerialFrameStats()
+{
+	return {serialFrameTicks.load(), serialFrameDeferredTicks.load(), serialFrameMaxTickCostNs.load()};
+}
@@ -24,8 +24,15 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "rpc/RequestBatchRequest.h"
 
 namespace RequestBatchHandler {
+	struct SerialFrameStats {
+		uint64_t ticks;         // Graphics ticks which processed SerialFrame requests
+		uint64_t deferredTicks; // Ticks which deferred requests to the next frame, after using up the budget
+		uint64_t maxTickCostNs; // Most time spent processing SerialFrame requests in a single tick
+	};
+
 	std::vector<RequestResult> ProcessRequestBatch(QThreadPool &threadPool, SessionPtr session,
 						       RequestBatchExecutionType::RequestBatchExecutionType executionType,
 						       std::vector<RequestBatchRequest> &requests, json &variables,
 						       bool haltOnFailure);
+	SerialFrameStats GetSerialFrameStats();
 }
@@ -22,11 +22,15 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #endif
 
 #include "RequestHandler.h"
+#include "../websocketserver/WebSocketServer.h"
+#include "../utils/Metrics.h"
 
 const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_handlerMap{
 	// General
 	{"GetVersion", &RequestHandler::GetVersion},
 	{"GetStats", &RequestHandler::GetStats},
+	{"GetRequestStats", &RequestHandler::GetRequestStats},
+	{"GetEventStats", &RequestHandler::GetEventStats},
 	{"BroadcastCustomEvent", &RequestHandler::BroadcastCustomEvent},
 	{"CallVendorRequest", &RequestHandler::CallVendorRequest},
 	{"GetHotkeyList", &RequestHandler::GetHotkeyList},
@@ -36,6 +40,7 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 
 	// Config
 	{"GetPersistentData", &RequestHandler::GetPersistentData},
+	{"GetPersistentDataBatch", &RequestHandler::GetPersistentDataBatch},
 	{"SetPersistentData", &RequestHandler::SetPersistentData},
 	{"GetSceneCollectionList", &RequestHandler::GetSceneCollectionList},
 	{"SetCurrentSceneCollection", &RequestHandler::SetCurrentSceneCollection},
@@ -57,6 +62,9 @@ const std::unordered_map<std::string, RequestMethodHandler> RequestHandler::_han
 	{"GetSourceActive", &RequestHandler::GetSourceActive},
 	{"GetSourceScreenshot", &RequestHandler::GetSourceScreenshot},
 	{"SaveSourceScreenshot", &RequestHandler::SaveSourceScreenshot},
+	{"StartSourceFrameStream", &RequestHandler::StartSourceFrameStream},
+	{"StartSourceFrameExport", &RequestHandler::StartSourceFrameExport},
+	{"StopSourceFrameStream", &RequestHandler::StopSourceFrameStream},
 	{"GetSourcePrivateSettings", &RequestHandler::GetSourcePrivateSettings},
 	{"SetSourcePrivateSettings", &RequestHandler::SetSourcePrivateSettings},
 
@@ -205,9 +213,7 @@ RequestHandler::RequestHandler(SessionPtr session) : _session(session) {}
 
 RequestResult RequestHandler::ProcessRequest(const Request &request)
 {
-#ifdef PLUGIN_TESTS
 	ScopeProfiler prof{"obs_websocket_request_processing"};
-#endif
 
 	if (!request.RequestData.is_object() && !request.RequestData.is_null())
 		return RequestResult::Error(RequestStatus::InvalidRequestFieldType, "Your request data is not an object.");
@@ -223,7 +229,24 @@ RequestResult RequestHandler::ProcessRequest(const Request &request)
 		return RequestResult::Error(RequestStatus::UnknownRequestType, "Your request type is not valid.");
 	}
 
-	return std::bind(handler, this, std::placeholders::_1)(request);
+	// Rate limits and admission control only apply to WebSocket sessions, not to the plugin API
+	if (_session) {
+		auto webSocketServer = GetWebSocketServer();
+		std::string comment;
+		if (webSocketServer && !webSocketServer->AdmitRequest(_session, request.RequestType, comment))
+			return RequestResult::Error(RequestStatus::RateLimited, comment);
+	}
+
+	uint64_t startedAt = os_gettime_ns();
+	RequestResult ret = std::bind(handler, this, std::placeholders::_1)(request);
+
+	auto requestMetrics = GetRequestMetrics();
+	if (requestMetrics) {
+		requestMetrics->Record(request.RequestType, Utils::Metrics::RequestPhase::Handler, os_gettime_ns() - startedAt);
+		requestMetrics->RecordResult(request.RequestType, ret.StatusCode == RequestStatus::Success);
+	}
+
+	return ret;
 }
 
 std::vector<std::string> RequestHandler::GetRequestList()
@@ -234,3 +257,14 @@ std::vector<std::string> RequestHandler::GetRequestList()
 
 	return ret;
 }
+
+// Settings objects can be large, so WebSocket sessions get them serialized straight to their encoding instead of through
+// a json tree. The plugin API has no session, and its responses are read as json.
+json RequestHandler::ObsDataToResponseField(obs_data_t *d, bool includeDefault)
+{
+	if (!_session)
+		return Utils::Json::ObsDataToJson(d, includeDefault);
+
+	bool msgPack = _session->Encoding() == WebSocketServer::WebSocketEncoding::MsgPack;
+	return Utils::Json::ObsDataToFragment(d, msgPack, includeDefault);
+}
@@ -46,6 +46,8 @@ private:
 	// General
 	RequestResult GetVersion(const Request &);
 	RequestResult GetStats(const Request &);
+	RequestResult GetRequestStats(const Request &);
+	RequestResult GetEventStats(const Request &);
 	RequestResult BroadcastCustomEvent(const Request &);
 	RequestResult CallVendorRequest(const Request &);
 	RequestResult GetHotkeyList(const Request &);
@@ -55,6 +57,7 @@ private:
 
 	// Config
 	RequestResult GetPersistentData(const Request &);
+	RequestResult GetPersistentDataBatch(const Request &);
 	RequestResult SetPersistentData(const Request &);
 	RequestResult GetSceneCollectionList(const Request &);
 	RequestResult SetCurrentSceneCollection(const Request &);
@@ -76,6 +79,9 @@ private:
 	RequestResult GetSourceActive(const Request &);
 	RequestResult GetSourceScreenshot(const Request &);
 	RequestResult SaveSourceScreenshot(const Request &);
+	RequestResult StartSourceFrameStream(const Request &);
+	RequestResult StartSourceFrameExport(const Request &);
+	RequestResult StopSourceFrameStream(const Request &);
 	RequestResult GetSourcePrivateSettings(const Request &);
 	RequestResult SetSourcePrivateSettings(const Request &);
 
@@ -219,6 +225,8 @@ private:
 	RequestResult OpenVideoMixProjector(const Request &);
 	RequestResult OpenSourceProjector(const Request &);
 
+	json ObsDataToResponseField(obs_data_t *d, bool includeDefault = false);
+
 	SessionPtr _session;
 	static const std::unordered_map<std::string, RequestMethodHandler> _handlerMap;
 };
@@ -21,9 +21,22 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <util/config-file.h>
 
 #include "RequestHandler.h"
+#include "../utils/PersistentData.h"
 
 #define GLOBAL_PERSISTENT_DATA_FILE_NAME "persistent_data.json"
 
+static bool GetPersistentDataPath(const std::string &realm, std::string &persistentDataPath)
+{
+	if (realm == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
+		persistentDataPath = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
+	else if (realm == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
+		persistentDataPath = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
+	else
+		return false;
+
+	return true;
+}
+
 /**
  * Gets the value of a "slot" from the selected persistent data realm.
  *
@@ -50,20 +63,64 @@ RequestResult RequestHandler::GetPersistentData(const Request &request)
 	std::string slotName = request.RequestData["slotName"];
 
 	std::string persistentDataPath;
-	if (realm == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
-		persistentDataPath = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
-	else if (realm == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
-		persistentDataPath = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
-	else
+	if (!GetPersistentDataPath(realm, persistentDataPath))
 		return RequestResult::Error(RequestStatus::ResourceNotFound,
 					    "You have specified an invalid persistent data realm.");
 
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Persistent data is unavailable.");
+
 	json responseData;
-	json persistentData;
-	if (Utils::Json::GetJsonFileContent(persistentDataPath, persistentData) && persistentData.contains(slotName))
-		responseData["slotValue"] = persistentData[slotName];
-	else
-		responseData["slotValue"] = nullptr;
+	responseData["slotValue"] = persistentDataStore->Get(persistentDataPath, slotName);
+
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Gets the values of multiple "slots" from the selected persistent data realm at once.
+ *
+ * @requestField realm     | String        | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
+ * @requestField slotNames | Array<String> | The names of the slots to retrieve data from
+ *
+ * @responseField slotValues | Object | Object of slot names to their values. Values are `null` for slots which are not set
+ *
+ * @requestType GetPersistentDataBatch
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @category config
+ * @api requests
+ */
+RequestResult RequestHandler::GetPersistentDataBatch(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!(request.ValidateString("realm", statusCode, comment) && request.ValidateArray("slotNames", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	std::string realm = request.RequestData["realm"];
+
+	std::vector<std::string> slotNames;
+	for (auto &slotName : request.RequestData["slotNames"]) {
+		if (!slotName.is_string())
+			return RequestResult::Error(RequestStatus::InvalidRequestFieldType,
+						    "The `slotNames` array must only contain strings.");
+
+		slotNames.push_back(slotName);
+	}
+
+	std::string persistentDataPath;
+	if (!GetPersistentDataPath(realm, persistentDataPath))
+		return RequestResult::Error(RequestStatus::ResourceNotFound,
+					    "You have specified an invalid persistent data realm.");
+
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Persistent data is unavailable.");
+
+	json responseData;
+	responseData["slotValues"] = persistentDataStore->GetMany(persistentDataPath, slotNames);
 
 	return RequestResult::Success(responseData);
 }
@@ -71,6 +128,9 @@ RequestResult RequestHandler::GetPersistentData(const Request &request)
 /**
  * Sets the value of a "slot" from the selected persistent data realm.
  *
+ * The value is available to `GetPersistentData` immediately, and written to disk shortly after. If the last write to the realm's
+ * file failed, the request fails, but the value is still kept and the write retried.
+ *
  * @requestField realm     | String | The data realm to select. `OBS_WEBSOCKET_DATA_REALM_GLOBAL` or `OBS_WEBSOCKET_DATA_REALM_PROFILE`
  * @requestField slotName  | String | The name of the slot to retrieve data from
  * @requestField slotValue | Any    | The value to apply to the slot
@@ -95,18 +155,15 @@ RequestResult RequestHandler::SetPersistentData(const Request &request)
 	json slotValue = request.RequestData["slotValue"];
 
 	std::string persistentDataPath;
-	if (realm == "OBS_WEBSOCKET_DATA_REALM_GLOBAL")
-		persistentDataPath = Utils::Obs::StringHelper::GetModuleConfigPath(GLOBAL_PERSISTENT_DATA_FILE_NAME);
-	else if (realm == "OBS_WEBSOCKET_DATA_REALM_PROFILE")
-		persistentDataPath = Utils::Obs::StringHelper::GetCurrentProfilePath() + "/obsWebSocketPersistentData.json";
-	else
+	if (!GetPersistentDataPath(realm, persistentDataPath))
 		return RequestResult::Error(RequestStatus::ResourceNotFound,
 					    "You have specified an invalid persistent data realm.");
 
-	json persistentData;
-	Utils::Json::GetJsonFileContent(persistentDataPath, persistentData);
-	persistentData[slotName] = slotValue;
-	if (!Utils::Json::SetJsonFileContent(persistentDataPath, persistentData))
+	auto persistentDataStore = GetPersistentDataStore();
+	if (!persistentDataStore)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Persistent data is unavailable.");
+
+	if (!persistentDataStore->Set(persistentDataPath, slotName, std::move(slotValue)))
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
 					    "Unable to write persistent data. No permissions?");
 
@@ -544,7 +601,7 @@ RequestResult RequestHandler::GetStreamServiceSettings(const Request &)
 	OBSService service = obs_frontend_get_streaming_service();
 	responseData["streamServiceType"] = obs_service_get_type(service);
 	OBSDataAutoRelease serviceSettings = obs_service_get_settings(service);
-	responseData["streamServiceSettings"] = Utils::Json::ObsDataToJson(serviceSettings, true);
+	responseData["streamServiceSettings"] = ObsDataToResponseField(serviceSettings, true);
 
 	return RequestResult::Success(responseData);
 }
@@ -100,7 +100,7 @@ RequestResult RequestHandler::GetSourceFilterDefaultSettings(const Request &requ
 		return RequestResult::Error(RequestStatus::InvalidFilterKind);
 
 	json responseData;
-	responseData["defaultFilterSettings"] = Utils::Json::ObsDataToJson(defaultSettings, true);
+	responseData["defaultFilterSettings"] = ObsDataToResponseField(defaultSettings, true);
 	return RequestResult::Success(responseData);
 }
 
@@ -254,7 +254,7 @@ RequestResult RequestHandler::GetSourceFilter(const Request &request)
 	responseData["filterKind"] = obs_source_get_id(pair.filter);
 
 	OBSDataAutoRelease filterSettings = obs_source_get_settings(pair.filter);
-	responseData["filterSettings"] = Utils::Json::ObsDataToJson(filterSettings);
+	responseData["filterSettings"] = ObsDataToResponseField(filterSettings);
 
 	return RequestResult::Success(responseData);
 }
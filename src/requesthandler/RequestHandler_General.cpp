@@ -17,14 +17,16 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
-#include <QImageWriter>
 #include <QSysInfo>
 
 #include "RequestHandler.h"
+#include "RequestBatchHandler.h"
 #include "../websocketserver/WebSocketServer.h"
 #include "../eventhandler/types/EventSubscription.h"
 #include "../WebSocketApi.h"
 #include "../obs-websocket.h"
+#include "../utils/Image.h"
+#include "../utils/Metrics.h"
 
 /**
  * Gets data about the current plugin and RPC version.
@@ -52,11 +54,10 @@ RequestResult RequestHandler::GetVersion(const Request &)
 	responseData["rpcVersion"] = OBS_WEBSOCKET_RPC_VERSION;
 	responseData["availableRequests"] = GetRequestList();
 
-	QList<QByteArray> imageWriterFormats = QImageWriter::supportedImageFormats();
-	std::vector<std::string> supportedImageFormats;
-	for (const QByteArray &format : imageWriterFormats) {
-		supportedImageFormats.push_back(format.toStdString());
-	}
+	std::vector<std::string> supportedImageFormats = Utils::Image::GetSupportedFormats();
+	// Uncompressed formats, converted straight from the GPU readback
+	for (const char *format : {"raw_rgba", "raw_bgra", "nv12", "i420"})
+		supportedImageFormats.push_back(format);
 	responseData["supportedImageFormats"] = supportedImageFormats;
 
 	responseData["platform"] = QSysInfo::productType().toStdString();
@@ -68,17 +69,20 @@ RequestResult RequestHandler::GetVersion(const Request &)
 /**
  * Gets statistics about OBS, obs-websocket, and the current session.
  *
- * @responseField cpuUsage                         | Number | Current CPU usage in percent
- * @responseField memoryUsage                      | Number | Amount of memory in MB currently being used by OBS
- * @responseField availableDiskSpace               | Number | Available disk space on the device being used for recording storage
- * @responseField activeFps                        | Number | Current FPS being rendered
- * @responseField averageFrameRenderTime           | Number | Average time in milliseconds that OBS is taking to render a frame
- * @responseField renderSkippedFrames              | Number | Number of frames skipped by OBS in the render thread
- * @responseField renderTotalFrames                | Number | Total number of frames outputted by the render thread
- * @responseField outputSkippedFrames              | Number | Number of frames skipped by OBS in the output thread
- * @responseField outputTotalFrames                | Number | Total number of frames outputted by the output thread
- * @responseField webSocketSessionIncomingMessages | Number | Total number of messages received by obs-websocket from the client
- * @responseField webSocketSessionOutgoingMessages | Number | Total number of messages sent by obs-websocket to the client
+ * @responseField cpuUsage                            | Number | Current CPU usage in percent
+ * @responseField memoryUsage                         | Number | Amount of memory in MB currently being used by OBS
+ * @responseField availableDiskSpace                  | Number | Available disk space on the device being used for recording storage
+ * @responseField activeFps                           | Number | Current FPS being rendered
+ * @responseField averageFrameRenderTime              | Number | Average time in milliseconds that OBS is taking to render a frame
+ * @responseField renderSkippedFrames                 | Number | Number of frames skipped by OBS in the render thread
+ * @responseField renderTotalFrames                   | Number | Total number of frames outputted by the render thread
+ * @responseField outputSkippedFrames                 | Number | Number of frames skipped by OBS in the output thread
+ * @responseField outputTotalFrames                   | Number | Total number of frames outputted by the output thread
+ * @responseField webSocketSessionIncomingMessages    | Number | Total number of messages received by obs-websocket from the client
+ * @responseField webSocketSessionOutgoingMessages    | Number | Total number of messages sent by obs-websocket to the client
+ * @responseField webSocketSessionRateLimitedRequests | Number | Total number of requests from the client rejected for being over a rate limit
+ * @responseField serialFrameDeferredTicks            | Number | Number of graphics ticks which deferred `SerialFrame` batch requests to the next frame, to stay within `serial_frame_budget_us`
+ * @responseField serialFrameMaxTickTime              | Number | Most time in milliseconds spent processing `SerialFrame` batch requests in a single graphics tick
  *
  * @requestType GetStats
  * @complexity 2
@@ -94,11 +98,99 @@ RequestResult RequestHandler::GetStats(const Request &)
 	if (_session) {
 		responseData["webSocketSessionIncomingMessages"] = _session->IncomingMessages();
 		responseData["webSocketSessionOutgoingMessages"] = _session->OutgoingMessages();
+		responseData["webSocketSessionRateLimitedRequests"] = _session->RateLimitedRequests();
 	} else {
 		responseData["webSocketSessionIncomingMessages"] = nullptr;
 		responseData["webSocketSessionOutgoingMessages"] = nullptr;
+		responseData["webSocketSessionRateLimitedRequests"] = nullptr;
+	}
+
+	auto serialFrameStats = RequestBatchHandler::GetSerialFrameStats();
+	responseData["serialFrameDeferredTicks"] = serialFrameStats.deferredTicks;
+	responseData["serialFrameMaxTickTime"] = (double)serialFrameStats.maxTickCostNs / 1000000.0;
+
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Gets latency statistics for each request type which has been used since obs-websocket was loaded, or since the last reset.
+ *
+ * Each request type has `requests` and `failedRequests` counts, and the latency objects `queueWait`, `decode`, `handler` and `encodeSend`.
+ * Latency objects contain `count`, then `mean`, `p50`, `p90`, `p99` and `max` in microseconds. Percentiles are accurate to 12.5%.
+ *
+ * `handler` covers every request, including batched and plugin API requests. The other phases only cover single requests from WebSocket clients.
+ *
+ * @requestField ?reset | Boolean | Whether to reset all statistics after taking this snapshot | None | false
+ *
+ * @responseField requestStats | Object | Object of request types to their statistics
+ *
+ * @requestType GetRequestStats
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::GetRequestStats(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	bool reset = false;
+	if (request.Contains("reset")) {
+		if (!request.ValidateOptionalBoolean("reset", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+		reset = request.RequestData["reset"];
 	}
 
+	auto requestMetrics = GetRequestMetrics();
+	if (!requestMetrics)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Request statistics are not available.");
+
+	json responseData;
+	responseData["requestStats"] = requestMetrics->Snapshot(reset);
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Gets statistics for each event type which has been emitted since obs-websocket was loaded, or since the last reset.
+ *
+ * Each event type has these counts:
+ * - `emitted`: events emitted
+ * - `recipients`: messages sent to sessions
+ * - `jsonBytes` and `msgPackBytes`: total bytes sent to sessions of each encoding
+ *
+ * Each event type also has `dispatch`, which times from the event being emitted to its last send to a session. It has the same fields as the latency objects of `GetRequestStats`, and only covers events with at least one recipient.
+ *
+ * Binary volume meter frames are not included.
+ *
+ * @requestField ?reset | Boolean | Whether to reset all statistics after taking this snapshot | None | false
+ *
+ * @responseField eventStats | Object | Object of event types to their statistics
+ *
+ * @requestType GetEventStats
+ * @complexity 3
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @category general
+ * @api requests
+ */
+RequestResult RequestHandler::GetEventStats(const Request &request)
+{
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	bool reset = false;
+	if (request.Contains("reset")) {
+		if (!request.ValidateOptionalBoolean("reset", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+		reset = request.RequestData["reset"];
+	}
+
+	auto eventMetrics = GetEventMetrics();
+	if (!eventMetrics)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Event statistics are not available.");
+
+	json responseData;
+	responseData["eventStats"] = eventMetrics->Snapshot(reset);
 	return RequestResult::Success(responseData);
 }
 
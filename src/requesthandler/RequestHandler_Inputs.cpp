@@ -288,7 +288,7 @@ RequestResult RequestHandler::GetInputDefaultSettings(const Request &request)
 		return RequestResult::Error(RequestStatus::InvalidInputKind);
 
 	json responseData;
-	responseData["defaultInputSettings"] = Utils::Json::ObsDataToJson(defaultSettings, true);
+	responseData["defaultInputSettings"] = ObsDataToResponseField(defaultSettings, true);
 	return RequestResult::Success(responseData);
 }
 
@@ -321,7 +321,7 @@ RequestResult RequestHandler::GetInputSettings(const Request &request)
 	OBSDataAutoRelease inputSettings = obs_source_get_settings(input);
 
 	json responseData;
-	responseData["inputSettings"] = Utils::Json::ObsDataToJson(inputSettings);
+	responseData["inputSettings"] = ObsDataToResponseField(inputSettings);
 	responseData["inputKind"] = obs_source_get_id(input);
 	return RequestResult::Success(responseData);
 }
@@ -329,10 +329,17 @@ RequestResult RequestHandler::GetInputSettings(const Request &request)
 /**
  * Sets the settings of an input.
  *
- * @requestField ?inputName    | String  | Name of the input to set the settings of
- * @requestField ?inputUuid    | String  | UUID of the input to set the settings of
- * @requestField inputSettings | Object  | Object of settings to apply
- * @requestField ?overlay      | Boolean | True == apply the settings on top of existing ones, False == reset the input to its defaults, then apply settings. | true
+ * Updating an input can be expensive, like a browser source reloading its page or a capture restarting.
+ * With `skipUnchanged`, the settings are compared to the current ones first. Only the settings which differ are applied,
+ * and the input is not updated at all if nothing differs.
+ *
+ * @requestField ?inputName     | String  | Name of the input to set the settings of
+ * @requestField ?inputUuid     | String  | UUID of the input to set the settings of
+ * @requestField inputSettings  | Object  | Object of settings to apply
+ * @requestField ?overlay       | Boolean | True == apply the settings on top of existing ones, False == reset the input to its defaults, then apply settings. | true
+ * @requestField ?skipUnchanged | Boolean | Whether to only apply settings which differ from the current ones                                                 | false
+ *
+ * @responseField settingsChanged | Boolean | Whether the input was updated. Always true unless `skipUnchanged` is used
  *
  * @requestType SetInputSettings
  * @complexity 3
@@ -357,8 +364,41 @@ RequestResult RequestHandler::SetInputSettings(const Request &request)
 		overlay = request.RequestData["overlay"];
 	}
 
+	bool skipUnchanged = false;
+	if (request.Contains("skipUnchanged")) {
+		if (!request.ValidateOptionalBoolean("skipUnchanged", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		skipUnchanged = request.RequestData["skipUnchanged"];
+	}
+
+	const json &inputSettings = request.RequestData["inputSettings"];
+	json changedSettings;
+	if (skipUnchanged) {
+		OBSDataAutoRelease currentSettings = obs_source_get_settings(input);
+		if (overlay) {
+			// Compared against effective values, so that setting a default value which is not overridden is a no-op.
+			// Nested objects are replaced as a whole by `obs_source_update()`, so they are compared as a whole too.
+			json currentJson = Utils::Json::ObsDataToJson(currentSettings, true);
+			changedSettings = json::object();
+			for (auto &[key, value] : inputSettings.items()) {
+				auto currentValue = currentJson.find(key);
+				if (currentValue == currentJson.end() || *currentValue != value)
+					changedSettings[key] = value;
+			}
+		} else if (Utils::Json::ObsDataToJson(currentSettings) != inputSettings) {
+			changedSettings = inputSettings;
+		}
+
+		if (changedSettings.is_null() || (overlay && changedSettings.empty())) {
+			json responseData;
+			responseData["settingsChanged"] = false;
+			return RequestResult::Success(responseData);
+		}
+	}
+
 	// Get the new settings and convert it to obs_data_t*
-	OBSDataAutoRelease newSettings = Utils::Json::JsonToObsData(request.RequestData["inputSettings"]);
+	OBSDataAutoRelease newSettings = Utils::Json::JsonToObsData(skipUnchanged ? changedSettings : inputSettings);
 	if (!newSettings)
 		// This should never happen
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed,
@@ -374,7 +414,9 @@ RequestResult RequestHandler::SetInputSettings(const Request &request)
 	// Tells any open source properties windows to perform a UI refresh
 	obs_source_update_properties(input);
 
-	return RequestResult::Success();
+	json responseData;
+	responseData["settingsChanged"] = true;
+	return RequestResult::Success(responseData);
 }
 
 /**
@@ -450,7 +450,7 @@ RequestResult RequestHandler::GetOutputSettings(const Request &request)
 	OBSDataAutoRelease outputSettings = obs_output_get_settings(output);
 
 	json responseData;
-	responseData["outputSettings"] = Utils::Json::ObsDataToJson(outputSettings);
+	responseData["outputSettings"] = ObsDataToResponseField(outputSettings);
 	return RequestResult::Success(responseData);
 }
 
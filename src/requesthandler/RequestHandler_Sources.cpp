@@ -17,23 +17,45 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
-#include <QBuffer>
-#include <QImageWriter>
+#include <QFile>
 #include <QFileInfo>
 #include <QImage>
 #include <QDir>
 
 #include "RequestHandler.h"
+#include "../websocketserver/WebSocketServer.h"
+#include "../utils/Obs_FrameReadback.h"
+#include "../utils/Obs_FrameStream.h"
+#include "../utils/Image.h"
 
-QImage TakeSourceScreenshot(obs_source_t *source, bool &success, uint32_t requestedWidth = 0, uint32_t requestedHeight = 0)
+// Maximum time to wait for the graphics thread to deliver a screenshot, in milliseconds
+#define SCREENSHOT_READBACK_TIMEOUT 5000
+
+// Encodes on the server's bounded encode pool. The request worker only waits on it, so its thread is released to the request
+// pool meanwhile, and a burst of screenshots cannot starve other requests.
+static bool EncodeScreenshot(const QImage &image, const std::string &format, int quality, std::vector<uint8_t> &out)
+{
+	auto webSocketServer = GetWebSocketServer();
+	if (!webSocketServer)
+		return Utils::Image::Encode(image, format, quality, out);
+
+	QThreadPool *requestPool = webSocketServer->GetThreadPool();
+	requestPool->releaseThread();
+	bool ret = Utils::Image::Encode(image, format, quality, out, webSocketServer->GetEncodeThreadPool());
+	requestPool->reserveThread();
+	return ret;
+}
+
+void GetScreenshotSize(obs_source_t *source, uint32_t requestedWidth, uint32_t requestedHeight, uint32_t &imgWidth,
+		       uint32_t &imgHeight)
 {
 	// Get info about the requested source
 	const uint32_t sourceWidth = obs_source_get_width(source);
 	const uint32_t sourceHeight = obs_source_get_height(source);
 	const double sourceAspectRatio = ((double)sourceWidth / (double)sourceHeight);
 
-	uint32_t imgWidth = sourceWidth;
-	uint32_t imgHeight = sourceHeight;
+	imgWidth = sourceWidth;
+	imgHeight = sourceHeight;
 
 	// Determine suitable image width
 	if (requestedWidth) {
@@ -50,63 +72,55 @@ QImage TakeSourceScreenshot(obs_source_t *source, bool &success, uint32_t reques
 		if (!requestedWidth)
 			imgWidth = ((double)imgHeight * sourceAspectRatio);
 	}
+}
+
+QImage TakeSourceScreenshot(obs_source_t *source, bool &success, uint32_t requestedWidth = 0, uint32_t requestedHeight = 0)
+{
+	uint32_t imgWidth;
+	uint32_t imgHeight;
+	GetScreenshotSize(source, requestedWidth, requestedHeight, imgWidth, imgHeight);
+
+	success = false;
 
-	// Create final image texture
-	QImage ret(imgWidth, imgHeight, QImage::Format::Format_RGBA8888);
-	ret.fill(0);
+	auto frameReadbackHandler = GetFrameReadbackHandler();
+	if (!frameReadbackHandler)
+		return QImage();
 
-	// Video image buffer
-	uint8_t *videoData = nullptr;
-	uint32_t videoLinesize = 0;
+	// The render and readback happen on the graphics tick, so the render loop is never stalled by the copy
+	std::future<QImage> frame = frameReadbackHandler->RequestFrame(source, imgWidth, imgHeight);
+	if (frame.wait_for(std::chrono::milliseconds(SCREENSHOT_READBACK_TIMEOUT)) != std::future_status::ready)
+		return QImage();
 
-	// Enter graphics context
-	obs_enter_graphics();
+	QImage ret = frame.get();
+	success = !ret.isNull();
+	return ret;
+}
 
-	gs_texrender_t *texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
-	gs_stagesurf_t *stageSurface = gs_stagesurface_create(imgWidth, imgHeight, GS_RGBA);
+// Raw formats are converted straight from the mapped staging surface, without going through QImage
+std::vector<uint8_t> TakeSourceRawScreenshot(obs_source_t *source, Utils::Obs::FrameReadback::PixelFormat format, bool &success,
+					     uint32_t &imgWidth, uint32_t &imgHeight, uint32_t requestedWidth = 0,
+					     uint32_t requestedHeight = 0)
+{
+	GetScreenshotSize(source, requestedWidth, requestedHeight, imgWidth, imgHeight);
 
 	success = false;
-	gs_texrender_reset(texRender);
-	if (gs_texrender_begin(texRender, imgWidth, imgHeight)) {
-		vec4 background;
-		vec4_zero(&background);
-
-		gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
-		gs_ortho(0.0f, (float)sourceWidth, 0.0f, (float)sourceHeight, -100.0f, 100.0f);
-
-		gs_blend_state_push();
-		gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
-
-		obs_source_inc_showing(source);
-		obs_source_video_render(source);
-		obs_source_dec_showing(source);
-
-		gs_blend_state_pop();
-		gs_texrender_end(texRender);
-
-		gs_stage_texture(stageSurface, gs_texrender_get_texture(texRender));
-		if (gs_stagesurface_map(stageSurface, &videoData, &videoLinesize)) {
-			int lineSize = ret.bytesPerLine();
-			for (uint y = 0; y < imgHeight; y++) {
-				memcpy(ret.scanLine(y), videoData + (y * videoLinesize), lineSize);
-			}
-			gs_stagesurface_unmap(stageSurface);
-			success = true;
-		}
-	}
 
-	gs_stagesurface_destroy(stageSurface);
-	gs_texrender_destroy(texRender);
+	auto frameReadbackHandler = GetFrameReadbackHandler();
+	if (!frameReadbackHandler)
+		return {};
 
-	obs_leave_graphics();
+	std::future<std::vector<uint8_t>> frame = frameReadbackHandler->RequestRawFrame(source, imgWidth, imgHeight, format);
+	if (frame.wait_for(std::chrono::milliseconds(SCREENSHOT_READBACK_TIMEOUT)) != std::future_status::ready)
+		return {};
 
+	std::vector<uint8_t> ret = frame.get();
+	success = !ret.empty();
 	return ret;
 }
 
 bool IsImageFormatValid(std::string format)
 {
-	QByteArrayList supportedFormats = QImageWriter::supportedImageFormats();
-	return supportedFormats.contains(format.c_str());
+	return Utils::Image::IsFormatSupported(format);
 }
 
 /**
@@ -150,6 +164,13 @@ RequestResult RequestHandler::GetSourceActive(const Request &request)
  * The `imageWidth` and `imageHeight` parameters are treated as "scale to inner", meaning the smallest ratio will be used and the aspect ratio of the original resolution is kept.
  * If `imageWidth` and `imageHeight` are not specified, the compressed image will use the full resolution of the source.
  *
+ * The `raw_rgba`, `raw_bgra`, `nv12` and `i420` formats return uncompressed pixels, converted straight from the GPU readback.
+ * `nv12` and `i420` use BT.709 limited range, with chroma planes of half the width and height (rounded up).
+ *
+ * If `imageDataEncoding` is `binary`, the encoded image is not converted to Base64.
+ * MsgPack sessions receive `imageData` as a MsgPack `bin` value. Json sessions receive `imageData` as an object `{"binaryAttachmentId": Number, "size": Number}`,
+ * and the image follows the response as a binary attachment frame with the same `binaryAttachmentId`.
+ *
  * **Compatible with inputs and scenes.**
  *
  * @requestField ?sourceName              | String | Name of the source to take a screenshot of
@@ -158,8 +179,11 @@ RequestResult RequestHandler::GetSourceActive(const Request &request)
  * @requestField ?imageWidth              | Number | Width to scale the screenshot to                                                                                         | >= 8, <= 4096 | Source value is used
  * @requestField ?imageHeight             | Number | Height to scale the screenshot to                                                                                        | >= 8, <= 4096 | Source value is used
  * @requestField ?imageCompressionQuality | Number | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" (whatever that means, idk) | >= -1, <= 100 | -1
+ * @requestField ?imageDataEncoding       | String | How to return the image data. `dataUri` or `binary`                                                                      | None          | `dataUri`
  *
- * @responseField imageData | String | Base64-encoded screenshot
+ * @responseField imageData    | Any    | Base64-encoded screenshot, or the raw encoded image with `binary` encoding
+ * @responseField ?imageWidth  | Number | Width of the screenshot. Only present for raw formats
+ * @responseField ?imageHeight | Number | Height of the screenshot. Only present for raw formats
  *
  * @requestType GetSourceScreenshot
  * @complexity 4
@@ -180,8 +204,9 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
 		return RequestResult::Error(RequestStatus::InvalidResourceType, "The specified source is not an input or a scene.");
 
 	std::string imageFormat = request.RequestData["imageFormat"];
+	auto pixelFormat = Utils::Obs::FrameReadback::GetPixelFormat(imageFormat);
 
-	if (!IsImageFormatValid(imageFormat))
+	if (pixelFormat == Utils::Obs::FrameReadback::PixelFormat::None && !IsImageFormatValid(imageFormat))
 		return RequestResult::Error(RequestStatus::InvalidRequestField,
 					    "Your specified image format is invalid or not supported by this system.");
 
@@ -210,21 +235,65 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
 		compressionQuality = request.RequestData["imageCompressionQuality"];
 	}
 
+	bool binaryImageData = false;
+	if (request.Contains("imageDataEncoding")) {
+		if (!request.ValidateOptionalString("imageDataEncoding", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		std::string imageDataEncoding = request.RequestData["imageDataEncoding"];
+		if (imageDataEncoding == "binary")
+			binaryImageData = true;
+		else if (imageDataEncoding != "dataUri")
+			return RequestResult::Error(RequestStatus::InvalidRequestField,
+						    "Your specified image data encoding must be `dataUri` or `binary`.");
+	}
+
+	// Binary values can not be converted to obs_data for the plugin API
+	if (binaryImageData && !_session)
+		return RequestResult::Error(RequestStatus::InvalidRequestField,
+					    "The `binary` image data encoding is only available to WebSocket clients.");
+
 	bool success;
+
+	if (pixelFormat != Utils::Obs::FrameReadback::PixelFormat::None) {
+		uint32_t imgWidth;
+		uint32_t imgHeight;
+		std::vector<uint8_t> rawImgData = TakeSourceRawScreenshot(source, pixelFormat, success, imgWidth, imgHeight,
+									  requestedWidth, requestedHeight);
+
+		if (!success)
+			return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
+
+		json responseData;
+		if (binaryImageData) {
+			responseData["imageData"] = json::binary(std::move(rawImgData));
+		} else {
+			QByteArray rawImgBytes = QByteArray::fromRawData((const char *)rawImgData.data(), rawImgData.size());
+			QString encodedPicture = QString("data:application/octet-stream;base64,").append(rawImgBytes.toBase64());
+			responseData["imageData"] = encodedPicture.toStdString();
+		}
+		responseData["imageWidth"] = imgWidth;
+		responseData["imageHeight"] = imgHeight;
+		return RequestResult::Success(std::move(responseData));
+	}
+
 	QImage renderedImage = TakeSourceScreenshot(source, success, requestedWidth, requestedHeight);
 
 	if (!success)
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
 
-	QByteArray encodedImgBytes;
-	QBuffer buffer(&encodedImgBytes);
-	buffer.open(QBuffer::WriteOnly);
-
-	if (!renderedImage.save(&buffer, imageFormat.c_str(), compressionQuality))
+	// Encoded directly into the buffer which is moved into the response, and serialized from there
+	std::vector<uint8_t> encodedImgData;
+	if (!EncodeScreenshot(renderedImage, imageFormat, compressionQuality, encodedImgData))
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to encode screenshot.");
 
-	buffer.close();
+	if (binaryImageData) {
+		json responseData;
+		responseData["imageData"] = json::binary(std::move(encodedImgData));
+		return RequestResult::Success(std::move(responseData));
+	}
 
+	QByteArray encodedImgBytes = QByteArray::fromRawData((const char *)encodedImgData.data(), encodedImgData.size());
 	QString encodedPicture = QString("data:image/%1;base64,").arg(imageFormat.c_str()).append(encodedImgBytes.toBase64());
 
 	json responseData;
@@ -238,6 +307,8 @@ RequestResult RequestHandler::GetSourceScreenshot(const Request &request)
  * The `imageWidth` and `imageHeight` parameters are treated as "scale to inner", meaning the smallest ratio will be used and the aspect ratio of the original resolution is kept.
  * If `imageWidth` and `imageHeight` are not specified, the compressed image will use the full resolution of the source.
  *
+ * Raw formats (`raw_rgba`, `raw_bgra`, `nv12`, `i420`) are written as headerless pixel data.
+ *
  * **Compatible with inputs and scenes.**
  *
  * @requestField ?sourceName              | String | Name of the source to take a screenshot of
@@ -269,8 +340,9 @@ RequestResult RequestHandler::SaveSourceScreenshot(const Request &request)
 
 	std::string imageFormat = request.RequestData["imageFormat"];
 	std::string imageFilePath = request.RequestData["imageFilePath"];
+	auto pixelFormat = Utils::Obs::FrameReadback::GetPixelFormat(imageFormat);
 
-	if (!IsImageFormatValid(imageFormat))
+	if (pixelFormat == Utils::Obs::FrameReadback::PixelFormat::None && !IsImageFormatValid(imageFormat))
 		return RequestResult::Error(RequestStatus::InvalidRequestField,
 					    "Your specified image format is invalid or not supported by this system.");
 
@@ -304,19 +376,294 @@ RequestResult RequestHandler::SaveSourceScreenshot(const Request &request)
 	}
 
 	bool success;
+	QString absoluteFilePath = filePathInfo.absoluteFilePath();
+
+	if (pixelFormat != Utils::Obs::FrameReadback::PixelFormat::None) {
+		uint32_t imgWidth;
+		uint32_t imgHeight;
+		std::vector<uint8_t> rawImgData = TakeSourceRawScreenshot(source, pixelFormat, success, imgWidth, imgHeight,
+									  requestedWidth, requestedHeight);
+
+		if (!success)
+			return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
+
+		QFile file(absoluteFilePath);
+		if (!file.open(QIODevice::WriteOnly) ||
+		    file.write((const char *)rawImgData.data(), rawImgData.size()) != (qint64)rawImgData.size())
+			return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to save screenshot.");
+
+		return RequestResult::Success();
+	}
+
 	QImage renderedImage = TakeSourceScreenshot(source, success, requestedWidth, requestedHeight);
 
 	if (!success)
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to render screenshot.");
 
-	QString absoluteFilePath = filePathInfo.absoluteFilePath();
+	std::vector<uint8_t> encodedImgData;
+	if (!EncodeScreenshot(renderedImage, imageFormat, compressionQuality, encodedImgData))
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to encode screenshot.");
 
-	if (!renderedImage.save(absoluteFilePath, imageFormat.c_str(), compressionQuality))
+	QFile file(absoluteFilePath);
+	if (!file.open(QIODevice::WriteOnly) ||
+	    file.write((const char *)encodedImgData.data(), encodedImgData.size()) != (qint64)encodedImgData.size())
 		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to save screenshot.");
 
 	return RequestResult::Success();
 }
 
+/**
+ * Starts streaming frames of a source to this client as binary messages.
+ *
+ * Each frame is sent as a binary WebSocket message, made of a 24 byte little-endian header followed by the encoded image:
+ * `char[4] magic ("OWFS")`, `uint16 version (1)`, `uint16 reserved`, `uint32 streamId`, `uint32 frameSequence`, `uint64 timestamp (ns)`.
+ *
+ * Clients watching the same source with the same size, format and quality share a single render and encode, and receive the same `streamId`.
+ * Starting a stream which this client already watches only updates its frame rate.
+ *
+ * The `imageWidth` and `imageHeight` parameters behave the same as with `GetSourceScreenshot`.
+ *
+ * Streams are stopped automatically when the client disconnects. Only available to WebSocket clients.
+ *
+ * **Compatible with inputs and scenes.**
+ *
+ * @requestField ?sourceName              | String | Name of the source to stream
+ * @requestField ?sourceUuid              | String | UUID of the source to stream
+ * @requestField imageFormat              | String | Image compression format to use. Use `GetVersion` to get compatible image formats
+ * @requestField ?imageWidth              | Number | Width to scale the frames to                                                           | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageHeight             | Number | Height to scale the frames to                                                          | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageCompressionQuality | Number | Compression quality to use. 0 for high compression, 100 for uncompressed. -1 to use "default" | >= -1, <= 100 | -1
+ * @requestField ?frameRate               | Number | Maximum number of frames per second to receive                                         | >= 1, <= 30   | 5
+ *
+ * @responseField streamId    | Number | ID of the stream, found in the header of every frame
+ * @responseField imageWidth  | Number | Width of the streamed frames
+ * @responseField imageHeight | Number | Height of the streamed frames
+ *
+ * @requestType StartSourceFrameStream
+ * @complexity 4
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @api requests
+ * @category sources
+ */
+RequestResult RequestHandler::StartSourceFrameStream(const Request &request)
+{
+	if (!_session)
+		return RequestResult::Error(RequestStatus::InvalidResourceState,
+					    "Frame streams are only available to WebSocket clients.");
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSourceAutoRelease source = request.ValidateSource("sourceName", "sourceUuid", statusCode, comment);
+	if (!(source && request.ValidateString("imageFormat", statusCode, comment)))
+		return RequestResult::Error(statusCode, comment);
+
+	if (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT && obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE)
+		return RequestResult::Error(RequestStatus::InvalidResourceType, "The specified source is not an input or a scene.");
+
+	std::string imageFormat = request.RequestData["imageFormat"];
+
+	if (Utils::Obs::FrameReadback::GetPixelFormat(imageFormat) == Utils::Obs::FrameReadback::PixelFormat::None &&
+	    !IsImageFormatValid(imageFormat))
+		return RequestResult::Error(RequestStatus::InvalidRequestField,
+					    "Your specified image format is invalid or not supported by this system.");
+
+	uint32_t requestedWidth{0};
+	uint32_t requestedHeight{0};
+	int compressionQuality{-1};
+	int frameRate{5};
+
+	if (request.Contains("imageWidth")) {
+		if (!request.ValidateOptionalNumber("imageWidth", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		requestedWidth = request.RequestData["imageWidth"];
+	}
+
+	if (request.Contains("imageHeight")) {
+		if (!request.ValidateOptionalNumber("imageHeight", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		requestedHeight = request.RequestData["imageHeight"];
+	}
+
+	if (request.Contains("imageCompressionQuality")) {
+		if (!request.ValidateOptionalNumber("imageCompressionQuality", statusCode, comment, -1, 100))
+			return RequestResult::Error(statusCode, comment);
+
+		compressionQuality = request.RequestData["imageCompressionQuality"];
+	}
+
+	if (request.Contains("frameRate")) {
+		if (!request.ValidateOptionalNumber("frameRate", statusCode, comment, 1, 30))
+			return RequestResult::Error(statusCode, comment);
+
+		frameRate = request.RequestData["frameRate"];
+	}
+
+	uint32_t imgWidth;
+	uint32_t imgHeight;
+	GetScreenshotSize(source, requestedWidth, requestedHeight, imgWidth, imgHeight);
+	if (!imgWidth || !imgHeight)
+		return RequestResult::Error(RequestStatus::InvalidResourceState, "The specified source has no size.");
+
+	auto frameStreamHandler = GetFrameStreamHandler();
+	if (!frameStreamHandler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Frame streams are unavailable.");
+
+	uint32_t streamId = frameStreamHandler->Subscribe(_session->Id(), source, imgWidth, imgHeight, imageFormat,
+							  compressionQuality, 1000 / frameRate);
+
+	json responseData;
+	responseData["streamId"] = streamId;
+	responseData["imageWidth"] = imgWidth;
+	responseData["imageHeight"] = imgHeight;
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Starts exporting raw frames of a source into a shared memory region, for high frame rate consumers on the same machine.
+ *
+ * Frames are converted straight into a ring of slots in the region, and the client only receives a 24 byte binary notification per frame.
+ * See the "Shared Memory Frame Exports" section of the protocol documentation for the layout of the region.
+ *
+ * Clients exporting the same source with the same size and format share a single region, and receive the same `streamId`.
+ * Exports are stopped with `StopSourceFrameStream`, and automatically when the client disconnects. Only available to WebSocket clients.
+ *
+ * **Compatible with inputs and scenes.**
+ *
+ * @requestField ?sourceName  | String | Name of the source to export
+ * @requestField ?sourceUuid  | String | UUID of the source to export
+ * @requestField ?imageFormat | String | Raw pixel format to export. One of `raw_rgba`, `raw_bgra`, `nv12` or `i420` | None | `raw_rgba`
+ * @requestField ?imageWidth  | Number | Width to scale the frames to                                                | >= 8, <= 4096 | Source value is used
+ * @requestField ?imageHeight | Number | Height to scale the frames to                                               | >= 8, <= 4096 | Source value is used
+ * @requestField ?frameRate   | Number | Maximum number of frames per second to export                               | >= 1, <= 60   | 30
+ *
+ * @responseField streamId         | Number | ID of the export, found in the header of every notification
+ * @responseField sharedMemoryName | String | Name of the shared memory region, to be passed to `shm_open()` (or `OpenFileMapping()` on Windows)
+ * @responseField sharedMemorySize | Number | Size of the shared memory region, in bytes
+ * @responseField imageWidth       | Number | Width of the exported frames
+ * @responseField imageHeight      | Number | Height of the exported frames
+ *
+ * @requestType StartSourceFrameExport
+ * @complexity 5
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @api requests
+ * @category sources
+ */
+RequestResult RequestHandler::StartSourceFrameExport(const Request &request)
+{
+	if (!_session)
+		return RequestResult::Error(RequestStatus::InvalidResourceState,
+					    "Frame exports are only available to WebSocket clients.");
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	OBSSourceAutoRelease source = request.ValidateSource("sourceName", "sourceUuid", statusCode, comment);
+	if (!source)
+		return RequestResult::Error(statusCode, comment);
+
+	if (obs_source_get_type(source) != OBS_SOURCE_TYPE_INPUT && obs_source_get_type(source) != OBS_SOURCE_TYPE_SCENE)
+		return RequestResult::Error(RequestStatus::InvalidResourceType, "The specified source is not an input or a scene.");
+
+	std::string imageFormat = "raw_rgba";
+	uint32_t requestedWidth{0};
+	uint32_t requestedHeight{0};
+	int frameRate{30};
+
+	if (request.Contains("imageFormat")) {
+		if (!request.ValidateOptionalString("imageFormat", statusCode, comment))
+			return RequestResult::Error(statusCode, comment);
+
+		imageFormat = request.RequestData["imageFormat"];
+		if (Utils::Obs::FrameReadback::GetPixelFormat(imageFormat) == Utils::Obs::FrameReadback::PixelFormat::None)
+			return RequestResult::Error(RequestStatus::InvalidRequestField,
+						    "Frame exports only support the `raw_rgba`, `raw_bgra`, `nv12` and `i420` formats.");
+	}
+
+	if (request.Contains("imageWidth")) {
+		if (!request.ValidateOptionalNumber("imageWidth", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		requestedWidth = request.RequestData["imageWidth"];
+	}
+
+	if (request.Contains("imageHeight")) {
+		if (!request.ValidateOptionalNumber("imageHeight", statusCode, comment, 8, 4096))
+			return RequestResult::Error(statusCode, comment);
+
+		requestedHeight = request.RequestData["imageHeight"];
+	}
+
+	if (request.Contains("frameRate")) {
+		if (!request.ValidateOptionalNumber("frameRate", statusCode, comment, 1, 60))
+			return RequestResult::Error(statusCode, comment);
+
+		frameRate = request.RequestData["frameRate"];
+	}
+
+	uint32_t imgWidth;
+	uint32_t imgHeight;
+	GetScreenshotSize(source, requestedWidth, requestedHeight, imgWidth, imgHeight);
+	if (!imgWidth || !imgHeight)
+		return RequestResult::Error(RequestStatus::InvalidResourceState, "The specified source has no size.");
+
+	auto frameStreamHandler = GetFrameStreamHandler();
+	if (!frameStreamHandler)
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Frame exports are unavailable.");
+
+	uint32_t streamId =
+		frameStreamHandler->Subscribe(_session->Id(), source, imgWidth, imgHeight, imageFormat, -1, 1000 / frameRate, true);
+
+	std::string sharedMemoryName;
+	size_t sharedMemorySize;
+	if (!streamId || !frameStreamHandler->GetSharedMemoryInfo(streamId, sharedMemoryName, sharedMemorySize))
+		return RequestResult::Error(RequestStatus::RequestProcessingFailed, "Failed to create the shared memory region.");
+
+	json responseData;
+	responseData["streamId"] = streamId;
+	responseData["sharedMemoryName"] = sharedMemoryName;
+	responseData["sharedMemorySize"] = sharedMemorySize;
+	responseData["imageWidth"] = imgWidth;
+	responseData["imageHeight"] = imgHeight;
+	return RequestResult::Success(responseData);
+}
+
+/**
+ * Stops streaming frames of a source to this client, or exporting them for it.
+ *
+ * The stream keeps running for other clients which are still watching it.
+ *
+ * @requestField streamId | Number | ID of the stream, from `StartSourceFrameStream` or `StartSourceFrameExport` | >= 1
+ *
+ * @requestType StopSourceFrameStream
+ * @complexity 2
+ * @rpcVersion -1
+ * @initialVersion 5.6.0
+ * @api requests
+ * @category sources
+ */
+RequestResult RequestHandler::StopSourceFrameStream(const Request &request)
+{
+	if (!_session)
+		return RequestResult::Error(RequestStatus::InvalidResourceState,
+					    "Frame streams are only available to WebSocket clients.");
+
+	RequestStatus::RequestStatus statusCode;
+	std::string comment;
+	if (!request.ValidateNumber("streamId", statusCode, comment, 1))
+		return RequestResult::Error(statusCode, comment);
+
+	uint32_t streamId = request.RequestData["streamId"];
+
+	auto frameStreamHandler = GetFrameStreamHandler();
+	if (!frameStreamHandler || !frameStreamHandler->Unsubscribe(_session->Id(), streamId))
+		return RequestResult::Error(RequestStatus::ResourceNotFound, "You are not watching a frame stream with that ID.");
+
+	return RequestResult::Success();
+}
+
 // Intentionally undocumented
 RequestResult RequestHandler::GetSourcePrivateSettings(const Request &request)
 {
@@ -118,7 +118,7 @@ RequestResult RequestHandler::GetCurrentSceneTransition(const Request &)
 	if (obs_source_configurable(transition)) {
 		responseData["transitionConfigurable"] = true;
 		OBSDataAutoRelease transitionSettings = obs_source_get_settings(transition);
-		responseData["transitionSettings"] = Utils::Json::ObsDataToJson(transitionSettings);
+		responseData["transitionSettings"] = ObsDataToResponseField(transitionSettings);
 	} else {
 		responseData["transitionConfigurable"] = false;
 		responseData["transitionSettings"] = nullptr;
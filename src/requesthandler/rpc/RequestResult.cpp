@@ -21,7 +21,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 RequestResult::RequestResult(RequestStatus::RequestStatus statusCode, json responseData, std::string comment)
 	: StatusCode(statusCode),
-	  ResponseData(responseData),
+	  ResponseData(std::move(responseData)),
 	  Comment(comment),
 	  SleepFrames(0)
 {
@@ -29,7 +29,7 @@ RequestResult::RequestResult(RequestStatus::RequestStatus statusCode, json respo
 
 RequestResult RequestResult::Success(json responseData)
 {
-	return RequestResult(RequestStatus::Success, responseData, "");
+	return RequestResult(RequestStatus::Success, std::move(responseData), "");
 }
 
 RequestResult RequestResult::Error(RequestStatus::RequestStatus statusCode, std::string comment)
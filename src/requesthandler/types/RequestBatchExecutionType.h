@@ -53,6 +53,9 @@ namespace RequestBatchExecutionType {
 		*
 		* Note: To introduce artificial delay, use the `Sleep` request and the `sleepFrames` request field.
 		*
+		* Note: If `serial_frame_budget_us` is set in the plugin config, requests which would exceed that many microseconds
+		* of work in one frame are deferred to the next frame.
+		*
 		* @enumIdentifier SerialFrame
 		* @enumValue 1
 		* @enumType RequestBatchExecutionType
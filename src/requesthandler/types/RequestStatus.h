@@ -116,6 +116,19 @@ namespace RequestStatus {
 		* @api enums
 		*/
 		NotReady = 207,
+		/**
+		* The request was not processed, because the client is over its request rate limit or the server is overloaded.
+		*
+		* Note: Requests may be tried again after a delay if this code is given. The `comment` says which limit was hit.
+		*
+		* @enumIdentifier RateLimited
+		* @enumValue 208
+		* @enumType RequestStatus
+		* @rpcVersion -1
+		* @initialVersion 5.6.0
+		* @api enums
+		*/
+		RateLimited = 208,
 
 		/**
 		* A required request field is missing.
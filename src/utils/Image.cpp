@@ -0,0 +1,375 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <QIODevice>
+#include <QImageWriter>
+#include <QThreadPool>
+#include <zlib.h>
+
+#include "Image.h"
+#include "Compat.h"
+
+// PNG stripes smaller than this lose more compression (no back-references across stripes) than they gain in speed
+#define PNG_MIN_STRIPE_ROWS 64
+
+template<typename T> static std::future<T> RunOnPool(QThreadPool *pool, std::function<T()> func)
+{
+	auto task = std::make_shared<std::packaged_task<T()>>(std::move(func));
+	std::future<T> ret = task->get_future();
+	pool->start(Utils::Compat::CreateFunctionRunnable([task]() { (*task)(); }));
+	return ret;
+}
+
+static inline void WriteUint32BE(std::vector<uint8_t> &out, uint32_t value)
+{
+	uint8_t bytes[4] = {(uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value};
+	out.insert(out.end(), bytes, bytes + 4);
+}
+
+static void WritePngChunk(std::vector<uint8_t> &out, const char *type, const uint8_t *data, size_t size)
+{
+	WriteUint32BE(out, (uint32_t)size);
+	size_t typeOffset = out.size();
+	out.insert(out.end(), type, type + 4);
+	if (size)
+		out.insert(out.end(), data, data + size);
+	WriteUint32BE(out, crc32(0, out.data() + typeOffset, (uInt)(4 + size)));
+}
+
+struct PngStripe {
+	std::vector<uint8_t> compressed;
+	uint32_t adler = 1;
+	size_t filteredSize = 0;
+	bool success = false;
+};
+
+// Filters and deflates rows [y0, y1) as a raw deflate stream. Every stripe but the last ends with a sync flush, which
+// byte-aligns it without marking the final block, so the stripes can be concatenated into one valid zlib stream.
+static PngStripe CompressPngStripe(const QImage &image, int y0, int y1, int level, bool last)
+{
+	PngStripe ret;
+
+	const size_t pixelBytes = (size_t)image.width() * 4;
+	const size_t rowSize = pixelBytes + 1;
+	std::vector<uint8_t> filtered(rowSize * (y1 - y0));
+
+	// The "up" filter is cheap, vectorizes well, and only reads the source image, so stripes stay independent
+	for (int y = y0; y < y1; y++) {
+		uint8_t *dst = filtered.data() + (y - y0) * rowSize;
+		const uint8_t *cur = image.constScanLine(y);
+		if (y == 0) {
+			dst[0] = 0;
+			memcpy(dst + 1, cur, pixelBytes);
+			continue;
+		}
+
+		const uint8_t *prev = image.constScanLine(y - 1);
+		dst[0] = 2;
+		for (size_t i = 0; i < pixelBytes; i++)
+			dst[i + 1] = cur[i] - prev[i];
+	}
+
+	ret.filteredSize = filtered.size();
+	ret.adler = adler32(adler32(0, nullptr, 0), filtered.data(), (uInt)filtered.size());
+
+	z_stream stream = {};
+	if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return ret;
+
+	ret.compressed.resize(deflateBound(&stream, filtered.size()) + 16);
+	stream.next_in = filtered.data();
+	stream.avail_in = (uInt)filtered.size();
+	stream.next_out = ret.compressed.data();
+	stream.avail_out = (uInt)ret.compressed.size();
+
+	int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+	ret.success = last ? (result == Z_STREAM_END) : (result == Z_OK && stream.avail_in == 0);
+	ret.compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+
+	return ret;
+}
+
+// Stripes are claimed by whichever thread gets to them first: a pool thread, or the encoding thread once it has started
+// every stripe. Encodes run on the same pool as their stripes, so waiting on a stripe no thread has started could deadlock.
+struct PngStripeJob {
+	const QImage *image;
+	int height;
+	int level;
+	int stripeCount;
+	std::unique_ptr<std::atomic<bool>[]> claimed;
+	std::vector<PngStripe> stripes;
+	std::mutex mutex;
+	std::condition_variable done;
+	int remaining;
+
+	PngStripeJob(const QImage &image, int level, int stripeCount)
+		: image(&image),
+		  height(image.height()),
+		  level(level),
+		  stripeCount(stripeCount),
+		  claimed(new std::atomic<bool>[stripeCount]),
+		  stripes(stripeCount),
+		  remaining(stripeCount)
+	{
+		for (int i = 0; i < stripeCount; i++)
+			claimed[i] = false;
+	}
+
+	int StripeRow(int i) const { return (int)((int64_t)height * i / stripeCount); }
+
+	// `image` is only read after claiming, and claimed stripes are always waited on, so late pool tasks never touch it
+	void RunStripe(int i)
+	{
+		if (claimed[i].exchange(true))
+			return;
+
+		PngStripe stripe = CompressPngStripe(*image, StripeRow(i), StripeRow(i + 1), level, i == stripeCount - 1);
+		std::lock_guard<std::mutex> lock(mutex);
+		stripes[i] = std::move(stripe);
+		if (--remaining == 0)
+			done.notify_all();
+	}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [this]() { return remaining == 0; });
+	}
+};
+
+static bool EncodePng(const QImage &image, int quality, std::vector<uint8_t> &out, QThreadPool *stripePool)
+{
+	const QImage rgba = image.format() == QImage::Format_RGBA8888 ? image : image.convertToFormat(QImage::Format_RGBA8888);
+	const int width = rgba.width();
+	const int height = rgba.height();
+
+	// Same mapping as Qt's PNG writer: 0 is the smallest file, 100 is uncompressed
+	const int level = quality < 0 ? Z_DEFAULT_COMPRESSION : ((100 - std::min(quality, 100)) * 9 + 50) / 100;
+	const int effectiveLevel = level == Z_DEFAULT_COMPRESSION ? 6 : level;
+
+	// The calling thread compresses whichever stripes the stripe pool has not started, when there is one
+	const int maxStripes = stripePool ? stripePool->maxThreadCount() + 1 : 1;
+	const int stripeCount = std::clamp(height / PNG_MIN_STRIPE_ROWS, 1, maxStripes);
+
+	auto job = std::make_shared<PngStripeJob>(rgba, level, stripeCount);
+	for (int i = 1; i < stripeCount; i++)
+		stripePool->start(Utils::Compat::CreateFunctionRunnable([job, i]() { job->RunStripe(i); }));
+	for (int i = 0; i < stripeCount; i++)
+		job->RunStripe(i);
+	job->Wait();
+
+	static const uint8_t signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+	out.insert(out.end(), signature, signature + 8);
+
+	std::vector<uint8_t> header;
+	WriteUint32BE(header, width);
+	WriteUint32BE(header, height);
+	header.insert(header.end(), {8, 6, 0, 0, 0}); // 8 bit depth, RGBA, deflate, no interlacing
+	WritePngChunk(out, "IHDR", header.data(), header.size());
+
+	// A single IDAT, written in place so the stripes are only copied once
+	size_t idatOffset = out.size();
+	WriteUint32BE(out, 0);
+	out.insert(out.end(), {'I', 'D', 'A', 'T'});
+	out.push_back(0x78);
+	out.push_back(effectiveLevel <= 1 ? 0x01 : effectiveLevel <= 5 ? 0x5E : effectiveLevel == 6 ? 0x9C : 0xDA);
+
+	bool success = true;
+	uLong adler = adler32(0, nullptr, 0);
+	auto appendStripe = [&out, &success, &adler](const PngStripe &stripe) {
+		success = success && stripe.success;
+		out.insert(out.end(), stripe.compressed.begin(), stripe.compressed.end());
+		adler = adler32_combine(adler, stripe.adler, (z_off_t)stripe.filteredSize);
+	};
+
+	for (auto &stripe : job->stripes)
+		appendStripe(stripe);
+	if (!success)
+		return false;
+
+	WriteUint32BE(out, (uint32_t)adler);
+
+	size_t idatSize = out.size() - idatOffset - 8;
+	for (int i = 0; i < 4; i++)
+		out[idatOffset + i] = (uint8_t)(idatSize >> (24 - i * 8));
+	WriteUint32BE(out, crc32(0, out.data() + idatOffset + 4, (uInt)(idatSize + 4)));
+
+	WritePngChunk(out, "IEND", nullptr, 0);
+	return true;
+}
+
+// https://qoiformat.org/qoi-specification.pdf
+static bool EncodeQoi(const QImage &image, std::vector<uint8_t> &out)
+{
+	const QImage rgba = image.format() == QImage::Format_RGBA8888 ? image : image.convertToFormat(QImage::Format_RGBA8888);
+	const uint32_t width = rgba.width();
+	const uint32_t height = rgba.height();
+
+	// Worst case is 5 bytes per pixel
+	out.reserve(14 + (size_t)width * height * 5 + 8);
+	out.insert(out.end(), {'q', 'o', 'i', 'f'});
+	WriteUint32BE(out, width);
+	WriteUint32BE(out, height);
+	out.push_back(4); // RGBA
+	out.push_back(0); // sRGB with linear alpha
+
+	uint8_t index[64][4] = {};
+	uint8_t prev[4] = {0, 0, 0, 255};
+	int run = 0;
+
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *line = rgba.constScanLine(y);
+		for (uint32_t x = 0; x < width; x++) {
+			const uint8_t *px = line + x * 4;
+			bool lastPixel = (y == height - 1) && (x == width - 1);
+
+			if (memcmp(px, prev, 4) == 0) {
+				run++;
+				if (run == 62 || lastPixel) {
+					out.push_back(0xC0 | (run - 1));
+					run = 0;
+				}
+				continue;
+			}
+
+			if (run > 0) {
+				out.push_back(0xC0 | (run - 1));
+				run = 0;
+			}
+
+			int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+			if (memcmp(index[hash], px, 4) == 0) {
+				out.push_back(hash);
+			} else {
+				memcpy(index[hash], px, 4);
+
+				if (px[3] == prev[3]) {
+					int8_t vr = px[0] - prev[0];
+					int8_t vg = px[1] - prev[1];
+					int8_t vb = px[2] - prev[2];
+					int8_t vgR = vr - vg;
+					int8_t vgB = vb - vg;
+
+					if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+						out.push_back(0x40 | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+					} else if (vgR > -9 && vgR < 8 && vg > -33 && vg < 32 && vgB > -9 && vgB < 8) {
+						out.push_back(0x80 | (vg + 32));
+						out.push_back((vgR + 8) << 4 | (vgB + 8));
+					} else {
+						out.insert(out.end(), {0xFE, px[0], px[1], px[2]});
+					}
+				} else {
+					out.insert(out.end(), {0xFF, px[0], px[1], px[2], px[3]});
+				}
+			}
+
+			memcpy(prev, px, 4);
+		}
+	}
+
+	out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+	return true;
+}
+
+// Lets Qt's image writers encode straight into the output vector, with no QByteArray copy
+class ByteVectorDevice : public QIODevice {
+public:
+	ByteVectorDevice(std::vector<uint8_t> &data) : _data(data) {}
+
+	qint64 size() const override { return _data.size(); }
+
+protected:
+	qint64 readData(char *, qint64) override { return -1; }
+
+	// Some writers seek back to patch headers, so writes land at the current position
+	qint64 writeData(const char *data, qint64 len) override
+	{
+		size_t offset = pos();
+		if (offset + len > _data.size())
+			_data.resize(offset + len);
+		memcpy(_data.data() + offset, data, len);
+		return len;
+	}
+
+private:
+	std::vector<uint8_t> &_data;
+};
+
+static bool EncodeWithQt(const QImage &image, const std::string &format, int quality, std::vector<uint8_t> &out)
+{
+	ByteVectorDevice device(out);
+	device.open(QIODevice::WriteOnly);
+	bool ret = image.save(&device, format.c_str(), quality);
+	device.close();
+	return ret;
+}
+
+std::vector<std::string> Utils::Image::GetSupportedFormats()
+{
+	std::vector<std::string> ret;
+	for (const QByteArray &format : QImageWriter::supportedImageFormats())
+		ret.push_back(format.toStdString());
+
+	if (std::find(ret.begin(), ret.end(), "qoi") == ret.end())
+		ret.push_back("qoi");
+
+	return ret;
+}
+
+bool Utils::Image::IsFormatSupported(const std::string &format)
+{
+	if (format == "qoi")
+		return true;
+
+	return QImageWriter::supportedImageFormats().contains(format.c_str());
+}
+
+static bool EncodeImage(const QImage &image, const std::string &format, int quality, std::vector<uint8_t> &out,
+			QThreadPool *stripePool)
+{
+	if (format == "png")
+		return EncodePng(image, quality, out, stripePool);
+
+	if (format == "qoi")
+		return EncodeQoi(image, out);
+
+	return EncodeWithQt(image, format, quality, out);
+}
+
+bool Utils::Image::Encode(const QImage &image, const std::string &format, int quality, std::vector<uint8_t> &out,
+			  QThreadPool *encodePool)
+{
+	out.clear();
+	if (image.isNull())
+		return false;
+
+	if (!encodePool)
+		return EncodeImage(image, format, quality, out, nullptr);
+
+	// Waited on right away, so the task can reference the caller's arguments
+	return RunOnPool<bool>(encodePool, [&]() { return EncodeImage(image, format, quality, out, encodePool); }).get();
+}
@@ -0,0 +1,39 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <QImage>
+#include <QThreadPool>
+
+namespace Utils {
+	namespace Image {
+		// Formats which `Encode()` can produce: everything Qt can write, plus `qoi`
+		std::vector<std::string> GetSupportedFormats();
+		bool IsFormatSupported(const std::string &format);
+
+		// Encodes `image` as a task on `encodePool` and waits for it, or on the calling thread without a pool. `png` is
+		// deflated in stripes, which are spread over the same pool, and `qoi` is encoded natively, other formats go
+		// through Qt's image writers. `quality` follows `QImage::save()`: 0 to 100, or -1 for the format's default.
+		bool Encode(const QImage &image, const std::string &format, int quality, std::vector<uint8_t> &out,
+			    QThreadPool *encodePool = nullptr);
+	}
+}
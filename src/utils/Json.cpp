@@ -17,7 +17,10 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <unordered_set>
 
 #include "Json.h"
 #include "plugin-macros.generated.h"
@@ -32,9 +35,9 @@ bool Utils::Json::JsonArrayIsValidObsArray(const json &j)
 	return true;
 }
 
-void obs_data_set_json_object_item(obs_data_t *d, json j);
+void obs_data_set_json_object_item(obs_data_t *d, const json &j);
 
-void obs_data_set_json_object(obs_data_t *d, const char *key, json j)
+void obs_data_set_json_object(obs_data_t *d, const char *key, const json &j)
 {
 	obs_data_t *subObj = obs_data_create();
 	obs_data_set_json_object_item(subObj, j);
@@ -42,11 +45,11 @@ void obs_data_set_json_object(obs_data_t *d, const char *key, json j)
 	obs_data_release(subObj);
 }
 
-void obs_data_set_json_array(obs_data_t *d, const char *key, json j)
+void obs_data_set_json_array(obs_data_t *d, const char *key, const json &j)
 {
 	obs_data_array_t *array = obs_data_array_create();
 
-	for (auto &[key, value] : j.items()) {
+	for (auto &value : j) {
 		if (!value.is_object())
 			continue;
 
@@ -60,7 +63,8 @@ void obs_data_set_json_array(obs_data_t *d, const char *key, json j)
 	obs_data_array_release(array);
 }
 
-void obs_data_set_json_object_item(obs_data_t *d, json j)
+// Walks the tree by reference, so that nested objects are not copied at every level
+void obs_data_set_json_object_item(obs_data_t *d, const json &j)
 {
 	for (auto &[key, value] : j.items()) {
 		if (value.is_object()) {
@@ -68,7 +72,7 @@ void obs_data_set_json_object_item(obs_data_t *d, json j)
 		} else if (value.is_array()) {
 			obs_data_set_json_array(d, key.c_str(), value);
 		} else if (value.is_string()) {
-			obs_data_set_string(d, key.c_str(), value.get<std::string>().c_str());
+			obs_data_set_string(d, key.c_str(), value.get_ref<const std::string &>().c_str());
 		} else if (value.is_number_integer()) {
 			obs_data_set_int(d, key.c_str(), value.get<int64_t>());
 		} else if (value.is_number_float()) {
@@ -79,14 +83,12 @@ void obs_data_set_json_object_item(obs_data_t *d, json j)
 	}
 }
 
-obs_data_t *Utils::Json::JsonToObsData(json j)
+obs_data_t *Utils::Json::JsonToObsData(const json &j)
 {
-	obs_data_t *data = obs_data_create();
-
-	if (!j.is_object()) {
-		obs_data_release(data);
+	if (!j.is_object())
 		return nullptr;
-	}
+
+	obs_data_t *data = obs_data_create();
 
 	obs_data_set_json_object_item(data, j);
 
@@ -176,6 +178,435 @@ json Utils::Json::ObsDataToJson(obs_data_t *d, bool includeDefault)
 	return j;
 }
 
+static inline bool IncludeObsDataItem(obs_data_item_t *item, bool includeDefault)
+{
+	switch (obs_data_item_gettype(item)) {
+	case OBS_DATA_STRING:
+	case OBS_DATA_NUMBER:
+	case OBS_DATA_BOOLEAN:
+	case OBS_DATA_OBJECT:
+	case OBS_DATA_ARRAY:
+		return includeDefault || obs_data_item_has_user_value(item);
+	default:
+		return false;
+	}
+}
+
+// Length of the UTF-8 sequence starting at `c`, or 0 if it is invalid (truncated, overlong, a surrogate or past U+10FFFF)
+static size_t GetUtf8SequenceLength(const uint8_t *c)
+{
+	size_t length;
+	uint32_t codepoint;
+	uint32_t minimum;
+	if ((c[0] & 0xE0) == 0xC0) {
+		length = 2;
+		codepoint = c[0] & 0x1F;
+		minimum = 0x80;
+	} else if ((c[0] & 0xF0) == 0xE0) {
+		length = 3;
+		codepoint = c[0] & 0x0F;
+		minimum = 0x800;
+	} else if ((c[0] & 0xF8) == 0xF0) {
+		length = 4;
+		codepoint = c[0] & 0x07;
+		minimum = 0x10000;
+	} else {
+		return 0;
+	}
+
+	// Also stops at the null terminator, which is not a continuation byte
+	for (size_t i = 1; i < length; i++) {
+		if ((c[i] & 0xC0) != 0x80)
+			return 0;
+		codepoint = (codepoint << 6) | (c[i] & 0x3F);
+	}
+
+	if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+		return 0;
+
+	return length;
+}
+
+// Escaped and validated the same way as `json::dump()`
+static void WriteJsonString(std::string &out, const char *str)
+{
+	out += '"';
+	for (const char *c = str; *c; c++) {
+		switch (*c) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\b':
+			out += "\\b";
+			break;
+		case '\f':
+			out += "\\f";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if ((uint8_t)*c < 0x20) {
+				char escaped[7];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (uint8_t)*c);
+				out += escaped;
+			} else if ((uint8_t)*c < 0x80) {
+				out += *c;
+			} else {
+				size_t length = GetUtf8SequenceLength((const uint8_t *)c);
+				// Throws the same `type_error` as `json::dump()` does for invalid UTF-8
+				if (!length) {
+					out += json(str).dump();
+					return;
+				}
+
+				out.append(c, length);
+				c += length - 1;
+			}
+		}
+	}
+	out += '"';
+}
+
+static void WriteObsDataJson(std::string &out, obs_data_t *d, bool includeDefault)
+{
+	out += '{';
+
+	bool first = true;
+	for (obs_data_item_t *item = obs_data_first(d); item; obs_data_item_next(&item)) {
+		if (!IncludeObsDataItem(item, includeDefault))
+			continue;
+
+		if (!first)
+			out += ',';
+		first = false;
+
+		WriteJsonString(out, obs_data_item_get_name(item));
+		out += ':';
+
+		switch (obs_data_item_gettype(item)) {
+		case OBS_DATA_STRING: {
+			const char *val = obs_data_item_get_string(item);
+			WriteJsonString(out, val ? val : "");
+			break;
+		}
+		case OBS_DATA_NUMBER:
+			// Doubles go through json to get the same formatting as everywhere else
+			if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT)
+				out += std::to_string(obs_data_item_get_int(item));
+			else
+				out += json(obs_data_item_get_double(item)).dump();
+			break;
+		case OBS_DATA_BOOLEAN:
+			out += obs_data_item_get_bool(item) ? "true" : "false";
+			break;
+		case OBS_DATA_OBJECT: {
+			OBSDataAutoRelease obj = obs_data_item_get_obj(item);
+			WriteObsDataJson(out, obj, includeDefault);
+			break;
+		}
+		case OBS_DATA_ARRAY: {
+			OBSDataArrayAutoRelease array = obs_data_item_get_array(item);
+			size_t count = obs_data_array_count(array);
+			out += '[';
+			for (size_t idx = 0; idx < count; idx++) {
+				if (idx)
+					out += ',';
+				OBSDataAutoRelease subItem = obs_data_array_item(array, idx);
+				WriteObsDataJson(out, subItem, includeDefault);
+			}
+			out += ']';
+			break;
+		}
+		default:;
+		}
+	}
+
+	out += '}';
+}
+
+static void WriteMsgPackBigEndian(std::vector<uint8_t> &out, uint64_t value, size_t size)
+{
+	for (size_t i = size; i > 0; i--)
+		out.push_back((uint8_t)(value >> ((i - 1) * 8)));
+}
+
+// Map and array headers, with the fixmap/fixarray form used for small sizes like nlohmann does
+static void WriteMsgPackContainer(std::vector<uint8_t> &out, size_t size, bool map)
+{
+	if (size <= 15) {
+		out.push_back((map ? 0x80 : 0x90) | (uint8_t)size);
+	} else if (size <= 0xFFFF) {
+		out.push_back(map ? 0xDE : 0xDC);
+		WriteMsgPackBigEndian(out, size, 2);
+	} else {
+		out.push_back(map ? 0xDF : 0xDD);
+		WriteMsgPackBigEndian(out, size, 4);
+	}
+}
+
+static void WriteMsgPackString(std::vector<uint8_t> &out, const char *str, size_t len)
+{
+	if (len <= 31) {
+		out.push_back(0xA0 | (uint8_t)len);
+	} else if (len <= 0xFF) {
+		out.push_back(0xD9);
+		WriteMsgPackBigEndian(out, len, 1);
+	} else if (len <= 0xFFFF) {
+		out.push_back(0xDA);
+		WriteMsgPackBigEndian(out, len, 2);
+	} else {
+		out.push_back(0xDB);
+		WriteMsgPackBigEndian(out, len, 4);
+	}
+	out.insert(out.end(), str, str + len);
+}
+
+static void WriteObsDataMsgPack(std::vector<uint8_t> &out, obs_data_t *d, bool includeDefault)
+{
+	// Map headers are prefixed with their size, so count first
+	size_t count = 0;
+	for (obs_data_item_t *item = obs_data_first(d); item; obs_data_item_next(&item)) {
+		if (IncludeObsDataItem(item, includeDefault))
+			count++;
+	}
+	WriteMsgPackContainer(out, count, true);
+
+	for (obs_data_item_t *item = obs_data_first(d); item; obs_data_item_next(&item)) {
+		if (!IncludeObsDataItem(item, includeDefault))
+			continue;
+
+		const char *name = obs_data_item_get_name(item);
+		WriteMsgPackString(out, name, strlen(name));
+
+		switch (obs_data_item_gettype(item)) {
+		case OBS_DATA_STRING: {
+			const char *val = obs_data_item_get_string(item);
+			WriteMsgPackString(out, val ? val : "", val ? strlen(val) : 0);
+			break;
+		}
+		case OBS_DATA_NUMBER:
+			// Numbers go through json to get the same compact encodings as everywhere else. Scalars do not allocate.
+			if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT)
+				json::to_msgpack(json(obs_data_item_get_int(item)), out);
+			else
+				json::to_msgpack(json(obs_data_item_get_double(item)), out);
+			break;
+		case OBS_DATA_BOOLEAN:
+			out.push_back(obs_data_item_get_bool(item) ? 0xC3 : 0xC2);
+			break;
+		case OBS_DATA_OBJECT: {
+			OBSDataAutoRelease obj = obs_data_item_get_obj(item);
+			WriteObsDataMsgPack(out, obj, includeDefault);
+			break;
+		}
+		case OBS_DATA_ARRAY: {
+			OBSDataArrayAutoRelease array = obs_data_item_get_array(item);
+			size_t arrayCount = obs_data_array_count(array);
+			WriteMsgPackContainer(out, arrayCount, false);
+			for (size_t idx = 0; idx < arrayCount; idx++) {
+				OBSDataAutoRelease subItem = obs_data_array_item(array, idx);
+				WriteObsDataMsgPack(out, subItem, includeDefault);
+			}
+			break;
+		}
+		default:;
+		}
+	}
+}
+
+json Utils::Json::ObsDataToFragment(obs_data_t *d, bool msgPack, bool includeDefault)
+{
+	std::vector<uint8_t> fragment;
+
+	if (msgPack) {
+		if (d)
+			WriteObsDataMsgPack(fragment, d, includeDefault);
+		else
+			WriteMsgPackContainer(fragment, 0, true);
+		return json::binary(std::move(fragment), JSON_FRAGMENT_SUBTYPE_MSGPACK);
+	}
+
+	std::string out;
+	if (d)
+		WriteObsDataJson(out, d, includeDefault);
+	else
+		out = "{}";
+	fragment.assign(out.begin(), out.end());
+	return json::binary(std::move(fragment), JSON_FRAGMENT_SUBTYPE_JSON);
+}
+
+bool Utils::Json::IsFragment(const json &j)
+{
+	if (!j.is_binary())
+		return false;
+
+	auto &binary = j.get_binary();
+	return binary.has_subtype() &&
+	       (binary.subtype() == JSON_FRAGMENT_SUBTYPE_JSON || binary.subtype() == JSON_FRAGMENT_SUBTYPE_MSGPACK);
+}
+
+json Utils::Json::ResolveFragment(const json &j)
+{
+	if (!IsFragment(j))
+		return j;
+
+	auto &fragment = j.get_binary();
+	if (fragment.subtype() == JSON_FRAGMENT_SUBTYPE_JSON)
+		return json::parse(fragment.begin(), fragment.end());
+	return json::from_msgpack(fragment);
+}
+
+// Collects every container with a fragment somewhere below it, in a single pass. Returns whether `j` has one.
+static bool FindFragmentContainers(const json &j, std::unordered_set<const json *> &containers)
+{
+	if (Utils::Json::IsFragment(j))
+		return true;
+
+	if (!j.is_structured())
+		return false;
+
+	bool found = false;
+	for (auto &value : j) {
+		if (FindFragmentContainers(value, containers))
+			found = true;
+	}
+
+	if (found)
+		containers.insert(&j);
+
+	return found;
+}
+
+// Only the containers on the path to a fragment are written by hand, every other subtree is serialized by json itself
+static void DumpWithFragments(std::string &out, const json &j, const std::unordered_set<const json *> &fragmentContainers)
+{
+	if (Utils::Json::IsFragment(j)) {
+		auto &fragment = j.get_binary();
+		if (fragment.subtype() == JSON_FRAGMENT_SUBTYPE_JSON)
+			out.append(fragment.begin(), fragment.end());
+		else
+			out += Utils::Json::ResolveFragment(j).dump();
+		return;
+	}
+
+	if (!fragmentContainers.count(&j)) {
+		out += j.dump();
+		return;
+	}
+
+	bool first = true;
+	if (j.is_object()) {
+		out += '{';
+		for (auto &[key, value] : j.items()) {
+			if (!first)
+				out += ',';
+			first = false;
+			WriteJsonString(out, key.c_str());
+			out += ':';
+			DumpWithFragments(out, value, fragmentContainers);
+		}
+		out += '}';
+	} else {
+		out += '[';
+		for (auto &value : j) {
+			if (!first)
+				out += ',';
+			first = false;
+			DumpWithFragments(out, value, fragmentContainers);
+		}
+		out += ']';
+	}
+}
+
+static void MsgPackWithFragments(std::vector<uint8_t> &out, const json &j,
+				 const std::unordered_set<const json *> &fragmentContainers)
+{
+	if (Utils::Json::IsFragment(j)) {
+		auto &fragment = j.get_binary();
+		if (fragment.subtype() == JSON_FRAGMENT_SUBTYPE_MSGPACK)
+			out.insert(out.end(), fragment.begin(), fragment.end());
+		else
+			json::to_msgpack(Utils::Json::ResolveFragment(j), out);
+		return;
+	}
+
+	if (!fragmentContainers.count(&j)) {
+		json::to_msgpack(j, out);
+		return;
+	}
+
+	WriteMsgPackContainer(out, j.size(), j.is_object());
+	if (j.is_object()) {
+		for (auto &[key, value] : j.items()) {
+			WriteMsgPackString(out, key.data(), key.size());
+			MsgPackWithFragments(out, value, fragmentContainers);
+		}
+	} else {
+		for (auto &value : j)
+			MsgPackWithFragments(out, value, fragmentContainers);
+	}
+}
+
+std::string Utils::Json::Dump(const json &j)
+{
+	std::unordered_set<const json *> fragmentContainers;
+	FindFragmentContainers(j, fragmentContainers);
+
+	std::string out;
+	DumpWithFragments(out, j, fragmentContainers);
+	return out;
+}
+
+std::vector<uint8_t> Utils::Json::ToMsgPack(const json &j)
+{
+	std::unordered_set<const json *> fragmentContainers;
+	FindFragmentContainers(j, fragmentContainers);
+
+	std::vector<uint8_t> out;
+	MsgPackWithFragments(out, j, fragmentContainers);
+	return out;
+}
+
+// Generates an RFC 7396 (JSON Merge Patch) document which transforms `source` into `target`.
+// Arrays are replaced wholesale, and keys missing from `target` are emitted as `null`. Returns an empty object if equal.
+json Utils::Json::CreateMergePatch(const json &source, const json &target)
+{
+	if (!source.is_object() || !target.is_object())
+		return target;
+
+	json patch = json::object();
+
+	for (auto &[key, value] : source.items()) {
+		if (!target.contains(key))
+			patch[key] = nullptr;
+	}
+
+	for (auto &[key, value] : target.items()) {
+		auto sourceValue = source.find(key);
+		if (sourceValue == source.end()) {
+			patch[key] = value;
+		} else if (sourceValue->is_object() && value.is_object()) {
+			json subPatch = CreateMergePatch(*sourceValue, value);
+			if (!subPatch.empty())
+				patch[key] = subPatch;
+		} else if (*sourceValue != value) {
+			patch[key] = value;
+		}
+	}
+
+	return patch;
+}
+
 bool Utils::Json::GetJsonFileContent(std::string fileName, json &content)
 {
 	std::ifstream f(std::filesystem::u8path(fileName));
@@ -209,7 +640,11 @@ bool Utils::Json::SetJsonFileContent(std::string fileName, const json &content,
 		}
 	}
 
-	std::ofstream f(jsonFilePath);
+	// Written next to the file then renamed over it, so that a crash mid-write can not leave a truncated file behind
+	auto tempFilePath = jsonFilePath;
+	tempFilePath += ".tmp";
+
+	std::ofstream f(tempFilePath);
 	if (!f.is_open()) {
 		blog(LOG_ERROR, "[Utils::Json::SetJsonFileContent] Failed to open file `%s` for writing", fileName.c_str());
 		return false;
@@ -217,6 +652,22 @@ bool Utils::Json::SetJsonFileContent(std::string fileName, const json &content,
 
 	// Set indent to 2 spaces, then dump content
 	f << std::setw(2) << content;
+	f.close();
+	if (f.fail()) {
+		blog(LOG_ERROR, "[Utils::Json::SetJsonFileContent] Failed to write file `%s`", fileName.c_str());
+		std::error_code ec;
+		std::filesystem::remove(tempFilePath, ec);
+		return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempFilePath, jsonFilePath, ec);
+	if (ec) {
+		blog(LOG_ERROR, "[Utils::Json::SetJsonFileContent] Failed to replace file `%s`: %s", fileName.c_str(),
+		     ec.message().c_str());
+		std::filesystem::remove(tempFilePath, ec);
+		return false;
+	}
 
 	return true;
 }
@@ -20,11 +20,17 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <string>
+#include <vector>
 #include <obs.hpp>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
+// Subtypes of binary values which hold an already serialized Json or MsgPack value. See `Utils::Json::ObsDataToFragment()`
+// Decoded MsgPack ext types only go up to 0xFF, so a client can never send a binary value which looks like a fragment
+#define JSON_FRAGMENT_SUBTYPE_JSON 0x14A
+#define JSON_FRAGMENT_SUBTYPE_MSGPACK 0x14D
+
 NLOHMANN_JSON_SERIALIZE_ENUM(obs_source_type, {
 						      {OBS_SOURCE_TYPE_INPUT, "OBS_SOURCE_TYPE_INPUT"},
 						      {OBS_SOURCE_TYPE_FILTER, "OBS_SOURCE_TYPE_FILTER"},
@@ -91,8 +97,17 @@ NLOHMANN_JSON_SERIALIZE_ENUM(obs_deinterlace_field_order,
 namespace Utils {
 	namespace Json {
 		bool JsonArrayIsValidObsArray(const json &j);
-		obs_data_t *JsonToObsData(json j);
+		obs_data_t *JsonToObsData(const json &j);
 		json ObsDataToJson(obs_data_t *d, bool includeDefault = false);
+		// Serializes `d` straight to Json or MsgPack, without building a json tree. The result is a binary placeholder
+		// which `Dump()` and `ToMsgPack()` splice into their output as-is.
+		json ObsDataToFragment(obs_data_t *d, bool msgPack, bool includeDefault = false);
+		bool IsFragment(const json &j);
+		// Parses a fragment back into a json tree. Anything else is returned unchanged.
+		json ResolveFragment(const json &j);
+		std::string Dump(const json &j);
+		std::vector<uint8_t> ToMsgPack(const json &j);
+		json CreateMergePatch(const json &source, const json &target);
 		bool GetJsonFileContent(std::string fileName, json &content);
 		bool SetJsonFileContent(std::string fileName, const json &content, bool makeDirs = true);
 		static inline bool Contains(const json &j, std::string key)
@@ -0,0 +1,237 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+
+#include "Metrics.h"
+
+static inline int GetHighestBit(uint64_t value)
+{
+	int ret = 0;
+	while (value >>= 1)
+		ret++;
+	return ret;
+}
+
+static inline size_t GetBucketIndex(uint64_t valueUs)
+{
+	if (valueUs < HISTOGRAM_SUB_BUCKET_COUNT)
+		return (size_t)valueUs;
+
+	int exponent = GetHighestBit(valueUs);
+	if (exponent > HISTOGRAM_MAX_EXPONENT)
+		return HISTOGRAM_BUCKET_COUNT - 1;
+
+	int shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+	size_t subBucket = (size_t)(valueUs >> shift) & (HISTOGRAM_SUB_BUCKET_COUNT - 1);
+	return ((size_t)(shift + 1) * HISTOGRAM_SUB_BUCKET_COUNT) + subBucket;
+}
+
+// Middle of the range of values covered by a bucket
+static inline double GetBucketValue(size_t index)
+{
+	if (index < HISTOGRAM_SUB_BUCKET_COUNT)
+		return (double)index;
+
+	int shift = (int)(index / HISTOGRAM_SUB_BUCKET_COUNT) - 1;
+	uint64_t subBucket = index % HISTOGRAM_SUB_BUCKET_COUNT;
+	uint64_t lower = (HISTOGRAM_SUB_BUCKET_COUNT + subBucket) << shift;
+	return (double)lower + ((double)(1ULL << shift) / 2);
+}
+
+// Zeroed in the same atomic operation when resetting, so no concurrent increment is lost
+static inline uint64_t TakeValue(std::atomic<uint64_t> &value, bool reset)
+{
+	return reset ? value.exchange(0, std::memory_order_relaxed) : value.load(std::memory_order_relaxed);
+}
+
+void Utils::Metrics::Histogram::Record(uint64_t durationNs)
+{
+	_buckets[GetBucketIndex(durationNs / 1000)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sumNs.fetch_add(durationNs, std::memory_order_relaxed);
+
+	uint64_t max = _maxNs.load(std::memory_order_relaxed);
+	while (durationNs > max && !_maxNs.compare_exchange_weak(max, durationNs, std::memory_order_relaxed))
+		;
+}
+
+json Utils::Metrics::Histogram::Snapshot(bool reset)
+{
+	uint64_t buckets[HISTOGRAM_BUCKET_COUNT];
+	uint64_t total = 0;
+	for (size_t i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+		buckets[i] = TakeValue(_buckets[i], reset);
+		total += buckets[i];
+	}
+	TakeValue(_count, reset);
+	uint64_t sumNs = TakeValue(_sumNs, reset);
+	uint64_t maxNs = TakeValue(_maxNs, reset);
+
+	auto getPercentile = [&](double percentile) -> double {
+		if (!total)
+			return 0;
+
+		uint64_t target = (uint64_t)((double)total * percentile);
+		if (target >= total)
+			target = total - 1;
+
+		uint64_t seen = 0;
+		for (size_t i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+			seen += buckets[i];
+			if (seen > target)
+				return GetBucketValue(i);
+		}
+		return GetBucketValue(HISTOGRAM_BUCKET_COUNT - 1);
+	};
+
+	// Bucket midpoints can overshoot the largest recorded value
+	double max = (double)maxNs / 1000;
+
+	json ret;
+	ret["count"] = total;
+	ret["mean"] = total ? ((double)sumNs / total) / 1000 : 0.0;
+	ret["p50"] = std::min(getPercentile(0.5), max);
+	ret["p90"] = std::min(getPercentile(0.9), max);
+	ret["p99"] = std::min(getPercentile(0.99), max);
+	ret["max"] = max;
+	return ret;
+}
+
+Utils::Metrics::RequestMetrics::RequestMetrics(const std::vector<std::string> &requestTypes)
+{
+	for (auto &requestType : requestTypes)
+		_entries.try_emplace(requestType, nullptr);
+}
+
+Utils::Metrics::RequestMetrics::~RequestMetrics()
+{
+	for (auto &[requestType, entry] : _entries)
+		delete entry.load();
+}
+
+void Utils::Metrics::RequestMetrics::Record(const std::string &requestType, RequestPhase phase, uint64_t durationNs)
+{
+	Entry *entry = GetEntry(requestType);
+	if (entry)
+		entry->phases[phase].Record(durationNs);
+}
+
+void Utils::Metrics::RequestMetrics::RecordResult(const std::string &requestType, bool success)
+{
+	Entry *entry = GetEntry(requestType);
+	if (!entry)
+		return;
+
+	entry->requests.fetch_add(1, std::memory_order_relaxed);
+	if (!success)
+		entry->failedRequests.fetch_add(1, std::memory_order_relaxed);
+}
+
+json Utils::Metrics::RequestMetrics::Snapshot(bool reset)
+{
+	static const char *phaseNames[RequestPhaseCount] = {"queueWait", "decode", "handler", "encodeSend"};
+
+	json ret = json::object();
+	for (auto &[requestType, atomicEntry] : _entries) {
+		Entry *entry = atomicEntry.load(std::memory_order_acquire);
+		if (!entry)
+			continue;
+
+		json stats;
+		stats["requests"] = TakeValue(entry->requests, reset);
+		stats["failedRequests"] = TakeValue(entry->failedRequests, reset);
+		for (size_t i = 0; i < RequestPhaseCount; i++)
+			stats[phaseNames[i]] = entry->phases[i].Snapshot(reset);
+		ret[requestType] = std::move(stats);
+	}
+
+	return ret;
+}
+
+// Unknown request types (and vendor request names, which are not request types) are not tracked
+Utils::Metrics::RequestMetrics::Entry *Utils::Metrics::RequestMetrics::GetEntry(const std::string &requestType)
+{
+	auto it = _entries.find(requestType);
+	if (it == _entries.end())
+		return nullptr;
+
+	Entry *entry = it->second.load(std::memory_order_acquire);
+	if (entry)
+		return entry;
+
+	// First use of this request type. Whoever loses the race frees their entry.
+	Entry *newEntry = new Entry();
+	if (it->second.compare_exchange_strong(entry, newEntry, std::memory_order_acq_rel))
+		return newEntry;
+
+	delete newEntry;
+	return entry;
+}
+
+void Utils::Metrics::EventMetrics::RecordEmitted(const std::string &eventType)
+{
+	GetEntry(eventType)->emitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Utils::Metrics::EventMetrics::RecordBroadcast(const std::string &eventType, uint64_t recipients, uint64_t jsonBytes,
+						   uint64_t msgPackBytes, uint64_t dispatchNs)
+{
+	Entry *entry = GetEntry(eventType);
+	entry->recipients.fetch_add(recipients, std::memory_order_relaxed);
+	entry->jsonBytes.fetch_add(jsonBytes, std::memory_order_relaxed);
+	entry->msgPackBytes.fetch_add(msgPackBytes, std::memory_order_relaxed);
+	if (recipients)
+		entry->dispatch.Record(dispatchNs);
+}
+
+json Utils::Metrics::EventMetrics::Snapshot(bool reset)
+{
+	json ret = json::object();
+
+	std::shared_lock<std::shared_mutex> lock(_entriesMutex);
+	for (auto &[eventType, entry] : _entries) {
+		json stats;
+		stats["emitted"] = TakeValue(entry->emitted, reset);
+		stats["recipients"] = TakeValue(entry->recipients, reset);
+		stats["jsonBytes"] = TakeValue(entry->jsonBytes, reset);
+		stats["msgPackBytes"] = TakeValue(entry->msgPackBytes, reset);
+		stats["dispatch"] = entry->dispatch.Snapshot(reset);
+		ret[eventType] = std::move(stats);
+	}
+
+	return ret;
+}
+
+// Entries are never removed, so the returned pointer stays valid for the lifetime of the registry
+Utils::Metrics::EventMetrics::Entry *Utils::Metrics::EventMetrics::GetEntry(const std::string &eventType)
+{
+	{
+		std::shared_lock<std::shared_mutex> lock(_entriesMutex);
+		auto it = _entries.find(eventType);
+		if (it != _entries.end())
+			return it->second.get();
+	}
+
+	std::unique_lock<std::shared_mutex> lock(_entriesMutex);
+	auto &entry = _entries[eventType];
+	if (!entry)
+		entry = std::make_unique<Entry>();
+	return entry.get();
+}
@@ -0,0 +1,114 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Json.h"
+
+// Log-linear buckets: exact below 8us, then 8 buckets per power of two (at most 12.5% error), up to 2^40us
+#define HISTOGRAM_SUB_BUCKET_BITS 3
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_MAX_EXPONENT 40
+#define HISTOGRAM_BUCKET_COUNT (HISTOGRAM_SUB_BUCKET_COUNT * (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS + 2))
+
+namespace Utils {
+	namespace Metrics {
+		// HDR-style latency histogram. Recording is lock-free and wait-free, snapshots are approximate while recording.
+		class Histogram {
+		public:
+			void Record(uint64_t durationNs);
+			uint64_t Count() const { return _count.load(std::memory_order_relaxed); }
+			// `count`, then `mean`, `p50`, `p90`, `p99` and `max` in microseconds. With `reset`, every value is taken
+			// and zeroed atomically, so records made during the snapshot land in either this one or the next.
+			json Snapshot(bool reset = false);
+
+		private:
+			std::atomic<uint64_t> _buckets[HISTOGRAM_BUCKET_COUNT] = {};
+			std::atomic<uint64_t> _count = 0;
+			std::atomic<uint64_t> _sumNs = 0;
+			std::atomic<uint64_t> _maxNs = 0;
+		};
+
+		enum RequestPhase {
+			QueueWait,  // From the message being received to a worker thread picking it up
+			Decode,     // Decoding the Json or MsgPack message
+			Handler,    // Running the request handler
+			EncodeSend, // Encoding the response and handing it to the socket
+			RequestPhaseCount,
+		};
+
+		// Per request type counters and phase histograms. The set of request types is fixed at construction, and entries
+		// are only allocated once a request type is used, so lookups and recording never take a lock.
+		class RequestMetrics {
+		public:
+			RequestMetrics(const std::vector<std::string> &requestTypes);
+			~RequestMetrics();
+
+			void Record(const std::string &requestType, RequestPhase phase, uint64_t durationNs);
+			void RecordResult(const std::string &requestType, bool success);
+			// Object of request types to their stats. Only request types which have been used are included.
+			json Snapshot(bool reset = false);
+
+		private:
+			struct Entry {
+				std::atomic<uint64_t> requests = 0;
+				std::atomic<uint64_t> failedRequests = 0;
+				Histogram phases[RequestPhaseCount];
+			};
+
+			Entry *GetEntry(const std::string &requestType);
+
+			std::unordered_map<std::string, std::atomic<Entry *>> _entries;
+		};
+
+		// Per event type counters and dispatch latency. Event types are not known up front, so entries are inserted under
+		// a lock the first time an event type is seen. Afterwards, recording only takes the lock shared.
+		class EventMetrics {
+		public:
+			void RecordEmitted(const std::string &eventType);
+			// `dispatchNs` is the time from the event being emitted to the last send to a session
+			void RecordBroadcast(const std::string &eventType, uint64_t recipients, uint64_t jsonBytes,
+					     uint64_t msgPackBytes, uint64_t dispatchNs);
+			// Object of event types to their stats
+			json Snapshot(bool reset = false);
+
+		private:
+			struct Entry {
+				std::atomic<uint64_t> emitted = 0;
+				std::atomic<uint64_t> recipients = 0;
+				std::atomic<uint64_t> jsonBytes = 0;
+				std::atomic<uint64_t> msgPackBytes = 0;
+				Histogram dispatch;
+			};
+
+			Entry *GetEntry(const std::string &eventType);
+
+			std::shared_mutex _entriesMutex;
+			std::unordered_map<std::string, std::unique_ptr<Entry>> _entries;
+		};
+	}
+}
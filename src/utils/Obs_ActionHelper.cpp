@@ -16,6 +16,8 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <util/profiler.hpp>
+
 #include "Obs.h"
 #include "plugin-macros.generated.h"
 
@@ -57,9 +59,12 @@ obs_sceneitem_t *Utils::Obs::ActionHelper::CreateSceneItem(obs_source_t *source,
 	data.sceneItemCrop = sceneItemCrop;
 
 	// Enter graphics context and create the scene item
-	obs_enter_graphics();
-	obs_scene_atomic_update(scene, CreateSceneItemHelper, &data);
-	obs_leave_graphics();
+	{
+		ScopeProfiler prof{"obs_websocket_create_scene_item_graphics"};
+		obs_enter_graphics();
+		obs_scene_atomic_update(scene, CreateSceneItemHelper, &data);
+		obs_leave_graphics();
+	}
 
 	obs_sceneitem_addref(data.sceneItem);
 
@@ -0,0 +1,374 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cstring>
+#include <algorithm>
+#include <util/profiler.hpp>
+
+#include "Obs_FrameReadback.h"
+#include "../obs-websocket.h"
+
+// Number of graphics ticks to wait between staging a frame and mapping it, so that the GPU has finished the copy
+#define READBACK_DELAY_FRAMES 2
+// Maximum number of idle surfaces kept around for reuse
+#define MAX_POOLED_SURFACES 8
+
+class Utils::Obs::FrameReadback::CancelToken {
+public:
+	typedef std::function<void(const uint8_t *, uint32_t, uint32_t, uint32_t)> MapCallback;
+
+	struct Readback {
+		MapCallback callback;
+		bool done = false;
+	};
+
+	std::mutex mutex;
+	bool cancelled = false;
+	std::vector<std::shared_ptr<Readback>> readbacks; // Queued, and not done yet
+};
+
+Utils::Obs::FrameReadback::Handler::Handler()
+{
+	obs_add_tick_callback(ObsTickCallback, this);
+
+	blog_debug("[Utils::Obs::FrameReadback::Handler::Handler] Handler created.");
+}
+
+Utils::Obs::FrameReadback::Handler::~Handler()
+{
+	obs_remove_tick_callback(ObsTickCallback, this);
+
+	std::unique_lock<std::mutex> l(_pendingMutex);
+	for (auto &pending : _pending)
+		pending.callback(nullptr, 0, 0, 0);
+	_pending.clear();
+	l.unlock();
+
+	obs_enter_graphics();
+	for (auto &inFlight : _inFlight) {
+		DestroySurface(inFlight.surface);
+		inFlight.callback(nullptr, 0, 0, 0);
+	}
+	_inFlight.clear();
+	for (auto &surface : _surfacePool)
+		DestroySurface(surface);
+	_surfacePool.clear();
+	obs_leave_graphics();
+
+	blog_debug("[Utils::Obs::FrameReadback::Handler::~Handler] Handler destroyed.");
+}
+
+std::future<QImage> Utils::Obs::FrameReadback::Handler::RequestFrame(obs_source_t *source, uint32_t width, uint32_t height,
+								     CancelTokenPtr cancelToken)
+{
+	auto promise = std::make_shared<std::promise<QImage>>();
+	std::future<QImage> ret = promise->get_future();
+
+	QueueReadback(source, width, height,
+		      [promise](const uint8_t *data, uint32_t linesize, uint32_t frameWidth, uint32_t frameHeight) {
+			      if (!data) {
+				      promise->set_value(QImage());
+				      return;
+			      }
+
+			      QImage image(frameWidth, frameHeight, QImage::Format::Format_RGBA8888);
+			      int lineSize = image.bytesPerLine();
+			      for (uint y = 0; y < frameHeight; y++)
+				      memcpy(image.scanLine(y), data + (y * linesize), lineSize);
+			      promise->set_value(image);
+		      },
+		      cancelToken);
+
+	return ret;
+}
+
+std::future<std::vector<uint8_t>> Utils::Obs::FrameReadback::Handler::RequestRawFrame(obs_source_t *source, uint32_t width,
+										      uint32_t height, PixelFormat format,
+										      CancelTokenPtr cancelToken)
+{
+	auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+	std::future<std::vector<uint8_t>> ret = promise->get_future();
+
+	QueueReadback(source, width, height,
+		      [promise, format](const uint8_t *data, uint32_t linesize, uint32_t frameWidth, uint32_t frameHeight) {
+			      std::vector<uint8_t> frame;
+			      if (data) {
+				      frame.resize(GetPixelFormatSize(format, frameWidth, frameHeight));
+				      ConvertFrame(format, data, linesize, frameWidth, frameHeight, frame.data());
+			      }
+			      promise->set_value(std::move(frame));
+		      },
+		      cancelToken);
+
+	return ret;
+}
+
+std::future<bool> Utils::Obs::FrameReadback::Handler::RequestRawFrameInto(obs_source_t *source, uint32_t width,
+									  uint32_t height, PixelFormat format, uint8_t *dst,
+									  CancelTokenPtr cancelToken)
+{
+	auto promise = std::make_shared<std::promise<bool>>();
+	std::future<bool> ret = promise->get_future();
+
+	QueueReadback(source, width, height,
+		      [promise, format, width, height, dst](const uint8_t *data, uint32_t linesize, uint32_t frameWidth,
+							   uint32_t frameHeight) {
+			      // `dst` is sized for the requested dimensions only
+			      if (!data || frameWidth != width || frameHeight != height) {
+				      promise->set_value(false);
+				      return;
+			      }
+
+			      ConvertFrame(format, data, linesize, frameWidth, frameHeight, dst);
+			      promise->set_value(true);
+		      },
+		      cancelToken);
+
+	return ret;
+}
+
+Utils::Obs::FrameReadback::CancelTokenPtr Utils::Obs::FrameReadback::Handler::CreateCancelToken()
+{
+	return std::make_shared<CancelToken>();
+}
+
+void Utils::Obs::FrameReadback::Handler::Cancel(const CancelTokenPtr &cancelToken)
+{
+	// A callback which is already running holds the token's mutex until it is done with its destination
+	std::unique_lock<std::mutex> l(cancelToken->mutex);
+	cancelToken->cancelled = true;
+	for (auto &readback : cancelToken->readbacks) {
+		readback->done = true;
+		readback->callback(nullptr, 0, 0, 0);
+	}
+	cancelToken->readbacks.clear();
+	l.unlock();
+
+	// Not worth rendering anymore
+	std::unique_lock<std::mutex> pendingLock(_pendingMutex);
+	auto cancelled = [&cancelToken](const PendingReadback &pending) {
+		return pending.cancelToken == cancelToken;
+	};
+	_pending.erase(std::remove_if(_pending.begin(), _pending.end(), cancelled), _pending.end());
+	_hasPending = !_pending.empty();
+}
+
+void Utils::Obs::FrameReadback::Handler::QueueReadback(obs_source_t *source, uint32_t width, uint32_t height,
+						       MapCallback callback, CancelTokenPtr cancelToken)
+{
+	if (cancelToken) {
+		std::unique_lock<std::mutex> l(cancelToken->mutex);
+		if (cancelToken->cancelled) {
+			l.unlock();
+			callback(nullptr, 0, 0, 0);
+			return;
+		}
+
+		auto readback = std::make_shared<CancelToken::Readback>();
+		readback->callback = std::move(callback);
+		cancelToken->readbacks.push_back(readback);
+
+		// Runs the real callback under the token's mutex, unless `Cancel()` got to it first
+		callback = [cancelToken, readback](const uint8_t *data, uint32_t linesize, uint32_t frameWidth,
+						   uint32_t frameHeight) {
+			std::unique_lock<std::mutex> l(cancelToken->mutex);
+			if (readback->done)
+				return;
+
+			readback->done = true;
+			auto &readbacks = cancelToken->readbacks;
+			readbacks.erase(std::find(readbacks.begin(), readbacks.end(), readback));
+			readback->callback(data, linesize, frameWidth, frameHeight);
+		};
+	}
+
+	// Waiting for a future tick from the graphics thread would deadlock (eg. `SerialFrame` request batches)
+	if (obs_in_task_thread(OBS_TASK_GRAPHICS)) {
+		ScopeProfiler prof{"obs_websocket_frame_readback_immediate"};
+		obs_enter_graphics();
+		Surface surface = AcquireSurface(width, height);
+		if (RenderSource(source, surface))
+			MapSurface(surface, callback);
+		else
+			callback(nullptr, 0, 0, 0);
+		ReleaseSurface(surface);
+		obs_leave_graphics();
+		return;
+	}
+
+	PendingReadback pending{obs_source_get_weak_source(source), width, height, std::move(callback), cancelToken};
+
+	std::unique_lock<std::mutex> l(_pendingMutex);
+	_pending.push_back(std::move(pending));
+	_hasPending = true;
+}
+
+void Utils::Obs::FrameReadback::Handler::ObsTickCallback(void *param, float)
+{
+	auto c = static_cast<Handler *>(param);
+	c->Tick();
+}
+
+void Utils::Obs::FrameReadback::Handler::Tick()
+{
+	_frameCount++;
+
+	if (_inFlight.empty() && !_hasPending)
+		return;
+
+	ScopeProfiler prof{"obs_websocket_frame_readback_tick"};
+
+	std::vector<PendingReadback> pending;
+	if (_hasPending) {
+		std::unique_lock<std::mutex> l(_pendingMutex);
+		pending.swap(_pending);
+		_hasPending = false;
+	}
+
+	obs_enter_graphics();
+
+	// Map frames which were staged long enough ago that mapping them will not stall the pipeline
+	for (auto iter = _inFlight.begin(); iter != _inFlight.end();) {
+		if (_frameCount - iter->stagedFrame < READBACK_DELAY_FRAMES) {
+			++iter;
+			continue;
+		}
+
+		MapSurface(iter->surface, iter->callback);
+		ReleaseSurface(iter->surface);
+		iter = _inFlight.erase(iter);
+	}
+
+	// Render and stage new requests
+	for (auto &readback : pending) {
+		OBSSourceAutoRelease source = obs_weak_source_get_source(readback.source);
+		if (!source) {
+			readback.callback(nullptr, 0, 0, 0);
+			continue;
+		}
+
+		Surface surface = AcquireSurface(readback.width, readback.height);
+		if (!RenderSource(source, surface)) {
+			ReleaseSurface(surface);
+			readback.callback(nullptr, 0, 0, 0);
+			continue;
+		}
+
+		InFlightReadback inFlight;
+		inFlight.surface = surface;
+		inFlight.stagedFrame = _frameCount;
+		inFlight.callback = std::move(readback.callback);
+		_inFlight.push_back(std::move(inFlight));
+	}
+
+	obs_leave_graphics();
+}
+
+// MUST BE IN GRAPHICS CONTEXT
+Utils::Obs::FrameReadback::Handler::Surface Utils::Obs::FrameReadback::Handler::AcquireSurface(uint32_t width, uint32_t height)
+{
+	for (auto iter = _surfacePool.begin(); iter != _surfacePool.end(); ++iter) {
+		if (iter->width == width && iter->height == height) {
+			Surface ret = *iter;
+			_surfacePool.erase(iter);
+			return ret;
+		}
+	}
+
+	Surface ret;
+	ret.texRender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+	ret.stageSurface = gs_stagesurface_create(width, height, GS_RGBA);
+	ret.width = width;
+	ret.height = height;
+	return ret;
+}
+
+// MUST BE IN GRAPHICS CONTEXT
+void Utils::Obs::FrameReadback::Handler::ReleaseSurface(Surface &surface)
+{
+	_surfacePool.push_back(surface);
+	surface = Surface();
+
+	if (_surfacePool.size() > MAX_POOLED_SURFACES) {
+		DestroySurface(_surfacePool.front());
+		_surfacePool.erase(_surfacePool.begin());
+	}
+}
+
+// MUST BE IN GRAPHICS CONTEXT
+bool Utils::Obs::FrameReadback::Handler::RenderSource(obs_source_t *source, Surface &surface)
+{
+	ScopeProfiler prof{"obs_websocket_frame_readback_render"};
+
+	if (!surface.texRender || !surface.stageSurface)
+		return false;
+
+	const uint32_t sourceWidth = obs_source_get_width(source);
+	const uint32_t sourceHeight = obs_source_get_height(source);
+
+	gs_texrender_reset(surface.texRender);
+	if (!gs_texrender_begin(surface.texRender, surface.width, surface.height))
+		return false;
+
+	vec4 background;
+	vec4_zero(&background);
+
+	gs_clear(GS_CLEAR_COLOR, &background, 0.0f, 0);
+	gs_ortho(0.0f, (float)sourceWidth, 0.0f, (float)sourceHeight, -100.0f, 100.0f);
+
+	gs_blend_state_push();
+	gs_blend_function(GS_BLEND_ONE, GS_BLEND_ZERO);
+
+	obs_source_inc_showing(source);
+	obs_source_video_render(source);
+	obs_source_dec_showing(source);
+
+	gs_blend_state_pop();
+	gs_texrender_end(surface.texRender);
+
+	gs_stage_texture(surface.stageSurface, gs_texrender_get_texture(surface.texRender));
+	return true;
+}
+
+// MUST BE IN GRAPHICS CONTEXT
+void Utils::Obs::FrameReadback::Handler::MapSurface(Surface &surface, const MapCallback &callback)
+{
+	// Includes the conversion done by the callback
+	ScopeProfiler prof{"obs_websocket_frame_readback_map"};
+
+	uint8_t *videoData = nullptr;
+	uint32_t videoLinesize = 0;
+	if (!gs_stagesurface_map(surface.stageSurface, &videoData, &videoLinesize)) {
+		callback(nullptr, 0, 0, 0);
+		return;
+	}
+
+	// Consumers copy or convert straight out of the mapped memory
+	callback(videoData, videoLinesize, surface.width, surface.height);
+
+	gs_stagesurface_unmap(surface.stageSurface);
+}
+
+// MUST BE IN GRAPHICS CONTEXT
+void Utils::Obs::FrameReadback::Handler::DestroySurface(Surface &surface)
+{
+	gs_stagesurface_destroy(surface.stageSurface);
+	gs_texrender_destroy(surface.texRender);
+	surface = Surface();
+}
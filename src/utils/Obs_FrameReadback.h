@@ -0,0 +1,115 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <QImage>
+#include <obs.hpp>
+
+#include "Obs_FrameReadback_Kernels.h"
+
+namespace Utils {
+	namespace Obs {
+		namespace FrameReadback {
+			// Readbacks queued with the same token can be failed together, see `Handler::Cancel()`
+			class CancelToken;
+			typedef std::shared_ptr<CancelToken> CancelTokenPtr;
+
+			// Renders sources on the graphics tick into a pool of reused staging surfaces, and maps them a few frames
+			// later once the GPU is done with them. Callers wait on a future instead of holding the graphics context.
+			class Handler {
+			public:
+				Handler();
+				~Handler();
+
+				// Fulfilled with an RGBA8888 image of `source` scaled to `width`x`height`, or a null image on failure.
+				// If called from the graphics thread, the readback is done synchronously.
+				std::future<QImage> RequestFrame(obs_source_t *source, uint32_t width, uint32_t height,
+								 CancelTokenPtr cancelToken = nullptr);
+				// Same as `RequestFrame()`, but converted straight from the mapped surface to `format`, without a QImage.
+				// Fulfilled with an empty vector on failure.
+				std::future<std::vector<uint8_t>> RequestRawFrame(obs_source_t *source, uint32_t width, uint32_t height,
+										  PixelFormat format,
+										  CancelTokenPtr cancelToken = nullptr);
+				// Same as `RequestRawFrame()`, but converted into `dst`, which must hold `GetPixelFormatSize()` bytes and
+				// stay valid until the future is fulfilled, or until `cancelToken` is cancelled. Fulfilled with false on
+				// failure.
+				std::future<bool> RequestRawFrameInto(obs_source_t *source, uint32_t width, uint32_t height,
+								      PixelFormat format, uint8_t *dst,
+								      CancelTokenPtr cancelToken = nullptr);
+
+				static CancelTokenPtr CreateCancelToken();
+				// Fails every readback queued with `cancelToken`, and every one queued with it later. Once this returns,
+				// none of them touches its destination anymore, and all of their futures are fulfilled.
+				void Cancel(const CancelTokenPtr &cancelToken);
+
+			private:
+				// Called with the mapped RGBA surface, or with nullptr on failure
+				typedef std::function<void(const uint8_t *, uint32_t, uint32_t, uint32_t)>
+					MapCallback; // const uint8_t *data, uint32_t linesize, uint32_t width, uint32_t height
+
+				struct Surface {
+					gs_texrender_t *texRender = nullptr;
+					gs_stagesurf_t *stageSurface = nullptr;
+					uint32_t width = 0;
+					uint32_t height = 0;
+				};
+
+				struct PendingReadback {
+					OBSWeakSourceAutoRelease source;
+					uint32_t width;
+					uint32_t height;
+					MapCallback callback;
+					CancelTokenPtr cancelToken;
+				};
+
+				struct InFlightReadback {
+					Surface surface;
+					uint64_t stagedFrame;
+					MapCallback callback;
+				};
+
+				std::mutex _pendingMutex;
+				std::vector<PendingReadback> _pending;
+				std::atomic<bool> _hasPending = false;
+
+				// Only touched on the graphics thread
+				std::vector<InFlightReadback> _inFlight;
+				std::vector<Surface> _surfacePool;
+				uint64_t _frameCount = 0;
+
+				void QueueReadback(obs_source_t *source, uint32_t width, uint32_t height, MapCallback callback,
+						   CancelTokenPtr cancelToken);
+				void Tick();
+				Surface AcquireSurface(uint32_t width, uint32_t height);
+				void ReleaseSurface(Surface &surface);
+				static bool RenderSource(obs_source_t *source, Surface &surface);
+				static void MapSurface(Surface &surface, const MapCallback &callback);
+				static void DestroySurface(Surface &surface);
+				static void ObsTickCallback(void *param, float);
+			};
+		}
+	}
+}
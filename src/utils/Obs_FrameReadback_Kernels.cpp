@@ -0,0 +1,269 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cstring>
+#include <algorithm>
+#include <util/sse-intrin.h>
+
+#include "Obs_FrameReadback_Kernels.h"
+
+// BT.709 limited range RGB to YUV coefficients, in 8 bit fixed point. Each chroma row sums to 0 so that greys stay neutral
+#define Y_R 47
+#define Y_G 157
+#define Y_B 16
+#define U_R -26
+#define U_G -86
+#define U_B 112
+#define V_R 112
+#define V_G -102
+#define V_B -10
+
+Utils::Obs::FrameReadback::PixelFormat Utils::Obs::FrameReadback::GetPixelFormat(const std::string &name)
+{
+	if (name == "raw_rgba")
+		return PixelFormat::Rgba;
+	else if (name == "raw_bgra")
+		return PixelFormat::Bgra;
+	else if (name == "nv12")
+		return PixelFormat::Nv12;
+	else if (name == "i420")
+		return PixelFormat::I420;
+	return PixelFormat::None;
+}
+
+size_t Utils::Obs::FrameReadback::GetPixelFormatSize(PixelFormat format, uint32_t width, uint32_t height)
+{
+	switch (format) {
+	case PixelFormat::Rgba:
+	case PixelFormat::Bgra:
+		return (size_t)width * height * 4;
+	case PixelFormat::Nv12:
+	case PixelFormat::I420:
+		return (size_t)width * height + 2 * (size_t)((width + 1) / 2) * ((height + 1) / 2);
+	default:
+		return 0;
+	}
+}
+
+void Utils::Obs::FrameReadback::ConvertFrame(PixelFormat format, const uint8_t *src, uint32_t srcLinesize, uint32_t width,
+					     uint32_t height, uint8_t *dst)
+{
+	size_t lumaSize = (size_t)width * height;
+	size_t chromaSize = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+
+	switch (format) {
+	case PixelFormat::Rgba:
+		Kernels::CopyRgba(src, srcLinesize, width, height, dst);
+		break;
+	case PixelFormat::Bgra:
+		Kernels::ConvertRgbaToBgra(src, srcLinesize, width, height, dst);
+		break;
+	case PixelFormat::Nv12:
+		Kernels::ConvertRgbaToYuv420(src, srcLinesize, width, height, dst, dst + lumaSize, dst + lumaSize + 1, 2);
+		break;
+	case PixelFormat::I420:
+		Kernels::ConvertRgbaToYuv420(src, srcLinesize, width, height, dst, dst + lumaSize, dst + lumaSize + chromaSize,
+					     1);
+		break;
+	default:
+		break;
+	}
+}
+
+void Utils::Obs::FrameReadback::Kernels::CopyRgba(const uint8_t *src, uint32_t srcLinesize, uint32_t width, uint32_t height,
+						  uint8_t *dst)
+{
+	size_t lineSize = (size_t)width * 4;
+	if (srcLinesize == lineSize) {
+		memcpy(dst, src, lineSize * height);
+		return;
+	}
+
+	for (uint32_t y = 0; y < height; y++)
+		memcpy(dst + y * lineSize, src + (size_t)y * srcLinesize, lineSize);
+}
+
+void Utils::Obs::FrameReadback::Kernels::ConvertRgbaToBgra(const uint8_t *src, uint32_t srcLinesize, uint32_t width,
+							   uint32_t height, uint8_t *dst)
+{
+	// Pixels are little-endian 0xAABBGGRR, so R and B swap by shifting 16 bits each way
+	const __m128i byteMask = _mm_set1_epi32(0x000000FF);
+	const __m128i agMask = _mm_set1_epi32((int)0xFF00FF00);
+
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *srcLine = src + (size_t)y * srcLinesize;
+		uint8_t *dstLine = dst + (size_t)y * width * 4;
+
+		uint32_t x = 0;
+		for (; x + 4 <= width; x += 4) {
+			__m128i px = _mm_loadu_si128((const __m128i *)(srcLine + x * 4));
+			__m128i ag = _mm_and_si128(px, agMask);
+			__m128i r = _mm_slli_epi32(_mm_and_si128(px, byteMask), 16);
+			__m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), byteMask);
+			_mm_storeu_si128((__m128i *)(dstLine + x * 4), _mm_or_si128(ag, _mm_or_si128(r, b)));
+		}
+
+		for (; x < width; x++) {
+			dstLine[x * 4 + 0] = srcLine[x * 4 + 2];
+			dstLine[x * 4 + 1] = srcLine[x * 4 + 1];
+			dstLine[x * 4 + 2] = srcLine[x * 4 + 0];
+			dstLine[x * 4 + 3] = srcLine[x * 4 + 3];
+		}
+	}
+}
+
+static inline uint8_t RgbToY(int r, int g, int b)
+{
+	return (uint8_t)(((Y_R * r + Y_G * g + Y_B * b + 128) >> 8) + 16);
+}
+
+// `r`, `g` and `b` are sums of the 4 pixels of a 2x2 block
+static inline uint8_t RgbSumToU(int r, int g, int b)
+{
+	return (uint8_t)(((U_R * r + U_G * g + U_B * b + 512) >> 10) + 128);
+}
+
+static inline uint8_t RgbSumToV(int r, int g, int b)
+{
+	return (uint8_t)(((V_R * r + V_G * g + V_B * b + 512) >> 10) + 128);
+}
+
+// Lanes hold 0x0000XXXX values, so 16 bit multiplies and madds give exact 32 bit results
+static inline __m128i Coefficient(int value)
+{
+	return _mm_set1_epi32(value & 0xFFFF);
+}
+
+static inline __m128i RgbaToY(__m128i px)
+{
+	const __m128i byteMask = _mm_set1_epi32(0x000000FF);
+	__m128i r = _mm_and_si128(px, byteMask);
+	__m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), byteMask);
+	__m128i b = _mm_and_si128(_mm_srli_epi32(px, 16), byteMask);
+
+	// The weighted sum is at most 220 * 255, which fits in the low 16 bits of each lane
+	__m128i y = _mm_mullo_epi16(r, Coefficient(Y_R));
+	y = _mm_add_epi32(y, _mm_mullo_epi16(g, Coefficient(Y_G)));
+	y = _mm_add_epi32(y, _mm_mullo_epi16(b, Coefficient(Y_B)));
+	y = _mm_srli_epi32(_mm_add_epi32(y, _mm_set1_epi32(128)), 8);
+	return _mm_add_epi32(y, _mm_set1_epi32(16));
+}
+
+// Returns U in lanes 0 and 1 and V in lanes 2 and 3, for the two 2x2 blocks covered by 2 pixels of each row
+static inline void RgbaBlocksToUv(__m128i top, __m128i bottom, __m128i &u, __m128i &v)
+{
+	const __m128i byteMask = _mm_set1_epi32(0x000000FF);
+	__m128i r = _mm_add_epi32(_mm_and_si128(top, byteMask), _mm_and_si128(bottom, byteMask));
+	__m128i g = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(top, 8), byteMask),
+				  _mm_and_si128(_mm_srli_epi32(bottom, 8), byteMask));
+	__m128i b = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(top, 16), byteMask),
+				  _mm_and_si128(_mm_srli_epi32(bottom, 16), byteMask));
+
+	// Sum horizontally adjacent pixels into lanes 0 and 2
+	r = _mm_add_epi32(r, _mm_srli_epi64(r, 32));
+	g = _mm_add_epi32(g, _mm_srli_epi64(g, 32));
+	b = _mm_add_epi32(b, _mm_srli_epi64(b, 32));
+
+	const __m128i rounding = _mm_set1_epi32(512);
+	const __m128i offset = _mm_set1_epi32(128);
+
+	u = _mm_madd_epi16(r, Coefficient(U_R));
+	u = _mm_add_epi32(u, _mm_madd_epi16(g, Coefficient(U_G)));
+	u = _mm_add_epi32(u, _mm_madd_epi16(b, Coefficient(U_B)));
+	u = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(u, rounding), 10), offset);
+
+	v = _mm_madd_epi16(r, Coefficient(V_R));
+	v = _mm_add_epi32(v, _mm_madd_epi16(g, Coefficient(V_G)));
+	v = _mm_add_epi32(v, _mm_madd_epi16(b, Coefficient(V_B)));
+	v = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(v, rounding), 10), offset);
+
+	// Move lanes 0 and 2 to the low half
+	u = _mm_shuffle_epi32(u, _MM_SHUFFLE(3, 1, 2, 0));
+	v = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+void Utils::Obs::FrameReadback::Kernels::ConvertRgbaToYuv420(const uint8_t *src, uint32_t srcLinesize, uint32_t width,
+							     uint32_t height, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV,
+							     size_t chromaStep)
+{
+	// Luma
+	for (uint32_t y = 0; y < height; y++) {
+		const uint8_t *srcLine = src + (size_t)y * srcLinesize;
+		uint8_t *dstLine = dstY + (size_t)y * width;
+
+		uint32_t x = 0;
+		for (; x + 16 <= width; x += 16) {
+			__m128i y0 = RgbaToY(_mm_loadu_si128((const __m128i *)(srcLine + x * 4)));
+			__m128i y1 = RgbaToY(_mm_loadu_si128((const __m128i *)(srcLine + x * 4 + 16)));
+			__m128i y2 = RgbaToY(_mm_loadu_si128((const __m128i *)(srcLine + x * 4 + 32)));
+			__m128i y3 = RgbaToY(_mm_loadu_si128((const __m128i *)(srcLine + x * 4 + 48)));
+			__m128i packed = _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+			_mm_storeu_si128((__m128i *)(dstLine + x), packed);
+		}
+
+		for (; x < width; x++)
+			dstLine[x] = RgbToY(srcLine[x * 4], srcLine[x * 4 + 1], srcLine[x * 4 + 2]);
+	}
+
+	// Chroma, from the average of each 2x2 block. Odd edges repeat their last row or column
+	uint32_t chromaWidth = (width + 1) / 2;
+	uint32_t chromaHeight = (height + 1) / 2;
+	for (uint32_t cy = 0; cy < chromaHeight; cy++) {
+		const uint8_t *top = src + (size_t)(cy * 2) * srcLinesize;
+		const uint8_t *bottom = src + (size_t)std::min(cy * 2 + 1, height - 1) * srcLinesize;
+		uint8_t *lineU = dstU + (size_t)cy * chromaWidth * chromaStep;
+		uint8_t *lineV = dstV + (size_t)cy * chromaWidth * chromaStep;
+
+		uint32_t x = 0;
+		for (; x + 8 <= width; x += 8) {
+			__m128i u0, v0, u1, v1;
+			RgbaBlocksToUv(_mm_loadu_si128((const __m128i *)(top + x * 4)),
+				       _mm_loadu_si128((const __m128i *)(bottom + x * 4)), u0, v0);
+			RgbaBlocksToUv(_mm_loadu_si128((const __m128i *)(top + x * 4 + 16)),
+				       _mm_loadu_si128((const __m128i *)(bottom + x * 4 + 16)), u1, v1);
+
+			__m128i u = _mm_unpacklo_epi64(u0, u1);
+			__m128i v = _mm_unpacklo_epi64(v0, v1);
+			u = _mm_packs_epi32(u, u);
+			v = _mm_packs_epi32(v, v);
+
+			size_t cx = x / 2;
+			if (chromaStep == 2) {
+				__m128i uv = _mm_packus_epi16(_mm_unpacklo_epi16(u, v), u);
+				_mm_storel_epi64((__m128i *)(lineU + cx * 2), uv);
+			} else {
+				int32_t packedU = _mm_cvtsi128_si32(_mm_packus_epi16(u, u));
+				int32_t packedV = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+				memcpy(lineU + cx, &packedU, 4);
+				memcpy(lineV + cx, &packedV, 4);
+			}
+		}
+
+		for (; x < width; x += 2) {
+			uint32_t x1 = std::min(x + 1, width - 1);
+			int r = top[x * 4] + top[x1 * 4] + bottom[x * 4] + bottom[x1 * 4];
+			int g = top[x * 4 + 1] + top[x1 * 4 + 1] + bottom[x * 4 + 1] + bottom[x1 * 4 + 1];
+			int b = top[x * 4 + 2] + top[x1 * 4 + 2] + bottom[x * 4 + 2] + bottom[x1 * 4 + 2];
+
+			size_t cx = x / 2;
+			lineU[cx * chromaStep] = RgbSumToU(r, g, b);
+			lineV[cx * chromaStep] = RgbSumToV(r, g, b);
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Utils {
+	namespace Obs {
+		namespace FrameReadback {
+			// Tightly packed pixel layouts which can be produced straight from a mapped RGBA staging surface
+			enum class PixelFormat {
+				None,
+				Rgba,
+				Bgra,
+				Nv12, // BT.709 limited range, full size Y plane followed by interleaved half size UV plane
+				I420, // BT.709 limited range, full size Y plane followed by half size U and V planes
+			};
+
+			// Maps `raw_rgba`, `raw_bgra`, `nv12` and `i420` to their format, anything else to `PixelFormat::None`
+			PixelFormat GetPixelFormat(const std::string &name);
+			size_t GetPixelFormatSize(PixelFormat format, uint32_t width, uint32_t height);
+
+			// `src` is RGBA8888 with `srcLinesize` bytes per line. `dst` must hold `GetPixelFormatSize()` bytes.
+			// Vectorized with SSE2, which is NEON on ARM through libobs' SSE intrinsic translation.
+			void ConvertFrame(PixelFormat format, const uint8_t *src, uint32_t srcLinesize, uint32_t width,
+					  uint32_t height, uint8_t *dst);
+
+			namespace Kernels {
+				void CopyRgba(const uint8_t *src, uint32_t srcLinesize, uint32_t width, uint32_t height,
+					      uint8_t *dst);
+				void ConvertRgbaToBgra(const uint8_t *src, uint32_t srcLinesize, uint32_t width, uint32_t height,
+						       uint8_t *dst);
+				void ConvertRgbaToYuv420(const uint8_t *src, uint32_t srcLinesize, uint32_t width, uint32_t height,
+							 uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, size_t chromaStep);
+			}
+		}
+	}
+}
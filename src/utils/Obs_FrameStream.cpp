@@ -0,0 +1,431 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include <QCoreApplication>
+#include <QImage>
+#include <util/platform.h>
+
+#include "Obs_FrameStream.h"
+#include "Obs_FrameReadback.h"
+#include "Image.h"
+#include "../obs-websocket.h"
+#include "../websocketserver/WebSocketServer.h"
+
+// Maximum time to wait for the graphics thread to deliver a frame, in milliseconds
+#define FRAME_STREAM_READBACK_TIMEOUT 1000
+// Maximum number of readbacks a frame stream keeps in flight. Shared memory exports use one less than their slot count
+#define FRAME_STREAM_MAX_IN_FLIGHT 3
+
+// Offset of the latest frame sequence in the shared memory header
+#define FRAME_EXPORT_LATEST_SEQUENCE_OFFSET 32
+
+static inline void WriteFrameValue(uint8_t *&dest, const void *src, size_t size)
+{
+	memcpy(dest, src, size);
+	dest += size;
+}
+
+Utils::Obs::FrameStream::Handler::Handler(FrameCallback cb) : _frameCallback(cb)
+{
+	blog_debug("[Utils::Obs::FrameStream::Handler::Handler] Handler created.");
+}
+
+Utils::Obs::FrameStream::Handler::~Handler()
+{
+	std::unique_lock<std::mutex> l(_streamMutex);
+	auto streams = std::move(_streams);
+	_streams.clear();
+	l.unlock();
+
+	for (auto &stream : streams)
+		StopStream(stream.second);
+
+	blog_debug("[Utils::Obs::FrameStream::Handler::~Handler] Handler destroyed.");
+}
+
+uint32_t Utils::Obs::FrameStream::Handler::Subscribe(uint32_t sessionId, obs_source_t *source, uint32_t width, uint32_t height,
+						     std::string format, int quality, uint64_t period,
+						     bool sharedMemory)
+{
+	std::unique_lock<std::mutex> l(_streamMutex);
+
+	// Reuse an existing pipeline for the same output
+	StreamPtr stream;
+	for (auto &it : _streams) {
+		auto &existing = it.second;
+		if (obs_weak_source_references_source(existing->source, source) && existing->width == width &&
+		    existing->height == height && existing->format == format && existing->quality == quality &&
+		    (existing->sharedMemory != nullptr) == sharedMemory) {
+			stream = existing;
+			break;
+		}
+	}
+
+	if (!stream) {
+		stream = std::make_shared<Stream>();
+		stream->id = _nextStreamId++;
+		stream->source = obs_source_get_weak_source(source);
+		stream->width = width;
+		stream->height = height;
+		stream->format = format;
+		stream->quality = quality;
+		stream->cancelToken = FrameReadback::Handler::CreateCancelToken();
+
+		if (sharedMemory) {
+			auto pixelFormat = FrameReadback::GetPixelFormat(format);
+			if (pixelFormat == FrameReadback::PixelFormat::None)
+				return 0;
+
+			// Slots are cache line aligned, so that readers can use aligned loads
+			uint32_t frameSize = (uint32_t)FrameReadback::GetPixelFormatSize(pixelFormat, width, height);
+			stream->slotStride = (FRAME_EXPORT_SLOT_HEADER_SIZE + frameSize + 63) & ~(size_t)63;
+
+			std::string name = QString("obs-websocket-%1-%2")
+						   .arg(QCoreApplication::applicationPid())
+						   .arg(stream->id)
+						   .toStdString();
+			stream->sharedMemory = std::make_unique<Utils::Platform::SharedMemory>(
+				name, FRAME_EXPORT_HEADER_SIZE + (stream->slotStride * FRAME_EXPORT_SLOT_COUNT));
+			if (!stream->sharedMemory->IsValid())
+				return 0;
+
+			// The region is zero-initialized, so the latest sequence and every slot sequence start out as 0
+			uint8_t *data = stream->sharedMemory->Data();
+			uint16_t version = FRAME_EXPORT_VERSION;
+			uint16_t formatId = (uint16_t)pixelFormat;
+			uint32_t slotCount = FRAME_EXPORT_SLOT_COUNT;
+			uint64_t slotStride = stream->slotStride;
+			WriteFrameValue(data, FRAME_EXPORT_MAGIC, 4);
+			WriteFrameValue(data, &version, sizeof(uint16_t));
+			WriteFrameValue(data, &formatId, sizeof(uint16_t));
+			WriteFrameValue(data, &width, sizeof(uint32_t));
+			WriteFrameValue(data, &height, sizeof(uint32_t));
+			WriteFrameValue(data, &slotCount, sizeof(uint32_t));
+			WriteFrameValue(data, &frameSize, sizeof(uint32_t));
+			WriteFrameValue(data, &slotStride, sizeof(uint64_t));
+		}
+
+		_streams[stream->id] = stream;
+
+		blog_debug("[Utils::Obs::FrameStream::Handler::Subscribe] Created %sstream %u for source `%s` (%ux%u %s)",
+			   sharedMemory ? "shared memory " : "", stream->id, obs_source_get_name(source), width, height,
+			   format.c_str());
+	}
+
+	std::unique_lock<std::mutex> streamLock(stream->mutex);
+	auto subscriber = std::find_if(stream->subscribers.begin(), stream->subscribers.end(),
+				       [sessionId](const Subscriber &s) { return s.sessionId == sessionId; });
+	if (subscriber != stream->subscribers.end())
+		subscriber->period = period;
+	else
+		stream->subscribers.push_back({sessionId, period});
+	streamLock.unlock();
+
+	if (!stream->running) {
+		stream->running = true;
+		stream->thread = std::thread(&Handler::StreamThread, this, stream);
+	} else {
+		// Wake the thread up, in case the new subscriber wants a faster rate
+		stream->cond.notify_all();
+	}
+
+	return stream->id;
+}
+
+bool Utils::Obs::FrameStream::Handler::Unsubscribe(uint32_t sessionId, uint32_t streamId)
+{
+	std::unique_lock<std::mutex> l(_streamMutex);
+	auto it = _streams.find(streamId);
+	if (it == _streams.end())
+		return false;
+
+	StreamPtr stream = it->second;
+
+	std::unique_lock<std::mutex> streamLock(stream->mutex);
+	auto &subscribers = stream->subscribers;
+	auto subscriber = std::find_if(subscribers.begin(), subscribers.end(),
+				       [sessionId](const Subscriber &s) { return s.sessionId == sessionId; });
+	if (subscriber == subscribers.end())
+		return false;
+
+	subscribers.erase(subscriber);
+	bool empty = subscribers.empty();
+	streamLock.unlock();
+
+	if (!empty)
+		return true;
+
+	_streams.erase(it);
+	l.unlock();
+
+	StopStream(stream);
+	return true;
+}
+
+bool Utils::Obs::FrameStream::Handler::GetSharedMemoryInfo(uint32_t streamId, std::string &name, size_t &size)
+{
+	std::unique_lock<std::mutex> l(_streamMutex);
+	auto it = _streams.find(streamId);
+	if (it == _streams.end() || !it->second->sharedMemory)
+		return false;
+
+	name = it->second->sharedMemory->Name();
+	size = it->second->sharedMemory->Size();
+	return true;
+}
+
+// Called when a session disconnects
+void Utils::Obs::FrameStream::Handler::UnsubscribeAll(uint32_t sessionId)
+{
+	std::vector<StreamPtr> stoppedStreams;
+
+	std::unique_lock<std::mutex> l(_streamMutex);
+	for (auto it = _streams.begin(); it != _streams.end();) {
+		StreamPtr stream = it->second;
+
+		std::unique_lock<std::mutex> streamLock(stream->mutex);
+		auto &subscribers = stream->subscribers;
+		subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+						 [sessionId](const Subscriber &s) { return s.sessionId == sessionId; }),
+				  subscribers.end());
+		bool empty = subscribers.empty();
+		streamLock.unlock();
+
+		if (empty) {
+			stoppedStreams.push_back(stream);
+			it = _streams.erase(it);
+		} else {
+			++it;
+		}
+	}
+	l.unlock();
+
+	for (auto &stream : stoppedStreams)
+		StopStream(stream);
+}
+
+void Utils::Obs::FrameStream::Handler::StopStream(StreamPtr stream)
+{
+	// Fails the readback the thread may be waiting on, and keeps the graphics thread off the shared memory from now on
+	auto frameReadbackHandler = GetFrameReadbackHandler();
+	if (frameReadbackHandler)
+		frameReadbackHandler->Cancel(stream->cancelToken);
+
+	if (stream->running) {
+		std::unique_lock<std::mutex> l(stream->mutex);
+		stream->running = false;
+		l.unlock();
+		stream->cond.notify_all();
+	}
+
+	if (stream->thread.joinable())
+		stream->thread.join();
+
+	blog_debug("[Utils::Obs::FrameStream::Handler::StopStream] Stopped stream %u", stream->id);
+}
+
+// Seqlock style: readers must discard a slot whose sequence is 0, or changed while they were copying it
+std::future<bool> Utils::Obs::FrameStream::Handler::BeginExportFrame(StreamPtr stream, FrameReadback::Handler *frameReadbackHandler,
+								     obs_source_t *source, FrameReadback::PixelFormat pixelFormat,
+								     uint16_t slot)
+{
+	uint8_t *slotData = stream->sharedMemory->Data() + FRAME_EXPORT_HEADER_SIZE + (slot * stream->slotStride);
+	auto slotSequence = reinterpret_cast<std::atomic<uint64_t> *>(slotData);
+
+	slotSequence->store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	// No timeout on this one, as the slot must not be written by the graphics thread once the region is unmapped.
+	// `StopStream()` cancels the readback instead.
+	return frameReadbackHandler->RequestRawFrameInto(source, stream->width, stream->height, pixelFormat,
+							 slotData + FRAME_EXPORT_SLOT_HEADER_SIZE, stream->cancelToken);
+}
+
+void Utils::Obs::FrameStream::Handler::FinishExportFrame(StreamPtr stream, const InFlightFrame &frame)
+{
+	uint8_t *data = stream->sharedMemory->Data();
+	uint8_t *slotData = data + FRAME_EXPORT_HEADER_SIZE + (frame.slot * stream->slotStride);
+	auto slotSequence = reinterpret_cast<std::atomic<uint64_t> *>(slotData);
+	auto latestSequence = reinterpret_cast<std::atomic<uint64_t> *>(data + FRAME_EXPORT_LATEST_SEQUENCE_OFFSET);
+
+	memcpy(slotData + sizeof(uint64_t), &frame.timestamp, sizeof(uint64_t));
+	slotSequence->store(frame.exportSequence, std::memory_order_release);
+	latestSequence->store(frame.exportSequence, std::memory_order_release);
+}
+
+bool Utils::Obs::FrameStream::Handler::WaitForFrame(const InFlightFrame &frame, uint64_t timeout)
+{
+	auto duration = std::chrono::milliseconds(timeout);
+	if (frame.exported.valid())
+		return frame.exported.wait_for(duration) == std::future_status::ready;
+	else if (frame.rawFrame.valid())
+		return frame.rawFrame.wait_for(duration) == std::future_status::ready;
+	return frame.frame.wait_for(duration) == std::future_status::ready;
+}
+
+// Readbacks complete a few graphics ticks after they are issued, so several are kept in flight to keep up with the frame rate
+void Utils::Obs::FrameStream::Handler::StreamThread(StreamPtr stream)
+{
+	std::vector<uint8_t> frameBuffer;
+	std::vector<uint32_t> sessionIds;
+	std::deque<InFlightFrame> inFlight;
+	uint32_t frameSequence = 0;
+	uint64_t exportSequence = 0;
+	uint64_t lastCapture = 0;
+	auto pixelFormat = FrameReadback::GetPixelFormat(stream->format);
+	// Keeps one slot out of the ring, which holds the latest complete frame while the others are being written
+	const size_t maxInFlight = stream->sharedMemory ? FRAME_EXPORT_SLOT_COUNT - 1 : FRAME_STREAM_MAX_IN_FLIGHT;
+
+	while (stream->running) {
+		// Run at the fastest rate requested by any subscriber
+		std::unique_lock<std::mutex> l(stream->mutex);
+		uint64_t period = 0;
+		for (auto &subscriber : stream->subscribers) {
+			if (!period || subscriber.period < period)
+				period = subscriber.period;
+		}
+
+		uint64_t elapsed = (os_gettime_ns() - lastCapture) / 1000000;
+		uint64_t untilCapture = (lastCapture && elapsed < period) ? period - elapsed : 0;
+		if (untilCapture && inFlight.empty()) {
+			stream->cond.wait_for(l, std::chrono::milliseconds(untilCapture));
+			continue; // Re-evaluate, as the subscribers may have changed
+		}
+		l.unlock();
+
+		// Issue a readback when one is due and there is room for it
+		if (!untilCapture && inFlight.size() < maxInFlight) {
+			lastCapture = os_gettime_ns();
+
+			OBSSourceAutoRelease source = obs_weak_source_get_source(stream->source);
+			auto frameReadbackHandler = GetFrameReadbackHandler();
+			if (!source || !frameReadbackHandler)
+				continue;
+
+			InFlightFrame frame;
+			frame.timestamp = lastCapture;
+			if (stream->sharedMemory) {
+				// Sequences are assigned when issuing, so that frames in flight have distinct slots
+				frame.exportSequence = ++exportSequence;
+				frame.slot = (frame.exportSequence - 1) % FRAME_EXPORT_SLOT_COUNT;
+				frame.exported =
+					BeginExportFrame(stream, frameReadbackHandler.get(), source, pixelFormat, frame.slot);
+			} else if (pixelFormat != FrameReadback::PixelFormat::None) {
+				frame.rawFrame = frameReadbackHandler->RequestRawFrame(source, stream->width, stream->height,
+										       pixelFormat, stream->cancelToken);
+			} else {
+				frame.frame = frameReadbackHandler->RequestFrame(source, stream->width, stream->height,
+										 stream->cancelToken);
+			}
+			inFlight.push_back(std::move(frame));
+			continue;
+		}
+
+		// Otherwise wait for the oldest readback, until the next one is due. Readbacks complete in order
+		InFlightFrame &frame = inFlight.front();
+		if (!WaitForFrame(frame, untilCapture ? untilCapture : FRAME_STREAM_READBACK_TIMEOUT)) {
+			// Exports are never abandoned, as their slot is still being written to
+			uint64_t age = (os_gettime_ns() - frame.timestamp) / 1000000;
+			if (!stream->sharedMemory && age >= FRAME_STREAM_READBACK_TIMEOUT)
+				inFlight.pop_front();
+			continue;
+		}
+
+		// Encode once for every subscriber of this stream
+		const uint8_t *imageData = nullptr;
+		size_t imageSize = 0;
+		uint64_t timestamp = frame.timestamp;
+		uint16_t slot = frame.slot;
+		uint32_t sequence;
+		std::vector<uint8_t> rawImage;
+		std::vector<uint8_t> encodedImage;
+		if (stream->sharedMemory) {
+			bool exported = frame.exported.get();
+			if (exported)
+				FinishExportFrame(stream, frame);
+			sequence = (uint32_t)frame.exportSequence;
+			inFlight.pop_front();
+			if (!exported)
+				continue;
+		} else if (frame.rawFrame.valid()) {
+			rawImage = frame.rawFrame.get();
+			inFlight.pop_front();
+			if (rawImage.empty())
+				continue;
+
+			imageData = rawImage.data();
+			imageSize = rawImage.size();
+			sequence = ++frameSequence;
+		} else {
+			QImage image = frame.frame.get();
+			inFlight.pop_front();
+			if (image.isNull())
+				continue;
+
+			auto webSocketServer = GetWebSocketServer();
+			QThreadPool *encodePool = webSocketServer ? webSocketServer->GetEncodeThreadPool() : nullptr;
+			if (!Image::Encode(image, stream->format, stream->quality, encodedImage, encodePool)) {
+				blog(LOG_WARNING,
+				     "[Utils::Obs::FrameStream::Handler::StreamThread] Failed to encode frame for stream %u",
+				     stream->id);
+				continue;
+			}
+
+			imageData = encodedImage.data();
+			imageSize = encodedImage.size();
+			sequence = ++frameSequence;
+		}
+
+		size_t frameSize = FRAME_STREAM_HEADER_SIZE + imageSize;
+		if (frameBuffer.size() < frameSize)
+			frameBuffer.resize(frameSize);
+
+		// Shared memory notifications carry the slot index where frame messages have a reserved field
+		uint8_t *data = frameBuffer.data();
+		uint16_t version = stream->sharedMemory ? FRAME_EXPORT_VERSION : FRAME_STREAM_VERSION;
+		WriteFrameValue(data, stream->sharedMemory ? FRAME_EXPORT_NOTIFICATION_MAGIC : FRAME_STREAM_MAGIC, 4);
+		WriteFrameValue(data, &version, sizeof(uint16_t));
+		WriteFrameValue(data, &slot, sizeof(uint16_t));
+		WriteFrameValue(data, &stream->id, sizeof(uint32_t));
+		WriteFrameValue(data, &sequence, sizeof(uint32_t));
+		WriteFrameValue(data, &timestamp, sizeof(uint64_t));
+		if (imageSize)
+			WriteFrameValue(data, imageData, imageSize);
+
+		// Downsample to each subscriber's own rate. Half a period of tolerance absorbs capture jitter
+		uint64_t now = os_gettime_ns();
+		sessionIds.clear();
+		l.lock();
+		for (auto &subscriber : stream->subscribers) {
+			if (now - subscriber.lastSent + (period * 500000) < subscriber.period * 1000000)
+				continue;
+			subscriber.lastSent = now;
+			sessionIds.push_back(subscriber.sessionId);
+		}
+		l.unlock();
+
+		if (_frameCallback) {
+			for (auto sessionId : sessionIds)
+				_frameCallback(sessionId, frameBuffer.data(), frameSize);
+		}
+	}
+}
@@ -0,0 +1,127 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <obs.hpp>
+
+#include "Obs_FrameReadback.h"
+#include "Platform.h"
+
+// Magic bytes at the start of every binary source frame message
+#define FRAME_STREAM_MAGIC "OWFS"
+#define FRAME_STREAM_VERSION 1
+#define FRAME_STREAM_HEADER_SIZE 24
+
+// Magic bytes of shared memory frame exports, and of their frame notification messages (same header as above, no payload)
+#define FRAME_EXPORT_MAGIC "OWSM"
+#define FRAME_EXPORT_NOTIFICATION_MAGIC "OWFX"
+#define FRAME_EXPORT_VERSION 1
+#define FRAME_EXPORT_HEADER_SIZE 64
+#define FRAME_EXPORT_SLOT_HEADER_SIZE 64
+#define FRAME_EXPORT_SLOT_COUNT 4
+
+namespace Utils {
+	namespace Obs {
+		namespace FrameStream {
+			// Renders, reads back and encodes frames of a source once per (source, size, format, quality), and fans the
+			// encoded frames out to every subscriber at its own rate.
+			// Shared memory streams instead convert raw frames straight into a ring of slots in a named shared memory
+			// region, and only send small notifications to their subscribers.
+			class Handler {
+				typedef std::function<void(uint32_t, const uint8_t *, size_t)>
+					FrameCallback; // uint32_t sessionId, const uint8_t *data, size_t size
+
+			public:
+				Handler(FrameCallback cb);
+				~Handler();
+
+				// Returns the ID of the (possibly shared) stream. Subscribing again to the same stream updates the period.
+				// Returns 0 if the shared memory region could not be created.
+				uint32_t Subscribe(uint32_t sessionId, obs_source_t *source, uint32_t width, uint32_t height,
+						   std::string format, int quality, uint64_t period, bool sharedMemory = false);
+				bool Unsubscribe(uint32_t sessionId, uint32_t streamId);
+				void UnsubscribeAll(uint32_t sessionId);
+				// Only valid for shared memory streams
+				bool GetSharedMemoryInfo(uint32_t streamId, std::string &name, size_t &size);
+
+			private:
+				struct Subscriber {
+					uint32_t sessionId; // Session addresses can be reused once a session is gone, IDs are not
+					uint64_t period;    // ms
+					uint64_t lastSent = 0;
+				};
+
+				struct Stream {
+					uint32_t id;
+					OBSWeakSourceAutoRelease source;
+					uint32_t width;
+					uint32_t height;
+					std::string format;
+					int quality;
+					std::unique_ptr<Utils::Platform::SharedMemory> sharedMemory;
+					size_t slotStride = 0;
+					FrameReadback::CancelTokenPtr cancelToken; // Cancelled before the thread is joined
+
+					std::mutex mutex;
+					std::condition_variable cond;
+					std::vector<Subscriber> subscribers;
+					std::atomic<bool> running = false;
+					std::thread thread;
+				};
+				typedef std::shared_ptr<Stream> StreamPtr;
+
+				// Issued by a stream thread, and not sent yet. Only one of the futures is valid
+				struct InFlightFrame {
+					uint64_t timestamp;
+					uint16_t slot = 0;
+					uint64_t exportSequence = 0;
+					std::future<bool> exported;
+					std::future<std::vector<uint8_t>> rawFrame;
+					std::future<QImage> frame;
+				};
+
+				FrameCallback _frameCallback;
+
+				std::mutex _streamMutex;
+				std::map<uint32_t, StreamPtr> _streams;
+				uint32_t _nextStreamId = 1;
+
+				void StreamThread(StreamPtr stream);
+				static std::future<bool> BeginExportFrame(StreamPtr stream,
+									  FrameReadback::Handler *frameReadbackHandler,
+									  obs_source_t *source,
+									  FrameReadback::PixelFormat pixelFormat, uint16_t slot);
+				static void FinishExportFrame(StreamPtr stream, const InFlightFrame &frame);
+				static bool WaitForFrame(const InFlightFrame &frame, uint64_t timeout);
+				static void StopStream(StreamPtr stream);
+			};
+		}
+	}
+}
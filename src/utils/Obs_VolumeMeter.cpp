@@ -19,20 +19,32 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
 #include <cmath>
+#include <cstring>
 #include <algorithm>
+#include <util/profiler.hpp>
 
 #include "Obs.h"
 #include "Obs_VolumeMeter.h"
-#include "Obs_VolumeMeter_Helpers.h"
+#include "Obs_VolumeMeter_Kernels.h"
 #include "../obs-websocket.h"
 
 Utils::Obs::VolumeMeter::Meter::Meter(obs_source_t *input)
 	: PeakMeterType(SAMPLE_PEAK_METER),
 	  _input(obs_source_get_weak_source(input)),
 	  _channels(0),
+	  _levelsSequence(0),
+	  _levelsChannels(0),
+	  _muted(false),
 	  _lastUpdate(0),
 	  _volume(obs_source_get_volume(input))
 {
+	for (int channel = 0; channel < MAX_AUDIO_CHANNELS; channel++) {
+		_levelsMagnitude[channel].store(0.0f, std::memory_order_relaxed);
+		_levelsPeak[channel].store(0.0f, std::memory_order_relaxed);
+		for (int i = 0; i < 4; i++)
+			_previousSamples[channel][i] = 0.0f;
+	}
+
 	signal_handler_t *sh = obs_source_get_signal_handler(input);
 	signal_handler_connect(sh, "volume", Meter::InputVolumeCallback, this);
 
@@ -74,23 +86,14 @@ json Utils::Obs::VolumeMeter::Meter::GetMeterData()
 		return ret;
 	}
 
-	std::vector<std::vector<float>> levels;
-	const float volume = _muted ? 0.0f : _volume.load();
-
-	std::unique_lock<std::mutex> l(_mutex);
-
-	if (_lastUpdate != 0 && (os_gettime_ns() - _lastUpdate) * 0.000000001 > 0.3)
-		ResetAudioLevels();
+	float levelData[MAX_AUDIO_CHANNELS * 3];
+	int channels = GetMeterLevels(levelData);
 
-	for (int channel = 0; channel < _channels; channel++) {
-		std::vector<float> level;
-		level.push_back(_magnitude[channel] * volume);
-		level.push_back(_peak[channel] * volume);
-		level.push_back(_peak[channel]);
-
-		levels.push_back(level);
+	std::vector<std::vector<float>> levels;
+	for (int channel = 0; channel < channels; channel++) {
+		const float *level = &levelData[channel * 3];
+		levels.push_back({level[0], level[1], level[2]});
 	}
-	l.unlock();
 
 	ret["inputName"] = obs_source_get_name(input);
 	ret["inputUuid"] = obs_source_get_uuid(input);
@@ -99,17 +102,43 @@ json Utils::Obs::VolumeMeter::Meter::GetMeterData()
 	return ret;
 }
 
-// MUST HOLD LOCK
-void Utils::Obs::VolumeMeter::Meter::ResetAudioLevels()
+// Writes [magnitude * volume, peak * volume, peak] for each channel into `levels`, which must fit MAX_AUDIO_CHANNELS * 3 floats.
+// Returns the number of channels written. Never blocks the audio thread.
+int Utils::Obs::VolumeMeter::Meter::GetMeterLevels(float *levels)
 {
-	_lastUpdate = 0;
-	for (int channelNumber = 0; channelNumber < MAX_AUDIO_CHANNELS; channelNumber++) {
-		_magnitude[channelNumber] = 0;
-		_peak[channelNumber] = 0;
-	}
+	const float volume = _muted ? 0.0f : _volume.load();
+
+	// Levels of inputs which stopped sending audio are reported as silent
+	uint64_t lastUpdate = _lastUpdate;
+	bool stale = lastUpdate != 0 && (os_gettime_ns() - lastUpdate) * 0.000000001 > 0.3;
+
+	int channels = 0;
+	uint32_t sequenceStart = 0, sequenceEnd = 0;
+	do {
+		sequenceStart = _levelsSequence.load(std::memory_order_acquire);
+		if (sequenceStart & 1) {
+			// The audio thread is mid-publish, which only takes a few nanoseconds
+			std::this_thread::yield();
+			continue;
+		}
+
+		channels = std::clamp(_levelsChannels.load(std::memory_order_relaxed), 0, MAX_AUDIO_CHANNELS);
+		for (int channel = 0; channel < channels; channel++) {
+			float magnitude = stale ? 0.0f : _levelsMagnitude[channel].load(std::memory_order_relaxed);
+			float peak = stale ? 0.0f : _levelsPeak[channel].load(std::memory_order_relaxed);
+			levels[channel * 3] = magnitude * volume;
+			levels[channel * 3 + 1] = peak * volume;
+			levels[channel * 3 + 2] = peak;
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		sequenceEnd = _levelsSequence.load(std::memory_order_relaxed);
+	} while ((sequenceStart & 1) || sequenceStart != sequenceEnd);
+
+	return channels;
 }
 
-// MUST HOLD LOCK
+// Audio thread only
 void Utils::Obs::VolumeMeter::Meter::ProcessAudioChannels(const struct audio_data *data)
 {
 	int channels = 0;
@@ -118,17 +147,16 @@ void Utils::Obs::VolumeMeter::Meter::ProcessAudioChannels(const struct audio_dat
 			channels++;
 	}
 
-	bool channelsChanged = _channels != channels;
 	_channels = std::clamp(channels, 0, MAX_AUDIO_CHANNELS);
-
-	if (channelsChanged)
-		ResetAudioLevels();
 }
 
-// MUST HOLD LOCK
-void Utils::Obs::VolumeMeter::Meter::ProcessPeak(const struct audio_data *data)
+// Audio thread only
+void Utils::Obs::VolumeMeter::Meter::ProcessLevels(const struct audio_data *data)
 {
 	size_t sampleCount = data->frames;
+	bool truePeak = PeakMeterType == TRUE_PEAK_METER;
+	float magnitudes[MAX_AUDIO_CHANNELS] = {};
+	float peaks[MAX_AUDIO_CHANNELS] = {};
 	int channelNumber = 0;
 
 	for (int planeNumber = 0; channelNumber < _channels; planeNumber++) {
@@ -136,24 +164,9 @@ void Utils::Obs::VolumeMeter::Meter::ProcessPeak(const struct audio_data *data)
 		if (!samples)
 			continue;
 
-		if (((uintptr_t)samples & 0xf) > 0) {
-			_peak[channelNumber] = 1.0f;
-			channelNumber++;
-			continue;
-		}
-
-		__m128 previousSamples = _mm_loadu_ps(_previousSamples[channelNumber]);
-
-		float peak;
-		switch (PeakMeterType) {
-		default:
-		case SAMPLE_PEAK_METER:
-			peak = GetSamplePeak(previousSamples, samples, sampleCount);
-			break;
-		case TRUE_PEAK_METER:
-			peak = GetTruePeak(previousSamples, samples, sampleCount);
-			break;
-		}
+		// Peak and magnitude are computed in a single pass
+		float peak, sumSquares;
+		ProcessPlane(_previousSamples[channelNumber], samples, sampleCount, truePeak, peak, sumSquares);
 
 		switch (sampleCount) {
 		case 0:
@@ -183,49 +196,41 @@ void Utils::Obs::VolumeMeter::Meter::ProcessPeak(const struct audio_data *data)
 			_previousSamples[channelNumber][3] = samples[sampleCount - 1];
 		}
 
-		_peak[channelNumber] = peak;
+		peaks[channelNumber] = peak;
+		magnitudes[channelNumber] = sampleCount ? std::sqrt(sumSquares / sampleCount) : 0.0f;
 
 		channelNumber++;
 	}
 
-	for (; channelNumber < MAX_AUDIO_CHANNELS; channelNumber++)
-		_peak[channelNumber] = 0.0;
+	PublishLevels(magnitudes, peaks);
 }
 
-// MUST HOLD LOCK
-void Utils::Obs::VolumeMeter::Meter::ProcessMagnitude(const struct audio_data *data)
+// Audio thread only. Seqlock write side: the sequence is odd while the levels are being written.
+void Utils::Obs::VolumeMeter::Meter::PublishLevels(const float *magnitude, const float *peak)
 {
-	size_t sampleCount = data->frames;
-
-	int channelNumber = 0;
-	for (int planeNumber = 0; channelNumber < _channels; planeNumber++) {
-		float *samples = (float *)data->data[planeNumber];
-		if (!samples)
-			continue;
-
-		float sum = 0.0;
-		for (size_t i = 0; i < sampleCount; i++) {
-			float sample = samples[i];
-			sum += sample * sample;
-		}
-
-		_magnitude[channelNumber] = std::sqrt(sum / sampleCount);
-
-		channelNumber++;
+	uint32_t sequence = _levelsSequence.load(std::memory_order_relaxed);
+	_levelsSequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	_levelsChannels.store(_channels, std::memory_order_relaxed);
+	for (int channel = 0; channel < MAX_AUDIO_CHANNELS; channel++) {
+		_levelsMagnitude[channel].store(magnitude[channel], std::memory_order_relaxed);
+		_levelsPeak[channel].store(peak[channel], std::memory_order_relaxed);
 	}
+
+	_levelsSequence.store(sequence + 2, std::memory_order_release);
 }
 
 void Utils::Obs::VolumeMeter::Meter::InputAudioCaptureCallback(void *priv_data, obs_source_t *, const struct audio_data *data,
 							       bool muted)
 {
-	auto c = static_cast<Meter *>(priv_data);
+	ScopeProfiler prof{"obs_websocket_volume_meter_audio_capture"};
 
-	std::unique_lock<std::mutex> l(c->_mutex);
+	auto c = static_cast<Meter *>(priv_data);
 
 	c->_muted = muted;
 	c->ProcessAudioChannels(data);
-	c->ProcessPeak(data);
-	c->ProcessMagnitude(data);
+	c->ProcessLevels(data);
 
 	c->_lastUpdate = os_gettime_ns();
 }
@@ -237,8 +242,12 @@ void Utils::Obs::VolumeMeter::Meter::InputVolumeCallback(void *priv_data, callda
 	c->_volume = (float)calldata_float(cd, "volume");
 }
 
-Utils::Obs::VolumeMeter::Handler::Handler(UpdateCallback cb, uint64_t updatePeriod)
+Utils::Obs::VolumeMeter::Handler::Handler(UpdateCallback cb, BinaryUpdateCallback binaryCb, MappingCallback mappingCb,
+					   uint64_t updatePeriod, std::vector<std::string> inputFilter)
 	: _updateCallback(cb),
+	  _binaryUpdateCallback(binaryCb),
+	  _mappingCallback(mappingCb),
+	  _inputFilter(inputFilter),
 	  _updatePeriod(updatePeriod),
 	  _running(false)
 {
@@ -256,7 +265,8 @@ Utils::Obs::VolumeMeter::Handler::Handler(UpdateCallback cb, uint64_t updatePeri
 		if ((flags & OBS_SOURCE_AUDIO) == 0)
 			return true;
 
-		c->_meters.emplace_back(std::move(new Meter(input)));
+		if (c->InputWanted(input))
+			c->AddMeter(input);
 
 		return true;
 	};
@@ -268,7 +278,7 @@ Utils::Obs::VolumeMeter::Handler::Handler(UpdateCallback cb, uint64_t updatePeri
 	_running = true;
 	_updateThread = std::thread(&Handler::UpdateThread, this);
 
-	blog_debug("[Utils::Obs::VolumeMeter::Handler::Handler] Handler created.");
+	blog_debug("[Utils::Obs::VolumeMeter::Handler::Handler] Handler created. Using %s meter kernels.", GetPlaneKernelName());
 }
 
 Utils::Obs::VolumeMeter::Handler::~Handler()
@@ -291,16 +301,79 @@ Utils::Obs::VolumeMeter::Handler::~Handler()
 	blog_debug("[Utils::Obs::VolumeMeter::Handler::~Handler] Handler destroyed.");
 }
 
+// Replaces the set of metered inputs, creating and destroying meters (and their audio capture callbacks) to match
+void Utils::Obs::VolumeMeter::Handler::SetInputFilter(std::vector<std::string> inputFilter)
+{
+	// Collect active audio inputs first, so that the meter lock is not held while libobs enumerates sources
+	std::vector<OBSSource> activeInputs;
+	auto enumProc = [](void *priv_data, obs_source_t *input) {
+		auto activeInputs = static_cast<std::vector<OBSSource> *>(priv_data);
+
+		if (!obs_source_active(input))
+			return true;
+
+		uint32_t flags = obs_source_get_output_flags(input);
+		if ((flags & OBS_SOURCE_AUDIO) == 0)
+			return true;
+
+		activeInputs->push_back(input);
+
+		return true;
+	};
+	obs_enum_sources(enumProc, &activeInputs);
+
+	std::unique_lock<std::mutex> l(_meterMutex);
+	_inputFilter = inputFilter;
+
+	std::vector<MeterPtr>::iterator iter;
+	for (iter = _meters.begin(); iter != _meters.end();) {
+		OBSSourceAutoRelease input = obs_weak_source_get_source(iter->get()->GetWeakInput());
+		if (!input || !InputWanted(input)) {
+			iter = _meters.erase(iter);
+			_mappingChanged = true;
+		} else {
+			++iter;
+		}
+	}
+
+	for (auto &input : activeInputs) {
+		if (!InputWanted(input))
+			continue;
+
+		bool metered = false;
+		for (auto &meter : _meters) {
+			if (obs_weak_source_references_source(meter->GetWeakInput(), input)) {
+				metered = true;
+				break;
+			}
+		}
+
+		if (!metered)
+			AddMeter(input);
+	}
+}
+
 void Utils::Obs::VolumeMeter::Handler::UpdateThread()
 {
 	blog_debug("[Utils::Obs::VolumeMeter::Handler::UpdateThread] Thread started.");
 	while (_running) {
 		{
 			std::unique_lock<std::mutex> l(_mutex);
-			if (_cond.wait_for(l, std::chrono::milliseconds(_updatePeriod), [this] { return !_running; }))
+			if (_cond.wait_for(l, std::chrono::milliseconds(_updatePeriod.load()), [this] { return !_running; }))
 				break;
 		}
 
+		ScopeProfiler prof{"obs_websocket_volume_meter_update"};
+
+		if (BinaryEnabled && _binaryUpdateCallback) {
+			if (_mappingChanged.exchange(false))
+				UpdateMapping();
+			UpdateBinaryFrame();
+		}
+
+		if (!JsonEnabled)
+			continue;
+
 		std::vector<json> inputs;
 		std::unique_lock<std::mutex> l(_meterMutex);
 		for (auto &meter : _meters) {
@@ -315,6 +388,121 @@ void Utils::Obs::VolumeMeter::Handler::UpdateThread()
 	blog_debug("[Utils::Obs::VolumeMeter::Handler::UpdateThread] Thread stopped.");
 }
 
+// Announces the index assigned to each active input. Only called when the set of meters changes.
+void Utils::Obs::VolumeMeter::Handler::UpdateMapping()
+{
+	std::vector<json> inputs;
+	std::unique_lock<std::mutex> l(_meterMutex);
+	for (auto &meter : _meters) {
+		OBSSourceAutoRelease input = obs_weak_source_get_source(meter->GetWeakInput());
+		if (!input)
+			continue;
+
+		json inputMapping;
+		inputMapping["inputIndex"] = meter->Index;
+		inputMapping["inputName"] = obs_source_get_name(input);
+		inputMapping["inputUuid"] = obs_source_get_uuid(input);
+		inputs.push_back(inputMapping);
+	}
+	l.unlock();
+
+	_mappingSequence++;
+	if (_mappingCallback)
+		_mappingCallback(_mappingSequence, inputs);
+}
+
+static inline void WriteFrameValue(uint8_t *&dest, const void *src, size_t size)
+{
+	memcpy(dest, src, size);
+	dest += size;
+}
+
+// Packs the levels of all meters into `_frameBuffer`. Values are written in host byte order, which is little-endian on all
+// platforms OBS supports. The buffer is only grown, so steady-state updates do not allocate.
+void Utils::Obs::VolumeMeter::Handler::UpdateBinaryFrame()
+{
+	std::unique_lock<std::mutex> l(_meterMutex);
+
+	size_t maxSize = VOLUME_METER_FRAME_HEADER_SIZE +
+			 _meters.size() * (VOLUME_METER_FRAME_ENTRY_HEADER_SIZE + (MAX_AUDIO_CHANNELS * 3 * sizeof(float)));
+	if (_frameBuffer.size() < maxSize)
+		_frameBuffer.resize(maxSize);
+
+	uint8_t *data = _frameBuffer.data() + VOLUME_METER_FRAME_HEADER_SIZE;
+	uint16_t inputCount = 0;
+	for (auto &meter : _meters) {
+		if (!meter->InputValid())
+			continue;
+
+		uint8_t *entry = data;
+		data += VOLUME_METER_FRAME_ENTRY_HEADER_SIZE;
+		int channels = meter->GetMeterLevels(reinterpret_cast<float *>(data));
+		data += channels * 3 * sizeof(float);
+
+		uint8_t channelCount = (uint8_t)channels;
+		uint8_t reserved = 0;
+		WriteFrameValue(entry, &meter->Index, sizeof(uint16_t));
+		WriteFrameValue(entry, &channelCount, sizeof(uint8_t));
+		WriteFrameValue(entry, &reserved, sizeof(uint8_t));
+
+		inputCount++;
+	}
+	l.unlock();
+
+	size_t frameSize = data - _frameBuffer.data();
+
+	uint8_t *header = _frameBuffer.data();
+	uint16_t version = VOLUME_METER_FRAME_VERSION;
+	_frameSequence++;
+	WriteFrameValue(header, VOLUME_METER_FRAME_MAGIC, 4);
+	WriteFrameValue(header, &version, sizeof(uint16_t));
+	WriteFrameValue(header, &inputCount, sizeof(uint16_t));
+	WriteFrameValue(header, &_mappingSequence, sizeof(uint32_t));
+	WriteFrameValue(header, &_frameSequence, sizeof(uint32_t));
+
+	_binaryUpdateCallback(_frameBuffer.data(), frameSize);
+}
+
+// MUST HOLD LOCK (or be called before the update thread is started)
+bool Utils::Obs::VolumeMeter::Handler::InputWanted(obs_source_t *input)
+{
+	if (_inputFilter.empty())
+		return true;
+
+	std::string inputName = obs_source_get_name(input);
+	std::string inputUuid = obs_source_get_uuid(input);
+	for (auto &filter : _inputFilter) {
+		if (filter == inputName || filter == inputUuid)
+			return true;
+	}
+
+	return false;
+}
+
+// MUST HOLD LOCK (or be called before the update thread is started)
+void Utils::Obs::VolumeMeter::Handler::AddMeter(obs_source_t *input)
+{
+	// Reuse the lowest free index, so that indices stay small and stable for the lifetime of a meter
+	uint16_t index = 0;
+	bool inUse = true;
+	while (inUse) {
+		inUse = false;
+		for (auto &meter : _meters) {
+			if (meter->Index == index) {
+				inUse = true;
+				index++;
+				break;
+			}
+		}
+	}
+
+	auto meter = new Meter(input);
+	meter->Index = index;
+	_meters.emplace_back(std::move(meter));
+
+	_mappingChanged = true;
+}
+
 void Utils::Obs::VolumeMeter::Handler::InputActivateCallback(void *priv_data, calldata_t *cd)
 {
 	auto c = static_cast<Handler *>(priv_data);
@@ -331,7 +519,8 @@ void Utils::Obs::VolumeMeter::Handler::InputActivateCallback(void *priv_data, ca
 		return;
 
 	std::unique_lock<std::mutex> l(c->_meterMutex);
-	c->_meters.emplace_back(std::move(new Meter(input)));
+	if (c->InputWanted(input))
+		c->AddMeter(input);
 }
 
 void Utils::Obs::VolumeMeter::Handler::InputDeactivateCallback(void *priv_data, calldata_t *cd)
@@ -349,9 +538,11 @@ void Utils::Obs::VolumeMeter::Handler::InputDeactivateCallback(void *priv_data,
 	std::unique_lock<std::mutex> l(c->_meterMutex);
 	std::vector<MeterPtr>::iterator iter;
 	for (iter = c->_meters.begin(); iter != c->_meters.end();) {
-		if (obs_weak_source_references_source(iter->get()->GetWeakInput(), input))
+		if (obs_weak_source_references_source(iter->get()->GetWeakInput(), input)) {
 			iter = c->_meters.erase(iter);
-		else
+			c->_mappingChanged = true;
+		} else {
 			++iter;
+		}
 	}
 }
@@ -30,6 +30,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "Obs.h"
 #include "Json.h"
 
+// Magic bytes at the start of every binary volume meter frame
+#define VOLUME_METER_FRAME_MAGIC "OWVM"
+#define VOLUME_METER_FRAME_VERSION 1
+#define VOLUME_METER_FRAME_HEADER_SIZE 16
+#define VOLUME_METER_FRAME_ENTRY_HEADER_SIZE 4
+
 namespace Utils {
 	namespace Obs {
 		namespace VolumeMeter {
@@ -43,27 +49,32 @@ namespace Utils {
 				bool InputValid();
 				obs_weak_source_t *GetWeakInput() { return _input; }
 				json GetMeterData();
+				int GetMeterLevels(float *levels);
 
 				std::atomic<enum obs_peak_meter_type> PeakMeterType;
+				uint16_t Index = 0; // Assigned by the handler, used to identify the input in binary meter frames
 
 			private:
 				OBSWeakSourceAutoRelease _input;
 
-				// All values in mul
-				std::mutex _mutex;
-				bool _muted;
+				// Only touched by the audio thread
 				int _channels;
-				float _magnitude[MAX_AUDIO_CHANNELS];
-				float _peak[MAX_AUDIO_CHANNELS];
 				float _previousSamples[MAX_AUDIO_CHANNELS][4];
 
+				// Levels published by the audio thread, read by the update thread. All values in mul.
+				// Guarded by a seqlock so that the audio thread never waits on the update thread.
+				std::atomic<uint32_t> _levelsSequence;
+				std::atomic<int> _levelsChannels;
+				std::atomic<float> _levelsMagnitude[MAX_AUDIO_CHANNELS];
+				std::atomic<float> _levelsPeak[MAX_AUDIO_CHANNELS];
+
+				std::atomic<bool> _muted;
 				std::atomic<uint64_t> _lastUpdate;
 				std::atomic<float> _volume;
 
-				void ResetAudioLevels();
 				void ProcessAudioChannels(const struct audio_data *data);
-				void ProcessPeak(const struct audio_data *data);
-				void ProcessMagnitude(const struct audio_data *data);
+				void ProcessLevels(const struct audio_data *data);
+				void PublishLevels(const float *magnitude, const float *peak);
 
 				static void InputAudioCaptureCallback(void *priv_data, obs_source_t *source,
 								      const struct audio_data *data, bool muted);
@@ -73,18 +84,40 @@ namespace Utils {
 			// Maintains an array of active inputs
 			class Handler {
 				typedef std::function<void(std::vector<json> &)> UpdateCallback;
+				typedef std::function<void(const uint8_t *, size_t)> BinaryUpdateCallback; // data, size
+				typedef std::function<void(uint32_t, std::vector<json> &)>
+					MappingCallback; // uint32_t mappingSequence, std::vector<json> inputs
 				typedef std::unique_ptr<Meter> MeterPtr;
 
 			public:
-				Handler(UpdateCallback cb, uint64_t updatePeriod = 50);
+				Handler(UpdateCallback cb, BinaryUpdateCallback binaryCb = nullptr, MappingCallback mappingCb = nullptr,
+					uint64_t updatePeriod = 50, std::vector<std::string> inputFilter = {});
 				~Handler();
 
+				inline void SetUpdatePeriod(uint64_t updatePeriod) { _updatePeriod = updatePeriod; }
+				void SetInputFilter(std::vector<std::string> inputFilter);
+
+				// Forces the input index mapping to be announced again on the next update
+				inline void InvalidateMapping() { _mappingChanged = true; }
+
+				std::atomic<bool> JsonEnabled = true;
+				std::atomic<bool> BinaryEnabled = false;
+
 			private:
 				UpdateCallback _updateCallback;
+				BinaryUpdateCallback _binaryUpdateCallback;
+				MappingCallback _mappingCallback;
 
 				std::mutex _meterMutex;
 				std::vector<MeterPtr> _meters;
-				uint64_t _updatePeriod;
+				std::vector<std::string> _inputFilter; // Input names or UUIDs to meter. Empty for all
+				std::atomic<uint64_t> _updatePeriod;
+
+				// Binary frame state, only touched by the update thread
+				std::vector<uint8_t> _frameBuffer;
+				uint32_t _frameSequence = 0;
+				uint32_t _mappingSequence = 0;
+				std::atomic<bool> _mappingChanged = true;
 
 				std::mutex _mutex;
 				std::condition_variable _cond;
@@ -92,6 +125,10 @@ namespace Utils {
 				std::thread _updateThread;
 
 				void UpdateThread();
+				void UpdateMapping();
+				void UpdateBinaryFrame();
+				void AddMeter(obs_source_t *input);
+				bool InputWanted(obs_source_t *input);
 				static void InputActivateCallback(void *priv_data, calldata_t *cd);
 				static void InputDeactivateCallback(void *priv_data, calldata_t *cd);
 			};
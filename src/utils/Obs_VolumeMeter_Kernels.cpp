@@ -0,0 +1,287 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <cmath>
+#include <algorithm>
+#include <util/sse-intrin.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VOLUME_METER_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+#include "Obs_VolumeMeter_Kernels.h"
+
+// 4-tap interpolation filters used for true peak detection, at 4 sub-sample positions. Tap 0 is the oldest sample.
+// Same coefficients as libobs' obs-audio-controls.c
+static const float TruePeakFilters[4][4] = {
+	{-0.103943f, 0.233872f, 0.935489f, -0.155915f},
+	{-0.189207f, 0.504551f, 0.756827f, -0.216236f},
+	{-0.216236f, 0.756827f, 0.504551f, -0.189207f},
+	{-0.155915f, 0.935489f, 0.233872f, -0.103943f},
+};
+
+// Sample `index` of the plane, where negative indexes refer to `previousSamples`
+static inline float GetSample(const float *previousSamples, const float *samples, ptrdiff_t index)
+{
+	return index < 0 ? previousSamples[4 + index] : samples[index];
+}
+
+// The previous samples are part of the peak, like in the original SSE implementation
+static inline float GetInitialPeak(const float *previousSamples)
+{
+	return std::max(std::max(previousSamples[0], previousSamples[1]), std::max(previousSamples[2], previousSamples[3]));
+}
+
+// Scalar path for [begin, end), used for the heads and tails of the vectorized kernels
+static inline void ProcessRange(const float *previousSamples, const float *samples, size_t begin, size_t end, bool truePeak,
+				float &peak, float &sumSquares)
+{
+	for (size_t i = begin; i < end; i++) {
+		float sample = samples[i];
+		peak = std::max(peak, std::fabs(sample));
+		sumSquares += sample * sample;
+
+		if (!truePeak)
+			continue;
+
+		for (int filter = 0; filter < 4; filter++) {
+			float interpolated = 0.0f;
+			for (int tap = 0; tap < 4; tap++)
+				interpolated += TruePeakFilters[filter][tap] *
+						GetSample(previousSamples, samples, (ptrdiff_t)i - 3 + tap);
+			peak = std::max(peak, std::fabs(interpolated));
+		}
+	}
+}
+
+void Utils::Obs::VolumeMeter::Kernels::ProcessPlaneScalar(const float *previousSamples, const float *samples,
+							  size_t sampleCount, bool truePeak, float &peak, float &sumSquares)
+{
+	peak = GetInitialPeak(previousSamples);
+	sumSquares = 0.0f;
+	ProcessRange(previousSamples, samples, 0, sampleCount, truePeak, peak, sumSquares);
+}
+
+static inline float HorizontalMax(__m128 v)
+{
+	float values[4];
+	_mm_storeu_ps(values, v);
+	return std::max(std::max(values[0], values[1]), std::max(values[2], values[3]));
+}
+
+static inline float HorizontalSum(__m128 v)
+{
+	float values[4];
+	_mm_storeu_ps(values, v);
+	return (values[0] + values[1]) + (values[2] + values[3]);
+}
+
+void Utils::Obs::VolumeMeter::Kernels::ProcessPlaneSse(const float *previousSamples, const float *samples,
+						       size_t sampleCount, bool truePeak, float &peak, float &sumSquares)
+{
+	peak = GetInitialPeak(previousSamples);
+	sumSquares = 0.0f;
+
+	// The first 3 samples need the previous packet for interpolation
+	size_t head = std::min<size_t>(3, sampleCount);
+	ProcessRange(previousSamples, samples, 0, head, truePeak, peak, sumSquares);
+
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 peakVec = _mm_set1_ps(peak);
+	__m128 sumVec = _mm_setzero_ps();
+
+	size_t i = head;
+	if (truePeak) {
+		__m128 filters[4][4];
+		for (int filter = 0; filter < 4; filter++)
+			for (int tap = 0; tap < 4; tap++)
+				filters[filter][tap] = _mm_set1_ps(TruePeakFilters[filter][tap]);
+
+		for (; i + 4 <= sampleCount; i += 4) {
+			__m128 w0 = _mm_loadu_ps(&samples[i - 3]);
+			__m128 w1 = _mm_loadu_ps(&samples[i - 2]);
+			__m128 w2 = _mm_loadu_ps(&samples[i - 1]);
+			__m128 w3 = _mm_loadu_ps(&samples[i]);
+
+			peakVec = _mm_max_ps(peakVec, _mm_andnot_ps(signMask, w3));
+			sumVec = _mm_add_ps(sumVec, _mm_mul_ps(w3, w3));
+
+			for (int filter = 0; filter < 4; filter++) {
+				__m128 interpolated = _mm_mul_ps(w0, filters[filter][0]);
+				interpolated = _mm_add_ps(interpolated, _mm_mul_ps(w1, filters[filter][1]));
+				interpolated = _mm_add_ps(interpolated, _mm_mul_ps(w2, filters[filter][2]));
+				interpolated = _mm_add_ps(interpolated, _mm_mul_ps(w3, filters[filter][3]));
+				peakVec = _mm_max_ps(peakVec, _mm_andnot_ps(signMask, interpolated));
+			}
+		}
+	} else {
+		for (; i + 4 <= sampleCount; i += 4) {
+			__m128 work = _mm_loadu_ps(&samples[i]);
+			peakVec = _mm_max_ps(peakVec, _mm_andnot_ps(signMask, work));
+			sumVec = _mm_add_ps(sumVec, _mm_mul_ps(work, work));
+		}
+	}
+
+	peak = HorizontalMax(peakVec);
+	sumSquares += HorizontalSum(sumVec);
+
+	ProcessRange(previousSamples, samples, i, sampleCount, truePeak, peak, sumSquares);
+}
+
+#ifdef VOLUME_METER_KERNELS_X86
+TARGET_AVX2 static inline float HorizontalMax256(__m256 v)
+{
+	__m128 max = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	return HorizontalMax(max);
+}
+
+TARGET_AVX2 static inline float HorizontalSum256(__m256 v)
+{
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+	return HorizontalSum(sum);
+}
+
+TARGET_AVX2 static void ProcessPlaneAvx2Impl(const float *previousSamples, const float *samples, size_t sampleCount,
+					     bool truePeak, float &peak, float &sumSquares)
+{
+	peak = GetInitialPeak(previousSamples);
+	sumSquares = 0.0f;
+
+	size_t head = std::min<size_t>(3, sampleCount);
+	ProcessRange(previousSamples, samples, 0, head, truePeak, peak, sumSquares);
+
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	__m256 peakVec = _mm256_set1_ps(peak);
+	__m256 sumVec = _mm256_setzero_ps();
+
+	size_t i = head;
+	if (truePeak) {
+		__m256 filters[4][4];
+		for (int filter = 0; filter < 4; filter++)
+			for (int tap = 0; tap < 4; tap++)
+				filters[filter][tap] = _mm256_set1_ps(TruePeakFilters[filter][tap]);
+
+		for (; i + 8 <= sampleCount; i += 8) {
+			__m256 w0 = _mm256_loadu_ps(&samples[i - 3]);
+			__m256 w1 = _mm256_loadu_ps(&samples[i - 2]);
+			__m256 w2 = _mm256_loadu_ps(&samples[i - 1]);
+			__m256 w3 = _mm256_loadu_ps(&samples[i]);
+
+			peakVec = _mm256_max_ps(peakVec, _mm256_andnot_ps(signMask, w3));
+			sumVec = _mm256_fmadd_ps(w3, w3, sumVec);
+
+			for (int filter = 0; filter < 4; filter++) {
+				__m256 interpolated = _mm256_mul_ps(w0, filters[filter][0]);
+				interpolated = _mm256_fmadd_ps(w1, filters[filter][1], interpolated);
+				interpolated = _mm256_fmadd_ps(w2, filters[filter][2], interpolated);
+				interpolated = _mm256_fmadd_ps(w3, filters[filter][3], interpolated);
+				peakVec = _mm256_max_ps(peakVec, _mm256_andnot_ps(signMask, interpolated));
+			}
+		}
+	} else {
+		for (; i + 8 <= sampleCount; i += 8) {
+			__m256 work = _mm256_loadu_ps(&samples[i]);
+			peakVec = _mm256_max_ps(peakVec, _mm256_andnot_ps(signMask, work));
+			sumVec = _mm256_fmadd_ps(work, work, sumVec);
+		}
+	}
+
+	peak = HorizontalMax256(peakVec);
+	sumSquares += HorizontalSum256(sumVec);
+
+	ProcessRange(previousSamples, samples, i, sampleCount, truePeak, peak, sumSquares);
+}
+#endif
+
+void Utils::Obs::VolumeMeter::Kernels::ProcessPlaneAvx2(const float *previousSamples, const float *samples,
+							size_t sampleCount, bool truePeak, float &peak, float &sumSquares)
+{
+#ifdef VOLUME_METER_KERNELS_X86
+	if (Avx2Supported()) {
+		ProcessPlaneAvx2Impl(previousSamples, samples, sampleCount, truePeak, peak, sumSquares);
+		return;
+	}
+#endif
+	ProcessPlaneSse(previousSamples, samples, sampleCount, truePeak, peak, sumSquares);
+}
+
+bool Utils::Obs::VolumeMeter::Kernels::Avx2Supported()
+{
+#ifdef VOLUME_METER_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+	static const bool supported = [] {
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		__cpuid(info, 1);
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (!fma || !osxsave)
+			return false;
+
+		// The OS must save the YMM registers on context switches
+		if ((_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+	return supported;
+#else
+	static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	return supported;
+#endif
+#else
+	return false;
+#endif
+}
+
+static Utils::Obs::VolumeMeter::PlaneKernel SelectPlaneKernel()
+{
+	if (Utils::Obs::VolumeMeter::Kernels::Avx2Supported())
+		return Utils::Obs::VolumeMeter::Kernels::ProcessPlaneAvx2;
+	return Utils::Obs::VolumeMeter::Kernels::ProcessPlaneSse;
+}
+
+void Utils::Obs::VolumeMeter::ProcessPlane(const float *previousSamples, const float *samples, size_t sampleCount,
+					   bool truePeak, float &peak, float &sumSquares)
+{
+	static const PlaneKernel kernel = SelectPlaneKernel();
+	kernel(previousSamples, samples, sampleCount, truePeak, peak, sumSquares);
+}
+
+const char *Utils::Obs::VolumeMeter::GetPlaneKernelName()
+{
+	if (Kernels::Avx2Supported())
+		return "AVX2";
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return "NEON";
+#else
+	return "SSE";
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+namespace Utils {
+	namespace Obs {
+		namespace VolumeMeter {
+			// Computes the peak (sample or true peak) and the sum of squares of one audio plane in a single pass.
+			// `previousSamples` holds the last 4 samples of the previous packet, which the true peak interpolation spans.
+			// `samples` does not need to be aligned.
+			typedef void (*PlaneKernel)(const float *previousSamples, const float *samples, size_t sampleCount,
+						    bool truePeak, float &peak, float &sumSquares);
+
+			namespace Kernels {
+				void ProcessPlaneScalar(const float *previousSamples, const float *samples, size_t sampleCount,
+							bool truePeak, float &peak, float &sumSquares);
+				// Uses NEON on ARM, through libobs' SSE intrinsic translation
+				void ProcessPlaneSse(const float *previousSamples, const float *samples, size_t sampleCount,
+						     bool truePeak, float &peak, float &sumSquares);
+				// Only available on x86 CPUs supporting AVX2 and FMA. Falls back to SSE otherwise
+				void ProcessPlaneAvx2(const float *previousSamples, const float *samples, size_t sampleCount,
+						      bool truePeak, float &peak, float &sumSquares);
+				bool Avx2Supported();
+			}
+
+			// Runtime-dispatched to the fastest kernel supported by the CPU
+			void ProcessPlane(const float *previousSamples, const float *samples, size_t sampleCount, bool truePeak,
+					  float &peak, float &sumSquares);
+			const char *GetPlaneKernelName();
+		}
+	}
+}
@@ -0,0 +1,182 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <chrono>
+
+#include "PersistentData.h"
+#include "plugin-macros.generated.h"
+
+// Time to wait after a change before writing, so that clients saving often get their changes written together, in ms
+#define PERSISTENT_DATA_FLUSH_DELAY 1000
+
+Utils::PersistentData::Store::Store()
+{
+	_flushThread = std::thread(&Store::FlushThread, this);
+
+	blog_debug("[Utils::PersistentData::Store::Store] Store created.");
+}
+
+Utils::PersistentData::Store::~Store()
+{
+	std::unique_lock<std::mutex> l(_flushMutex);
+	_running = false;
+	l.unlock();
+	_flushCond.notify_all();
+
+	if (_flushThread.joinable())
+		_flushThread.join();
+
+	// Anything changed since the last background flush, or which failed to be written by it
+	if (!Flush())
+		blog(LOG_ERROR, "[Utils::PersistentData::Store::~Store] Unable to write persistent data, changes have been lost.");
+
+	blog_debug("[Utils::PersistentData::Store::~Store] Store destroyed.");
+}
+
+json Utils::PersistentData::Store::Get(const std::string &path, const std::string &slotName)
+{
+	std::shared_lock<std::shared_mutex> l(_realmMutex);
+	const Realm *realm = FindRealm(path);
+	if (!realm) {
+		l.unlock();
+		std::unique_lock<std::shared_mutex> writeLock(_realmMutex);
+		const Realm &loadedRealm = LoadRealm(path);
+		auto value = loadedRealm.data.find(slotName);
+		return value != loadedRealm.data.end() ? *value : json(nullptr);
+	}
+
+	auto value = realm->data.find(slotName);
+	return value != realm->data.end() ? *value : json(nullptr);
+}
+
+json Utils::PersistentData::Store::GetMany(const std::string &path, const std::vector<std::string> &slotNames)
+{
+	std::shared_lock<std::shared_mutex> l(_realmMutex);
+	const Realm *realm = FindRealm(path);
+	std::unique_lock<std::shared_mutex> writeLock;
+	if (!realm) {
+		l.unlock();
+		writeLock = std::unique_lock<std::shared_mutex>(_realmMutex);
+		realm = &LoadRealm(path);
+	}
+
+	json ret = json::object();
+	for (auto &slotName : slotNames) {
+		auto value = realm->data.find(slotName);
+		ret[slotName] = value != realm->data.end() ? *value : json(nullptr);
+	}
+
+	return ret;
+}
+
+bool Utils::PersistentData::Store::Set(const std::string &path, const std::string &slotName, json slotValue)
+{
+	std::unique_lock<std::shared_mutex> l(_realmMutex);
+	Realm &realm = LoadRealm(path);
+	realm.data[slotName] = std::move(slotValue);
+	realm.dirty = true;
+	bool writeFailed = realm.writeFailed;
+	l.unlock();
+
+	std::unique_lock<std::mutex> flushLock(_flushMutex);
+	_flushPending = true;
+	flushLock.unlock();
+	_flushCond.notify_all();
+
+	return !writeFailed;
+}
+
+bool Utils::PersistentData::Store::Flush()
+{
+	// Copied out, so that readers are not blocked while writing to disk
+	std::vector<std::pair<std::string, json>> dirtyRealms;
+	std::unique_lock<std::shared_mutex> l(_realmMutex);
+	for (auto &[path, realm] : _realms) {
+		if (!realm.dirty)
+			continue;
+
+		dirtyRealms.emplace_back(path, realm.data);
+		realm.dirty = false;
+	}
+	l.unlock();
+
+	bool ret = true;
+	for (auto &[path, data] : dirtyRealms) {
+		bool written = Utils::Json::SetJsonFileContent(path, data);
+		ret = ret && written;
+
+		// Failed realms are marked changed again, so that the next flush retries them. Only logged once per failure streak
+		l.lock();
+		Realm &realm = _realms[path];
+		if (!written && !realm.writeFailed)
+			blog(LOG_WARNING, "[Utils::PersistentData::Store::Flush] Failed to write persistent data to `%s`",
+			     path.c_str());
+		else if (written && realm.writeFailed)
+			blog(LOG_INFO, "[Utils::PersistentData::Store::Flush] Persistent data written to `%s` again", path.c_str());
+		realm.dirty = realm.dirty || !written;
+		realm.writeFailed = !written;
+		l.unlock();
+	}
+
+	return ret;
+}
+
+// MUST HOLD LOCK (shared or exclusive)
+const Utils::PersistentData::Store::Realm *Utils::PersistentData::Store::FindRealm(const std::string &path)
+{
+	auto it = _realms.find(path);
+	return it != _realms.end() ? &it->second : nullptr;
+}
+
+// MUST HOLD EXCLUSIVE LOCK
+Utils::PersistentData::Store::Realm &Utils::PersistentData::Store::LoadRealm(const std::string &path)
+{
+	auto it = _realms.find(path);
+	if (it != _realms.end())
+		return it->second;
+
+	Realm &realm = _realms[path];
+	if (!Utils::Json::GetJsonFileContent(path, realm.data) || !realm.data.is_object())
+		realm.data = json::object();
+
+	blog_debug("[Utils::PersistentData::Store::LoadRealm] Loaded realm `%s`", path.c_str());
+
+	return realm;
+}
+
+void Utils::PersistentData::Store::FlushThread()
+{
+	std::unique_lock<std::mutex> l(_flushMutex);
+	while (_running) {
+		_flushCond.wait(l, [this] { return _flushPending || !_running; });
+		if (!_running)
+			break;
+
+		_flushCond.wait_for(l, std::chrono::milliseconds(PERSISTENT_DATA_FLUSH_DELAY), [this] { return !_running; });
+		_flushPending = false;
+		l.unlock();
+
+		bool flushed = Flush();
+
+		l.lock();
+		// Retried after another delay
+		if (!flushed)
+			_flushPending = true;
+	}
+}
@@ -0,0 +1,72 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
+
+#include "Json.h"
+
+namespace Utils {
+	namespace PersistentData {
+		// Keeps persistent data realms in memory, keyed by file path. Realms are read from disk once, and changes are
+		// written back in the background, batched and atomically.
+		class Store {
+		public:
+			Store();
+			~Store();
+
+			// `null` if the slot is not set
+			json Get(const std::string &path, const std::string &slotName);
+			// Object of slot names to values, with `null` for slots which are not set
+			json GetMany(const std::string &path, const std::vector<std::string> &slotNames);
+			// Returns false if the last write of the realm failed. The value is kept, and the write retried regardless.
+			bool Set(const std::string &path, const std::string &slotName, json slotValue);
+			// Writes every changed realm to disk now. Returns false if any write failed, those realms stay changed
+			bool Flush();
+
+		private:
+			struct Realm {
+				json data;
+				bool dirty = false;
+				bool writeFailed = false;
+			};
+
+			std::shared_mutex _realmMutex;
+			std::unordered_map<std::string, Realm> _realms;
+
+			std::mutex _flushMutex;
+			std::condition_variable _flushCond;
+			bool _flushPending = false;
+			std::atomic<bool> _running = true;
+			std::thread _flushThread;
+
+			const Realm *FindRealm(const std::string &path);
+			Realm &LoadRealm(const std::string &path);
+			void FlushThread();
+		};
+	}
+}
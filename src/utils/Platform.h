@@ -20,6 +20,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <string>
+#include <stddef.h>
+#include <stdint.h>
 #include <QString>
 #include <QSystemTrayIcon>
 
@@ -29,5 +31,31 @@ namespace Utils {
 		QString GetCommandLineArgument(QString arg);
 		bool GetCommandLineFlagSet(QString arg);
 		void SendTrayNotification(QSystemTrayIcon::MessageIcon icon, QString title, QString body);
+
+		// A named, zero-initialized shared memory region which other local processes can map read-only.
+		// POSIX shared memory (`shm_open()`), or a named file mapping on Windows. Removed when destroyed.
+		class SharedMemory {
+		public:
+			SharedMemory(const std::string &baseName, size_t size);
+			~SharedMemory();
+			SharedMemory(const SharedMemory &) = delete;
+			SharedMemory &operator=(const SharedMemory &) = delete;
+
+			inline bool IsValid() { return _data != nullptr; }
+			inline uint8_t *Data() { return _data; }
+			inline size_t Size() { return _size; }
+			// Platform name of the region, as passed to `shm_open()` or `OpenFileMapping()`
+			inline std::string Name() { return _name; }
+
+		private:
+			std::string _name;
+			size_t _size;
+			uint8_t *_data = nullptr;
+#ifdef _WIN32
+			void *_handle = nullptr;
+#else
+			int _fd = -1;
+#endif
+		};
 	}
 }
@@ -0,0 +1,99 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "Platform.h"
+#include "plugin-macros.generated.h"
+
+#ifdef _WIN32
+Utils::Platform::SharedMemory::SharedMemory(const std::string &baseName, size_t size) : _name("Local\\" + baseName), _size(size)
+{
+	_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32),
+				     (DWORD)(size & 0xFFFFFFFF), _name.c_str());
+	if (!_handle || GetLastError() == ERROR_ALREADY_EXISTS) {
+		blog(LOG_WARNING, "[Utils::Platform::SharedMemory::SharedMemory] Failed to create file mapping `%s`: %lu",
+		     _name.c_str(), GetLastError());
+		if (_handle)
+			CloseHandle(_handle);
+		_handle = nullptr;
+		return;
+	}
+
+	_data = (uint8_t *)MapViewOfFile(_handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (!_data) {
+		blog(LOG_WARNING, "[Utils::Platform::SharedMemory::SharedMemory] Failed to map `%s`: %lu", _name.c_str(),
+		     GetLastError());
+		CloseHandle(_handle);
+		_handle = nullptr;
+	}
+}
+
+Utils::Platform::SharedMemory::~SharedMemory()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_handle)
+		CloseHandle(_handle);
+}
+#else
+Utils::Platform::SharedMemory::SharedMemory(const std::string &baseName, size_t size) : _name("/" + baseName), _size(size)
+{
+	_fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (_fd < 0) {
+		blog(LOG_WARNING, "[Utils::Platform::SharedMemory::SharedMemory] Failed to create `%s`: %s", _name.c_str(),
+		     strerror(errno));
+		return;
+	}
+
+	void *data = MAP_FAILED;
+	if (ftruncate(_fd, (off_t)size) == 0)
+		data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+
+	if (data == MAP_FAILED) {
+		blog(LOG_WARNING, "[Utils::Platform::SharedMemory::SharedMemory] Failed to map `%s`: %s", _name.c_str(),
+		     strerror(errno));
+		close(_fd);
+		shm_unlink(_name.c_str());
+		_fd = -1;
+		return;
+	}
+
+	_data = (uint8_t *)data;
+}
+
+Utils::Platform::SharedMemory::~SharedMemory()
+{
+	if (_data)
+		munmap(_data, _size);
+	if (_fd >= 0) {
+		close(_fd);
+		shm_unlink(_name.c_str());
+	}
+}
+#endif
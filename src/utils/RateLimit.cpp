@@ -0,0 +1,74 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "RateLimit.h"
+
+static bool EndsWith(const std::string &value, const char *suffix)
+{
+	size_t suffixLength = strlen(suffix);
+	return value.size() >= suffixLength && value.compare(value.size() - suffixLength, suffixLength, suffix) == 0;
+}
+
+Utils::RateLimit::RequestClass Utils::RateLimit::GetRequestClass(const std::string &requestType)
+{
+	if (requestType == "GetSourceScreenshot" || requestType == "SaveSourceScreenshot" || EndsWith(requestType, "List"))
+		return Bulk;
+	if (requestType.rfind("Get", 0) == 0)
+		return Query;
+	return Control;
+}
+
+const char *Utils::RateLimit::GetRequestClassName(RequestClass requestClass)
+{
+	switch (requestClass) {
+	case Control:
+		return "control";
+	case Query:
+		return "query";
+	case Bulk:
+		return "bulk";
+	default:
+		return "unknown";
+	}
+}
+
+bool Utils::RateLimit::TokenBucket::Refill(uint64_t rate, uint64_t now)
+{
+	if (!rate) {
+		_lastRefill = 0;
+		return true;
+	}
+
+	if (!_lastRefill || now < _lastRefill)
+		_tokens = (double)rate;
+	else
+		_tokens = std::min((double)rate, _tokens + (double)(now - _lastRefill) * (double)rate / 1000000000.0);
+	_lastRefill = now;
+
+	return _tokens >= 1.0;
+}
+
+void Utils::RateLimit::TokenBucket::Take()
+{
+	if (_lastRefill)
+		_tokens -= 1.0;
+}
@@ -0,0 +1,51 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Utils {
+	namespace RateLimit {
+		// Requests are limited per class, so that a client flooding bulk requests does not use up its control budget
+		enum RequestClass {
+			Control, // Anything which acts on OBS, like `SetCurrentProgramScene`
+			Query,   // Cheap `Get*` requests
+			Bulk,    // Screenshots and `*List` requests, which scale with the size of the scene collection
+			RequestClassCount,
+		};
+
+		RequestClass GetRequestClass(const std::string &requestType);
+		const char *GetRequestClassName(RequestClass requestClass);
+
+		// Starts full, then refills continuously. `rate` is in tokens per second and is also the burst size, 0 for no
+		// limit. Passing the rate on every call lets config changes apply to existing buckets. Not thread safe.
+		class TokenBucket {
+		public:
+			// Adds the tokens earned since the last refill, and returns whether one can be taken
+			bool Refill(uint64_t rate, uint64_t now);
+			void Take();
+
+		private:
+			double _tokens = 0.0;
+			uint64_t _lastRefill = 0; // 0 while unlimited
+		};
+	}
+}
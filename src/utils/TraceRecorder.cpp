@@ -0,0 +1,139 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "TraceRecorder.h"
+#include "plugin-macros.generated.h"
+
+// How often the writer thread wakes up to write out recorded messages, in ms
+#define TRACE_WRITE_INTERVAL 100
+
+Utils::Trace::Recorder::Recorder(const std::string &filePath, size_t ringSize)
+{
+	_file = fopen(filePath.c_str(), "wb");
+	if (!_file) {
+		blog(LOG_WARNING, "[Utils::Trace::Recorder::Recorder] Unable to open trace file `%s`", filePath.c_str());
+		return;
+	}
+
+	uint8_t fileHeader[TRACE_FILE_HEADER_SIZE] = {};
+	uint32_t version = TRACE_FILE_VERSION;
+	memcpy(fileHeader, TRACE_FILE_MAGIC, 8);
+	memcpy(fileHeader + 8, &version, sizeof(version));
+	fwrite(fileHeader, 1, sizeof(fileHeader), _file);
+
+	// Allocated and touched up front, so that recording never faults in pages
+	_ring.assign(ringSize, 0);
+	_writerThread = std::thread(&Recorder::WriterThread, this);
+
+	blog(LOG_INFO, "[Utils::Trace::Recorder::Recorder] Recording trace to `%s`", filePath.c_str());
+}
+
+Utils::Trace::Recorder::~Recorder()
+{
+	if (!_file)
+		return;
+
+	std::unique_lock<std::mutex> l(_ringMutex);
+	_running = false;
+	l.unlock();
+	_ringCond.notify_all();
+
+	if (_writerThread.joinable())
+		_writerThread.join();
+
+	fclose(_file);
+
+	blog(LOG_INFO, "[Utils::Trace::Recorder::~Recorder] Trace finished with %llu records, %llu dropped.",
+	     (unsigned long long)_recordCount.load(), (unsigned long long)_droppedRecordCount.load());
+}
+
+void Utils::Trace::Recorder::Record(uint64_t timestamp, uint32_t sessionId, RecordType type, bool binary, const void *data,
+				    size_t size)
+{
+	if (!_file)
+		return;
+
+	RecordHeader header = {};
+	header.timestamp = timestamp;
+	header.sessionId = sessionId;
+	header.type = type;
+	header.binary = binary ? 1 : 0;
+	header.size = (uint32_t)size;
+	uint64_t recordSize = sizeof(header) + size;
+
+	std::unique_lock<std::mutex> l(_ringMutex);
+	if (_head - _tail + recordSize > _ring.size()) {
+		l.unlock();
+		_droppedRecordCount++;
+		return;
+	}
+
+	// The writer only reads between the tail and the head, so the copy can not race with it
+	CopyIn(_head, &header, sizeof(header));
+	if (size)
+		CopyIn(_head + sizeof(header), data, size);
+	_head += recordSize;
+	l.unlock();
+
+	_recordCount++;
+}
+
+// MUST HOLD LOCK
+void Utils::Trace::Recorder::CopyIn(uint64_t position, const void *data, size_t size)
+{
+	size_t offset = (size_t)(position % _ring.size());
+	size_t firstSize = std::min(size, _ring.size() - offset);
+	memcpy(_ring.data() + offset, data, firstSize);
+	if (firstSize < size)
+		memcpy(_ring.data(), (const uint8_t *)data + firstSize, size - firstSize);
+}
+
+void Utils::Trace::Recorder::WriterThread()
+{
+	std::unique_lock<std::mutex> l(_ringMutex);
+	while (true) {
+		_ringCond.wait_for(l, std::chrono::milliseconds(TRACE_WRITE_INTERVAL), [this] { return !_running; });
+
+		uint64_t head = _head;
+		uint64_t tail = _tail;
+		bool running = _running;
+		l.unlock();
+
+		// Recording only appends past the head, so the pending range can be written out without the lock
+		while (tail < head) {
+			size_t offset = (size_t)(tail % _ring.size());
+			size_t writeSize = (size_t)std::min<uint64_t>(head - tail, _ring.size() - offset);
+			if (fwrite(_ring.data() + offset, 1, writeSize, _file) != writeSize) {
+				blog(LOG_WARNING, "[Utils::Trace::Recorder::WriterThread] Failed to write to the trace file.");
+				break;
+			}
+			tail += writeSize;
+		}
+		fflush(_file);
+
+		l.lock();
+		_tail = head; // Records are dropped on a failed write, so that the ring keeps moving
+		if (!running)
+			break;
+	}
+}
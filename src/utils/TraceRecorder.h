@@ -0,0 +1,91 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Trace files start with the 8 byte magic, a uint32 version and a reserved uint32. Every record after that is a
+// `RecordHeader` followed by `size` bytes of payload. All fields are little-endian.
+#define TRACE_FILE_MAGIC "OBSWSTRC"
+#define TRACE_FILE_VERSION 1
+#define TRACE_FILE_HEADER_SIZE 16
+// Size of the ring which messages are copied into. When the writer falls this far behind, records are dropped.
+#define TRACE_RING_SIZE (32 * 1024 * 1024)
+
+namespace Utils {
+	namespace Trace {
+		enum RecordType : uint8_t {
+			Connected,    // Payload is the selected subprotocol, if any
+			Disconnected, // No payload
+			Inbound,      // Payload is the message as received from the client
+			Outbound,     // Payload is the message as sent to the client
+		};
+
+#pragma pack(push, 1)
+		struct RecordHeader {
+			uint64_t timestamp; // Nanoseconds, from an arbitrary monotonic epoch
+			uint32_t sessionId;
+			uint8_t type;   // `RecordType`
+			uint8_t binary; // 1 for binary frames, 0 for text frames
+			uint16_t reserved;
+			uint32_t size;
+		};
+#pragma pack(pop)
+
+		// Appends messages to a trace file. Recording only copies the message into a preallocated ring under a short
+		// lock, the file is written by a background thread.
+		class Recorder {
+		public:
+			Recorder(const std::string &filePath, size_t ringSize = TRACE_RING_SIZE);
+			~Recorder();
+
+			inline bool IsOpen() const { return _file != nullptr; }
+			void Record(uint64_t timestamp, uint32_t sessionId, RecordType type, bool binary,
+				    const void *data = nullptr, size_t size = 0);
+			inline uint64_t RecordCount() const { return _recordCount; }
+			inline uint64_t DroppedRecordCount() const { return _droppedRecordCount; }
+
+		private:
+			void CopyIn(uint64_t position, const void *data, size_t size);
+			void WriterThread();
+
+			FILE *_file = nullptr;
+			std::vector<uint8_t> _ring;
+
+			// Positions are running byte counts, wrapped into the ring when used
+			std::mutex _ringMutex;
+			std::condition_variable _ringCond;
+			uint64_t _head = 0; // Recorded up to here
+			uint64_t _tail = 0; // Written to the file up to here
+			bool _running = true;
+			std::thread _writerThread;
+
+			std::atomic<uint64_t> _recordCount = 0;
+			std::atomic<uint64_t> _droppedRecordCount = 0;
+		};
+	}
+}
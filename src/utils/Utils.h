@@ -21,7 +21,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include "Crypto.h"
 #include "Json.h"
+#include "Image.h"
 #include "Obs.h"
 #include "Obs_VolumeMeter.h"
+#include "Obs_FrameReadback.h"
+#include "Obs_FrameStream.h"
+#include "Metrics.h"
+#include "PersistentData.h"
 #include "Platform.h"
 #include "Compat.h"
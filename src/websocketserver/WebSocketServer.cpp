@@ -17,18 +17,26 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <QDateTime>
+#include <QThread>
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 
 #include "WebSocketServer.h"
+#include "rpc/ProtocolMessages.h"
 #include "../obs-websocket.h"
 #include "../Config.h"
 #include "../utils/Crypto.h"
+#include "../utils/Metrics.h"
 #include "../utils/Platform.h"
 #include "../utils/Compat.h"
+#include "../utils/Obs_FrameStream.h"
+
+// Upper bound of the encode pool, which runs next to the request worker pool
+#define ENCODE_POOL_MAX_THREADS 8
 
 WebSocketServer::WebSocketServer() : QObject(nullptr)
 {
@@ -46,6 +54,13 @@ WebSocketServer::WebSocketServer() : QObject(nullptr)
 	_server.set_close_handler(websocketpp::lib::bind(&WebSocketServer::onClose, this, websocketpp::lib::placeholders::_1));
 	_server.set_message_handler(websocketpp::lib::bind(&WebSocketServer::onMessage, this, websocketpp::lib::placeholders::_1,
 							   websocketpp::lib::placeholders::_2));
+	_server.set_http_handler(websocketpp::lib::bind(&WebSocketServer::onHttp, this, websocketpp::lib::placeholders::_1));
+
+	_encodeThreadPool.setMaxThreadCount(std::clamp(QThread::idealThreadCount() / 2, 2, ENCODE_POOL_MAX_THREADS));
+
+	auto conf = GetConfig();
+	if (conf && !conf->TraceFilePath.empty())
+		_traceRecorder = std::make_unique<Utils::Trace::Recorder>(conf->TraceFilePath);
 }
 
 WebSocketServer::~WebSocketServer()
@@ -124,6 +139,9 @@ void WebSocketServer::Start()
 
 	blog(LOG_INFO, "[WebSocketServer::Start] Server started successfully on port %d. Possible connect address: %s",
 	     conf->ServerPort.load(), Utils::Platform::GetLocalAddress().c_str());
+
+	if (conf->MetricsEnabled)
+		blog(LOG_INFO, "[WebSocketServer::Start] Metrics are enabled, and served at `/metrics` on the same port.");
 }
 
 void WebSocketServer::Stop()
@@ -153,6 +171,7 @@ void WebSocketServer::Stop()
 	lock.unlock();
 
 	_threadPool.waitForDone();
+	_encodeThreadPool.waitForDone();
 
 	// This can delay the thread that it is running on. Bad but kinda required.
 	while (_sessions.size() > 0)
@@ -181,6 +200,21 @@ void WebSocketServer::InvalidateSession(websocketpp::connection_hdl hdl)
 	}
 }
 
+void WebSocketServer::AnnounceSubscriptionChange(bool type, uint64_t eventSubscriptions)
+{
+	for (size_t i = 0; i < 64; i++) {
+		if ((eventSubscriptions & (1ULL << i)) == 0)
+			continue;
+		if (type)
+			_intentSubscriberCounts[i]++;
+		else
+			_intentSubscriberCounts[i]--;
+	}
+
+	if (_clientSubscriptionCallback)
+		_clientSubscriptionCallback(type, eventSubscriptions);
+}
+
 std::vector<WebSocketServer::WebSocketSessionState> WebSocketServer::GetWebSocketSessions()
 {
 	std::vector<WebSocketServer::WebSocketSessionState> webSocketSessions;
@@ -231,6 +265,8 @@ void WebSocketServer::onOpen(websocketpp::connection_hdl hdl)
 	SessionPtr session = _sessions[hdl] = std::make_shared<WebSocketSession>();
 	std::unique_lock<std::mutex> sessionLock(session->OperationMutex);
 	lock.unlock();
+	_sessionCount++;
+	session->SetId(++_nextSessionId);
 
 	// Configure session details
 	session->SetRemoteAddress(conn->get_remote_endpoint());
@@ -279,16 +315,26 @@ void WebSocketServer::onOpen(websocketpp::connection_hdl hdl)
 
 	blog_debug("[WebSocketServer::onOpen] Sending Op 0 (Hello) message:\n%s", helloMessage.dump(2).c_str());
 
+	if (_traceRecorder)
+		_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Connected, false, selectedSubprotocol.data(),
+				       selectedSubprotocol.size());
+
 	// Send object to client
 	websocketpp::lib::error_code errorCode;
 	auto sessionEncoding = session->Encoding();
 	if (sessionEncoding == WebSocketEncoding::Json) {
 		std::string helloMessageJson = helloMessage.dump();
 		_server.send(hdl, helloMessageJson, websocketpp::frame::opcode::text, errorCode);
+		if (_traceRecorder)
+			_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, false,
+					       helloMessageJson.data(), helloMessageJson.size());
 	} else if (sessionEncoding == WebSocketEncoding::MsgPack) {
 		auto msgPackData = json::to_msgpack(helloMessage);
 		std::string messageMsgPack(msgPackData.begin(), msgPackData.end());
 		_server.send(hdl, messageMsgPack, websocketpp::frame::opcode::binary, errorCode);
+		if (_traceRecorder)
+			_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, true, messageMsgPack.data(),
+					       messageMsgPack.size());
 	}
 	session->IncrementOutgoingMessages();
 }
@@ -308,10 +354,28 @@ void WebSocketServer::onClose(websocketpp::connection_hdl hdl)
 	std::string remoteAddress = session->RemoteAddress();
 	_sessions.erase(hdl);
 	lock.unlock();
+	_sessionCount--;
+
+	if (_traceRecorder)
+		_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Disconnected, false);
 
 	// If client was identified, announce unsubscription
-	if (isIdentified && _clientSubscriptionCallback)
-		_clientSubscriptionCallback(false, eventSubscriptions);
+	if (isIdentified) {
+		_identifiedSessionCount--;
+		AnnounceSubscriptionChange(false, eventSubscriptions);
+	}
+
+	if (isIdentified)
+		UpdateInputVolumeMetersConfig();
+
+	// Stop any source frame streams which only this client was watching. Stopping a stream joins its thread, which
+	// must not hold up the IO thread
+	uint32_t sessionId = session->Id();
+	_threadPool.start(Utils::Compat::CreateFunctionRunnable([sessionId]() {
+		auto frameStreamHandler = GetFrameStreamHandler();
+		if (frameStreamHandler)
+			frameStreamHandler->UnsubscribeAll(sessionId);
+	}));
 
 	// Build SessionState object for signal
 	WebSocketSessionState state;
@@ -349,16 +413,48 @@ void WebSocketServer::onMessage(websocketpp::connection_hdl hdl,
 {
 	auto opCode = message->get_opcode();
 	std::string payload = message->get_payload();
+	uint64_t receivedAt = os_gettime_ns();
+
+	std::unique_lock<std::mutex> lock(_sessionMutex);
+	SessionPtr session;
+	try {
+		session = _sessions.at(hdl);
+	} catch (const std::out_of_range &oor) {
+		UNUSED_PARAMETER(oor);
+		return;
+	}
+	lock.unlock();
+
+	// Recorded on receipt, so that a replay reproduces the client's timing rather than the thread pool's
+	if (_traceRecorder)
+		_traceRecorder->Record(receivedAt, session->Id(), Utils::Trace::Inbound,
+				       opCode == websocketpp::frame::opcode::binary, payload.data(), payload.size());
+
+	// Checked before queuing, so that requests over a session's limits are answered without taking up a worker thread.
+	// Messages which cannot be answered here, such as `Identify`, are queued regardless.
+	if (!AdmitMessage(hdl, session, opCode, payload, receivedAt))
+		return;
+
+	_queuedTasks++;
+	_queuedMessages++;
+	session->IncrementQueuedMessages();
 	_threadPool.start(Utils::Compat::CreateFunctionRunnable([=]() {
-		std::unique_lock<std::mutex> lock(_sessionMutex);
-		SessionPtr session;
-		try {
-			session = _sessions.at(hdl);
-		} catch (const std::out_of_range &oor) {
-			UNUSED_PARAMETER(oor);
+		uint64_t startedAt = os_gettime_ns();
+		_queuedTasks--;
+		_queuedMessages--;
+		session->DecrementQueuedMessages();
+
+		UpdateAdmission(startedAt - receivedAt, startedAt);
+
+		// The session may have been closed while the message was queued
+		std::unique_lock<std::mutex> sessionLock(_sessionMutex);
+		bool sessionOpen = _sessions.count(hdl) != 0;
+		sessionLock.unlock();
+		if (!sessionOpen)
 			return;
-		}
-		lock.unlock();
+
+		// Not counting the wait for `_sessionMutex`, which would make the decode phase look slower under contention
+		uint64_t decodeStartedAt = os_gettime_ns();
 
 		session->IncrementIncomingMessages();
 
@@ -398,44 +494,18 @@ void WebSocketServer::onMessage(websocketpp::connection_hdl hdl,
 				return;
 			}
 		}
+		uint64_t decodedAt = os_gettime_ns();
 
 		blog_debug("[WebSocketServer::onMessage] Incoming message (decoded):\n%s", incomingMessage.dump(2).c_str());
 
 		ProcessResult ret;
-
-		// Verify incoming message is an object
-		if (!incomingMessage.is_object()) {
-			ret.closeCode = WebSocketCloseCode::MessageDecodeError;
-			ret.closeReason = "You sent a non-object payload.";
-			goto skipProcessing;
-		}
-
-		// Disconnect client if 4.x protocol is detected
-		if (!session->IsIdentified() && incomingMessage.contains("request-type")) {
+		ret.closeCode = ProtocolMessages::ValidateMessage(incomingMessage, session->IsIdentified(), ret.closeReason);
+		if (ret.closeCode == WebSocketCloseCode::UnsupportedRpcVersion)
 			blog(LOG_WARNING, "[WebSocketServer::onMessage] Client %s appears to be running a pre-5.0.0 protocol.",
 			     session->RemoteAddress().c_str());
-			ret.closeCode = WebSocketCloseCode::UnsupportedRpcVersion;
-			ret.closeReason =
-				"You appear to be attempting to connect with the pre-5.0.0 plugin protocol. Check to make sure your client is updated.";
-			goto skipProcessing;
-		}
+		else if (ret.closeCode == WebSocketCloseCode::DontClose)
+			ProcessMessage(session, ret, incomingMessage["op"], incomingMessage["d"]);
 
-		// Validate op code
-		if (!incomingMessage.contains("op")) {
-			ret.closeCode = WebSocketCloseCode::UnknownOpCode;
-			ret.closeReason = "Your request is missing an `op`.";
-			goto skipProcessing;
-		}
-
-		if (!incomingMessage["op"].is_number()) {
-			ret.closeCode = WebSocketCloseCode::UnknownOpCode;
-			ret.closeReason = "Your `op` is not a number.";
-			goto skipProcessing;
-		}
-
-		ProcessMessage(session, ret, incomingMessage["op"], incomingMessage["d"]);
-
-	skipProcessing:
 		if (ret.closeCode != WebSocketCloseCode::DontClose) {
 			websocketpp::lib::error_code errorCode;
 			_server.close(hdl, ret.closeCode, ret.closeReason, errorCode);
@@ -443,22 +513,50 @@ void WebSocketServer::onMessage(websocketpp::connection_hdl hdl,
 		}
 
 		if (!ret.result.is_null()) {
-			websocketpp::lib::error_code errorCode;
-			if (sessionEncoding == WebSocketEncoding::Json) {
-				std::string helloMessageJson = ret.result.dump();
-				_server.send(hdl, helloMessageJson, websocketpp::frame::opcode::text, errorCode);
-			} else if (sessionEncoding == WebSocketEncoding::MsgPack) {
-				auto msgPackData = json::to_msgpack(ret.result);
-				std::string messageMsgPack(msgPackData.begin(), msgPackData.end());
-				_server.send(hdl, messageMsgPack, websocketpp::frame::opcode::binary, errorCode);
-			}
-			session->IncrementOutgoingMessages();
+			uint64_t encodeStartedAt = os_gettime_ns();
+			SendSessionMessage(hdl, session, ret.result);
 
-			blog_debug("[WebSocketServer::onMessage] Outgoing message:\n%s", ret.result.dump(2).c_str());
+			// Binary response fields follow their response, for Json sessions
+			for (auto &attachment : ret.binaryAttachments) {
+				SendBinaryAttachment(hdl, attachment);
+				session->IncrementOutgoingMessages();
+			}
 
-			if (errorCode)
-				blog(LOG_WARNING, "[WebSocketServer::onMessage] Sending message to client failed: %s",
-				     errorCode.message().c_str());
+			// Only single requests are timed per phase, batches are timed per request by the request handler
+			auto requestMetrics = GetRequestMetrics();
+			if (requestMetrics && !ret.requestType.empty()) {
+				using Utils::Metrics::RequestPhase;
+				requestMetrics->Record(ret.requestType, RequestPhase::QueueWait, startedAt - receivedAt);
+				requestMetrics->Record(ret.requestType, RequestPhase::Decode, decodedAt - decodeStartedAt);
+				requestMetrics->Record(ret.requestType, RequestPhase::EncodeSend, os_gettime_ns() - encodeStartedAt);
+			}
 		}
 	}));
 }
+
+// Encodes `message` with the session's encoding and sends it
+void WebSocketServer::SendSessionMessage(websocketpp::connection_hdl hdl, SessionPtr session, const json &message)
+{
+	websocketpp::lib::error_code errorCode;
+	uint8_t sessionEncoding = session->Encoding();
+	if (sessionEncoding == WebSocketEncoding::Json) {
+		std::string messageJson = Utils::Json::Dump(message);
+		_server.send(hdl, messageJson, websocketpp::frame::opcode::text, errorCode);
+		if (_traceRecorder)
+			_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, false, messageJson.data(),
+					       messageJson.size());
+	} else if (sessionEncoding == WebSocketEncoding::MsgPack) {
+		auto msgPackData = Utils::Json::ToMsgPack(message);
+		_server.send(hdl, msgPackData.data(), msgPackData.size(), websocketpp::frame::opcode::binary, errorCode);
+		if (_traceRecorder)
+			_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, true, msgPackData.data(),
+					       msgPackData.size());
+	}
+	session->IncrementOutgoingMessages();
+
+	blog_debug("[WebSocketServer::SendSessionMessage] Outgoing message:\n%s", message.dump(2).c_str());
+
+	if (errorCode)
+		blog(LOG_WARNING, "[WebSocketServer::SendSessionMessage] Sending message to client failed: %s",
+		     errorCode.message().c_str());
+}
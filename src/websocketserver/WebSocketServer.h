@@ -20,6 +20,7 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #pragma once
 
 #include <mutex>
+#include <unordered_map>
 #include <QObject>
 #include <QThreadPool>
 #include <QString>
@@ -32,6 +33,8 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include "types/WebSocketOpCode.h"
 #include "../requesthandler/rpc/Request.h"
 #include "../utils/Json.h"
+#include "../utils/RateLimit.h"
+#include "../utils/TraceRecorder.h"
 #include "plugin-macros.generated.h"
 
 class WebSocketServer : QObject {
@@ -56,25 +59,55 @@ public:
 	void Stop();
 	void InvalidateSession(websocketpp::connection_hdl hdl);
 	void BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData = nullptr,
-			    uint8_t rpcVersion = 0);
+			    uint8_t rpcVersion = 0, uint64_t emittedAt = 0);
+	void BroadcastBinaryEvent(uint64_t requiredIntent, const uint8_t *data, size_t size);
+	void SendSessionBinaryMessage(uint32_t sessionId, const uint8_t *data, size_t size);
 	inline void SetObsReady(bool ready) { _obsReady = ready; }
 	inline bool IsListening() { return _server.is_listening(); }
 	std::vector<WebSocketSessionState> GetWebSocketSessions();
 	inline QThreadPool *GetThreadPool() { return &_threadPool; }
+	inline QThreadPool *GetEncodeThreadPool() { return &_encodeThreadPool; }
+	std::string RenderMetrics();
+	bool AdmitRequest(SessionPtr session, const std::string &requestType, std::string &comment);
 
 	// Callback for when a client subscribes or unsubscribes. `true` for sub, `false` for unsub
 	typedef std::function<void(bool, uint64_t)> ClientSubscriptionCallback; // bool type, uint64_t eventSubscriptions
 	inline void SetClientSubscriptionCallback(ClientSubscriptionCallback cb) { _clientSubscriptionCallback = cb; }
 
+	// Callback for when the aggregated volume meter parameters of subscribed clients change
+	typedef std::function<void(uint64_t, std::vector<std::string>)>
+		InputVolumeMetersConfigCallback; // uint64_t updatePeriod, std::vector<std::string> inputs (empty for all)
+	inline void SetInputVolumeMetersConfigCallback(InputVolumeMetersConfigCallback cb)
+	{
+		_inputVolumeMetersConfigCallback = cb;
+	}
+
 signals:
 	void ClientConnected(WebSocketSessionState state);
 	void ClientDisconnected(WebSocketSessionState state, uint16_t closeCode);
 
 private:
+	struct BinaryAttachment {
+		uint32_t attachmentId;
+		json::binary_t data;
+	};
+
 	struct ProcessResult {
 		WebSocketCloseCode::WebSocketCloseCode closeCode = WebSocketCloseCode::DontClose;
 		std::string closeReason;
 		json result;
+		std::vector<BinaryAttachment> binaryAttachments;
+		std::string requestType; // Set for single requests, for per request type metrics
+	};
+
+	struct InputVolumeMetersMappingEntry {
+		std::string inputName;
+		std::string inputUuid;
+	};
+
+	struct DeltaEventState {
+		json lastSent;
+		uint32_t eventsSinceSnapshot = 0;
 	};
 
 	void ServerRunner();
@@ -83,11 +116,33 @@ private:
 	void onOpen(websocketpp::connection_hdl hdl);
 	void onClose(websocketpp::connection_hdl hdl);
 	void onMessage(websocketpp::connection_hdl hdl, websocketpp::server<websocketpp::config::asio>::message_ptr message);
+	void onHttp(websocketpp::connection_hdl hdl);
+
+	void AnnounceSubscriptionChange(bool type, uint64_t eventSubscriptions);
+	void UpdateOutboundBufferedBytes(uint64_t total, uint64_t max);
+	bool AdmitMessage(websocketpp::connection_hdl hdl, SessionPtr session, websocketpp::frame::opcode::value opCode,
+			  const std::string &payload, uint64_t now);
+	bool RejectMessage(websocketpp::connection_hdl hdl, SessionPtr session, websocketpp::frame::opcode::value opCode,
+			   const std::string &payload, const std::string &comment);
+	void UpdateAdmission(uint64_t queueWait, uint64_t now);
 
 	static void SetSessionParameters(SessionPtr session, WebSocketServer::ProcessResult &ret, const json &payloadData);
+	static void ExtractBinaryAttachments(SessionPtr session, json &responseData, std::vector<BinaryAttachment> &attachments);
+	void SendBinaryAttachment(websocketpp::connection_hdl hdl, const BinaryAttachment &attachment);
+	void SendSessionMessage(websocketpp::connection_hdl hdl, SessionPtr session, const json &message);
 	void ProcessMessage(SessionPtr session, ProcessResult &ret, WebSocketOpCode::WebSocketOpCode opCode, json &payloadData);
 
+	bool BuildDeltaEventData(const std::string &eventType, const json &eventData, json &deltaEventData);
+	void UpdateDeltaEventStates(const std::string &eventType, const json &eventData);
+	void ResetDeltaEventStates();
+
+	void UpdateInputVolumeMetersConfig();
+	void RenameInputVolumeMetersInput(const std::string &oldInputName, const std::string &inputName);
+	void UpdateInputVolumeMetersMapping(const json &eventData);
+	bool FilterInputVolumeMetersFrame(SessionPtr session, const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
 	QThreadPool _threadPool;
+	QThreadPool _encodeThreadPool; // Image encodes and their stripes, which request workers only wait on
 
 	std::thread _serverThread;
 	websocketpp::server<websocketpp::config::asio> _server;
@@ -97,8 +152,43 @@ private:
 
 	std::mutex _sessionMutex;
 	std::map<websocketpp::connection_hdl, SessionPtr, std::owner_less<websocketpp::connection_hdl>> _sessions;
+	std::vector<uint8_t> _msgPackFrameBuffer; // `BinaryFrame` events for MsgPack sessions. MUST HOLD `_sessionMutex`
+	std::vector<uint8_t> _filteredFrameBuffer; // Binary meter frames filtered per session. MUST HOLD `_sessionMutex`
 
 	std::atomic<bool> _obsReady = false;
 
+	std::mutex _deltaEventMutex;
+	std::unordered_map<std::string, DeltaEventState> _deltaEventStates;
+
+	std::mutex _inputVolumeMetersConfigMutex;
+	std::atomic<uint64_t> _inputVolumeMetersPeriod = 50;
+
+	// Last `InputVolumeMetersMapping`, indexed by `inputIndex`, so that binary meter frames can be filtered per session
+	std::mutex _inputVolumeMetersMappingMutex;
+	uint32_t _inputVolumeMetersMappingSequence = 0;
+	std::vector<InputVolumeMetersMappingEntry> _inputVolumeMetersMapping;
+
+	std::atomic<uint32_t> _nextSessionId = 0;
+
+	// Only created when `--websocket_trace` is passed
+	std::unique_ptr<Utils::Trace::Recorder> _traceRecorder;
+
 	ClientSubscriptionCallback _clientSubscriptionCallback;
+	InputVolumeMetersConfigCallback _inputVolumeMetersConfigCallback;
+
+	// Maintained as things happen, so that `RenderMetrics()` never needs to take the session lock
+	std::atomic<uint64_t> _sessionCount = 0;
+	std::atomic<uint64_t> _identifiedSessionCount = 0;
+	std::atomic<uint64_t> _intentSubscriberCounts[64] = {};
+	std::atomic<uint64_t> _broadcastEvents = 0;
+	std::atomic<uint64_t> _broadcastMessages = 0;
+	std::atomic<uint64_t> _outboundBufferedBytes = 0;    // Sum over sessions, sampled by the last broadcast
+	std::atomic<uint64_t> _outboundBufferedBytesMax = 0; // Largest single session, sampled by the last broadcast
+	std::atomic<uint64_t> _queuedTasks = 0;              // Started on `_threadPool`, but not yet picked up
+	std::atomic<uint64_t> _queuedMessages = 0;           // Like `_queuedTasks`, but only counting incoming messages
+	std::atomic<uint64_t> _sheddingUntil = 0;            // Bulk requests are rejected until then, see `UpdateAdmission()`
+	std::atomic<uint64_t> _shedRequests = 0;
+	std::atomic<uint64_t> _rateLimitedMessages = 0; // Answered by `AdmitMessage()` for being over the session rate limit
+	std::atomic<uint64_t> _queueFullMessages = 0;   // Answered by `AdmitMessage()` for the session having too many queued
+	std::atomic<uint64_t> _rateLimitedRequests[Utils::RateLimit::RequestClassCount] = {};
 };
@@ -0,0 +1,227 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include <sstream>
+#include <obs-module.h>
+
+#include "WebSocketServer.h"
+#include "../eventhandler/types/EventSubscription.h"
+#include "../obs-websocket.h"
+#include "../Config.h"
+#include "../requesthandler/RequestBatchHandler.h"
+#include "../utils/Metrics.h"
+#include "../utils/Obs.h"
+#include "../utils/Compat.h"
+
+#define METRICS_PATH "/metrics"
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+static const std::pair<uint64_t, const char *> intentNames[] = {
+	{EventSubscription::General, "General"},
+	{EventSubscription::Config, "Config"},
+	{EventSubscription::Scenes, "Scenes"},
+	{EventSubscription::Inputs, "Inputs"},
+	{EventSubscription::Transitions, "Transitions"},
+	{EventSubscription::Filters, "Filters"},
+	{EventSubscription::Outputs, "Outputs"},
+	{EventSubscription::SceneItems, "SceneItems"},
+	{EventSubscription::MediaInputs, "MediaInputs"},
+	{EventSubscription::Vendors, "Vendors"},
+	{EventSubscription::Ui, "Ui"},
+	{EventSubscription::InputVolumeMeters, "InputVolumeMeters"},
+	{EventSubscription::InputActiveStateChanged, "InputActiveStateChanged"},
+	{EventSubscription::InputShowStateChanged, "InputShowStateChanged"},
+	{EventSubscription::SceneItemTransformChanged, "SceneItemTransformChanged"},
+	{EventSubscription::InputVolumeMetersBinary, "InputVolumeMetersBinary"},
+};
+
+static const std::pair<const char *, const char *> handlerQuantiles[] = {
+	{"0.5", "p50"},
+	{"0.9", "p90"},
+	{"0.99", "p99"},
+};
+
+static void WriteMetricHeader(std::ostringstream &out, const char *name, const char *type, const char *help)
+{
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " " << type << "\n";
+}
+
+template<typename T>
+static void WriteMetric(std::ostringstream &out, const char *name, const char *type, const char *help, T value)
+{
+	WriteMetricHeader(out, name, type, help);
+	out << name << " " << value << "\n";
+}
+
+// Plain HTTP requests on the WebSocket port. Only `/metrics` is served, and only when enabled in the config.
+void WebSocketServer::onHttp(websocketpp::connection_hdl hdl)
+{
+	auto conn = _server.get_con_from_hdl(hdl);
+
+	// Matches websocketpp's response when there is no HTTP handler
+	auto conf = GetConfig();
+	std::string resource = conn->get_resource();
+	resource = resource.substr(0, resource.find('?'));
+	if (!conf || !conf->MetricsEnabled || conn->get_request().get_method() != "GET" || resource != METRICS_PATH) {
+		conn->set_status(websocketpp::http::status_code::upgrade_required);
+		return;
+	}
+
+	// The OBS stats query the config and the disk, which must not stall every connection on the IO thread. The response
+	// is deferred, rendered on the worker pool, and then sent from the IO thread again.
+	websocketpp::lib::error_code errorCode = conn->defer_http_response();
+	if (errorCode) {
+		conn->set_status(websocketpp::http::status_code::internal_server_error);
+		return;
+	}
+
+	_queuedTasks++;
+	_threadPool.start(Utils::Compat::CreateFunctionRunnable([this, conn]() {
+		_queuedTasks--;
+
+		std::string body = RenderMetrics();
+		_server.get_io_service().post([conn, body]() {
+			conn->set_status(websocketpp::http::status_code::ok);
+			conn->append_header("Content-Type", METRICS_CONTENT_TYPE);
+			conn->set_body(body);
+
+			websocketpp::lib::error_code errorCode;
+			conn->send_http_response(errorCode);
+			if (errorCode)
+				blog(LOG_WARNING, "[WebSocketServer::onHttp] Failed to send metrics response: %s",
+				     errorCode.message().c_str());
+		});
+	}));
+}
+
+void WebSocketServer::UpdateOutboundBufferedBytes(uint64_t total, uint64_t max)
+{
+	_outboundBufferedBytes = total;
+	_outboundBufferedBytesMax = max;
+}
+
+// Renders the metrics in the Prometheus text exposition format. Everything but the OBS stats is read from atomics, so this
+// does not contend with request processing or event broadcasts. Runs on the worker pool.
+std::string WebSocketServer::RenderMetrics()
+{
+	std::ostringstream out;
+	out.imbue(std::locale::classic());
+
+	WriteMetric(out, "obs_websocket_sessions", "gauge", "Connected WebSocket sessions", _sessionCount.load());
+	WriteMetric(out, "obs_websocket_identified_sessions", "gauge", "Identified WebSocket sessions",
+		    _identifiedSessionCount.load());
+
+	WriteMetricHeader(out, "obs_websocket_intent_subscribers", "gauge", "Identified sessions subscribed to each event intent");
+	for (auto &[intent, intentName] : intentNames) {
+		size_t bit = 0;
+		while (((uint64_t)1 << bit) != intent)
+			bit++;
+		out << "obs_websocket_intent_subscribers{intent=\"" << intentName << "\"} " << _intentSubscriberCounts[bit].load()
+		    << "\n";
+	}
+
+	WriteMetric(out, "obs_websocket_broadcast_events_total", "counter", "Events broadcast to sessions",
+		    _broadcastEvents.load());
+	WriteMetric(out, "obs_websocket_broadcast_messages_total", "counter", "Event messages sent, across all sessions",
+		    _broadcastMessages.load());
+	WriteMetric(out, "obs_websocket_outbound_buffered_bytes", "gauge",
+		    "Bytes queued for sending across all sessions, as of the last event broadcast", _outboundBufferedBytes.load());
+	WriteMetric(out, "obs_websocket_outbound_buffered_bytes_max", "gauge",
+		    "Bytes queued for sending to the most backed up session, as of the last event broadcast",
+		    _outboundBufferedBytesMax.load());
+
+	WriteMetric(out, "obs_websocket_thread_pool_active_threads", "gauge", "Worker threads currently running a task",
+		    _threadPool.activeThreadCount());
+	WriteMetric(out, "obs_websocket_thread_pool_max_threads", "gauge", "Maximum worker threads",
+		    _threadPool.maxThreadCount());
+	WriteMetric(out, "obs_websocket_thread_pool_queued_tasks", "gauge", "Tasks waiting for a worker thread",
+		    _queuedTasks.load());
+
+	WriteMetricHeader(out, "obs_websocket_rate_limited_messages_total", "counter",
+			  "Messages answered with RateLimited instead of being queued for a worker thread, by reason");
+	out << "obs_websocket_rate_limited_messages_total{reason=\"rate_limit\"} " << _rateLimitedMessages.load() << "\n";
+	out << "obs_websocket_rate_limited_messages_total{reason=\"queue_full\"} " << _queueFullMessages.load() << "\n";
+	WriteMetricHeader(out, "obs_websocket_rate_limited_requests_total", "counter",
+			  "Requests rejected for being over a request class rate limit, by request class");
+	for (size_t i = 0; i < Utils::RateLimit::RequestClassCount; i++)
+		out << "obs_websocket_rate_limited_requests_total{class=\""
+		    << Utils::RateLimit::GetRequestClassName((Utils::RateLimit::RequestClass)i) << "\"} "
+		    << _rateLimitedRequests[i].load() << "\n";
+	WriteMetric(out, "obs_websocket_shed_requests_total", "counter",
+		    "Bulk requests rejected because the thread pool queue wait was over the admission threshold",
+		    _shedRequests.load());
+	WriteMetric(out, "obs_websocket_shedding", "gauge", "Whether bulk requests are currently being shed",
+		    os_gettime_ns() < _sheddingUntil ? 1 : 0);
+
+	auto serialFrameStats = RequestBatchHandler::GetSerialFrameStats();
+	WriteMetric(out, "obs_websocket_serial_frame_ticks_total", "counter", "Graphics ticks which processed SerialFrame requests",
+		    serialFrameStats.ticks);
+	WriteMetric(out, "obs_websocket_serial_frame_deferred_ticks_total", "counter",
+		    "Graphics ticks which deferred SerialFrame requests to the next frame after using up the budget",
+		    serialFrameStats.deferredTicks);
+	WriteMetric(out, "obs_websocket_serial_frame_max_tick_seconds", "gauge",
+		    "Most time spent processing SerialFrame requests in a single graphics tick",
+		    (double)serialFrameStats.maxTickCostNs / 1000000000.0);
+
+	json stats = Utils::Obs::ObjectHelper::GetStats();
+	WriteMetric(out, "obs_cpu_usage_percent", "gauge", "OBS CPU usage", stats["cpuUsage"].get<double>());
+	WriteMetric(out, "obs_memory_usage_megabytes", "gauge", "OBS resident memory", stats["memoryUsage"].get<double>());
+	WriteMetric(out, "obs_available_disk_space_megabytes", "gauge", "Free disk space at the recording path",
+		    stats["availableDiskSpace"].get<double>());
+	WriteMetric(out, "obs_active_fps", "gauge", "Frames being rendered per second", stats["activeFps"].get<double>());
+	WriteMetric(out, "obs_average_frame_render_time_milliseconds", "gauge", "Average frame render time",
+		    stats["averageFrameRenderTime"].get<double>());
+	WriteMetric(out, "obs_render_skipped_frames_total", "counter", "Frames skipped by the render thread",
+		    stats["renderSkippedFrames"].get<uint64_t>());
+	WriteMetric(out, "obs_render_frames_total", "counter", "Frames output by the render thread",
+		    stats["renderTotalFrames"].get<uint64_t>());
+	WriteMetric(out, "obs_output_skipped_frames_total", "counter", "Frames skipped by the output thread",
+		    stats["outputSkippedFrames"].get<uint64_t>());
+	WriteMetric(out, "obs_output_frames_total", "counter", "Frames output by the output thread",
+		    stats["outputTotalFrames"].get<uint64_t>());
+
+	auto requestMetrics = GetRequestMetrics();
+	if (requestMetrics) {
+		json requestStats = requestMetrics->Snapshot();
+
+		WriteMetricHeader(out, "obs_websocket_requests_total", "counter", "Requests processed");
+		for (auto &[requestType, stats] : requestStats.items())
+			out << "obs_websocket_requests_total{request_type=\"" << requestType << "\"} " << stats["requests"] << "\n";
+
+		WriteMetricHeader(out, "obs_websocket_failed_requests_total", "counter", "Requests which did not succeed");
+		for (auto &[requestType, stats] : requestStats.items())
+			out << "obs_websocket_failed_requests_total{request_type=\"" << requestType << "\"} "
+			    << stats["failedRequests"] << "\n";
+
+		WriteMetricHeader(out, "obs_websocket_request_handler_seconds", "summary", "Time spent in request handlers");
+		for (auto &[requestType, stats] : requestStats.items()) {
+			json &handler = stats["handler"];
+			for (auto &[quantile, field] : handlerQuantiles)
+				out << "obs_websocket_request_handler_seconds{request_type=\"" << requestType << "\",quantile=\""
+				    << quantile << "\"} " << handler[field].get<double>() / 1000000 << "\n";
+			out << "obs_websocket_request_handler_seconds_sum{request_type=\"" << requestType << "\"} "
+			    << handler["mean"].get<double>() * handler["count"].get<uint64_t>() / 1000000 << "\n";
+			out << "obs_websocket_request_handler_seconds_count{request_type=\"" << requestType << "\"} "
+			    << handler["count"] << "\n";
+		}
+	}
+
+	return out.str();
+}
@@ -17,41 +17,202 @@ You should have received a copy of the GNU General Public License along
 with this program. If not, see <https://www.gnu.org/licenses/>
 */
 
+#include <set>
+#include <map>
+#include <algorithm>
+#include <cstring>
 #include <obs-module.h>
 #include <util/profiler.hpp>
 
 #include "WebSocketServer.h"
+#include "rpc/ProtocolMessages.h"
 #include "../requesthandler/RequestHandler.h"
 #include "../requesthandler/RequestBatchHandler.h"
+#include "../utils/Obs_VolumeMeter.h"
 #include "../obs-websocket.h"
 #include "../Config.h"
 #include "../utils/Crypto.h"
+#include "../utils/Metrics.h"
 #include "../utils/Platform.h"
 #include "../utils/Compat.h"
 
+// Number of delta-encoded events sent for an object before a full snapshot is sent again, so clients can resync
+#define DELTA_EVENT_SNAPSHOT_INTERVAL 30
+
+// Subscriptions containing delta-encoded events, see `GetDeltaEventField()`
+#define DELTA_EVENT_SUBSCRIPTIONS (EventSubscription::Inputs | EventSubscription::SceneItemTransformChanged)
+
+// Bounds of the volume meter update period sessions may request, in milliseconds
+#define INPUT_VOLUME_METERS_MIN_PERIOD 16
+#define INPUT_VOLUME_METERS_MAX_PERIOD 1000
+#define INPUT_VOLUME_METERS_DEFAULT_PERIOD 50
+
+// Header of the binary frames carrying binary response fields to Json sessions
+#define BINARY_ATTACHMENT_MAGIC "OWBA"
+#define BINARY_ATTACHMENT_VERSION 1
+#define BINARY_ATTACHMENT_HEADER_SIZE 12
+
+// How long bulk requests keep being shed after the last message which waited too long for a worker thread
+#define ADMISSION_SHED_HOLD_MS 1000
+
 static bool IsSupportedRpcVersion(uint8_t requestedVersion)
 {
 	return (requestedVersion == CURRENT_RPC_VERSION);
 }
 
-static json ConstructRequestResult(RequestResult requestResult, const json &requestJson)
+// Returns the event data field which is delta-encoded for sessions with `eventDeltas` enabled, or nullptr if not supported
+static const char *GetDeltaEventField(const std::string &eventType)
 {
+	if (eventType == "InputSettingsChanged")
+		return "inputSettings";
+	else if (eventType == "SceneItemTransformChanged")
+		return "sceneItemTransform";
+	return nullptr;
+}
+
+// Returns the key of the object (input, scene item) which an event refers to, for tracking last-sent delta state
+static std::string GetDeltaEventObjectKey(const std::string &eventType, const json &eventData)
+{
+	if (eventType == "InputSettingsChanged" || eventType == "InputRemoved") {
+		if (eventData.contains("inputUuid") && eventData["inputUuid"].is_string())
+			return "input:" + eventData["inputUuid"].get<std::string>();
+	} else if (eventType == "SceneItemTransformChanged" || eventType == "SceneItemRemoved") {
+		if (eventData.contains("sceneUuid") && eventData["sceneUuid"].is_string() && eventData.contains("sceneItemId"))
+			return "sceneItem:" + eventData["sceneUuid"].get<std::string>() + ":" + eventData["sceneItemId"].dump();
+	}
+	return "";
+}
+
+// Builds a copy of an `InputVolumeMeters` event message only containing the inputs matching `inputs` (names or UUIDs)
+static json FilterInputVolumeMeters(const json &eventMessage, const std::vector<std::string> &inputs)
+{
+	json filteredInputs = json::array();
+	for (auto &input : eventMessage["d"]["eventData"]["inputs"]) {
+		for (auto &filter : inputs) {
+			if (input["inputName"] == filter || input["inputUuid"] == filter) {
+				filteredInputs.push_back(input);
+				break;
+			}
+		}
+	}
+
 	json ret;
+	ret["op"] = eventMessage["op"];
+	ret["d"]["eventType"] = eventMessage["d"]["eventType"];
+	ret["d"]["eventIntent"] = eventMessage["d"]["eventIntent"];
+	ret["d"]["eventData"]["inputs"] = filteredInputs;
+	return ret;
+}
+
+static void WriteMsgPackBigEndian(std::vector<uint8_t> &out, uint64_t value, size_t size)
+{
+	for (size_t i = size; i > 0; i--)
+		out.push_back((uint8_t)(value >> ((i - 1) * 8)));
+}
+
+// Only used for the short constant keys and values of `BinaryFrame` events
+static void WriteMsgPackFixStr(std::vector<uint8_t> &out, const char *str)
+{
+	size_t len = strlen(str);
+	out.push_back(0xA0 | (uint8_t)len);
+	out.insert(out.end(), str, str + len);
+}
+
+// MsgPack sessions decode every message as MsgPack, so they get raw binary frames wrapped in a `BinaryFrame` event. Written
+// by hand into `out`, which is reused across frames, so that meter ticks neither build a json tree nor allocate once `out`
+// has grown. The bytes are the same as `json::to_msgpack()` would produce for the event message.
+static void EncodeMsgPackBinaryFrame(std::vector<uint8_t> &out, uint64_t eventIntent, const uint8_t *data, size_t size)
+{
+	out.clear();
+	out.push_back(0x82); // {"d", "op"}
+	WriteMsgPackFixStr(out, "d");
+	out.push_back(0x83); // {"eventData", "eventIntent", "eventType"}
+	WriteMsgPackFixStr(out, "eventData");
+	out.push_back(0x81); // {"frame"}
+	WriteMsgPackFixStr(out, "frame");
+	if (size <= 0xFF) {
+		out.push_back(0xC4);
+		WriteMsgPackBigEndian(out, size, 1);
+	} else if (size <= 0xFFFF) {
+		out.push_back(0xC5);
+		WriteMsgPackBigEndian(out, size, 2);
+	} else {
+		out.push_back(0xC6);
+		WriteMsgPackBigEndian(out, size, 4);
+	}
+	out.insert(out.end(), data, data + size);
 
-	ret["requestType"] = requestJson["requestType"];
+	WriteMsgPackFixStr(out, "eventIntent");
+	if (eventIntent <= 0x7F) {
+		out.push_back((uint8_t)eventIntent);
+	} else if (eventIntent <= 0xFF) {
+		out.push_back(0xCC);
+		WriteMsgPackBigEndian(out, eventIntent, 1);
+	} else if (eventIntent <= 0xFFFF) {
+		out.push_back(0xCD);
+		WriteMsgPackBigEndian(out, eventIntent, 2);
+	} else if (eventIntent <= 0xFFFFFFFF) {
+		out.push_back(0xCE);
+		WriteMsgPackBigEndian(out, eventIntent, 4);
+	} else {
+		out.push_back(0xCF);
+		WriteMsgPackBigEndian(out, eventIntent, 8);
+	}
 
-	if (requestJson.contains("requestId") && !requestJson["requestId"].is_null())
-		ret["requestId"] = requestJson["requestId"];
+	WriteMsgPackFixStr(out, "eventType");
+	WriteMsgPackFixStr(out, "BinaryFrame");
+	WriteMsgPackFixStr(out, "op");
+	out.push_back(WebSocketOpCode::Event); // Positive fixint
+}
 
-	ret["requestStatus"] = {{"result", requestResult.StatusCode == RequestStatus::Success}, {"code", requestResult.StatusCode}};
+// Json can not carry binary values, so binary response fields are sent to Json sessions as separate binary frames, and
+// replaced in the response by a reference to them. Only top-level fields of the response data are checked.
+// Pre-serialized fragments are binary values too, but are spliced into the message when it is serialized.
+void WebSocketServer::ExtractBinaryAttachments(SessionPtr session, json &responseData,
+					       std::vector<BinaryAttachment> &attachments)
+{
+	if (!responseData.is_object())
+		return;
 
-	if (!requestResult.Comment.empty())
-		ret["requestStatus"]["comment"] = requestResult.Comment;
+	for (auto &it : responseData.items()) {
+		json &value = it.value();
+		if (!value.is_binary() || Utils::Json::IsFragment(value))
+			continue;
 
-	if (requestResult.ResponseData.is_object())
-		ret["responseData"] = requestResult.ResponseData;
+		BinaryAttachment attachment;
+		attachment.attachmentId = session->NextBinaryAttachmentId();
+		attachment.data = std::move(value.get_binary());
 
-	return ret;
+		value = {{"binaryAttachmentId", attachment.attachmentId}, {"size", attachment.data.size()}};
+		attachments.push_back(std::move(attachment));
+	}
+}
+
+// The header is written straight into the outgoing message, so the attachment is only copied once, into the socket buffer
+void WebSocketServer::SendBinaryAttachment(websocketpp::connection_hdl hdl, const BinaryAttachment &attachment)
+{
+	websocketpp::lib::error_code errorCode;
+	auto conn = _server.get_con_from_hdl(hdl, errorCode);
+	if (errorCode)
+		return;
+
+	uint8_t header[BINARY_ATTACHMENT_HEADER_SIZE];
+	uint16_t version = BINARY_ATTACHMENT_VERSION;
+	uint16_t reserved = 0;
+	memcpy(header, BINARY_ATTACHMENT_MAGIC, 4);
+	memcpy(header + 4, &version, sizeof(uint16_t));
+	memcpy(header + 6, &reserved, sizeof(uint16_t));
+	memcpy(header + 8, &attachment.attachmentId, sizeof(uint32_t));
+
+	auto message = conn->get_message(websocketpp::frame::opcode::binary,
+					 BINARY_ATTACHMENT_HEADER_SIZE + attachment.data.size());
+	message->append_payload(header, BINARY_ATTACHMENT_HEADER_SIZE);
+	message->append_payload(attachment.data.data(), attachment.data.size());
+
+	errorCode = conn->send(message);
+	if (errorCode)
+		blog(LOG_WARNING, "[WebSocketServer::SendBinaryAttachment] Sending binary attachment to client failed: %s",
+		     errorCode.message().c_str());
 }
 
 void WebSocketServer::SetSessionParameters(SessionPtr session, ProcessResult &ret, const json &payloadData)
@@ -64,21 +225,246 @@ void WebSocketServer::SetSessionParameters(SessionPtr session, ProcessResult &re
 		}
 		session->SetEventSubscriptions(payloadData["eventSubscriptions"]);
 	}
+
+	if (payloadData.contains("eventDeltas")) {
+		if (!payloadData["eventDeltas"].is_boolean()) {
+			ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+			ret.closeReason = "Your `eventDeltas` is not a boolean.";
+			return;
+		}
+		session->SetEventDeltas(payloadData["eventDeltas"]);
+	}
+
+	if (payloadData.contains("inputVolumeMetersPeriod")) {
+		if (!payloadData["inputVolumeMetersPeriod"].is_number_unsigned()) {
+			ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+			ret.closeReason = "Your `inputVolumeMetersPeriod` is not an unsigned number.";
+			return;
+		}
+		uint64_t period = payloadData["inputVolumeMetersPeriod"];
+		if (period < INPUT_VOLUME_METERS_MIN_PERIOD || period > INPUT_VOLUME_METERS_MAX_PERIOD) {
+			ret.closeCode = WebSocketCloseCode::InvalidDataFieldValue;
+			ret.closeReason = "Your `inputVolumeMetersPeriod` is out of range. Minimum: " +
+					  std::to_string(INPUT_VOLUME_METERS_MIN_PERIOD) +
+					  ", Maximum: " + std::to_string(INPUT_VOLUME_METERS_MAX_PERIOD);
+			return;
+		}
+		session->SetInputVolumeMetersPeriod(period);
+	}
+
+	if (payloadData.contains("inputVolumeMetersInputs")) {
+		const json &inputs = payloadData["inputVolumeMetersInputs"];
+		if (inputs.is_null()) {
+			session->SetInputVolumeMetersInputs({});
+		} else {
+			if (!inputs.is_array()) {
+				ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+				ret.closeReason = "Your `inputVolumeMetersInputs` is not an array.";
+				return;
+			}
+			if (inputs.empty()) {
+				ret.closeCode = WebSocketCloseCode::InvalidDataFieldValue;
+				ret.closeReason = "Your `inputVolumeMetersInputs` is empty. Use `null` to receive all inputs.";
+				return;
+			}
+			std::vector<std::string> inputList;
+			for (auto &input : inputs) {
+				if (!input.is_string()) {
+					ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
+					ret.closeReason = "Your `inputVolumeMetersInputs` contains a non-string item.";
+					return;
+				}
+				inputList.push_back(input);
+			}
+			// Normalized, so that sessions selecting the same inputs share a filtered message
+			std::sort(inputList.begin(), inputList.end());
+			inputList.erase(std::unique(inputList.begin(), inputList.end()), inputList.end());
+			session->SetInputVolumeMetersInputs(inputList);
+		}
+	}
+}
+
+static uint64_t GetRequestClassRateLimit(const ConfigPtr &conf, Utils::RateLimit::RequestClass requestClass)
+{
+	switch (requestClass) {
+	case Utils::RateLimit::Control:
+		return conf->ControlRateLimit;
+	case Utils::RateLimit::Query:
+		return conf->QueryRateLimit;
+	case Utils::RateLimit::Bulk:
+		return conf->BulkRateLimit;
+	default:
+		return 0;
+	}
+}
+
+// Called on the IO thread for every message, before it is queued for a worker thread, so that a session sending faster than
+// it is allowed to cannot fill up the queue ahead of other sessions. Returns false if the message was answered with
+// `RequestStatus::RateLimited`, and must not be queued.
+bool WebSocketServer::AdmitMessage(websocketpp::connection_hdl hdl, SessionPtr session,
+				   websocketpp::frame::opcode::value opCode, const std::string &payload, uint64_t now)
+{
+	auto conf = GetConfig();
+	if (!conf)
+		return true;
+
+	// Only the IO thread increments the queued count, so it cannot grow between this check and the message being queued
+	uint64_t maxQueued = conf->SessionMaxQueuedMessages;
+	if (maxQueued && session->QueuedMessages() >= maxQueued) {
+		std::string comment = std::string("You have too many messages waiting to be processed. Limit: ") +
+				      std::to_string(maxQueued) + ".";
+		if (!RejectMessage(hdl, session, opCode, payload, comment))
+			return true;
+		_queueFullMessages++;
+		return false;
+	}
+
+	uint64_t sessionRate = conf->SessionRateLimit;
+	if (!session->TryTakeMessageToken(sessionRate, now)) {
+		std::string comment =
+			std::string("You are over your message rate limit. Limit: ") + std::to_string(sessionRate) + "/s.";
+		if (!RejectMessage(hdl, session, opCode, payload, comment))
+			return true;
+		_rateLimitedMessages++;
+		return false;
+	}
+
+	return true;
+}
+
+// Answers a `Request` or `RequestBatch` message with `RequestStatus::RateLimited` for all of its requests, without doing any
+// of their work. Returns false for any other message, and for messages which are invalid, which are left to the worker
+// thread so that `Identify` and `Reidentify` are never lost, and invalid messages close the session as usual.
+bool WebSocketServer::RejectMessage(websocketpp::connection_hdl hdl, SessionPtr session,
+				    websocketpp::frame::opcode::value opCode, const std::string &payload,
+				    const std::string &comment)
+{
+	if (!session->IsIdentified())
+		return false;
+
+	json message;
+	uint8_t sessionEncoding = session->Encoding();
+	try {
+		if (sessionEncoding == WebSocketEncoding::Json && opCode == websocketpp::frame::opcode::text)
+			message = json::parse(payload);
+		else if (sessionEncoding == WebSocketEncoding::MsgPack && opCode == websocketpp::frame::opcode::binary)
+			message = json::from_msgpack(payload);
+		else
+			return false;
+	} catch (json::parse_error &e) {
+		UNUSED_PARAMETER(e);
+		return false;
+	}
+
+	std::string closeReason;
+	if (ProtocolMessages::ValidateMessage(message, true, closeReason) != WebSocketCloseCode::DontClose ||
+	    ProtocolMessages::ValidatePayloadData(message["d"], closeReason) != WebSocketCloseCode::DontClose)
+		return false;
+
+	json &payloadData = message["d"];
+	json response;
+	switch ((WebSocketOpCode::WebSocketOpCode)message["op"]) {
+	case WebSocketOpCode::Request:
+		if (ProtocolMessages::ValidateRequest(payloadData, closeReason) != WebSocketCloseCode::DontClose)
+			return false;
+
+		response["op"] = WebSocketOpCode::RequestResponse;
+		response["d"] = ProtocolMessages::ConstructRequestResult(
+			RequestResult::Error(RequestStatus::RateLimited, comment), payloadData);
+		session->IncrementRateLimitedRequests();
+		break;
+	case WebSocketOpCode::RequestBatch: {
+		if (!payloadData.contains("requestId") || !payloadData.contains("requests") || !payloadData["requests"].is_array())
+			return false;
+
+		// Matches the worker thread, which stops after the first failed request when halting on failure
+		bool haltOnFailure = payloadData.contains("haltOnFailure") && payloadData["haltOnFailure"].is_boolean() &&
+				     payloadData["haltOnFailure"].get<bool>();
+
+		json results = json::array();
+		for (auto &requestJson : payloadData["requests"]) {
+			if (!requestJson.is_object())
+				return false;
+			if (!requestJson["requestType"].is_string())
+				requestJson["requestType"] = "";
+			results.push_back(ProtocolMessages::ConstructRequestResult(
+				RequestResult::Error(RequestStatus::RateLimited, comment), requestJson));
+			session->IncrementRateLimitedRequests();
+			if (haltOnFailure)
+				break;
+		}
+
+		response["op"] = WebSocketOpCode::RequestBatchResponse;
+		response["d"]["requestId"] = payloadData["requestId"];
+		response["d"]["results"] = std::move(results);
+	} break;
+	default:
+		return false;
+	}
+
+	session->IncrementIncomingMessages();
+	SendSessionMessage(hdl, session, response);
+	return true;
+}
+
+// Called by the request handler before doing any work for a session's request, including requests in batches.
+// Returns false with `comment` set if the request should be rejected with `RequestStatus::RateLimited`.
+bool WebSocketServer::AdmitRequest(SessionPtr session, const std::string &requestType, std::string &comment)
+{
+	auto conf = GetConfig();
+	if (!conf)
+		return true;
+
+	Utils::RateLimit::RequestClass requestClass = Utils::RateLimit::GetRequestClass(requestType);
+	uint64_t now = os_gettime_ns();
+
+	// While the pool is backed up, bulk requests are shed from the sessions holding at least their share of the queued
+	// messages, so that control requests keep a steady latency and sessions not causing the backlog are left alone
+	if (requestClass == Utils::RateLimit::Bulk && now < _sheddingUntil) {
+		uint64_t fairShare = std::max<uint64_t>(_queuedMessages / std::max<uint64_t>(_sessionCount, 1), 1);
+		if (session->QueuedMessages() >= fairShare) {
+			_shedRequests++;
+			comment = "The server is overloaded, and you have a large share of the waiting messages, so your bulk "
+				  "requests are not being processed. Try again later.";
+			return false;
+		}
+	}
+
+	uint64_t classRate = GetRequestClassRateLimit(conf, requestClass);
+	if (!session->TryTakeRequestToken(requestClass, classRate, now)) {
+		session->IncrementRateLimitedRequests();
+		_rateLimitedRequests[requestClass]++;
+		comment = std::string("You are over the rate limit for ") + Utils::RateLimit::GetRequestClassName(requestClass) +
+			  " requests: " + std::to_string(classRate) + "/s.";
+		return false;
+	}
+
+	return true;
+}
+
+// Called for every message picked up by a worker thread. Messages waiting longer than `admission_queue_wait_ms` mean the
+// pool is backed up, so `AdmitRequest()` sheds bulk requests from the sessions holding the most queued messages, until
+// messages have been picked up in time for `ADMISSION_SHED_HOLD_MS`.
+void WebSocketServer::UpdateAdmission(uint64_t queueWait, uint64_t now)
+{
+	auto conf = GetConfig();
+	uint64_t threshold = conf ? conf->AdmissionQueueWait * 1000000 : 0;
+	if (!threshold || queueWait < threshold)
+		return;
+
+	if (now >= _sheddingUntil)
+		blog(LOG_WARNING,
+		     "[WebSocketServer::UpdateAdmission] A message waited %.1f ms for a worker thread. Shedding bulk requests.",
+		     (double)queueWait / 1000000.0);
+	_sheddingUntil = now + (uint64_t)ADMISSION_SHED_HOLD_MS * 1000000;
 }
 
 void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::ProcessResult &ret,
 				     WebSocketOpCode::WebSocketOpCode opCode, json &payloadData)
 {
-	if (!payloadData.is_object()) {
-		if (payloadData.is_null()) {
-			ret.closeCode = WebSocketCloseCode::MissingDataField;
-			ret.closeReason = "Your payload is missing data (`d`).";
-		} else {
-			ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
-			ret.closeReason = "Your payload's data (`d`) is not an object.";
-		}
+	ret.closeCode = ProtocolMessages::ValidatePayloadData(payloadData, ret.closeReason);
+	if (ret.closeCode != WebSocketCloseCode::DontClose)
 		return;
-	}
 
 	// Only `Identify` is allowed when not identified
 	if (!session->IsIdentified() && opCode != WebSocketOpCode::Identify) {
@@ -148,12 +534,19 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 		if (ret.closeCode != WebSocketCloseCode::DontClose)
 			return;
 
+		// Force full snapshots so that the new session has a base to apply deltas to
+		if (session->EventDeltas())
+			ResetDeltaEventStates();
+
+		// Configure the meters before subscribing, so that the meter handler is created with the right parameters
+		UpdateInputVolumeMetersConfig();
+
 		// Announce subscribe
-		if (_clientSubscriptionCallback)
-			_clientSubscriptionCallback(true, session->EventSubscriptions());
+		AnnounceSubscriptionChange(true, session->EventSubscriptions());
 
 		// Mark session as identified
 		session->SetIsIdentified(true);
+		_identifiedSessionCount++;
 
 		// Send desktop notification. TODO: Move to UI code
 		auto conf = GetConfig();
@@ -172,40 +565,33 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 		std::unique_lock<std::mutex> sessionLock(session->OperationMutex);
 
 		// Announce unsubscribe
-		if (_clientSubscriptionCallback)
-			_clientSubscriptionCallback(false, session->EventSubscriptions());
+		AnnounceSubscriptionChange(false, session->EventSubscriptions());
+
+		bool hadEventDeltas = session->EventDeltas();
+		uint64_t previousEventSubscriptions = session->EventSubscriptions();
 
 		SetSessionParameters(session, ret, payloadData);
 		if (ret.closeCode != WebSocketCloseCode::DontClose)
 			return;
 
+		// The session has no base for events it was not receiving deltas of, so force full snapshots
+		uint64_t newEventSubscriptions = session->EventSubscriptions() & ~previousEventSubscriptions;
+		if (session->EventDeltas() && (!hadEventDeltas || (newEventSubscriptions & DELTA_EVENT_SUBSCRIPTIONS)))
+			ResetDeltaEventStates();
+
+		UpdateInputVolumeMetersConfig();
+
 		// Announce subscribe
-		if (_clientSubscriptionCallback)
-			_clientSubscriptionCallback(true, session->EventSubscriptions());
+		AnnounceSubscriptionChange(true, session->EventSubscriptions());
 
 		ret.result["op"] = WebSocketOpCode::Identified;
 		ret.result["d"]["negotiatedRpcVersion"] = session->RpcVersion();
 	}
 		return;
 	case WebSocketOpCode::Request: { // Request
-		// RequestID checking has to be done here where we are able to close the connection.
-		if (!payloadData.contains("requestId")) {
-			ret.closeCode = WebSocketCloseCode::MissingDataField;
-			ret.closeReason = "Your payload data is missing a `requestId`.";
-			return;
-		}
-
-		if (!payloadData.contains("requestType")) {
-			ret.closeCode = WebSocketCloseCode::MissingDataField;
-			ret.closeReason = "Your payload's data is missing an `requestType`.";
-			return;
-		}
-
-		if (!payloadData["requestType"].is_string()) {
-			ret.closeCode = WebSocketCloseCode::InvalidDataFieldType;
-			ret.closeReason = "Your `requestType` is not a string.";
+		ret.closeCode = ProtocolMessages::ValidateRequest(payloadData, ret.closeReason);
+		if (ret.closeCode != WebSocketCloseCode::DontClose)
 			return;
-		}
 
 		std::string requestType = payloadData["requestType"];
 		RequestResult requestResult;
@@ -219,6 +605,8 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			requestResult = RequestResult::Error(RequestStatus::NotReady, "OBS is not ready to perform the request.");
 		}
 
+		ret.requestType = requestType;
+
 		json resultPayloadData;
 		resultPayloadData["requestType"] = requestType;
 		resultPayloadData["requestId"] = payloadData["requestId"];
@@ -226,10 +614,13 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 						      {"code", requestResult.StatusCode}};
 		if (!requestResult.Comment.empty())
 			resultPayloadData["requestStatus"]["comment"] = requestResult.Comment;
-		if (requestResult.ResponseData.is_object())
-			resultPayloadData["responseData"] = requestResult.ResponseData;
+		if (requestResult.ResponseData.is_object()) {
+			resultPayloadData["responseData"] = std::move(requestResult.ResponseData);
+			if (session->Encoding() == WebSocketEncoding::Json)
+				ExtractBinaryAttachments(session, resultPayloadData["responseData"], ret.binaryAttachments);
+		}
 		ret.result["op"] = WebSocketOpCode::RequestResponse;
-		ret.result["d"] = resultPayloadData;
+		ret.result["d"] = std::move(resultPayloadData);
 	}
 		return;
 	case WebSocketOpCode::RequestBatch: { // RequestBatch
@@ -307,19 +698,8 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 		std::vector<json> requests = payloadData["requests"];
 		std::vector<RequestResult> resultsVector;
 		if (_obsReady) {
-			std::vector<RequestBatchRequest> requestsVector;
-			for (auto &requestJson : requests) {
-				if (!requestJson["requestType"].is_string())
-					requestJson["requestType"] =
-						""; // Workaround for what would otherwise be extensive additional logic for a rare edge case
-				std::string requestType = requestJson["requestType"];
-				json requestData = requestJson["requestData"];
-				json inputVariables = requestJson["inputVariables"];
-				json outputVariables = requestJson["outputVariables"];
-				requestsVector.emplace_back(requestType, requestData, executionType, inputVariables,
-							    outputVariables);
-			}
-
+			std::vector<RequestBatchRequest> requestsVector =
+				ProtocolMessages::BuildBatchRequests(requests, executionType);
 			resultsVector = RequestBatchHandler::ProcessRequestBatch(
 				_threadPool, session, executionType, requestsVector, payloadData["variables"], haltOnFailure);
 		} else {
@@ -333,16 +713,19 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 			}
 		}
 
+		bool extractBinary = (session->Encoding() == WebSocketEncoding::Json);
 		size_t i = 0;
 		std::vector<json> results;
 		for (auto &requestResult : resultsVector) {
-			results.push_back(ConstructRequestResult(requestResult, requests[i]));
+			results.push_back(ProtocolMessages::ConstructRequestResult(std::move(requestResult), requests[i]));
+			if (extractBinary && results.back().contains("responseData"))
+				ExtractBinaryAttachments(session, results.back()["responseData"], ret.binaryAttachments);
 			i++;
 		}
 
 		ret.result["op"] = WebSocketOpCode::RequestBatchResponse;
 		ret.result["d"]["requestId"] = payloadData["requestId"];
-		ret.result["d"]["results"] = results;
+		ret.result["d"]["results"] = std::move(results);
 	}
 		return;
 	default:
@@ -352,14 +735,110 @@ void WebSocketServer::ProcessMessage(SessionPtr session, WebSocketServer::Proces
 	}
 }
 
+// Builds the event data sent to sessions with `eventDeltas` enabled. Returns false if nothing changed since the last event.
+// MUST BE CALLED IN EMISSION ORDER, as it updates the last-sent state of the object
+bool WebSocketServer::BuildDeltaEventData(const std::string &eventType, const json &eventData, json &deltaEventData)
+{
+	const char *deltaField = GetDeltaEventField(eventType);
+	std::string objectKey = GetDeltaEventObjectKey(eventType, eventData);
+	if (!deltaField || objectKey.empty() || !eventData.contains(deltaField)) {
+		deltaEventData = eventData;
+		return true;
+	}
+
+	const json &currentValue = eventData[deltaField];
+
+	// Copy everything except the delta field, which is set below
+	deltaEventData = json::object();
+	for (auto &[key, value] : eventData.items()) {
+		if (key != deltaField)
+			deltaEventData[key] = value;
+	}
+
+	std::unique_lock<std::mutex> lock(_deltaEventMutex);
+	DeltaEventState &state = _deltaEventStates[objectKey];
+
+	if (!state.lastSent.is_null()) {
+		json patch = Utils::Json::CreateMergePatch(state.lastSent, currentValue);
+		if (patch.empty())
+			return false;
+
+		if (++state.eventsSinceSnapshot < DELTA_EVENT_SNAPSHOT_INTERVAL) {
+			deltaEventData[deltaField] = patch;
+			deltaEventData["isDelta"] = true;
+			state.lastSent = currentValue;
+			return true;
+		}
+	}
+
+	// First event for this object, or a periodic resync
+	state.eventsSinceSnapshot = 0;
+	state.lastSent = currentValue;
+	deltaEventData[deltaField] = currentValue;
+	deltaEventData["isDelta"] = false;
+	return true;
+}
+
+// Drops last-sent delta state for objects which no longer exist
+void WebSocketServer::UpdateDeltaEventStates(const std::string &eventType, const json &eventData)
+{
+	std::unique_lock<std::mutex> lock(_deltaEventMutex);
+	if (_deltaEventStates.empty())
+		return;
+
+	if (eventType == "CurrentSceneCollectionChanging") {
+		_deltaEventStates.clear();
+		return;
+	}
+
+	// Scene items of a removed scene do not get their own removal events
+	if (eventType == "SceneRemoved" && eventData.contains("sceneUuid") && eventData["sceneUuid"].is_string()) {
+		std::string keyPrefix = "sceneItem:" + eventData["sceneUuid"].get<std::string>() + ":";
+		for (auto it = _deltaEventStates.begin(); it != _deltaEventStates.end();) {
+			if (it->first.rfind(keyPrefix, 0) == 0)
+				it = _deltaEventStates.erase(it);
+			else
+				++it;
+		}
+		return;
+	}
+
+	std::string objectKey = GetDeltaEventObjectKey(eventType, eventData);
+	if (!objectKey.empty() && !GetDeltaEventField(eventType))
+		_deltaEventStates.erase(objectKey);
+}
+
+void WebSocketServer::ResetDeltaEventStates()
+{
+	std::unique_lock<std::mutex> lock(_deltaEventMutex);
+	_deltaEventStates.clear();
+}
+
 // It isn't consistent to directly call the WebSocketServer from the events system, but it would also be dumb to make it unnecessarily complicated.
 void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string &eventType, const json &eventData,
-				     uint8_t rpcVersion)
+				     uint8_t rpcVersion, uint64_t emittedAt)
 {
 	if (!_server.is_listening() || !_obsReady)
 		return;
 
+	// Vendor events do not come through the event handler, so they are counted here
+	if (!emittedAt) {
+		emittedAt = os_gettime_ns();
+		auto eventMetrics = GetEventMetrics();
+		if (eventMetrics)
+			eventMetrics->RecordEmitted(eventType);
+	}
+
+	// Recorded before queuing, as the binary meter frames using a mapping are sent synchronously right after it
+	if (eventType == "InputVolumeMetersMapping")
+		UpdateInputVolumeMetersMapping(eventData);
+
+	_queuedTasks++;
 	_threadPool.start(Utils::Compat::CreateFunctionRunnable([=]() {
+		_queuedTasks--;
+
+		ScopeProfiler prof{"obs_websocket_event_broadcast"};
+
 		// Populate message object
 		json eventMessage;
 		eventMessage["op"] = 5;
@@ -372,6 +851,81 @@ void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string
 		std::string messageJson;
 		std::string messageMsgPack;
 
+		// Delta-encoded variant of the message, only built if a subscribed session has `eventDeltas` enabled
+		bool supportsDelta = eventData.is_object() && GetDeltaEventField(eventType);
+		bool deltaBuilt = false;
+		bool deltaChanged = false;
+		json deltaEventMessage;
+		std::string deltaMessageJson;
+		std::string deltaMessageMsgPack;
+
+		UpdateDeltaEventStates(eventType, eventData);
+
+		if (eventType == "InputNameChanged" && eventData.is_object())
+			RenameInputVolumeMetersInput(eventData["oldInputName"].get<std::string>(),
+						     eventData["inputName"].get<std::string>());
+
+		// Volume meters are downsampled and filtered per session
+		bool isInputVolumeMeters = (requiredIntent == EventSubscription::InputVolumeMeters);
+
+		// Filtered volume meter messages, built and encoded once per distinct input selection
+		struct FilteredMessage {
+			json message;
+			std::string messageJson;
+			std::string messageMsgPack;
+		};
+		std::map<std::vector<std::string>, FilteredMessage> filteredMessages;
+		uint64_t now = isInputVolumeMeters ? os_gettime_ns() : 0;
+		uint64_t tolerance = _inputVolumeMetersPeriod * 500000; // Half of the meter update period
+
+		uint64_t messagesSent = 0;
+		uint64_t jsonBytesSent = 0;
+		uint64_t msgPackBytesSent = 0;
+		uint64_t bufferedBytes = 0;
+		uint64_t bufferedBytesMax = 0;
+
+		auto sendMessage = [&](websocketpp::connection_hdl hdl, SessionPtr &session, const json &message,
+				       std::string &encodedJson, std::string &encodedMsgPack) {
+			websocketpp::lib::error_code errorCode;
+			switch (session->Encoding()) {
+			case WebSocketEncoding::Json:
+				if (encodedJson.empty())
+					encodedJson = message.dump();
+				_server.send(hdl, encodedJson, websocketpp::frame::opcode::text, errorCode);
+				session->IncrementOutgoingMessages();
+				jsonBytesSent += encodedJson.size();
+				if (_traceRecorder)
+					_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, false,
+							       encodedJson.data(), encodedJson.size());
+				break;
+			case WebSocketEncoding::MsgPack:
+				if (encodedMsgPack.empty()) {
+					auto msgPackData = json::to_msgpack(message);
+					encodedMsgPack = std::string(msgPackData.begin(), msgPackData.end());
+				}
+				_server.send(hdl, encodedMsgPack, websocketpp::frame::opcode::binary, errorCode);
+				session->IncrementOutgoingMessages();
+				msgPackBytesSent += encodedMsgPack.size();
+				if (_traceRecorder)
+					_traceRecorder->Record(os_gettime_ns(), session->Id(), Utils::Trace::Outbound, true,
+							       encodedMsgPack.data(), encodedMsgPack.size());
+				break;
+			}
+			if (errorCode) {
+				blog(LOG_ERROR, "[WebSocketServer::BroadcastEvent] Error sending event message: %s",
+				     errorCode.message().c_str());
+				return;
+			}
+
+			messagesSent++;
+			auto conn = _server.get_con_from_hdl(hdl, errorCode);
+			if (!errorCode) {
+				uint64_t connBufferedBytes = conn->get_buffered_amount();
+				bufferedBytes += connBufferedBytes;
+				bufferedBytesMax = std::max(bufferedBytesMax, connBufferedBytes);
+			}
+		};
+
 		// Recurse connected sessions and send the event to suitable sessions.
 		std::unique_lock<std::mutex> lock(_sessionMutex);
 		for (auto &it : _sessions) {
@@ -379,33 +933,287 @@ void WebSocketServer::BroadcastEvent(uint64_t requiredIntent, const std::string
 				continue;
 			if (rpcVersion && it.second->RpcVersion() != rpcVersion)
 				continue;
-			if ((it.second->EventSubscriptions() & requiredIntent) != 0) {
-				websocketpp::lib::error_code errorCode;
-				switch (it.second->Encoding()) {
-				case WebSocketEncoding::Json:
-					if (messageJson.empty())
-						messageJson = eventMessage.dump();
-					_server.send((websocketpp::connection_hdl)it.first, messageJson,
-						     websocketpp::frame::opcode::text, errorCode);
-					it.second->IncrementOutgoingMessages();
-					break;
-				case WebSocketEncoding::MsgPack:
-					if (messageMsgPack.empty()) {
-						auto msgPackData = json::to_msgpack(eventMessage);
-						messageMsgPack = std::string(msgPackData.begin(), msgPackData.end());
+			if ((it.second->EventSubscriptions() & requiredIntent) == 0)
+				continue;
+
+			if (isInputVolumeMeters) {
+				if (!it.second->ShouldSendInputVolumeMeters(now, tolerance))
+					continue;
+
+				if (it.second->HasInputVolumeMetersInputs()) {
+					auto inputs = it.second->InputVolumeMetersInputs();
+					auto filtered = filteredMessages.find(inputs);
+					if (filtered == filteredMessages.end()) {
+						json filteredEventMessage = FilterInputVolumeMeters(eventMessage, inputs);
+						filtered = filteredMessages.emplace(inputs, FilteredMessage{filteredEventMessage}).first;
 					}
-					_server.send((websocketpp::connection_hdl)it.first, messageMsgPack,
-						     websocketpp::frame::opcode::binary, errorCode);
-					it.second->IncrementOutgoingMessages();
-					break;
+					sendMessage(it.first, it.second, filtered->second.message, filtered->second.messageJson,
+						    filtered->second.messageMsgPack);
+					continue;
+				}
+			}
+
+			if (supportsDelta && it.second->EventDeltas()) {
+				// Deltas are computed once per broadcast, while holding the session lock to preserve send order
+				if (!deltaBuilt) {
+					deltaBuilt = true;
+					deltaEventMessage["op"] = 5;
+					deltaEventMessage["d"]["eventType"] = eventType;
+					deltaEventMessage["d"]["eventIntent"] = requiredIntent;
+					deltaChanged = BuildDeltaEventData(eventType, eventData, deltaEventMessage["d"]["eventData"]);
 				}
-				if (errorCode)
-					blog(LOG_ERROR, "[WebSocketServer::BroadcastEvent] Error sending event message: %s",
-					     errorCode.message().c_str());
+				if (deltaChanged)
+					sendMessage(it.first, it.second, deltaEventMessage, deltaMessageJson, deltaMessageMsgPack);
+				continue;
 			}
+
+			sendMessage(it.first, it.second, eventMessage, messageJson, messageMsgPack);
 		}
 		lock.unlock();
+
+		auto eventMetrics = GetEventMetrics();
+		if (eventMetrics)
+			eventMetrics->RecordBroadcast(eventType, messagesSent, jsonBytesSent, msgPackBytesSent,
+						      os_gettime_ns() - emittedAt);
+
+		_broadcastEvents++;
+		_broadcastMessages += messagesSent;
+		if (messagesSent)
+			UpdateOutboundBufferedBytes(bufferedBytes, bufferedBytesMax);
+
 		if (IsDebugEnabled() && (EventSubscription::All & requiredIntent) != 0) // Don't log high volume events
 			blog(LOG_INFO, "[WebSocketServer::BroadcastEvent] Outgoing event:\n%s", eventMessage.dump(2).c_str());
 	}));
 }
+
+// Sends a pre-encoded binary frame to all identified sessions subscribed to `requiredIntent`. MsgPack sessions get it wrapped
+// in a `BinaryFrame` event. Sent synchronously, as `data` is only valid for the duration of the call.
+void WebSocketServer::BroadcastBinaryEvent(uint64_t requiredIntent, const uint8_t *data, size_t size)
+{
+	if (!_server.is_listening() || !_obsReady)
+		return;
+
+	// Binary volume meters are downsampled per session, like their JSON counterpart
+	bool isInputVolumeMeters = (requiredIntent == EventSubscription::InputVolumeMetersBinary);
+	uint64_t now = isInputVolumeMeters ? os_gettime_ns() : 0;
+	uint64_t tolerance = _inputVolumeMetersPeriod * 500000; // Half of the meter update period
+
+	uint64_t messagesSent = 0;
+	uint64_t bufferedBytes = 0;
+	uint64_t bufferedBytesMax = 0;
+
+	// Only built if a MsgPack session is subscribed
+	bool msgPackFrameBuilt = false;
+
+	std::unique_lock<std::mutex> lock(_sessionMutex);
+	for (auto &it : _sessions) {
+		if (!it.second->IsIdentified())
+			continue;
+		if ((it.second->EventSubscriptions() & requiredIntent) == 0)
+			continue;
+		if (isInputVolumeMeters && !it.second->ShouldSendInputVolumeMeters(now, tolerance, true))
+			continue;
+
+		// Sessions selecting inputs get their own copy of the frame, like the filtered `InputVolumeMeters` event
+		bool filtered = isInputVolumeMeters && it.second->HasInputVolumeMetersInputs() &&
+				FilterInputVolumeMetersFrame(it.second, data, size, _filteredFrameBuffer);
+		const uint8_t *frameData = filtered ? _filteredFrameBuffer.data() : data;
+		size_t frameSize = filtered ? _filteredFrameBuffer.size() : size;
+
+		websocketpp::lib::error_code errorCode;
+		if (it.second->Encoding() == WebSocketEncoding::MsgPack) {
+			if (filtered || !msgPackFrameBuilt) {
+				EncodeMsgPackBinaryFrame(_msgPackFrameBuffer, requiredIntent, frameData, frameSize);
+				msgPackFrameBuilt = !filtered;
+			}
+			_server.send((websocketpp::connection_hdl)it.first, _msgPackFrameBuffer.data(), _msgPackFrameBuffer.size(),
+				     websocketpp::frame::opcode::binary, errorCode);
+		} else {
+			_server.send((websocketpp::connection_hdl)it.first, frameData, frameSize, websocketpp::frame::opcode::binary,
+				     errorCode);
+		}
+		it.second->IncrementOutgoingMessages();
+		if (errorCode) {
+			blog(LOG_ERROR, "[WebSocketServer::BroadcastBinaryEvent] Error sending event message: %s",
+			     errorCode.message().c_str());
+			continue;
+		}
+
+		messagesSent++;
+		auto conn = _server.get_con_from_hdl(it.first, errorCode);
+		if (!errorCode) {
+			uint64_t connBufferedBytes = conn->get_buffered_amount();
+			bufferedBytes += connBufferedBytes;
+			bufferedBytesMax = std::max(bufferedBytesMax, connBufferedBytes);
+		}
+	}
+	lock.unlock();
+
+	_broadcastEvents++;
+	_broadcastMessages += messagesSent;
+	if (messagesSent)
+		UpdateOutboundBufferedBytes(bufferedBytes, bufferedBytesMax);
+}
+
+// Sends a pre-encoded binary frame to a single session, if it is still connected and identified. MsgPack sessions get it
+// wrapped in a `BinaryFrame` event. Sent synchronously, as `data` is only valid for the duration of the call.
+void WebSocketServer::SendSessionBinaryMessage(uint32_t sessionId, const uint8_t *data, size_t size)
+{
+	if (!_server.is_listening())
+		return;
+
+	std::unique_lock<std::mutex> lock(_sessionMutex);
+	for (auto &it : _sessions) {
+		if (it.second->Id() != sessionId)
+			continue;
+		if (!it.second->IsIdentified())
+			return;
+
+		websocketpp::lib::error_code errorCode;
+		if (it.second->Encoding() == WebSocketEncoding::MsgPack) {
+			EncodeMsgPackBinaryFrame(_msgPackFrameBuffer, 0, data, size);
+			_server.send((websocketpp::connection_hdl)it.first, _msgPackFrameBuffer.data(), _msgPackFrameBuffer.size(),
+				     websocketpp::frame::opcode::binary, errorCode);
+		} else {
+			_server.send((websocketpp::connection_hdl)it.first, data, size, websocketpp::frame::opcode::binary,
+				     errorCode);
+		}
+		it.second->IncrementOutgoingMessages();
+		if (errorCode)
+			blog(LOG_ERROR, "[WebSocketServer::SendSessionBinaryMessage] Error sending binary message: %s",
+			     errorCode.message().c_str());
+		return;
+	}
+}
+
+// Session input selections may refer to inputs by name, so they follow renames
+void WebSocketServer::RenameInputVolumeMetersInput(const std::string &oldInputName, const std::string &inputName)
+{
+	std::unique_lock<std::mutex> mappingLock(_inputVolumeMetersMappingMutex);
+	for (auto &entry : _inputVolumeMetersMapping) {
+		if (entry.inputName == oldInputName)
+			entry.inputName = inputName;
+	}
+	mappingLock.unlock();
+
+	bool renamed = false;
+
+	std::unique_lock<std::mutex> lock(_sessionMutex);
+	for (auto &it : _sessions) {
+		if (!it.second->HasInputVolumeMetersInputs())
+			continue;
+
+		auto inputs = it.second->InputVolumeMetersInputs();
+		auto input = std::find(inputs.begin(), inputs.end(), oldInputName);
+		if (input == inputs.end())
+			continue;
+
+		*input = inputName;
+		std::sort(inputs.begin(), inputs.end());
+		inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+		it.second->SetInputVolumeMetersInputs(inputs);
+		renamed = true;
+	}
+	lock.unlock();
+
+	if (renamed)
+		UpdateInputVolumeMetersConfig();
+}
+
+void WebSocketServer::UpdateInputVolumeMetersMapping(const json &eventData)
+{
+	if (!eventData.is_object() || !eventData["mappingSequence"].is_number_unsigned() || !eventData["inputs"].is_array())
+		return;
+
+	std::lock_guard<std::mutex> lock(_inputVolumeMetersMappingMutex);
+	_inputVolumeMetersMappingSequence = eventData["mappingSequence"];
+	_inputVolumeMetersMapping.clear();
+	for (auto &input : eventData["inputs"]) {
+		size_t inputIndex = input["inputIndex"].get<size_t>();
+		if (inputIndex >= _inputVolumeMetersMapping.size())
+			_inputVolumeMetersMapping.resize(inputIndex + 1);
+		_inputVolumeMetersMapping[inputIndex] = {input["inputName"].get<std::string>(),
+							 input["inputUuid"].get<std::string>()};
+	}
+}
+
+// Copies the header and the entries of a binary meter frame which `session` selected into `out`, which is reused across
+// frames. Returns false if the frame can not be filtered, because it is malformed or its mapping is not the last announced
+// one, in which case it is sent whole.
+bool WebSocketServer::FilterInputVolumeMetersFrame(SessionPtr session, const uint8_t *data, size_t size,
+						   std::vector<uint8_t> &out)
+{
+	if (size < VOLUME_METER_FRAME_HEADER_SIZE)
+		return false;
+
+	uint32_t mappingSequence;
+	memcpy(&mappingSequence, data + 8, sizeof(uint32_t));
+
+	std::lock_guard<std::mutex> lock(_inputVolumeMetersMappingMutex);
+	if (mappingSequence != _inputVolumeMetersMappingSequence)
+		return false;
+
+	out.assign(data, data + VOLUME_METER_FRAME_HEADER_SIZE);
+	uint16_t inputCount = 0;
+	size_t offset = VOLUME_METER_FRAME_HEADER_SIZE;
+	while (offset + VOLUME_METER_FRAME_ENTRY_HEADER_SIZE <= size) {
+		uint16_t inputIndex;
+		memcpy(&inputIndex, data + offset, sizeof(uint16_t));
+		uint8_t channelCount = data[offset + 2];
+		size_t entrySize = VOLUME_METER_FRAME_ENTRY_HEADER_SIZE + channelCount * 3 * sizeof(float);
+		if (offset + entrySize > size)
+			return false;
+
+		if (inputIndex < _inputVolumeMetersMapping.size()) {
+			auto &entry = _inputVolumeMetersMapping[inputIndex];
+			if (session->WantsInputVolumeMetersInput(entry.inputName, entry.inputUuid)) {
+				out.insert(out.end(), data + offset, data + offset + entrySize);
+				inputCount++;
+			}
+		}
+		offset += entrySize;
+	}
+
+	memcpy(out.data() + 6, &inputCount, sizeof(uint16_t));
+	return true;
+}
+
+// Aggregates the meter parameters of all sessions subscribed to volume meters. The meter handler runs at the fastest
+// requested period, and only meters inputs which at least one session wants.
+void WebSocketServer::UpdateInputVolumeMetersConfig()
+{
+	std::unique_lock<std::mutex> configLock(_inputVolumeMetersConfigMutex);
+
+	uint64_t updatePeriod = 0;
+	bool allInputs = false;
+	std::set<std::string> inputs;
+
+	std::unique_lock<std::mutex> lock(_sessionMutex);
+	for (auto &it : _sessions) {
+		if ((it.second->EventSubscriptions() &
+		     (EventSubscription::InputVolumeMeters | EventSubscription::InputVolumeMetersBinary)) == 0)
+			continue;
+
+		uint64_t period = it.second->InputVolumeMetersPeriod();
+		if (!updatePeriod || period < updatePeriod)
+			updatePeriod = period;
+
+		auto sessionInputs = it.second->InputVolumeMetersInputs();
+		if (sessionInputs.empty())
+			allInputs = true;
+		else
+			inputs.insert(sessionInputs.begin(), sessionInputs.end());
+	}
+	lock.unlock();
+
+	if (!updatePeriod)
+		updatePeriod = INPUT_VOLUME_METERS_DEFAULT_PERIOD;
+	_inputVolumeMetersPeriod = updatePeriod;
+
+	std::vector<std::string> inputFilter;
+	if (!allInputs)
+		inputFilter.assign(inputs.begin(), inputs.end());
+
+	if (_inputVolumeMetersConfigCallback)
+		_inputVolumeMetersConfigCallback(updatePeriod, inputFilter);
+}
@@ -0,0 +1,124 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#include "ProtocolMessages.h"
+
+WebSocketCloseCode::WebSocketCloseCode ProtocolMessages::ValidateMessage(const json &message, bool identified,
+									 std::string &closeReason)
+{
+	// Verify incoming message is an object
+	if (!message.is_object()) {
+		closeReason = "You sent a non-object payload.";
+		return WebSocketCloseCode::MessageDecodeError;
+	}
+
+	// Disconnect client if 4.x protocol is detected
+	if (!identified && message.contains("request-type")) {
+		closeReason =
+			"You appear to be attempting to connect with the pre-5.0.0 plugin protocol. Check to make sure your client is updated.";
+		return WebSocketCloseCode::UnsupportedRpcVersion;
+	}
+
+	// Validate op code
+	if (!message.contains("op")) {
+		closeReason = "Your request is missing an `op`.";
+		return WebSocketCloseCode::UnknownOpCode;
+	}
+
+	if (!message["op"].is_number()) {
+		closeReason = "Your `op` is not a number.";
+		return WebSocketCloseCode::UnknownOpCode;
+	}
+
+	return WebSocketCloseCode::DontClose;
+}
+
+WebSocketCloseCode::WebSocketCloseCode ProtocolMessages::ValidatePayloadData(const json &payloadData, std::string &closeReason)
+{
+	if (payloadData.is_null()) {
+		closeReason = "Your payload is missing data (`d`).";
+		return WebSocketCloseCode::MissingDataField;
+	}
+
+	if (!payloadData.is_object()) {
+		closeReason = "Your payload's data (`d`) is not an object.";
+		return WebSocketCloseCode::InvalidDataFieldType;
+	}
+
+	return WebSocketCloseCode::DontClose;
+}
+
+WebSocketCloseCode::WebSocketCloseCode ProtocolMessages::ValidateRequest(const json &payloadData, std::string &closeReason)
+{
+	// RequestID checking has to be done here where we are able to close the connection.
+	if (!payloadData.contains("requestId")) {
+		closeReason = "Your payload data is missing a `requestId`.";
+		return WebSocketCloseCode::MissingDataField;
+	}
+
+	if (!payloadData.contains("requestType")) {
+		closeReason = "Your payload's data is missing an `requestType`.";
+		return WebSocketCloseCode::MissingDataField;
+	}
+
+	if (!payloadData["requestType"].is_string()) {
+		closeReason = "Your `requestType` is not a string.";
+		return WebSocketCloseCode::InvalidDataFieldType;
+	}
+
+	return WebSocketCloseCode::DontClose;
+}
+
+std::vector<RequestBatchRequest>
+ProtocolMessages::BuildBatchRequests(std::vector<json> &requests,
+				     RequestBatchExecutionType::RequestBatchExecutionType executionType)
+{
+	std::vector<RequestBatchRequest> ret;
+	for (auto &requestJson : requests) {
+		if (!requestJson["requestType"].is_string())
+			requestJson["requestType"] =
+				""; // Workaround for what would otherwise be extensive additional logic for a rare edge case
+		std::string requestType = requestJson["requestType"];
+		json requestData = requestJson["requestData"];
+		json inputVariables = requestJson["inputVariables"];
+		json outputVariables = requestJson["outputVariables"];
+		ret.emplace_back(requestType, requestData, executionType, inputVariables, outputVariables);
+	}
+	return ret;
+}
+
+json ProtocolMessages::ConstructRequestResult(RequestResult &&requestResult, const json &requestJson)
+{
+	json ret;
+
+	ret["requestType"] = requestJson["requestType"];
+
+	if (requestJson.contains("requestId") && !requestJson["requestId"].is_null())
+		ret["requestId"] = requestJson["requestId"];
+
+	ret["requestStatus"] = {{"result", requestResult.StatusCode == RequestStatus::Success}, {"code", requestResult.StatusCode}};
+
+	if (!requestResult.Comment.empty())
+		ret["requestStatus"]["comment"] = requestResult.Comment;
+
+	if (requestResult.ResponseData.is_object())
+		ret["responseData"] = std::move(requestResult.ResponseData);
+
+	return ret;
+}
@@ -0,0 +1,45 @@
+/*
+obs-websocket
+Copyright (C) 2016-2021 Stephane Lepin <stephane.lepin@gmail.com>
+Copyright (C) 2020-2021 Kyle Manning <tt2468@gmail.com>
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program. If not, see <https://www.gnu.org/licenses/>
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../types/WebSocketCloseCode.h"
+#include "../../requesthandler/rpc/RequestBatchRequest.h"
+#include "../../requesthandler/rpc/RequestResult.h"
+#include "../../utils/Json.h"
+
+// The parts of message processing which do not depend on the server or libobs, so that they can be benchmarked alone.
+// Validation functions return `WebSocketCloseCode::DontClose` if the message is valid, otherwise the code to close the
+// session with, along with `closeReason`.
+namespace ProtocolMessages {
+	// Envelope of every incoming message: an object with a numeric `op`
+	WebSocketCloseCode::WebSocketCloseCode ValidateMessage(const json &message, bool identified, std::string &closeReason);
+	// Data (`d`) of every incoming message
+	WebSocketCloseCode::WebSocketCloseCode ValidatePayloadData(const json &payloadData, std::string &closeReason);
+	// Data of a `Request` message
+	WebSocketCloseCode::WebSocketCloseCode ValidateRequest(const json &payloadData, std::string &closeReason);
+	// `requests` of a `RequestBatch` message. Requests without a string `requestType` get an empty one.
+	std::vector<RequestBatchRequest> BuildBatchRequests(std::vector<json> &requests,
+							    RequestBatchExecutionType::RequestBatchExecutionType executionType);
+	// Entry of the `results` array of a `RequestBatchResponse`
+	json ConstructRequestResult(RequestResult &&requestResult, const json &requestJson);
+}
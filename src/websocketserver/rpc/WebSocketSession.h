@@ -21,10 +21,12 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 
 #include <mutex>
 #include <string>
+#include <vector>
 #include <atomic>
 #include <memory>
 
 #include "../../eventhandler/types/EventSubscription.h"
+#include "../../utils/RateLimit.h"
 #include "plugin-macros.generated.h"
 
 class WebSocketSession;
@@ -32,6 +34,10 @@ typedef std::shared_ptr<WebSocketSession> SessionPtr;
 
 class WebSocketSession {
 public:
+	// Unique for the lifetime of the server, unlike connection handles
+	inline uint32_t Id() { return _id; }
+	inline void SetId(uint32_t id) { _id = id; }
+
 	inline std::string RemoteAddress()
 	{
 		std::lock_guard<std::mutex> lock(_remoteAddressMutex);
@@ -55,6 +61,8 @@ public:
 	inline uint8_t Encoding() { return _encoding; }
 	inline void SetEncoding(uint8_t encoding) { _encoding = encoding; }
 
+	inline uint32_t NextBinaryAttachmentId() { return ++_binaryAttachmentCount; }
+
 	inline bool AuthenticationRequired() { return _authenticationRequired; }
 	inline void SetAuthenticationRequired(bool required) { _authenticationRequired = required; }
 
@@ -89,15 +97,92 @@ public:
 	inline uint64_t EventSubscriptions() { return _eventSubscriptions; }
 	inline void SetEventSubscriptions(uint64_t subscriptions) { _eventSubscriptions = subscriptions; }
 
+	inline bool EventDeltas() { return _eventDeltas; }
+	inline void SetEventDeltas(bool enabled) { _eventDeltas = enabled; }
+
+	inline uint64_t InputVolumeMetersPeriod() { return _inputVolumeMetersPeriod; }
+	inline void SetInputVolumeMetersPeriod(uint64_t period) { _inputVolumeMetersPeriod = period; }
+
+	// Input names or UUIDs to receive volume meters for. Empty for all inputs
+	inline std::vector<std::string> InputVolumeMetersInputs()
+	{
+		std::lock_guard<std::mutex> lock(_inputVolumeMetersInputsMutex);
+		return _inputVolumeMetersInputs;
+	}
+	inline void SetInputVolumeMetersInputs(std::vector<std::string> inputs)
+	{
+		std::lock_guard<std::mutex> lock(_inputVolumeMetersInputsMutex);
+		_inputVolumeMetersInputs = inputs;
+	}
+	inline bool HasInputVolumeMetersInputs()
+	{
+		std::lock_guard<std::mutex> lock(_inputVolumeMetersInputsMutex);
+		return !_inputVolumeMetersInputs.empty();
+	}
+	// Like matching against `InputVolumeMetersInputs()`, without copying them
+	inline bool WantsInputVolumeMetersInput(const std::string &inputName, const std::string &inputUuid)
+	{
+		std::lock_guard<std::mutex> lock(_inputVolumeMetersInputsMutex);
+		if (_inputVolumeMetersInputs.empty())
+			return true;
+		for (auto &input : _inputVolumeMetersInputs) {
+			if (input == inputName || input == inputUuid)
+				return true;
+		}
+		return false;
+	}
+
+	// Downsamples meter updates to the session's requested period. `tolerance` absorbs jitter of the meter update thread
+	inline bool ShouldSendInputVolumeMeters(uint64_t now, uint64_t tolerance, bool binary = false)
+	{
+		std::atomic<uint64_t> &lastSent = binary ? _lastInputVolumeMetersBinarySent : _lastInputVolumeMetersSent;
+		uint64_t period = _inputVolumeMetersPeriod * 1000000;
+		if (now - lastSent + tolerance < period)
+			return false;
+		lastSent = now;
+		return true;
+	}
+
+	// Takes a token from the session's message bucket. The rate is in messages per second, 0 for no limit
+	inline bool TryTakeMessageToken(uint64_t rate, uint64_t now)
+	{
+		std::lock_guard<std::mutex> lock(_requestTokensMutex);
+		if (!_messageTokens.Refill(rate, now))
+			return false;
+		_messageTokens.Take();
+		return true;
+	}
+
+	// Takes a token from the bucket of the request's class. The rate is in requests per second, 0 for no limit
+	inline bool TryTakeRequestToken(Utils::RateLimit::RequestClass requestClass, uint64_t rate, uint64_t now)
+	{
+		std::lock_guard<std::mutex> lock(_requestTokensMutex);
+		Utils::RateLimit::TokenBucket &classTokens = _requestClassTokens[requestClass];
+		if (!classTokens.Refill(rate, now))
+			return false;
+		classTokens.Take();
+		return true;
+	}
+
+	// Messages started on the worker pool, but not yet picked up
+	inline uint64_t QueuedMessages() { return _queuedMessages; }
+	inline void IncrementQueuedMessages() { _queuedMessages++; }
+	inline void DecrementQueuedMessages() { _queuedMessages--; }
+
+	inline uint64_t RateLimitedRequests() { return _rateLimitedRequests; }
+	inline void IncrementRateLimitedRequests() { _rateLimitedRequests++; }
+
 	std::mutex OperationMutex;
 
 private:
+	std::atomic<uint32_t> _id = 0;
 	std::mutex _remoteAddressMutex;
 	std::string _remoteAddress;
 	std::atomic<uint64_t> _connectedAt = 0;
 	std::atomic<uint64_t> _incomingMessages = 0;
 	std::atomic<uint64_t> _outgoingMessages = 0;
 	std::atomic<uint8_t> _encoding = 0;
+	std::atomic<uint32_t> _binaryAttachmentCount = 0;
 	std::atomic<bool> _authenticationRequired = false;
 	std::mutex _secretMutex;
 	std::string _secret;
@@ -106,4 +191,15 @@ private:
 	std::atomic<uint8_t> _rpcVersion = OBS_WEBSOCKET_RPC_VERSION;
 	std::atomic<bool> _isIdentified = false;
 	std::atomic<uint64_t> _eventSubscriptions = EventSubscription::All;
+	std::atomic<bool> _eventDeltas = false;
+	std::atomic<uint64_t> _inputVolumeMetersPeriod = 50;
+	std::atomic<uint64_t> _lastInputVolumeMetersSent = 0;
+	std::atomic<uint64_t> _lastInputVolumeMetersBinarySent = 0;
+	std::mutex _inputVolumeMetersInputsMutex;
+	std::vector<std::string> _inputVolumeMetersInputs;
+	std::mutex _requestTokensMutex;
+	Utils::RateLimit::TokenBucket _messageTokens;
+	Utils::RateLimit::TokenBucket _requestClassTokens[Utils::RateLimit::RequestClassCount];
+	std::atomic<uint64_t> _queuedMessages = 0;
+	std::atomic<uint64_t> _rateLimitedRequests = 0;
 };